@@ -715,6 +715,8 @@ int CPDF_CIDFont::GlyphFromCharCode(uint32_t charcode, bool* pVertGlyph) {
 
     if (m_pFontFile && !m_pCMap->m_pMapping)
       return cid;
+    if (m_Font.IsShared())
+      FT_UseCIDCharmap(m_Font.GetFace(), m_pCMap->m_Coding);
     if (m_pCMap->m_Coding == CIDCODING_UNKNOWN ||
         !FXFT_Get_Face_Charmap(m_Font.GetFace())) {
       return cid;
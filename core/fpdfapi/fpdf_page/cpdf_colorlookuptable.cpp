@@ -0,0 +1,165 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#include "core/fpdfapi/fpdf_page/cpdf_colorlookuptable.h"
+
+#include <algorithm>
+
+#include "core/fpdfapi/fpdf_page/cpdf_colorspace.h"
+#include "core/fxcrt/fx_ext.h"
+
+namespace {
+
+// Coarser grids lose too much of the shape of a tint transform.
+const int kMinGridSize = 5;
+
+// GetGridSize() returns 0 above this, since kMinGridSize ^ 6 is the largest
+// power of kMinGridSize within kMaxGridPoints.
+const uint32_t kMaxGridComponents = 6;
+
+uint8_t ToByte(FX_FLOAT value) {
+  return static_cast<uint8_t>(static_cast<int32_t>(value * 255));
+}
+
+}  // namespace
+
+// static
+int CPDF_ColorLookupTable::GetGridSize(uint32_t nComponents) {
+  if (nComponents == 0 || nComponents > kMaxGridComponents)
+    return 0;
+  if (nComponents == 1)
+    return 256;
+
+  int size = 2;
+  while (size < 256) {
+    int points = 1;
+    for (uint32_t i = 0; i < nComponents; ++i)
+      points *= size + 1;
+    if (points > kMaxGridPoints)
+      break;
+    ++size;
+  }
+  return size >= kMinGridSize ? size : 0;
+}
+
+CPDF_ColorLookupTable::CPDF_ColorLookupTable()
+    : m_nComponents(0), m_GridSize(0) {}
+
+CPDF_ColorLookupTable::~CPDF_ColorLookupTable() {}
+
+int CPDF_ColorLookupTable::GetPointCount() const {
+  int points = IsBuilt() ? 1 : 0;
+  for (uint32_t i = 0; i < m_nComponents; ++i)
+    points *= m_GridSize;
+  return points;
+}
+
+void CPDF_ColorLookupTable::Build(const CPDF_ColorSpace* pCS, int nGridSize) {
+  m_nComponents = pCS->CountComponents();
+  ASSERT(nGridSize > 1 && nGridSize <= GetGridSize(m_nComponents));
+  m_GridSize = nGridSize;
+  m_Bytes.clear();
+  m_Grid.clear();
+
+  const bool bIndexed = pCS->GetFamily() == PDFCS_INDEXED;
+  const int nPoints = GetPointCount();
+  FX_FLOAT comps[kMaxGridComponents];
+  for (int point = 0; point < nPoints; ++point) {
+    int index = point;
+    for (int i = m_nComponents - 1; i >= 0; --i) {
+      int step = index % m_GridSize;
+      index /= m_GridSize;
+      // Same values as CPDF_ColorSpace::TranslateImageLine() uses for the
+      // samples at the grid points.
+      comps[i] = bIndexed ? static_cast<FX_FLOAT>(step)
+                          : static_cast<FX_FLOAT>(step) / (m_GridSize - 1);
+    }
+    FX_FLOAT R = 0.0f;
+    FX_FLOAT G = 0.0f;
+    FX_FLOAT B = 0.0f;
+    pCS->GetRGB(comps, R, G, B);
+    if (m_nComponents == 1) {
+      m_Bytes.push_back(ToByte(B));
+      m_Bytes.push_back(ToByte(G));
+      m_Bytes.push_back(ToByte(R));
+    } else {
+      m_Grid.push_back(R);
+      m_Grid.push_back(G);
+      m_Grid.push_back(B);
+    }
+  }
+}
+
+void CPDF_ColorLookupTable::TranslateImageLine(uint8_t* dest_buf,
+                                               const uint8_t* src_buf,
+                                               int pixels) const {
+  if (m_nComponents != 1) {
+    TranslateImageLineByGrid(dest_buf, src_buf, pixels);
+    return;
+  }
+  const uint8_t* pTable = m_Bytes.data();
+  for (int i = 0; i < pixels; ++i) {
+    const uint8_t* pEntry = pTable + src_buf[i] * 3;
+    *dest_buf++ = pEntry[0];
+    *dest_buf++ = pEntry[1];
+    *dest_buf++ = pEntry[2];
+  }
+}
+
+void CPDF_ColorLookupTable::TranslateImageLineByGrid(uint8_t* dest_buf,
+                                                     const uint8_t* src_buf,
+                                                     int pixels) const {
+  int strides[kMaxGridComponents];
+  int stride = 3;
+  for (int i = m_nComponents - 1; i >= 0; --i) {
+    strides[i] = stride;
+    stride *= m_GridSize;
+  }
+  const int nCorners = 1 << m_nComponents;
+  const int nMaxStep = m_GridSize - 1;
+  const FX_FLOAT* pGrid = m_Grid.data();
+  FX_FLOAT fractions[kMaxGridComponents];
+  for (int col = 0; col < pixels; ++col) {
+    // Find the grid cell of the pixel and where in it the pixel lies.
+    int base = 0;
+    for (uint32_t i = 0; i < m_nComponents; ++i) {
+      int pos = *src_buf++ * nMaxStep;
+      int step = pos / 255;
+      int remainder = pos % 255;
+      if (step == nMaxStep) {
+        step = nMaxStep - 1;
+        remainder = 255;
+      }
+      base += step * strides[i];
+      fractions[i] = static_cast<FX_FLOAT>(remainder) / 255;
+    }
+
+    FX_FLOAT R = 0.0f;
+    FX_FLOAT G = 0.0f;
+    FX_FLOAT B = 0.0f;
+    for (int corner = 0; corner < nCorners; ++corner) {
+      FX_FLOAT weight = 1.0f;
+      int offset = base;
+      for (uint32_t i = 0; i < m_nComponents; ++i) {
+        if (corner & (1 << i)) {
+          weight *= fractions[i];
+          offset += strides[i];
+        } else {
+          weight *= 1.0f - fractions[i];
+        }
+      }
+      if (weight == 0.0f)
+        continue;
+
+      R += pGrid[offset] * weight;
+      G += pGrid[offset + 1] * weight;
+      B += pGrid[offset + 2] * weight;
+    }
+    *dest_buf++ = ToByte(std::min(std::max(B, 0.0f), 1.0f));
+    *dest_buf++ = ToByte(std::min(std::max(G, 0.0f), 1.0f));
+    *dest_buf++ = ToByte(std::min(std::max(R, 0.0f), 1.0f));
+  }
+}
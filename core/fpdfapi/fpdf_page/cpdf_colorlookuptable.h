@@ -0,0 +1,76 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#ifndef CORE_FPDFAPI_FPDF_PAGE_CPDF_COLORLOOKUPTABLE_H_
+#define CORE_FPDFAPI_FPDF_PAGE_CPDF_COLORLOOKUPTABLE_H_
+
+#include <vector>
+
+#include "core/fxcrt/fx_system.h"
+
+class CPDF_ColorSpace;
+
+// Converts lines of 8-bit image samples to BGR from a table of GetRGB()
+// results, instead of calling GetRGB() for every pixel. Meant for color
+// spaces whose GetRGB() is expensive, such as those with a tint transform.
+//
+// Single component spaces get one entry per sample value, and give exactly
+// the result of CPDF_ColorSpace::TranslateImageLine(). Spaces with more
+// components are sampled on a regular grid of n = GetGridSize() points per
+// component, from 128 for two components down to 5 for six, which is
+// interpolated multilinearly.
+//
+// Both conversions truncate to bytes. Take components and RGB values as
+// fractions in [0, 1], and let M_i bound the second derivative of GetRGB()
+// along component i over a grid cell. Inside that cell the interpolated
+// value is then within E = (M_1 + ... + M_k) / (8 * (n - 1)^2) of the exact
+// one, so output bytes differ by at most 255 * E, rounded up, plus one. A
+// conversion that is linear in each component thus stays within one level.
+// The bound does not hold in cells where GetRGB() has a kink, for example
+// where it clips to [0, 1] or where a PostScript tint transform branches.
+// There the error can be as large as the change of the output across the
+// cell.
+class CPDF_ColorLookupTable {
+ public:
+  // Grids are limited to this many points.
+  static const int kMaxGridPoints = 16384;
+
+  // Returns the number of grid points per component for a color space with
+  // |nComponents| components, or 0 if the grid would be too coarse to be
+  // useful.
+  static int GetGridSize(uint32_t nComponents);
+
+  CPDF_ColorLookupTable();
+  ~CPDF_ColorLookupTable();
+
+  bool IsBuilt() const { return m_GridSize != 0; }
+  // Returns the number of points in the table.
+  int GetPointCount() const;
+
+  // Samples |pCS| with |nGridSize| points per component, which must not
+  // exceed GetGridSize(). The samples of an Indexed color space are palette
+  // indices rather than fractions of the component range.
+  void Build(const CPDF_ColorSpace* pCS, int nGridSize);
+
+  void TranslateImageLine(uint8_t* dest_buf,
+                          const uint8_t* src_buf,
+                          int pixels) const;
+
+ private:
+  void TranslateImageLineByGrid(uint8_t* dest_buf,
+                                const uint8_t* src_buf,
+                                int pixels) const;
+
+  uint32_t m_nComponents;
+  int m_GridSize;
+  // BGR bytes for single component spaces.
+  std::vector<uint8_t> m_Bytes;
+  // RGB values at the grid points otherwise, with the first component
+  // varying slowest.
+  std::vector<FX_FLOAT> m_Grid;
+};
+
+#endif  // CORE_FPDFAPI_FPDF_PAGE_CPDF_COLORLOOKUPTABLE_H_
@@ -0,0 +1,139 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/fpdf_page/cpdf_colorlookuptable.h"
+
+#include <stdlib.h>
+
+#include <vector>
+
+#include "core/fpdfapi/fpdf_page/cpdf_colorspace.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// A color space whose conversion is linear in each component when it has two
+// components, and curved when it has one.
+class TestColorSpace : public CPDF_ColorSpace {
+ public:
+  explicit TestColorSpace(uint32_t nComponents)
+      : CPDF_ColorSpace(nullptr, PDFCS_DEVICEN, nComponents) {}
+  ~TestColorSpace() override {}
+
+  FX_BOOL GetRGB(FX_FLOAT* pBuf,
+                 FX_FLOAT& R,
+                 FX_FLOAT& G,
+                 FX_FLOAT& B) const override {
+    if (m_nComponents == 1) {
+      R = pBuf[0] * pBuf[0];
+      G = 1.0f - pBuf[0];
+      B = pBuf[0] * (1.0f - pBuf[0]);
+      return TRUE;
+    }
+    R = pBuf[0];
+    G = 1.0f - pBuf[1];
+    B = pBuf[0] * pBuf[1];
+    return TRUE;
+  }
+};
+
+// A four component color space with curvature along some components.
+class CurvedColorSpace : public CPDF_ColorSpace {
+ public:
+  CurvedColorSpace() : CPDF_ColorSpace(nullptr, PDFCS_DEVICEN, 4) {}
+  ~CurvedColorSpace() override {}
+
+  FX_BOOL GetRGB(FX_FLOAT* pBuf,
+                 FX_FLOAT& R,
+                 FX_FLOAT& G,
+                 FX_FLOAT& B) const override {
+    R = pBuf[0] * pBuf[0];
+    G = pBuf[1] * (1.0f - pBuf[3]);
+    B = (pBuf[2] * pBuf[2] + pBuf[3] * pBuf[3]) / 2;
+    return TRUE;
+  }
+};
+
+}  // namespace
+
+TEST(CPDF_ColorLookupTable, GetGridSize) {
+  EXPECT_EQ(0, CPDF_ColorLookupTable::GetGridSize(0));
+  EXPECT_EQ(256, CPDF_ColorLookupTable::GetGridSize(1));
+  EXPECT_EQ(128, CPDF_ColorLookupTable::GetGridSize(2));
+  EXPECT_EQ(25, CPDF_ColorLookupTable::GetGridSize(3));
+  EXPECT_EQ(11, CPDF_ColorLookupTable::GetGridSize(4));
+  EXPECT_EQ(5, CPDF_ColorLookupTable::GetGridSize(6));
+  EXPECT_EQ(0, CPDF_ColorLookupTable::GetGridSize(7));
+}
+
+TEST(CPDF_ColorLookupTable, SingleComponent) {
+  TestColorSpace cs(1);
+  CPDF_ColorLookupTable table;
+  EXPECT_FALSE(table.IsBuilt());
+  table.Build(&cs, 256);
+  EXPECT_TRUE(table.IsBuilt());
+  EXPECT_EQ(256, table.GetPointCount());
+
+  uint8_t src[256];
+  for (int i = 0; i < 256; ++i)
+    src[i] = static_cast<uint8_t>(i);
+  uint8_t expected[256 * 3];
+  uint8_t actual[256 * 3];
+  cs.CPDF_ColorSpace::TranslateImageLine(expected, src, 256, 256, 1);
+  table.TranslateImageLine(actual, src, 256);
+  for (int i = 0; i < 256 * 3; ++i)
+    EXPECT_EQ(expected[i], actual[i]) << " at " << i;
+}
+
+TEST(CPDF_ColorLookupTable, Grid) {
+  TestColorSpace cs(2);
+  CPDF_ColorLookupTable table;
+  int nGridSize = CPDF_ColorLookupTable::GetGridSize(2);
+  table.Build(&cs, nGridSize);
+  EXPECT_EQ(nGridSize * nGridSize, table.GetPointCount());
+
+  std::vector<uint8_t> src(256 * 256 * 2);
+  for (int i = 0; i < 256 * 256; ++i) {
+    src[i * 2] = static_cast<uint8_t>(i / 256);
+    src[i * 2 + 1] = static_cast<uint8_t>(i % 256);
+  }
+  std::vector<uint8_t> expected(256 * 256 * 3);
+  std::vector<uint8_t> actual(256 * 256 * 3);
+  cs.CPDF_ColorSpace::TranslateImageLine(expected.data(), src.data(),
+                                         256 * 256, 256, 256);
+  table.TranslateImageLine(actual.data(), src.data(), 256 * 256);
+  for (size_t i = 0; i < expected.size(); ++i)
+    ASSERT_GE(1, abs(expected[i] - actual[i])) << " at " << i;
+
+  // The corners of the grid are exact.
+  EXPECT_EQ(expected[0], actual[0]);
+  EXPECT_EQ(expected.back(), actual.back());
+}
+
+TEST(CPDF_ColorLookupTable, CurvedGrid) {
+  CurvedColorSpace cs;
+  CPDF_ColorLookupTable table;
+  int nGridSize = CPDF_ColorLookupTable::GetGridSize(4);
+  ASSERT_EQ(11, nGridSize);
+  table.Build(&cs, nGridSize);
+
+  std::vector<uint8_t> src;
+  uint32_t seed = 1;
+  for (int i = 0; i < 100000 * 4; ++i) {
+    seed = seed * 1103515245 + 12345;
+    src.push_back(seed >> 24);
+  }
+  const int pixels = src.size() / 4;
+  std::vector<uint8_t> expected(pixels * 3);
+  std::vector<uint8_t> actual(pixels * 3);
+  cs.CPDF_ColorSpace::TranslateImageLine(expected.data(), src.data(), pixels,
+                                         pixels, 1);
+  table.TranslateImageLine(actual.data(), src.data(), pixels);
+
+  // The bound from cpdf_colorlookuptable.h. The second derivatives of B, G
+  // and R add up to 2, 0 and 2, so E is 2 / 800 for B and R, or 0.64 levels.
+  const int kMaxErrors[] = {2, 1, 2};
+  for (size_t i = 0; i < expected.size(); ++i)
+    ASSERT_GE(kMaxErrors[i % 3], abs(expected[i] - actual[i])) << " at " << i;
+}
@@ -9,6 +9,7 @@
 #include <memory>
 
 #include "core/fpdfapi/cpdf_modulemgr.h"
+#include "core/fpdfapi/fpdf_page/cpdf_colorlookuptable.h"
 #include "core/fpdfapi/fpdf_page/cpdf_pagemodule.h"
 #include "core/fpdfapi/fpdf_page/pageint.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_array.h"
@@ -195,6 +196,12 @@ class CPDF_IndexedCS : public CPDF_ColorSpace {
   CPDF_ColorSpace* GetBaseCS() const override;
 
   void EnableStdConversion(FX_BOOL bEnabled) override;
+  void TranslateImageLine(uint8_t* pDestBuf,
+                          const uint8_t* pSrcBuf,
+                          int pixels,
+                          int image_width,
+                          int image_height,
+                          FX_BOOL bTransMask = FALSE) const override;
 
   CPDF_ColorSpace* m_pBaseCS;
   CPDF_CountedColorSpace* m_pCountedBaseCS;
@@ -202,6 +209,8 @@ class CPDF_IndexedCS : public CPDF_ColorSpace {
   int m_MaxIndex;
   CFX_ByteString m_Table;
   FX_FLOAT* m_pCompMinMax;
+  // Indexed by whether standard conversion is enabled.
+  mutable CPDF_ColorLookupTable m_LookupTables[2];
 };
 
 class CPDF_SeparationCS : public CPDF_ColorSpace {
@@ -220,10 +229,18 @@ class CPDF_SeparationCS : public CPDF_ColorSpace {
                  FX_FLOAT& G,
                  FX_FLOAT& B) const override;
   void EnableStdConversion(FX_BOOL bEnabled) override;
+  void TranslateImageLine(uint8_t* pDestBuf,
+                          const uint8_t* pSrcBuf,
+                          int pixels,
+                          int image_width,
+                          int image_height,
+                          FX_BOOL bTransMask = FALSE) const override;
 
   std::unique_ptr<CPDF_ColorSpace> m_pAltCS;
   std::unique_ptr<CPDF_Function> m_pFunc;
   enum { None, All, Colorant } m_Type;
+  // Indexed by whether standard conversion is enabled.
+  mutable CPDF_ColorLookupTable m_LookupTables[2];
 };
 
 class CPDF_DeviceNCS : public CPDF_ColorSpace {
@@ -242,9 +259,17 @@ class CPDF_DeviceNCS : public CPDF_ColorSpace {
                  FX_FLOAT& G,
                  FX_FLOAT& B) const override;
   void EnableStdConversion(FX_BOOL bEnabled) override;
+  void TranslateImageLine(uint8_t* pDestBuf,
+                          const uint8_t* pSrcBuf,
+                          int pixels,
+                          int image_width,
+                          int image_height,
+                          FX_BOOL bTransMask = FALSE) const override;
 
   std::unique_ptr<CPDF_ColorSpace> m_pAltCS;
   std::unique_ptr<CPDF_Function> m_pFunc;
+  // Indexed by whether standard conversion is enabled.
+  mutable CPDF_ColorLookupTable m_LookupTables[2];
 };
 
 FX_FLOAT RGB_Conversion(FX_FLOAT colorComponent) {
@@ -309,6 +334,23 @@ void XYZ_to_sRGB_WhitePoint(FX_FLOAT X,
   B = RGB_Conversion(RGB.c);
 }
 
+// Returns the table in |pTables| for the current conversion of |pCS|,
+// building it with |nGridSize| points per component on first use.
+//
+// The tables are members of the color spaces that use them rather than a
+// separate cache in CPDF_DocPageData. CPDF_DocPageData already keeps one
+// instance of each color space per document, so the tables are built once per
+// document and are freed along with the color space.
+const CPDF_ColorLookupTable* GetLookupTable(const CPDF_ColorSpace* pCS,
+                                            CPDF_ColorLookupTable* pTables,
+                                            bool bStdConversion,
+                                            int nGridSize) {
+  CPDF_ColorLookupTable* pTable = &pTables[bStdConversion ? 1 : 0];
+  if (!pTable->IsBuilt())
+    pTable->Build(pCS, nGridSize);
+  return pTable;
+}
+
 }  // namespace
 
 CPDF_ColorSpace* CPDF_ColorSpace::ColorspaceFromName(
@@ -962,7 +1004,12 @@ void CPDF_ICCBasedCS::TranslateImageLine(uint8_t* pDestBuf,
     for (uint32_t i = 0; i < m_nComponents; i++) {
       nMaxColors *= 52;
     }
-    if (m_nComponents > 3 || image_width * image_height < nMaxColors * 3 / 2) {
+    if (m_nComponents == 4 &&
+        image_width * image_height >= CCodec_IccModule::kGridPoints) {
+      CPDF_ModuleMgr::Get()->GetIccModule()->TranslateScanlineByGrid(
+          m_pProfile->m_pTransform, pDestBuf, pSrcBuf, pixels);
+    } else if (m_nComponents > 3 ||
+               image_width * image_height < nMaxColors * 3 / 2) {
       CPDF_ModuleMgr::Get()->GetIccModule()->TranslateScanline(
           m_pProfile->m_pTransform, pDestBuf, pSrcBuf, pixels);
     } else {
@@ -1090,6 +1137,16 @@ void CPDF_IndexedCS::EnableStdConversion(FX_BOOL bEnabled) {
   }
 }
 
+void CPDF_IndexedCS::TranslateImageLine(uint8_t* pDestBuf,
+                                        const uint8_t* pSrcBuf,
+                                        int pixels,
+                                        int image_width,
+                                        int image_height,
+                                        FX_BOOL bTransMask) const {
+  GetLookupTable(this, m_LookupTables, m_dwStdConversion != 0, 256)
+      ->TranslateImageLine(pDestBuf, pSrcBuf, pixels);
+}
+
 CPDF_PatternCS::CPDF_PatternCS(CPDF_Document* pDoc)
     : CPDF_ColorSpace(pDoc, PDFCS_PATTERN, 1),
       m_pBaseCS(nullptr),
@@ -1221,6 +1278,16 @@ void CPDF_SeparationCS::EnableStdConversion(FX_BOOL bEnabled) {
     m_pAltCS->EnableStdConversion(bEnabled);
 }
 
+void CPDF_SeparationCS::TranslateImageLine(uint8_t* pDestBuf,
+                                           const uint8_t* pSrcBuf,
+                                           int pixels,
+                                           int image_width,
+                                           int image_height,
+                                           FX_BOOL bTransMask) const {
+  GetLookupTable(this, m_LookupTables, m_dwStdConversion != 0, 256)
+      ->TranslateImageLine(pDestBuf, pSrcBuf, pixels);
+}
+
 CPDF_DeviceNCS::CPDF_DeviceNCS(CPDF_Document* pDoc)
     : CPDF_ColorSpace(pDoc, PDFCS_DEVICEN, 0) {}
 
@@ -1275,3 +1342,25 @@ void CPDF_DeviceNCS::EnableStdConversion(FX_BOOL bEnabled) {
     m_pAltCS->EnableStdConversion(bEnabled);
   }
 }
+
+void CPDF_DeviceNCS::TranslateImageLine(uint8_t* pDestBuf,
+                                        const uint8_t* pSrcBuf,
+                                        int pixels,
+                                        int image_width,
+                                        int image_height,
+                                        FX_BOOL bTransMask) const {
+  // Sampling the grid costs up to as many conversions as an image of this
+  // many pixels, so smaller images are converted exactly. Larger ones are
+  // interpolated, within the tolerance documented in cpdf_colorlookuptable.h.
+  // Deciding by the stored image size keeps the result for an image
+  // independent of the zoom and of what was drawn before.
+  int nGridSize = CPDF_ColorLookupTable::GetGridSize(m_nComponents);
+  if (!nGridSize || static_cast<int64_t>(image_width) * image_height <
+                        CPDF_ColorLookupTable::kMaxGridPoints) {
+    CPDF_ColorSpace::TranslateImageLine(pDestBuf, pSrcBuf, pixels, image_width,
+                                        image_height, bTransMask);
+    return;
+  }
+  GetLookupTable(this, m_LookupTables, m_dwStdConversion != 0, nGridSize)
+      ->TranslateImageLine(pDestBuf, pSrcBuf, pixels);
+}
@@ -68,6 +68,9 @@ class CPDF_ColorSpace {
                   FX_FLOAT y,
                   FX_FLOAT k) const;
 
+  // |image_width| and |image_height| are the size of the image as stored, even
+  // when it is decoded scaled down. Some color spaces pick between exact and
+  // approximate conversion by that size.
   virtual void TranslateImageLine(uint8_t* dest_buf,
                                   const uint8_t* src_buf,
                                   int pixels,
@@ -96,6 +96,13 @@ void CPDF_Page::ParseContent() {
   ContinueParse(nullptr);
 }
 
+void CPDF_Page::ParseTextContent(CPDF_TextObjectSink* pSink) {
+  CPDF_ContentParser parser;
+  parser.SetTextObjectSink(pSink);
+  parser.Start(this);
+  parser.Continue(nullptr);
+}
+
 void CPDF_Page::SetRenderContext(
     std::unique_ptr<CPDF_PageRenderContext> pContext) {
   m_pRenderContext = std::move(pContext);
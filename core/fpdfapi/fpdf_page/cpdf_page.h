@@ -19,6 +19,7 @@ class CPDF_Document;
 class CPDF_Object;
 class CPDF_PageRenderCache;
 class CPDF_PageRenderContext;
+class CPDF_TextObjectSink;
 
 class CPDF_Page : public CPDF_PageObjectHolder {
  public:
@@ -31,6 +32,11 @@ class CPDF_Page : public CPDF_PageObjectHolder {
 
   void ParseContent();
 
+  // Parses the content without keeping it: every text object is passed to
+  // |pSink| as soon as it is complete, and no other page objects are
+  // created. The page is left unparsed.
+  void ParseTextContent(CPDF_TextObjectSink* pSink);
+
   void GetDisplayMatrix(CFX_Matrix& matrix,
                         int xPos,
                         int yPos,
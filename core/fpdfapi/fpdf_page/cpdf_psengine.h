@@ -12,6 +12,7 @@
 
 #include "core/fxcrt/fx_system.h"
 
+class CPDF_PSCompiler;
 class CPDF_PSEngine;
 class CPDF_PSOP;
 class CPDF_SimpleParser;
@@ -60,7 +61,10 @@ enum PDF_PSOP {
   PSOP_INDEX,
   PSOP_ROLL,
   PSOP_PROC,
-  PSOP_CONST
+  PSOP_CONST,
+  // Only used in compiled programs.
+  PSOP_JUMP,
+  PSOP_JUMPIFNOT
 };
 
 constexpr uint32_t PSENGINE_STACKSIZE = 100;
@@ -72,6 +76,7 @@ class CPDF_PSProc {
 
   FX_BOOL Parse(CPDF_SimpleParser* parser, int depth);
   FX_BOOL Execute(CPDF_PSEngine* pEngine);
+  void Compile(CPDF_PSCompiler* pCompiler) const;
 
  private:
   static const int kMaxDepth = 128;
@@ -85,6 +90,25 @@ class CPDF_PSEngine {
 
   FX_BOOL Parse(const FX_CHAR* str, int size);
   FX_BOOL Execute();
+
+  // Lowers the parsed procedure to a flat instruction list, with the
+  // procedures of if and ifelse turned into jumps and operators on constants
+  // evaluated ahead of time. |nInitialStackSize| bounds the number of values
+  // on the stack when the program starts.
+  void Compile(uint32_t nInitialStackSize);
+  // Runs the compiled program on the current stack. Leaves the stack exactly
+  // as Execute() would.
+  void ExecuteCompiled();
+  // Runs the compiled program |count| times, the i-th time on a stack of the
+  // |nInputs| values at |inputs| + i * |nInputs|, and pops |nResults| values
+  // into |results| + i * |nResults|. Results of runs that leave fewer values
+  // than that are not written, and make this return FALSE.
+  FX_BOOL ExecuteBatch(const FX_FLOAT* inputs,
+                       uint32_t nInputs,
+                       FX_FLOAT* results,
+                       uint32_t nResults,
+                       size_t count);
+
   FX_BOOL DoOperator(PDF_PSOP op);
   void Reset() { m_StackCount = 0; }
   void Push(FX_FLOAT value);
@@ -93,9 +117,20 @@ class CPDF_PSEngine {
   uint32_t GetStackSize() const { return m_StackCount; }
 
  private:
+  struct Instruction {
+    PDF_PSOP op;
+    // The value of PSOP_CONST.
+    FX_FLOAT value;
+    // The destination of PSOP_JUMP and PSOP_JUMPIFNOT.
+    uint32_t target;
+  };
+
+  friend class CPDF_PSCompiler;
+
   FX_FLOAT m_Stack[PSENGINE_STACKSIZE];
   uint32_t m_StackCount;
   CPDF_PSProc m_MainProc;
+  std::vector<Instruction> m_Program;
 };
 
 #endif  // CORE_FPDFAPI_FPDF_PAGE_CPDF_PSENGINE_H_
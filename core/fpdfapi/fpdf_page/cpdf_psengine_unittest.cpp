@@ -0,0 +1,142 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/fpdf_page/cpdf_psengine.h"
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "core/fxcrt/fx_memory.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const FX_FLOAT kInputs[] = {0.0f, 0.25f, 0.5f, 1.0f, -3.0f, 97.5f};
+
+std::vector<FX_FLOAT> PopAll(CPDF_PSEngine* engine) {
+  std::vector<FX_FLOAT> values;
+  while (engine->GetStackSize())
+    values.push_back(engine->Pop());
+  return values;
+}
+
+// Checks that the compiled form of |program| leaves the same stack as the
+// interpreter, starting from stacks of up to two inputs.
+void ExpectSameAsInterpreter(const std::string& program) {
+  SCOPED_TRACE(program);
+  CPDF_PSEngine engine;
+  if (!engine.Parse(program.c_str(), program.size()))
+    return;
+
+  for (uint32_t nInputs = 0; nInputs <= 2; ++nInputs) {
+    engine.Compile(nInputs);
+    for (FX_FLOAT input : kInputs) {
+      engine.Reset();
+      for (uint32_t i = 0; i < nInputs; ++i)
+        engine.Push(input + i);
+      engine.Execute();
+      std::vector<FX_FLOAT> expected = PopAll(&engine);
+
+      engine.Reset();
+      for (uint32_t i = 0; i < nInputs; ++i)
+        engine.Push(input + i);
+      engine.ExecuteCompiled();
+      std::vector<FX_FLOAT> actual = PopAll(&engine);
+      ASSERT_EQ(expected.size(), actual.size());
+      if (!expected.empty()) {
+        EXPECT_EQ(0, memcmp(expected.data(), actual.data(),
+                            expected.size() * sizeof(FX_FLOAT)));
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(CPDF_PSEngine, CompiledPrograms) {
+  const char* const kPrograms[] = {
+      "{}",
+      "{1 2 add}",
+      "{dup mul 0.5 exch sub}",
+      "{2 3 add 4 mul neg abs sqrt}",
+      "{dup 0.5 gt {1 sub} if}",
+      "{dup 0.5 lt {pop 0} {2 mul 1 sub} ifelse}",
+      "{dup 0.3 gt {dup 0.6 gt {pop 1} {pop 0.5} ifelse} {pop 0} ifelse}",
+      "{true {1} {2} ifelse false {3} {4} ifelse}",
+      "{1 2 3 3 copy 4 2 roll 2 index}",
+      "{1 if 2}",
+      "{{1} {2} 3 ifelse 4}",
+      "{{5} 1 {6} 0 {7} ifelse}",
+      "{{1 if 8} true exch if 9}",
+      "{7 3 idiv 7 3 mod 7 0 idiv 3 -1 bitshift 1 4 bitshift}",
+      "{1 0 div 0 0 div -1 sqrt 0 ln 30 sin 60 cos 1 1 atan 2 10 exp}",
+      "{5 3 and 5 3 or 5 3 xor 0 not 1 2 eq 1 2 ne 1 2 le 2.5 cvi 2.5 cvr}",
+      "{1.5 round -1.5 floor 1.2 ceiling -2.7 truncate 100 log}",
+      "{pop pop add exch dup}",
+      "{0 copy 3 index -2 roll}",
+  };
+  for (const char* program : kPrograms)
+    ExpectSameAsInterpreter(program);
+}
+
+TEST(CPDF_PSEngine, CompiledFullStack) {
+  // Values pushed onto a full stack are dropped, so constants there must not
+  // be folded.
+  for (int count = 95; count <= 101; ++count) {
+    std::string program = "{";
+    for (int i = 0; i < count; ++i)
+      program += "1 ";
+    program += "2 3 add 4 neg dup {5 6 mul} if 7 8 sub}";
+    ExpectSameAsInterpreter(program);
+
+    program = "{";
+    for (int i = 0; i < count / 10; ++i)
+      program += "1 2 3 4 5 6 7 8 9 10 20 copy ";
+    program += "2 3 add 4 neg}";
+    ExpectSameAsInterpreter(program);
+  }
+}
+
+TEST(CPDF_PSEngine, CompiledGeneratedPrograms) {
+  const char* const kWords[] = {
+      "add", "sub",  "mul", "div",   "idiv", "mod",   "neg", "abs",
+      "exp", "cvi",  "eq",  "gt",    "le",   "and",   "not", "bitshift",
+      "pop", "exch", "dup", "copy",  "index", "roll", "0",   "1",
+      "2",   "0.5",  "-1",  "true",  "false", "if",   "ifelse", "{",
+      "}",   "{",    "}",   "3",
+  };
+  uint32_t seed = 1;
+  for (int i = 0; i < 2000; ++i) {
+    std::string program = "{";
+    int length = 1 + i % 40;
+    for (int j = 0; j < length; ++j) {
+      seed = seed * 1103515245 + 12345;
+      program += kWords[(seed >> 16) % FX_ArraySize(kWords)];
+      program += " ";
+    }
+    program += "}";
+    ExpectSameAsInterpreter(program);
+  }
+}
+
+TEST(CPDF_PSEngine, ExecuteBatch) {
+  const char kProgram[] = "{dup mul exch 2 mul}";
+  CPDF_PSEngine engine;
+  ASSERT_TRUE(engine.Parse(kProgram, sizeof(kProgram) - 1));
+  engine.Compile(2);
+
+  const FX_FLOAT inputs[] = {1.0f, 2.0f, 3.0f, 4.0f, 0.5f, 0.25f};
+  FX_FLOAT results[6] = {};
+  EXPECT_TRUE(engine.ExecuteBatch(inputs, 2, results, 2, 3));
+  const FX_FLOAT expected[] = {4.0f, 2.0f, 16.0f, 6.0f, 0.0625f, 1.0f};
+  for (size_t i = 0; i < FX_ArraySize(expected); ++i)
+    EXPECT_EQ(expected[i], results[i]);
+
+  // Runs that leave too few values do not write results.
+  FX_FLOAT few[3] = {-1.0f, -1.0f, -1.0f};
+  EXPECT_FALSE(engine.ExecuteBatch(inputs, 2, few, 3, 1));
+  EXPECT_EQ(-1.0f, few[0]);
+}
@@ -0,0 +1,23 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#ifndef CORE_FPDFAPI_FPDF_PAGE_CPDF_TEXTOBJECTSINK_H_
+#define CORE_FPDFAPI_FPDF_PAGE_CPDF_TEXTOBJECTSINK_H_
+
+class CPDF_TextObject;
+
+// Receives the text objects of a content stream while it is being parsed, in
+// content stream order. See CPDF_Page::ParseTextContent().
+class CPDF_TextObjectSink {
+ public:
+  virtual ~CPDF_TextObjectSink() {}
+
+  // |pTextObj| is positioned in page space and is destroyed once this
+  // returns.
+  virtual void OnTextObject(const CPDF_TextObject* pTextObj) = 0;
+};
+
+#endif  // CORE_FPDFAPI_FPDF_PAGE_CPDF_TEXTOBJECTSINK_H_
@@ -206,12 +206,13 @@ FX_BOOL CPDF_PSEngine::DoOperator(PDF_PSOP op) {
     case PSOP_IDIV:
       i2 = (int)Pop();
       i1 = (int)Pop();
-      Push(i2 ? i1 / i2 : 0);
+      // Widened so that INT_MIN / -1 does not trap.
+      Push(i2 ? static_cast<FX_FLOAT>(static_cast<int64_t>(i1) / i2) : 0);
       break;
     case PSOP_MOD:
       i2 = (int)Pop();
       i1 = (int)Pop();
-      Push(i2 ? i1 % i2 : 0);
+      Push(i2 ? static_cast<FX_FLOAT>(static_cast<int64_t>(i1) % i2) : 0);
       break;
     case PSOP_NEG:
       d1 = Pop();
@@ -404,6 +405,246 @@ FX_BOOL CPDF_PSEngine::DoOperator(PDF_PSOP op) {
   return TRUE;
 }
 
+class CPDF_PSCompiler {
+ public:
+  CPDF_PSCompiler(std::vector<CPDF_PSEngine::Instruction>* pCode,
+                  uint32_t nInitialStackSize)
+      : m_pCode(pCode), m_StackBound(nInitialStackSize), m_FoldStart(0) {}
+
+  void EmitConst(FX_FLOAT value);
+  void EmitOperator(PDF_PSOP op);
+  // Returns the position of the jump, to be passed to SetJumpTarget().
+  uint32_t EmitJump(PDF_PSOP op);
+  // Makes the jump at |jump| go to the next instruction emitted.
+  void SetJumpTarget(uint32_t jump);
+
+ private:
+  void Emit(PDF_PSOP op, FX_FLOAT value);
+  bool FoldOperator(PDF_PSOP op);
+
+  std::vector<CPDF_PSEngine::Instruction>* const m_pCode;
+  // An upper bound on the stack size before each instruction. Constants can
+  // only be folded where pushing them could not have overflowed the stack,
+  // since the interpreter drops values pushed onto a full stack.
+  std::vector<uint32_t> m_StackBounds;
+  uint32_t m_StackBound;
+  // Jumps may land on this instruction, so it cannot be folded into the ones
+  // before it.
+  uint32_t m_FoldStart;
+  // Evaluates folded operators exactly as the program would.
+  CPDF_PSEngine m_Folder;
+};
+
+void CPDF_PSCompiler::EmitConst(FX_FLOAT value) {
+  Emit(PSOP_CONST, value);
+}
+
+void CPDF_PSCompiler::EmitOperator(PDF_PSOP op) {
+  if (op == PSOP_TRUE || op == PSOP_FALSE) {
+    EmitConst(op == PSOP_TRUE ? 1.0f : 0.0f);
+    return;
+  }
+  if (!FoldOperator(op))
+    Emit(op, 0);
+}
+
+uint32_t CPDF_PSCompiler::EmitJump(PDF_PSOP op) {
+  Emit(op, 0);
+  return pdfium::base::checked_cast<uint32_t>(m_pCode->size() - 1);
+}
+
+void CPDF_PSCompiler::SetJumpTarget(uint32_t jump) {
+  m_FoldStart = pdfium::base::checked_cast<uint32_t>(m_pCode->size());
+  (*m_pCode)[jump].target = m_FoldStart;
+}
+
+void CPDF_PSCompiler::Emit(PDF_PSOP op, FX_FLOAT value) {
+  CPDF_PSEngine::Instruction instruction = {op, value, 0};
+  m_pCode->push_back(instruction);
+  m_StackBounds.push_back(m_StackBound);
+
+  // Jumps only go forward, so the bound only has to grow to cover every path
+  // to the next instruction.
+  uint32_t bound = m_StackBound;
+  switch (op) {
+    case PSOP_CONST:
+      bound++;
+      break;
+    case PSOP_DUP:
+      bound = std::max(bound + 1, 2u);
+      break;
+    case PSOP_EXCH:
+      bound = std::max(bound, 2u);
+      break;
+    case PSOP_COPY:
+      bound *= 2;
+      break;
+    case PSOP_POP:
+    case PSOP_ROLL:
+    case PSOP_CVR:
+    case PSOP_JUMP:
+    case PSOP_JUMPIFNOT:
+      break;
+    default:
+      bound = std::max(bound, 1u);
+      break;
+  }
+  m_StackBound = std::min(bound, PSENGINE_STACKSIZE);
+}
+
+bool CPDF_PSCompiler::FoldOperator(PDF_PSOP op) {
+  uint32_t nOperands;
+  switch (op) {
+    case PSOP_NEG:
+    case PSOP_ABS:
+    case PSOP_CEILING:
+    case PSOP_FLOOR:
+    case PSOP_ROUND:
+    case PSOP_TRUNCATE:
+    case PSOP_SQRT:
+    case PSOP_SIN:
+    case PSOP_COS:
+    case PSOP_LN:
+    case PSOP_LOG:
+    case PSOP_CVI:
+    case PSOP_CVR:
+    case PSOP_NOT:
+      nOperands = 1;
+      break;
+    case PSOP_ADD:
+    case PSOP_SUB:
+    case PSOP_MUL:
+    case PSOP_DIV:
+    case PSOP_IDIV:
+    case PSOP_MOD:
+    case PSOP_ATAN:
+    case PSOP_EXP:
+    case PSOP_EQ:
+    case PSOP_NE:
+    case PSOP_GT:
+    case PSOP_GE:
+    case PSOP_LT:
+    case PSOP_LE:
+    case PSOP_AND:
+    case PSOP_OR:
+    case PSOP_XOR:
+    case PSOP_BITSHIFT:
+      nOperands = 2;
+      break;
+    default:
+      return false;
+  }
+  size_t size = m_pCode->size();
+  if (size < m_FoldStart + nOperands)
+    return false;
+
+  size_t first = size - nOperands;
+  for (size_t i = first; i < size; ++i) {
+    if ((*m_pCode)[i].op != PSOP_CONST)
+      return false;
+  }
+  if (m_StackBounds[first] + nOperands > PSENGINE_STACKSIZE)
+    return false;
+
+  m_Folder.Reset();
+  for (size_t i = first; i < size; ++i)
+    m_Folder.Push((*m_pCode)[i].value);
+  m_Folder.DoOperator(op);
+  (*m_pCode)[first].value = m_Folder.Pop();
+  m_pCode->resize(first + 1);
+  m_StackBounds.resize(first + 1);
+  return true;
+}
+
+void CPDF_PSProc::Compile(CPDF_PSCompiler* pCompiler) const {
+  for (size_t i = 0; i < m_Operators.size(); ++i) {
+    const PDF_PSOP op = m_Operators[i]->GetOp();
+    if (op == PSOP_PROC)
+      continue;
+
+    if (op == PSOP_CONST) {
+      pCompiler->EmitConst(m_Operators[i]->GetFloatValue());
+      continue;
+    }
+
+    if (op == PSOP_IF) {
+      // Execute() stops running the procedure at a misplaced if or ifelse,
+      // so the rest of it is never run.
+      if (i == 0 || m_Operators[i - 1]->GetOp() != PSOP_PROC)
+        return;
+
+      uint32_t skip = pCompiler->EmitJump(PSOP_JUMPIFNOT);
+      m_Operators[i - 1]->GetProc()->Compile(pCompiler);
+      pCompiler->SetJumpTarget(skip);
+    } else if (op == PSOP_IFELSE) {
+      if (i < 2 || m_Operators[i - 1]->GetOp() != PSOP_PROC ||
+          m_Operators[i - 2]->GetOp() != PSOP_PROC) {
+        return;
+      }
+      uint32_t to_else = pCompiler->EmitJump(PSOP_JUMPIFNOT);
+      m_Operators[i - 2]->GetProc()->Compile(pCompiler);
+      uint32_t to_end = pCompiler->EmitJump(PSOP_JUMP);
+      pCompiler->SetJumpTarget(to_else);
+      m_Operators[i - 1]->GetProc()->Compile(pCompiler);
+      pCompiler->SetJumpTarget(to_end);
+    } else {
+      pCompiler->EmitOperator(op);
+    }
+  }
+}
+
+void CPDF_PSEngine::Compile(uint32_t nInitialStackSize) {
+  m_Program.clear();
+  CPDF_PSCompiler compiler(&m_Program, nInitialStackSize);
+  m_MainProc.Compile(&compiler);
+}
+
+void CPDF_PSEngine::ExecuteCompiled() {
+  const Instruction* pProgram = m_Program.data();
+  const size_t size = m_Program.size();
+  size_t pc = 0;
+  while (pc < size) {
+    const Instruction& instruction = pProgram[pc++];
+    switch (instruction.op) {
+      case PSOP_CONST:
+        Push(instruction.value);
+        break;
+      case PSOP_JUMP:
+        pc = instruction.target;
+        break;
+      case PSOP_JUMPIFNOT:
+        if (!static_cast<int>(Pop()))
+          pc = instruction.target;
+        break;
+      default:
+        DoOperator(instruction.op);
+        break;
+    }
+  }
+}
+
+FX_BOOL CPDF_PSEngine::ExecuteBatch(const FX_FLOAT* inputs,
+                                    uint32_t nInputs,
+                                    FX_FLOAT* results,
+                                    uint32_t nResults,
+                                    size_t count) {
+  FX_BOOL bRet = TRUE;
+  for (size_t i = 0; i < count; ++i) {
+    Reset();
+    for (uint32_t j = 0; j < nInputs; ++j)
+      Push(inputs[i * nInputs + j]);
+    ExecuteCompiled();
+    if (m_StackCount < nResults) {
+      bRet = FALSE;
+      continue;
+    }
+    FX_FLOAT* pResults = results + i * nResults;
+    for (uint32_t j = 0; j < nResults; ++j)
+      pResults[nResults - j - 1] = Pop();
+  }
+  return bRet;
+}
+
 // See PDF Reference 1.7, page 170, table 3.36.
 bool IsValidBitsPerSample(uint32_t x) {
   switch (x) {
@@ -439,6 +680,9 @@ class CPDF_PSFunc : public CPDF_Function {
   // CPDF_Function
   FX_BOOL v_Init(CPDF_Object* pObj) override;
   FX_BOOL v_Call(FX_FLOAT* inputs, FX_FLOAT* results) const override;
+  void v_CallBatch(FX_FLOAT* inputs,
+                   size_t count,
+                   FX_FLOAT* results) const override;
 
  private:
   CPDF_PSEngine m_PS;
@@ -447,21 +691,24 @@ class CPDF_PSFunc : public CPDF_Function {
 FX_BOOL CPDF_PSFunc::v_Init(CPDF_Object* pObj) {
   CPDF_StreamAcc acc;
   acc.LoadAllData(pObj->AsStream(), FALSE);
-  return m_PS.Parse(reinterpret_cast<const FX_CHAR*>(acc.GetData()),
-                    acc.GetSize());
+  if (!m_PS.Parse(reinterpret_cast<const FX_CHAR*>(acc.GetData()),
+                  acc.GetSize())) {
+    return FALSE;
+  }
+  m_PS.Compile(m_nInputs);
+  return TRUE;
 }
 
 FX_BOOL CPDF_PSFunc::v_Call(FX_FLOAT* inputs, FX_FLOAT* results) const {
   CPDF_PSEngine& PS = const_cast<CPDF_PSEngine&>(m_PS);
-  PS.Reset();
-  for (uint32_t i = 0; i < m_nInputs; i++)
-    PS.Push(inputs[i]);
-  PS.Execute();
-  if (PS.GetStackSize() < m_nOutputs)
-    return FALSE;
-  for (uint32_t i = 0; i < m_nOutputs; i++)
-    results[m_nOutputs - i - 1] = PS.Pop();
-  return TRUE;
+  return PS.ExecuteBatch(inputs, m_nInputs, results, m_nOutputs, 1);
+}
+
+void CPDF_PSFunc::v_CallBatch(FX_FLOAT* inputs,
+                              size_t count,
+                              FX_FLOAT* results) const {
+  CPDF_PSEngine& PS = const_cast<CPDF_PSEngine&>(m_PS);
+  PS.ExecuteBatch(inputs, m_nInputs, results, m_nOutputs, count);
 }
 
 
@@ -520,10 +767,33 @@ FX_BOOL CPDF_SampledFunc::v_Init(CPDF_Object* pObj) {
       m_DecodeInfo[i].decode_max = m_pRanges[i * 2 + 1];
     }
   }
+  if (nTotalSampleBits.ValueOrDie() <= INT_MAX)
+    DecodeSamples();
   return TRUE;
 }
 
+void CPDF_SampledFunc::DecodeSamples() {
+  const uint8_t* pSampleData = m_pSampleStream->GetData();
+  if (!pSampleData)
+    return;
+
+  uint32_t nSamples = m_nOutputs;
+  for (const SampleEncodeInfo& info : m_EncodeInfo) {
+    if (info.sizes > kMaxDecodedSamples / nSamples)
+      return;
+    nSamples *= info.sizes;
+  }
+  m_DecodedSamples.resize(nSamples);
+  for (uint32_t i = 0; i < nSamples; i++) {
+    m_DecodedSamples[i] = static_cast<FX_FLOAT>(
+        GetBits32(pSampleData, i * m_nBitsPerSample, m_nBitsPerSample));
+  }
+}
+
 FX_BOOL CPDF_SampledFunc::v_Call(FX_FLOAT* inputs, FX_FLOAT* results) const {
+  if (!m_DecodedSamples.empty())
+    return CallDecoded(inputs, results);
+
   int pos = 0;
   CFX_FixedBufGrow<FX_FLOAT, 16> encoded_input_buf(m_nInputs);
   FX_FLOAT* encoded_input = encoded_input_buf;
@@ -591,6 +861,84 @@ FX_BOOL CPDF_SampledFunc::v_Call(FX_FLOAT* inputs, FX_FLOAT* results) const {
   return TRUE;
 }
 
+// Same as the stream based path of v_Call(). v_Init() only decodes samples
+// when every bit position fits in an int, so none of its checks can fail.
+FX_BOOL CPDF_SampledFunc::CallDecoded(const FX_FLOAT* inputs,
+                                      FX_FLOAT* results) const {
+  uint32_t pos = 0;
+  CFX_FixedBufGrow<FX_FLOAT, 16> encoded_input_buf(m_nInputs);
+  FX_FLOAT* encoded_input = encoded_input_buf;
+  CFX_FixedBufGrow<uint32_t, 32> int_buf(m_nInputs * 2);
+  uint32_t* index = int_buf;
+  uint32_t* blocksize = index + m_nInputs;
+  for (uint32_t i = 0; i < m_nInputs; i++) {
+    if (i == 0)
+      blocksize[i] = 1;
+    else
+      blocksize[i] = blocksize[i - 1] * m_EncodeInfo[i - 1].sizes;
+    encoded_input[i] =
+        PDF_Interpolate(inputs[i], m_pDomains[i * 2], m_pDomains[i * 2 + 1],
+                        m_EncodeInfo[i].encode_min, m_EncodeInfo[i].encode_max);
+    index[i] = std::min((uint32_t)std::max(0.f, encoded_input[i]),
+                        m_EncodeInfo[i].sizes - 1);
+    pos += index[i] * blocksize[i];
+  }
+  const FX_FLOAT* pSamples = m_DecodedSamples.data();
+  for (uint32_t j = 0; j < m_nOutputs; j++) {
+    FX_FLOAT sample = pSamples[pos * m_nOutputs + j];
+    FX_FLOAT encoded = sample;
+    for (uint32_t i = 0; i < m_nInputs; i++) {
+      if (index[i] == m_EncodeInfo[i].sizes - 1) {
+        if (index[i] == 0)
+          encoded = encoded_input[i] * sample;
+      } else {
+        FX_FLOAT sample1 = pSamples[(pos + blocksize[i]) * m_nOutputs + j];
+        encoded += (encoded_input[i] - index[i]) * (sample1 - sample);
+      }
+    }
+    results[j] =
+        PDF_Interpolate(encoded, 0, (FX_FLOAT)m_SampleMax,
+                        m_DecodeInfo[j].decode_min, m_DecodeInfo[j].decode_max);
+  }
+  return TRUE;
+}
+
+void CPDF_SampledFunc::v_CallBatch(FX_FLOAT* inputs,
+                                   size_t count,
+                                   FX_FLOAT* results) const {
+  if (m_DecodedSamples.empty() || m_nInputs != 1) {
+    CPDF_Function::v_CallBatch(inputs, count, results);
+    return;
+  }
+
+  // The common case of shadings, with CallDecoded() unrolled for one input.
+  const SampleEncodeInfo& encode = m_EncodeInfo[0];
+  const uint32_t nLastIndex = encode.sizes - 1;
+  const FX_FLOAT* pSamples = m_DecodedSamples.data();
+  for (size_t i = 0; i < count; i++) {
+    FX_FLOAT encoded_input =
+        PDF_Interpolate(inputs[i], m_pDomains[0], m_pDomains[1],
+                        encode.encode_min, encode.encode_max);
+    uint32_t index =
+        std::min((uint32_t)std::max(0.f, encoded_input), nLastIndex);
+    const FX_FLOAT* pSample = pSamples + index * m_nOutputs;
+    FX_FLOAT* pResults = results + i * m_nOutputs;
+    for (uint32_t j = 0; j < m_nOutputs; j++) {
+      FX_FLOAT encoded = pSample[j];
+      if (index == nLastIndex) {
+        if (index == 0)
+          encoded = encoded_input * pSample[j];
+      } else {
+        encoded +=
+            (encoded_input - index) * (pSample[m_nOutputs + j] - pSample[j]);
+      }
+      pResults[j] = PDF_Interpolate(encoded, 0, (FX_FLOAT)m_SampleMax,
+                                    m_DecodeInfo[j].decode_min,
+                                    m_DecodeInfo[j].decode_max);
+    }
+  }
+}
+
 CPDF_ExpIntFunc::CPDF_ExpIntFunc()
     : CPDF_Function(Type::kType2ExpotentialInterpolation),
       m_pBeginValues(nullptr),
@@ -638,6 +986,26 @@ FX_BOOL CPDF_ExpIntFunc::v_Call(FX_FLOAT* inputs, FX_FLOAT* results) const {
   return TRUE;
 }
 
+void CPDF_ExpIntFunc::v_CallBatch(FX_FLOAT* inputs,
+                                  size_t count,
+                                  FX_FLOAT* results) const {
+  CFX_FixedBufGrow<FX_FLOAT, 16> diff_buf(m_nOrigOutputs);
+  FX_FLOAT* diffs = diff_buf;
+  for (uint32_t j = 0; j < m_nOrigOutputs; j++)
+    diffs[j] = m_pEndValues[j] - m_pBeginValues[j];
+
+  // pow(x, 1) is exactly x, and linear interpolation is the common case.
+  const bool bLinear = m_Exponent == 1.0f;
+  const size_t nValues = count * m_nInputs;
+  for (size_t i = 0; i < nValues; i++) {
+    FX_FLOAT t =
+        bLinear ? inputs[i] : (FX_FLOAT)FXSYS_pow(inputs[i], m_Exponent);
+    FX_FLOAT* pResults = results + i * m_nOrigOutputs;
+    for (uint32_t j = 0; j < m_nOrigOutputs; j++)
+      pResults[j] = m_pBeginValues[j] + t * diffs[j];
+  }
+}
+
 CPDF_StitchFunc::CPDF_StitchFunc()
     : CPDF_Function(Type::kType3Stitching),
       m_pBounds(nullptr),
@@ -703,17 +1071,44 @@ FX_BOOL CPDF_StitchFunc::v_Init(CPDF_Object* pObj) {
 }
 
 FX_BOOL CPDF_StitchFunc::v_Call(FX_FLOAT* inputs, FX_FLOAT* outputs) const {
-  FX_FLOAT input = inputs[0];
+  FX_FLOAT input;
+  size_t i = FindSubFunction(inputs[0], &input);
+  int nresults;
+  m_pSubFunctions[i]->Call(&input, kRequiredNumInputs, outputs, nresults);
+  return TRUE;
+}
+
+void CPDF_StitchFunc::v_CallBatch(FX_FLOAT* inputs,
+                                  size_t count,
+                                  FX_FLOAT* outputs) const {
+  std::vector<size_t> subs(count);
+  std::vector<FX_FLOAT> sub_inputs(count);
+  for (size_t i = 0; i < count; i++)
+    subs[i] = FindSubFunction(inputs[i], &sub_inputs[i]);
+
+  // Shadings evaluate monotonic inputs, so consecutive points mostly share a
+  // subfunction.
+  size_t start = 0;
+  while (start < count) {
+    size_t end = start + 1;
+    while (end < count && subs[end] == subs[start])
+      end++;
+    m_pSubFunctions[subs[start]]->CallBatch(&sub_inputs[start], end - start,
+                                            outputs + start * m_nOutputs);
+    start = end;
+  }
+}
+
+size_t CPDF_StitchFunc::FindSubFunction(FX_FLOAT input,
+                                        FX_FLOAT* pEncoded) const {
   size_t i;
   for (i = 0; i < m_pSubFunctions.size() - 1; i++) {
     if (input < m_pBounds[i + 1])
       break;
   }
-  input = PDF_Interpolate(input, m_pBounds[i], m_pBounds[i + 1],
-                          m_pEncode[i * 2], m_pEncode[i * 2 + 1]);
-  int nresults;
-  m_pSubFunctions[i]->Call(&input, kRequiredNumInputs, outputs, nresults);
-  return TRUE;
+  *pEncoded = PDF_Interpolate(input, m_pBounds[i], m_pBounds[i + 1],
+                              m_pEncode[i * 2], m_pEncode[i * 2 + 1]);
+  return i;
 }
 
 // static
@@ -809,22 +1204,52 @@ FX_BOOL CPDF_Function::Call(FX_FLOAT* inputs,
     return FALSE;
   }
   nresults = m_nOutputs;
+  ClipInputs(inputs);
+  v_Call(inputs, results);
+  ClipResults(results);
+  return TRUE;
+}
+
+void CPDF_Function::CallBatch(const FX_FLOAT* inputs,
+                              size_t count,
+                              FX_FLOAT* results) const {
+  if (count == 0)
+    return;
+
+  std::vector<FX_FLOAT> clipped(inputs, inputs + count * m_nInputs);
+  for (size_t i = 0; i < count; i++)
+    ClipInputs(&clipped[i * m_nInputs]);
+  v_CallBatch(clipped.data(), count, results);
+  for (size_t i = 0; i < count; i++)
+    ClipResults(results + i * m_nOutputs);
+}
+
+void CPDF_Function::v_CallBatch(FX_FLOAT* inputs,
+                                size_t count,
+                                FX_FLOAT* results) const {
+  for (size_t i = 0; i < count; i++)
+    v_Call(inputs + i * m_nInputs, results + i * m_nOutputs);
+}
+
+void CPDF_Function::ClipInputs(FX_FLOAT* inputs) const {
   for (uint32_t i = 0; i < m_nInputs; i++) {
     if (inputs[i] < m_pDomains[i * 2])
       inputs[i] = m_pDomains[i * 2];
     else if (inputs[i] > m_pDomains[i * 2 + 1])
       inputs[i] = m_pDomains[i * 2] + 1;
   }
-  v_Call(inputs, results);
-  if (m_pRanges) {
-    for (uint32_t i = 0; i < m_nOutputs; i++) {
-      if (results[i] < m_pRanges[i * 2])
-        results[i] = m_pRanges[i * 2];
-      else if (results[i] > m_pRanges[i * 2 + 1])
-        results[i] = m_pRanges[i * 2 + 1];
-    }
+}
+
+void CPDF_Function::ClipResults(FX_FLOAT* results) const {
+  if (!m_pRanges)
+    return;
+
+  for (uint32_t i = 0; i < m_nOutputs; i++) {
+    if (results[i] < m_pRanges[i * 2])
+      results[i] = m_pRanges[i * 2];
+    else if (results[i] > m_pRanges[i * 2 + 1])
+      results[i] = m_pRanges[i * 2 + 1];
   }
-  return TRUE;
 }
 
 const CPDF_SampledFunc* CPDF_Function::ToSampledFunc() const {
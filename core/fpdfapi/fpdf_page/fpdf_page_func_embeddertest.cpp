@@ -18,3 +18,25 @@ TEST_F(FPDFPageFuncEmbeddertest, Bug_551460) {
   FPDFBitmap_Destroy(bitmap);
   UnloadPage(page);
 }
+
+TEST_F(FPDFPageFuncEmbeddertest, Shadings) {
+  // Axial, radial and function based shadings with all function types.
+  EXPECT_TRUE(OpenDocument("shading_functions.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_NE(nullptr, page);
+  FPDF_BITMAP bitmap = RenderPage(page);
+  ASSERT_NE(nullptr, bitmap);
+  EXPECT_EQ(400, FPDFBitmap_GetWidth(bitmap));
+
+  // The start circle of the radial shading is extended with the first sample,
+  // blue.
+  const uint8_t* buffer =
+      static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap));
+  const uint8_t* pixel = buffer + 100 * FPDFBitmap_GetStride(bitmap) + 300 * 4;
+  EXPECT_EQ(0xff, pixel[0]);
+  EXPECT_EQ(0x00, pixel[1]);
+  EXPECT_EQ(0x00, pixel[2]);
+
+  FPDFBitmap_Destroy(bitmap);
+  UnloadPage(page);
+}
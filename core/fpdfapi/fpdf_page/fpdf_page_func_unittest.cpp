@@ -0,0 +1,261 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/fpdfapi/fpdf_page/pageint.h"
+#include "core/fpdfapi/fpdf_parser/cpdf_array.h"
+#include "core/fpdfapi/fpdf_parser/cpdf_dictionary.h"
+#include "core/fpdfapi/fpdf_parser/cpdf_stream.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+using ScopedObject = std::unique_ptr<CPDF_Object, ReleaseDeleter<CPDF_Object>>;
+
+CPDF_Array* MakeArray(const std::vector<FX_FLOAT>& values) {
+  CPDF_Array* pArray = new CPDF_Array;
+  for (FX_FLOAT value : values)
+    pArray->AddNumber(value);
+  return pArray;
+}
+
+CPDF_Stream* MakeStream(CPDF_Dictionary* pDict, const std::string& data) {
+  uint8_t* pData = FX_Alloc(uint8_t, data.size());
+  memcpy(pData, data.data(), data.size());
+  return new CPDF_Stream(pData, data.size(), pDict);
+}
+
+CPDF_Dictionary* MakeExpIntDict(FX_FLOAT exponent, uint32_t nInputs) {
+  CPDF_Dictionary* pDict = new CPDF_Dictionary;
+  pDict->SetIntegerFor("FunctionType", 2);
+  std::vector<FX_FLOAT> domain;
+  for (uint32_t i = 0; i < nInputs; ++i) {
+    domain.push_back(0.0f);
+    domain.push_back(1.0f);
+  }
+  pDict->SetFor("Domain", MakeArray(domain));
+  pDict->SetFor("C0", MakeArray({0.25f, 1.0f}));
+  pDict->SetFor("C1", MakeArray({0.75f, -0.5f}));
+  pDict->SetNumberFor("N", exponent);
+  return pDict;
+}
+
+CPDF_Stream* MakeSampledStream(uint32_t nInputs) {
+  CPDF_Dictionary* pDict = new CPDF_Dictionary;
+  pDict->SetIntegerFor("FunctionType", 0);
+  pDict->SetIntegerFor("BitsPerSample", 8);
+  std::string samples;
+  if (nInputs == 1) {
+    pDict->SetFor("Domain", MakeArray({0.0f, 1.0f}));
+    pDict->SetFor("Range", MakeArray({0.0f, 1.0f, -1.0f, 1.0f}));
+    pDict->SetFor("Size", MakeArray({5}));
+    samples = std::string("\x00\xff\x40\x80\xff\x00\x10\x20\x90\x33", 10);
+  } else {
+    pDict->SetFor("Domain", MakeArray({0.0f, 1.0f, -1.0f, 1.0f}));
+    pDict->SetFor("Range", MakeArray({0.0f, 1.0f, 0.0f, 1.0f}));
+    pDict->SetFor("Size", MakeArray({3, 2}));
+    samples = std::string("\x00\xff\x40\x80\xff\x00\x10\x20\x90\x33\x77\x01",
+                          12);
+  }
+  return MakeStream(pDict, samples);
+}
+
+// Makes an 8 bit Sampled function with one output in [0, 1] and default
+// Encode and Decode arrays.
+CPDF_Stream* MakeGridStream(const std::vector<FX_FLOAT>& domain,
+                            const std::vector<FX_FLOAT>& sizes,
+                            const std::string& samples) {
+  CPDF_Dictionary* pDict = new CPDF_Dictionary;
+  pDict->SetIntegerFor("FunctionType", 0);
+  pDict->SetIntegerFor("BitsPerSample", 8);
+  pDict->SetFor("Domain", MakeArray(domain));
+  pDict->SetFor("Range", MakeArray({0.0f, 1.0f}));
+  pDict->SetFor("Size", MakeArray(sizes));
+  return MakeStream(pDict, samples);
+}
+
+uint8_t GridSample(uint32_t index) {
+  return static_cast<uint8_t>(index * 37 + index / 5);
+}
+
+CPDF_Stream* MakePSStream() {
+  CPDF_Dictionary* pDict = new CPDF_Dictionary;
+  pDict->SetIntegerFor("FunctionType", 4);
+  pDict->SetFor("Domain", MakeArray({0.0f, 1.0f, 0.0f, 1.0f}));
+  pDict->SetFor("Range", MakeArray({0.0f, 1.0f, 0.0f, 1.0f}));
+  return MakeStream(pDict, "{2 copy mul 3 1 roll dup 0.5 gt {pop} if}");
+}
+
+CPDF_Dictionary* MakeStitchDict() {
+  CPDF_Dictionary* pDict = new CPDF_Dictionary;
+  pDict->SetIntegerFor("FunctionType", 3);
+  pDict->SetFor("Domain", MakeArray({0.0f, 1.0f}));
+  CPDF_Array* pFunctions = new CPDF_Array;
+  pFunctions->Add(MakeExpIntDict(1.0f, 1));
+  pFunctions->Add(MakeSampledStream(1));
+  pFunctions->Add(MakeExpIntDict(2.2f, 1));
+  pDict->SetFor("Functions", pFunctions);
+  pDict->SetFor("Bounds", MakeArray({0.3f, 0.6f}));
+  pDict->SetFor("Encode", MakeArray({0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f}));
+  return pDict;
+}
+
+// Checks that CallBatch() gives exactly the results of Call() at points in
+// and around the domain of |pFuncObj|.
+void ExpectBatchMatchesCall(CPDF_Object* pFuncObj) {
+  ScopedObject object(pFuncObj);
+  std::unique_ptr<CPDF_Function> pFunc = CPDF_Function::Load(pFuncObj);
+  ASSERT_TRUE(pFunc);
+  const uint32_t nInputs = pFunc->CountInputs();
+  const uint32_t nOutputs = pFunc->CountOutputs();
+  ASSERT_LE(nInputs, 2u);
+
+  const size_t kSteps = 41;
+  std::vector<FX_FLOAT> inputs;
+  for (size_t i = 0; i < kSteps; ++i) {
+    for (size_t j = 0; j < (nInputs == 2 ? kSteps : 1); ++j) {
+      inputs.push_back(-0.25f + 1.5f * i / (kSteps - 1));
+      if (nInputs == 2)
+        inputs.push_back(-1.25f + 2.5f * j / (kSteps - 1));
+    }
+  }
+  const size_t count = inputs.size() / nInputs;
+  std::vector<FX_FLOAT> expected(count * nOutputs);
+  for (size_t i = 0; i < count; ++i) {
+    std::vector<FX_FLOAT> point(inputs.begin() + i * nInputs,
+                                inputs.begin() + (i + 1) * nInputs);
+    int nresults = 0;
+    EXPECT_TRUE(
+        pFunc->Call(point.data(), nInputs, &expected[i * nOutputs], nresults));
+    EXPECT_EQ(static_cast<int>(nOutputs), nresults);
+  }
+  std::vector<FX_FLOAT> actual(count * nOutputs);
+  pFunc->CallBatch(inputs.data(), count, actual.data());
+  for (size_t i = 0; i < actual.size(); ++i)
+    EXPECT_EQ(expected[i], actual[i]) << " at " << i;
+}
+
+}  // namespace
+
+TEST(CPDF_Function, CallBatchExpInt) {
+  ExpectBatchMatchesCall(MakeExpIntDict(1.0f, 1));
+  ExpectBatchMatchesCall(MakeExpIntDict(2.2f, 1));
+  ExpectBatchMatchesCall(MakeExpIntDict(0.5f, 2));
+}
+
+TEST(CPDF_Function, CallBatchSampled) {
+  ExpectBatchMatchesCall(MakeSampledStream(1));
+  ExpectBatchMatchesCall(MakeSampledStream(2));
+}
+
+TEST(CPDF_Function, CallBatchStitch) {
+  ExpectBatchMatchesCall(MakeStitchDict());
+}
+
+TEST(CPDF_Function, CallBatchPostScript) {
+  ExpectBatchMatchesCall(MakePSStream());
+}
+
+TEST(CPDF_Function, SampledValues) {
+  ScopedObject object(MakeSampledStream(1));
+  std::unique_ptr<CPDF_Function> pFunc = CPDF_Function::Load(object.get());
+  ASSERT_TRUE(pFunc);
+  // Samples are (0x00, 0xff), (0x40, 0x80), (0xff, 0x00), (0x10, 0x20) and
+  // (0x90, 0x33) at 0, 0.25, 0.5, 0.75 and 1. Inputs are clipped to the
+  // domain, and outputs map 0..255 to the ranges [0, 1] and [-1, 1].
+  std::vector<FX_FLOAT> inputs = {-1.0f,  0.0f,   0.125f, 0.25f,
+                                 0.375f, 0.625f, 1.0f,   2.0f};
+  const FX_FLOAT kExpected[][2] = {
+      {0.0f, 1.0f},
+      {0.0f, 1.0f},
+      {32.0f / 255, -1.0f + 2 * 191.5f / 255},
+      {64.0f / 255, -1.0f + 2 * 128.0f / 255},
+      {159.5f / 255, -1.0f + 2 * 64.0f / 255},
+      {135.5f / 255, -1.0f + 2 * 16.0f / 255},
+      {144.0f / 255, -1.0f + 2 * 51.0f / 255},
+      {144.0f / 255, -1.0f + 2 * 51.0f / 255},
+  };
+  std::vector<FX_FLOAT> batch(inputs.size() * 2);
+  pFunc->CallBatch(inputs.data(), inputs.size(), batch.data());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    FX_FLOAT results[2];
+    int nresults = 0;
+    EXPECT_TRUE(pFunc->Call(&inputs[i], 1, results, nresults));
+    ASSERT_EQ(2, nresults);
+    for (int j = 0; j < 2; ++j) {
+      EXPECT_FLOAT_EQ(kExpected[i][j], results[j]) << i << " " << j;
+      EXPECT_FLOAT_EQ(kExpected[i][j], batch[i * 2 + j]) << i << " " << j;
+    }
+  }
+}
+
+// Functions with more samples than CPDF_SampledFunc decodes up front read
+// them from the stream on every call. Check that path against the decoded
+// one, using 2 samples per input functions that hold the corners of a cell of
+// the large grid. Inputs are multiples of 1/8 so that both map them to the
+// cell exactly.
+TEST(CPDF_Function, SampledLargerThanDecodeLimit) {
+  const uint32_t kWidth = (1 << 20) + 1;
+  std::string samples(kWidth, 0);
+  for (uint32_t i = 0; i < kWidth; ++i)
+    samples[i] = GridSample(i);
+  ScopedObject big(MakeGridStream({0.0f, kWidth - 1.0f}, {kWidth}, samples));
+  std::unique_ptr<CPDF_Function> pBig = CPDF_Function::Load(big.get());
+  ASSERT_TRUE(pBig);
+  for (uint32_t cell : {0u, 12345u, kWidth - 2}) {
+    std::string corners;
+    corners += GridSample(cell);
+    corners += GridSample(cell + 1);
+    ScopedObject small(
+        MakeGridStream({1.0f * cell, cell + 1.0f}, {2}, corners));
+    std::unique_ptr<CPDF_Function> pSmall = CPDF_Function::Load(small.get());
+    ASSERT_TRUE(pSmall);
+    std::vector<FX_FLOAT> inputs;
+    for (int k = 0; k < 8; ++k)
+      inputs.push_back(cell + k / 8.0f);
+    std::vector<FX_FLOAT> expected(inputs.size());
+    pSmall->CallBatch(inputs.data(), inputs.size(), expected.data());
+    std::vector<FX_FLOAT> actual(inputs.size());
+    pBig->CallBatch(inputs.data(), inputs.size(), actual.data());
+    for (size_t k = 0; k < inputs.size(); ++k)
+      EXPECT_EQ(expected[k], actual[k]) << cell << " " << k;
+  }
+
+  const uint32_t kRows = 1025;
+  const uint32_t kCols = 1024;
+  samples.assign(kRows * kCols, 0);
+  for (uint32_t i = 0; i < kRows * kCols; ++i)
+    samples[i] = GridSample(i);
+  big.reset(MakeGridStream({0.0f, kCols - 1.0f, 0.0f, kRows - 1.0f},
+                           {kCols, kRows}, samples));
+  pBig = CPDF_Function::Load(big.get());
+  ASSERT_TRUE(pBig);
+  for (uint32_t row : {0u, 700u, kRows - 2}) {
+    for (uint32_t col : {0u, 513u, kCols - 2}) {
+      uint32_t index = row * kCols + col;
+      std::string corners;
+      corners += GridSample(index);
+      corners += GridSample(index + 1);
+      corners += GridSample(index + kCols);
+      corners += GridSample(index + kCols + 1);
+      ScopedObject small(MakeGridStream(
+          {1.0f * col, col + 1.0f, 1.0f * row, row + 1.0f}, {2, 2}, corners));
+      std::unique_ptr<CPDF_Function> pSmall =
+          CPDF_Function::Load(small.get());
+      ASSERT_TRUE(pSmall);
+      for (int k = 0; k < 64; ++k) {
+        FX_FLOAT point[2] = {col + k % 8 / 8.0f, row + k / 8 / 8.0f};
+        FX_FLOAT expected;
+        FX_FLOAT actual;
+        int nresults = 0;
+        EXPECT_TRUE(pSmall->Call(point, 2, &expected, nresults));
+        EXPECT_TRUE(pBig->Call(point, 2, &actual, nresults));
+        EXPECT_EQ(expected, actual) << row << " " << col << " " << k;
+      }
+    }
+  }
+}
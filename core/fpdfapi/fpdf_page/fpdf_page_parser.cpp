@@ -24,6 +24,7 @@
 #include "core/fpdfapi/fpdf_page/cpdf_shadingobject.h"
 #include "core/fpdfapi/fpdf_page/cpdf_shadingpattern.h"
 #include "core/fpdfapi/fpdf_page/cpdf_textobject.h"
+#include "core/fpdfapi/fpdf_page/cpdf_textobjectsink.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_array.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_dictionary.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_document.h"
@@ -223,7 +224,8 @@ CPDF_StreamContentParser::CPDF_StreamContentParser(
       m_pLastCloneImageDict(nullptr),
       m_bReleaseLastDict(TRUE),
       m_bColored(FALSE),
-      m_bResourceMissing(FALSE) {
+      m_bResourceMissing(FALSE),
+      m_pTextSink(nullptr) {
   if (pmtContentToUser)
     m_mtContentToUser = *pmtContentToUser;
   if (!m_pResources)
@@ -743,6 +745,9 @@ void CPDF_StreamContentParser::Handle_ExecuteXObject() {
 
   if (type == "Image") {
     CPDF_ImageObject* pObj = AddImage(pXObject, nullptr, false);
+    if (!pObj)
+      return;
+
     m_LastImageName = name;
     m_pLastImage = pObj->GetImage();
     if (!m_pObjectHolder->HasImageMask())
@@ -753,6 +758,11 @@ void CPDF_StreamContentParser::Handle_ExecuteXObject() {
 }
 
 void CPDF_StreamContentParser::AddForm(CPDF_Stream* pStream) {
+  if (m_pTextSink) {
+    AddFormText(pStream);
+    return;
+  }
+
   std::unique_ptr<CPDF_FormObject> pFormObj(new CPDF_FormObject);
   pFormObj->m_pForm.reset(
       new CPDF_Form(m_pDocument, m_pPageResources, pStream, m_pResources));
@@ -773,10 +783,27 @@ void CPDF_StreamContentParser::AddForm(CPDF_Stream* pStream) {
   m_pObjectHolder->GetPageObjectList()->push_back(std::move(pFormObj));
 }
 
+void CPDF_StreamContentParser::AddFormText(CPDF_Stream* pStream) {
+  // The form is parsed straight into the sink. Its content is mapped through
+  // the current matrix here, since there is no form object to carry it.
+  CPDF_Form form(m_pDocument, m_pPageResources, pStream, m_pResources);
+  CFX_Matrix form_matrix = m_pCurStates->m_CTM;
+  form_matrix.Concat(m_mtContentToUser);
+  CPDF_AllStates status;
+  status.m_GeneralState = m_pCurStates->m_GeneralState;
+  status.m_GraphState = m_pCurStates->m_GraphState;
+  status.m_ColorState = m_pCurStates->m_ColorState;
+  status.m_TextState = m_pCurStates->m_TextState;
+  CPDF_ContentParser parser;
+  parser.SetTextObjectSink(m_pTextSink);
+  parser.Start(&form, &status, &form_matrix, nullptr, m_Level + 1);
+  parser.Continue(nullptr);
+}
+
 CPDF_ImageObject* CPDF_StreamContentParser::AddImage(CPDF_Stream* pStream,
                                                      CPDF_Image* pImage,
                                                      bool bInline) {
-  if (!pStream && !pImage)
+  if ((!pStream && !pImage) || m_pTextSink)
     return nullptr;
 
   CFX_Matrix ImageMatrix = m_pCurStates->m_CTM;
@@ -1076,6 +1103,9 @@ void CPDF_StreamContentParser::Handle_SetColorPS_Stroke() {
 }
 
 void CPDF_StreamContentParser::Handle_ShadeFill() {
+  if (m_pTextSink)
+    return;
+
   CPDF_Pattern* pPattern = FindPattern(GetString(0), true);
   if (!pPattern)
     return;
@@ -1255,11 +1285,16 @@ void CPDF_StreamContentParser::AddTextObject(CFX_ByteString* pStrs,
                             m_pCurStates->m_TextHorzScale, m_Level);
     m_pCurStates->m_TextX += x_advance;
     m_pCurStates->m_TextY += y_advance;
-    if (TextRenderingModeIsClipMode(text_mode)) {
-      m_ClipTextList.push_back(
-          std::unique_ptr<CPDF_TextObject>(pText->Clone()));
+    if (m_pTextSink) {
+      m_pTextSink->OnTextObject(pText.get());
+      m_pLastTextObject = nullptr;
+    } else {
+      if (TextRenderingModeIsClipMode(text_mode)) {
+        m_ClipTextList.push_back(
+            std::unique_ptr<CPDF_TextObject>(pText->Clone()));
+      }
+      m_pObjectHolder->GetPageObjectList()->push_back(std::move(pText));
     }
-    m_pObjectHolder->GetPageObjectList()->push_back(std::move(pText));
   }
   if (pKerning && pKerning[nsegs - 1] != 0) {
     if (!pFont->IsVertWriting()) {
@@ -1457,6 +1492,9 @@ void CPDF_StreamContentParser::AddPathObject(int FillType, FX_BOOL bStroke) {
   uint8_t PathClipType = m_PathClipType;
   m_PathPointCount = 0;
   m_PathClipType = 0;
+  if (m_pTextSink)
+    return;
+
   if (PathPointCount <= 1) {
     if (PathPointCount && PathClipType) {
       CPDF_Path path;
@@ -131,7 +131,7 @@ uint32_t PDF_DecodeInlineStream(const uint8_t* src_buf,
     CCodec_ScanlineDecoder* pDecoder =
         CPDF_ModuleMgr::Get()->GetJpegModule()->CreateDecoder(
             src_buf, limit, width, height, 0,
-            pParam ? pParam->GetIntegerFor("ColorTransform", 1) : 1);
+            pParam ? pParam->GetIntegerFor("ColorTransform", 1) : 1, 1);
     return DecodeAllScanlines(pDecoder, dest_buf, dest_size);
   }
   if (decoder == "RunLengthDecode" || decoder == "RL") {
@@ -645,7 +645,8 @@ CPDF_ContentParser::CPDF_ContentParser()
       m_pType3Char(nullptr),
       m_pData(nullptr),
       m_Size(0),
-      m_CurrentOffset(0) {}
+      m_CurrentOffset(0),
+      m_pTextSink(nullptr) {}
 
 CPDF_ContentParser::~CPDF_ContentParser() {
   if (!m_pSingleStream)
@@ -717,6 +718,7 @@ void CPDF_ContentParser::Start(CPDF_Form* pForm,
   m_pParser.reset(new CPDF_StreamContentParser(
       pForm->m_pDocument, pForm->m_pPageResources, pForm->m_pResources,
       pParentMatrix, pForm, pResources, &form_bbox, pGraphicStates, level));
+  m_pParser->SetTextObjectSink(m_pTextSink);
   m_pParser->GetCurStates()->m_CTM = form_matrix;
   m_pParser->GetCurStates()->m_ParentMatrix = form_matrix;
   if (ClipPath) {
@@ -786,6 +788,7 @@ void CPDF_ContentParser::Continue(IFX_Pause* pPause) {
             m_pObjectHolder->m_pDocument, m_pObjectHolder->m_pPageResources,
             nullptr, nullptr, m_pObjectHolder, m_pObjectHolder->m_pResources,
             &m_pObjectHolder->m_BBox, nullptr, 0));
+        m_pParser->SetTextObjectSink(m_pTextSink);
         m_pParser->GetCurStates()->m_ColorState.SetDefault();
       }
       if (m_CurrentOffset >= m_Size) {
@@ -36,6 +36,7 @@ class CPDF_SampledFunc;
 class CPDF_StitchFunc;
 class CPDF_StreamAcc;
 class CPDF_TextObject;
+class CPDF_TextObjectSink;
 class CPDF_Type3Char;
 
 #define PARSE_STEP_LIMIT 100
@@ -123,6 +124,10 @@ class CPDF_StreamContentParser {
   FX_BOOL IsColored() const { return m_bColored; }
   const FX_FLOAT* GetType3Data() const { return m_Type3Data; }
 
+  // Hands text objects to |pSink| instead of the object holder. Nothing but
+  // text is created; paths, images and shadings are skipped.
+  void SetTextObjectSink(CPDF_TextObjectSink* pSink) { m_pTextSink = pSink; }
+
   void AddNumberParam(const FX_CHAR* str, int len);
   void AddObjectParam(CPDF_Object* pObj);
   void AddNameParam(const FX_CHAR* name, int size);
@@ -153,6 +158,7 @@ class CPDF_StreamContentParser {
                              bool bInline);
   void AddDuplicateImage();
   void AddForm(CPDF_Stream* pStream);
+  void AddFormText(CPDF_Stream* pStream);
   void SetGraphicStates(CPDF_PageObject* pObj,
                         FX_BOOL bColor,
                         FX_BOOL bText,
@@ -280,6 +286,7 @@ class CPDF_StreamContentParser {
   FX_FLOAT m_Type3Data[6];
   FX_BOOL m_bResourceMissing;
   std::vector<std::unique_ptr<CPDF_AllStates>> m_StateStack;
+  CPDF_TextObjectSink* m_pTextSink;
 };
 class CPDF_ContentParser {
  public:
@@ -289,6 +296,9 @@ class CPDF_ContentParser {
   ~CPDF_ContentParser();
 
   ParseStatus GetStatus() const { return m_Status; }
+  // Must be called before Start(). See
+  // CPDF_StreamContentParser::SetTextObjectSink().
+  void SetTextObjectSink(CPDF_TextObjectSink* pSink) { m_pTextSink = pSink; }
   void Start(CPDF_Page* pPage);
   void Start(CPDF_Form* pForm,
              CPDF_AllStates* pGraphicStates,
@@ -315,6 +325,7 @@ class CPDF_ContentParser {
   uint8_t* m_pData;
   uint32_t m_Size;
   uint32_t m_CurrentOffset;
+  CPDF_TextObjectSink* m_pTextSink;
   std::unique_ptr<CPDF_StreamContentParser> m_pParser;
 };
 
@@ -394,6 +405,13 @@ class CPDF_Function {
                uint32_t ninputs,
                FX_FLOAT* results,
                int& nresults) const;
+  // Evaluates the function at |count| points, with CountInputs() values per
+  // point in |inputs| and CountOutputs() values per point in |results|. Gives
+  // the same results as calling Call() on each point. The results of points
+  // the function cannot be evaluated at are left unchanged.
+  void CallBatch(const FX_FLOAT* inputs,
+                 size_t count,
+                 FX_FLOAT* results) const;
   uint32_t CountInputs() const { return m_nInputs; }
   uint32_t CountOutputs() const { return m_nOutputs; }
   FX_FLOAT GetDomain(int i) const { return m_pDomains[i]; }
@@ -409,6 +427,14 @@ class CPDF_Function {
   FX_BOOL Init(CPDF_Object* pObj);
   virtual FX_BOOL v_Init(CPDF_Object* pObj) = 0;
   virtual FX_BOOL v_Call(FX_FLOAT* inputs, FX_FLOAT* results) const = 0;
+  // |inputs| are already clipped to the domain. Calls v_Call() on each point
+  // by default.
+  virtual void v_CallBatch(FX_FLOAT* inputs,
+                           size_t count,
+                           FX_FLOAT* results) const;
+
+  void ClipInputs(FX_FLOAT* inputs) const;
+  void ClipResults(FX_FLOAT* results) const;
 
   uint32_t m_nInputs;
   uint32_t m_nOutputs;
@@ -425,6 +451,9 @@ class CPDF_ExpIntFunc : public CPDF_Function {
   // CPDF_Function
   FX_BOOL v_Init(CPDF_Object* pObj) override;
   FX_BOOL v_Call(FX_FLOAT* inputs, FX_FLOAT* results) const override;
+  void v_CallBatch(FX_FLOAT* inputs,
+                   size_t count,
+                   FX_FLOAT* results) const override;
 
   uint32_t m_nOrigOutputs;
   FX_FLOAT m_Exponent;
@@ -451,6 +480,9 @@ class CPDF_SampledFunc : public CPDF_Function {
   // CPDF_Function
   FX_BOOL v_Init(CPDF_Object* pObj) override;
   FX_BOOL v_Call(FX_FLOAT* inputs, FX_FLOAT* results) const override;
+  void v_CallBatch(FX_FLOAT* inputs,
+                   size_t count,
+                   FX_FLOAT* results) const override;
 
   const std::vector<SampleEncodeInfo>& GetEncodeInfo() const {
     return m_EncodeInfo;
@@ -461,11 +493,19 @@ class CPDF_SampledFunc : public CPDF_Function {
   }
 
  private:
+  // Samples at or below this count are decoded once in v_Init().
+  static const uint32_t kMaxDecodedSamples = 1 << 20;
+
+  void DecodeSamples();
+  FX_BOOL CallDecoded(const FX_FLOAT* inputs, FX_FLOAT* results) const;
+
   std::vector<SampleEncodeInfo> m_EncodeInfo;
   std::vector<SampleDecodeInfo> m_DecodeInfo;
   uint32_t m_nBitsPerSample;
   uint32_t m_SampleMax;
   std::unique_ptr<CPDF_StreamAcc> m_pSampleStream;
+  // All samples in stream order, if decoded.
+  std::vector<FX_FLOAT> m_DecodedSamples;
 };
 
 class CPDF_StitchFunc : public CPDF_Function {
@@ -476,6 +516,9 @@ class CPDF_StitchFunc : public CPDF_Function {
   // CPDF_Function
   FX_BOOL v_Init(CPDF_Object* pObj) override;
   FX_BOOL v_Call(FX_FLOAT* inputs, FX_FLOAT* results) const override;
+  void v_CallBatch(FX_FLOAT* inputs,
+                   size_t count,
+                   FX_FLOAT* results) const override;
 
   const std::vector<std::unique_ptr<CPDF_Function>>& GetSubFunctions() const {
     return m_pSubFunctions;
@@ -483,6 +526,10 @@ class CPDF_StitchFunc : public CPDF_Function {
   FX_FLOAT GetBound(size_t i) const { return m_pBounds[i]; }
 
  private:
+  // Returns the index of the subfunction for |input|, and sets |*pEncoded| to
+  // the input to pass to it.
+  size_t FindSubFunction(FX_FLOAT input, FX_FLOAT* pEncoded) const;
+
   std::vector<std::unique_ptr<CPDF_Function>> m_pSubFunctions;
   FX_FLOAT* m_pBounds;
   FX_FLOAT* m_pEncode;
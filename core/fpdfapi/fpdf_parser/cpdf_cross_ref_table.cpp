@@ -0,0 +1,202 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#include "core/fpdfapi/fpdf_parser/cpdf_cross_ref_table.h"
+
+#include <algorithm>
+
+namespace {
+
+// Object numbers below this always get a dense entry. That costs at most
+// 16 MB, in line with the object counts CPDF_Parser accepts for xref
+// sections.
+const uint32_t kMinDenseSize = 1048576;
+
+// Beyond kMinDenseSize, at least 1 in this many dense entries has to be in use
+// for the dense part to grow.
+const size_t kMaxDenseSparseness = 4;
+
+bool IsInUse(const CPDF_CrossRefTable::ObjectInfo& info) {
+  return info.pos || info.type || info.gennum;
+}
+
+}  // namespace
+
+CPDF_CrossRefTable::CPDF_CrossRefTable()
+    : m_bHasObjects(false),
+      m_LastObjNum(0),
+      m_DenseInUse(0),
+      m_bHasPendingEntry(false),
+      m_bPendingEntryWasInUse(false),
+      m_PendingObjNum(0),
+      m_bOffsetsSorted(true) {}
+
+CPDF_CrossRefTable::~CPDF_CrossRefTable() {}
+
+CPDF_CrossRefTable::ObjectInfo CPDF_CrossRefTable::GetInfo(
+    uint32_t objnum) const {
+  if (objnum < m_DenseObjects.size())
+    return m_DenseObjects[objnum];
+
+  auto it = m_SparseObjects.find(objnum);
+  return it != m_SparseObjects.end() ? it->second : ObjectInfo();
+}
+
+CPDF_CrossRefTable::ObjectInfo& CPDF_CrossRefTable::operator[](
+    uint32_t objnum) {
+  CountPendingEntry();
+  ObjectInfo& info = GetOrAdd(objnum);
+  m_bHasPendingEntry = true;
+  m_bPendingEntryWasInUse = IsInUse(info);
+  m_PendingObjNum = objnum;
+  return info;
+}
+
+CPDF_CrossRefTable::ObjectInfo& CPDF_CrossRefTable::GetOrAdd(
+    uint32_t objnum) {
+  if (!m_bHasObjects || objnum > m_LastObjNum) {
+    m_bHasObjects = true;
+    m_LastObjNum = objnum;
+  }
+  if (objnum < m_DenseObjects.size())
+    return m_DenseObjects[objnum];
+
+  if (!CanGrowDenseTo(objnum))
+    return m_SparseObjects[objnum];
+
+  if (objnum >= m_DenseObjects.capacity()) {
+    m_DenseObjects.reserve(
+        std::max<size_t>(objnum + 1, m_DenseObjects.capacity() * 2));
+  }
+  m_DenseObjects.resize(objnum + 1);
+
+  // Move over sparse entries that the dense part now covers.
+  auto it = m_SparseObjects.begin();
+  while (it != m_SparseObjects.end() && it->first <= objnum) {
+    m_DenseObjects[it->first] = it->second;
+    if (IsInUse(it->second))
+      ++m_DenseInUse;
+    it = m_SparseObjects.erase(it);
+  }
+  return m_DenseObjects[objnum];
+}
+
+void CPDF_CrossRefTable::Shrink(uint32_t size) {
+  if (size == 0) {
+    clear();
+    return;
+  }
+
+  CountPendingEntry();
+  if (size < m_DenseObjects.size()) {
+    m_DenseInUse -= std::count_if(m_DenseObjects.begin() + size,
+                                  m_DenseObjects.end(), IsInUse);
+    m_DenseObjects.resize(size);
+  }
+  m_SparseObjects.erase(m_SparseObjects.lower_bound(size),
+                        m_SparseObjects.end());
+  m_bHasObjects = true;
+  m_LastObjNum = size - 1;
+}
+
+void CPDF_CrossRefTable::ResetTypes() {
+  m_bHasPendingEntry = false;
+  m_DenseInUse = 0;
+  for (ObjectInfo& info : m_DenseObjects) {
+    info.type = 0;
+    if (IsInUse(info))
+      ++m_DenseInUse;
+  }
+  for (auto& it : m_SparseObjects)
+    it.second.type = 0;
+}
+
+void CPDF_CrossRefTable::clear() {
+  m_bHasObjects = false;
+  m_LastObjNum = 0;
+  m_DenseObjects.clear();
+  m_SparseObjects.clear();
+  m_DenseInUse = 0;
+  m_bHasPendingEntry = false;
+}
+
+bool CPDF_CrossRefTable::GetFirstPositioned(uint32_t* objnum,
+                                            FX_FILESIZE* pos) const {
+  for (size_t i = 0; i < m_DenseObjects.size(); ++i) {
+    if (m_DenseObjects[i].pos) {
+      *objnum = static_cast<uint32_t>(i);
+      *pos = m_DenseObjects[i].pos;
+      return true;
+    }
+  }
+  for (const auto& it : m_SparseObjects) {
+    if (it.second.pos) {
+      *objnum = it.first;
+      *pos = it.second.pos;
+      return true;
+    }
+  }
+  return false;
+}
+
+void CPDF_CrossRefTable::AddOffset(FX_FILESIZE offset) {
+  m_Offsets.push_back(offset);
+  m_bOffsetsSorted = false;
+}
+
+void CPDF_CrossRefTable::ClearOffsets() {
+  m_Offsets.clear();
+  m_bOffsetsSorted = true;
+}
+
+bool CPDF_CrossRefTable::GetNextOffset(FX_FILESIZE offset,
+                                       FX_FILESIZE* next) const {
+  SortOffsets();
+  auto it = std::lower_bound(m_Offsets.begin(), m_Offsets.end(), offset);
+  if (it == m_Offsets.end() || *it != offset || ++it == m_Offsets.end())
+    return false;
+
+  *next = *it;
+  return true;
+}
+
+bool CPDF_CrossRefTable::CanGrowDenseTo(uint32_t objnum) const {
+  if (objnum < kMinDenseSize || objnum < m_DenseObjects.capacity())
+    return true;
+
+  // Growing means a reallocation anyway, so this is the point to check that
+  // the existing entries are worth the larger vector.
+  size_t new_capacity =
+      std::max<size_t>(objnum + 1, m_DenseObjects.capacity() * 2);
+  size_t in_use = m_DenseInUse + m_SparseObjects.size();
+  return in_use >= new_capacity / kMaxDenseSparseness;
+}
+
+void CPDF_CrossRefTable::CountPendingEntry() {
+  if (!m_bHasPendingEntry)
+    return;
+
+  m_bHasPendingEntry = false;
+  // Sparse entries are all counted as in use.
+  if (m_PendingObjNum >= m_DenseObjects.size())
+    return;
+
+  bool bInUse = IsInUse(m_DenseObjects[m_PendingObjNum]);
+  if (bInUse && !m_bPendingEntryWasInUse)
+    ++m_DenseInUse;
+  else if (!bInUse && m_bPendingEntryWasInUse)
+    --m_DenseInUse;
+}
+
+void CPDF_CrossRefTable::SortOffsets() const {
+  if (m_bOffsetsSorted)
+    return;
+
+  std::sort(m_Offsets.begin(), m_Offsets.end());
+  m_Offsets.erase(std::unique(m_Offsets.begin(), m_Offsets.end()),
+                  m_Offsets.end());
+  m_bOffsetsSorted = true;
+}
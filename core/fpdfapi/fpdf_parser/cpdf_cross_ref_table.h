@@ -0,0 +1,91 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#ifndef CORE_FPDFAPI_FPDF_PARSER_CPDF_CROSS_REF_TABLE_H_
+#define CORE_FPDFAPI_FPDF_PARSER_CPDF_CROSS_REF_TABLE_H_
+
+#include <map>
+#include <vector>
+
+#include "core/fxcrt/fx_stream.h"
+
+// Cross reference entries keyed by object number, plus the sorted list of
+// known object and xref offsets used to work out object sizes.
+//
+// Entries live in a vector indexed by object number while the numbering is
+// reasonably dense, which is the common case, and fall back to a map for
+// object numbers far beyond the populated range so that a single huge object
+// number cannot force a huge allocation. Object numbers without an entry read
+// back as a default ObjectInfo, which is also what a freshly added entry
+// holds, so callers only observe the last object number.
+class CPDF_CrossRefTable {
+ public:
+  struct ObjectInfo {
+    ObjectInfo() : pos(0), gennum(0), type(0) {}
+
+    FX_FILESIZE pos;
+    uint16_t gennum;
+    uint8_t type;
+  };
+
+  CPDF_CrossRefTable();
+  ~CPDF_CrossRefTable();
+
+  bool empty() const { return !m_bHasObjects; }
+  uint32_t GetLastObjNum() const { return m_LastObjNum; }
+
+  ObjectInfo GetInfo(uint32_t objnum) const;
+
+  // Returns the entry for |objnum|, adding it first if necessary. The
+  // reference is only valid until the next call of a non-const method.
+  ObjectInfo& operator[](uint32_t objnum);
+
+  // Drops every entry at or above |size| and makes |size| - 1 the last object
+  // number. A |size| of 0 empties the table.
+  void Shrink(uint32_t size);
+
+  // Marks every entry as free without dropping it.
+  void ResetTypes();
+
+  void clear();
+
+  // Finds the entry with the lowest object number that has a non-zero
+  // position.
+  bool GetFirstPositioned(uint32_t* objnum, FX_FILESIZE* pos) const;
+
+  void AddOffset(FX_FILESIZE offset);
+  void ClearOffsets();
+
+  // Looks up |offset| in the offset list and returns the offset following it.
+  // Fails if |offset| is unknown or is the last one.
+  bool GetNextOffset(FX_FILESIZE offset, FX_FILESIZE* next) const;
+
+ private:
+  ObjectInfo& GetOrAdd(uint32_t objnum);
+  bool CanGrowDenseTo(uint32_t objnum) const;
+  void CountPendingEntry();
+  void SortOffsets() const;
+
+  bool m_bHasObjects;
+  uint32_t m_LastObjNum;
+  std::vector<ObjectInfo> m_DenseObjects;
+  std::map<uint32_t, ObjectInfo> m_SparseObjects;
+
+  // The number of dense entries in use. operator[] hands out the entry it
+  // returns for modification, so that entry is counted on the next call that
+  // may look at or change the count.
+  size_t m_DenseInUse;
+  bool m_bHasPendingEntry;
+  bool m_bPendingEntryWasInUse;
+  uint32_t m_PendingObjNum;
+
+  // Appended to while the cross reference data is loaded and sorted on the
+  // first lookup afterwards.
+  mutable std::vector<FX_FILESIZE> m_Offsets;
+  mutable bool m_bOffsetsSorted;
+};
+
+#endif  // CORE_FPDFAPI_FPDF_PARSER_CPDF_CROSS_REF_TABLE_H_
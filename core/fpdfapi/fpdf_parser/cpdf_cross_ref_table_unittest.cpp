@@ -0,0 +1,127 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/fpdf_parser/cpdf_cross_ref_table.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+TEST(cpdf_cross_ref_table, AddAndShrink) {
+  CPDF_CrossRefTable table;
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(0, table.GetInfo(3).pos);
+
+  table[3].pos = 30;
+  table[3].type = 1;
+  table[1].gennum = 2;
+  EXPECT_FALSE(table.empty());
+  EXPECT_EQ(3u, table.GetLastObjNum());
+  EXPECT_EQ(30, table.GetInfo(3).pos);
+  EXPECT_EQ(1, table.GetInfo(3).type);
+  EXPECT_EQ(2, table.GetInfo(1).gennum);
+  EXPECT_EQ(0, table.GetInfo(2).pos);
+
+  // Shrinking drops higher entries but still reports size - 1 as the last
+  // object number, like a trailer /Size does.
+  table.Shrink(3);
+  EXPECT_EQ(2u, table.GetLastObjNum());
+  EXPECT_EQ(0, table.GetInfo(3).pos);
+  EXPECT_EQ(2, table.GetInfo(1).gennum);
+
+  // Growing the last object number does not need any entries.
+  table.Shrink(1000000000);
+  EXPECT_EQ(999999999u, table.GetLastObjNum());
+  EXPECT_EQ(0, table.GetInfo(999999999).type);
+
+  table.Shrink(0);
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(0u, table.GetLastObjNum());
+}
+
+TEST(cpdf_cross_ref_table, SparseObjectNumbers) {
+  CPDF_CrossRefTable table;
+  table[4000000000u].pos = 400;
+  table[4000000000u].type = 1;
+  table[10].pos = 100;
+  EXPECT_EQ(4000000000u, table.GetLastObjNum());
+  EXPECT_EQ(400, table.GetInfo(4000000000u).pos);
+  EXPECT_EQ(100, table.GetInfo(10).pos);
+
+  uint32_t objnum;
+  FX_FILESIZE pos;
+  ASSERT_TRUE(table.GetFirstPositioned(&objnum, &pos));
+  EXPECT_EQ(10u, objnum);
+  EXPECT_EQ(100, pos);
+
+  table.ResetTypes();
+  EXPECT_EQ(0, table.GetInfo(4000000000u).type);
+  EXPECT_EQ(400, table.GetInfo(4000000000u).pos);
+
+  table.Shrink(11);
+  EXPECT_EQ(10u, table.GetLastObjNum());
+  EXPECT_EQ(0, table.GetInfo(4000000000u).pos);
+}
+
+TEST(cpdf_cross_ref_table, ManyObjects) {
+  // Fill well past the size that is always kept dense.
+  const uint32_t kCount = 3000000;
+  CPDF_CrossRefTable table;
+  for (uint32_t i = 1; i < kCount; ++i) {
+    table[i].pos = i * 10;
+    table[i].type = 1;
+  }
+  EXPECT_EQ(kCount - 1, table.GetLastObjNum());
+  for (uint32_t i = 1; i < kCount; i += 9973)
+    EXPECT_EQ(static_cast<FX_FILESIZE>(i) * 10, table.GetInfo(i).pos);
+}
+
+TEST(cpdf_cross_ref_table, SparseTail) {
+  // A dense part that is mostly free, followed by many entries too spread out
+  // for it to grow over them.
+  const uint32_t kDenseSize = 1048576;
+  const uint32_t kCount = 100000;
+  CPDF_CrossRefTable table;
+  for (uint32_t i = 0; i < kDenseSize; i += 1024)
+    table[i].pos = i + 1;
+  table[kDenseSize - 1].type = 1;
+  // Freed entries no longer count as in use.
+  table[1024].pos = 0;
+  for (uint32_t i = 0; i < kCount; ++i) {
+    table[kDenseSize + i * 16].pos = i + 1;
+    table[kDenseSize + i * 16].type = 1;
+  }
+  EXPECT_EQ(kDenseSize + (kCount - 1) * 16, table.GetLastObjNum());
+  EXPECT_EQ(0, table.GetInfo(1024).pos);
+  EXPECT_EQ(2049, table.GetInfo(2048).pos);
+  EXPECT_EQ(1, table.GetInfo(kDenseSize - 1).type);
+  for (uint32_t i = 0; i < kCount; i += 997) {
+    EXPECT_EQ(static_cast<FX_FILESIZE>(i) + 1,
+              table.GetInfo(kDenseSize + i * 16).pos);
+  }
+  EXPECT_EQ(0, table.GetInfo(kDenseSize + 1).pos);
+}
+
+TEST(cpdf_cross_ref_table, Offsets) {
+  CPDF_CrossRefTable table;
+  FX_FILESIZE next;
+  EXPECT_FALSE(table.GetNextOffset(0, &next));
+
+  table.AddOffset(300);
+  table.AddOffset(100);
+  table.AddOffset(200);
+  table.AddOffset(100);
+  EXPECT_TRUE(table.GetNextOffset(100, &next));
+  EXPECT_EQ(200, next);
+  EXPECT_TRUE(table.GetNextOffset(200, &next));
+  EXPECT_EQ(300, next);
+  EXPECT_FALSE(table.GetNextOffset(300, &next));
+  EXPECT_FALSE(table.GetNextOffset(150, &next));
+
+  // Offsets added after a lookup are picked up by the next one.
+  table.AddOffset(250);
+  EXPECT_TRUE(table.GetNextOffset(200, &next));
+  EXPECT_EQ(250, next);
+
+  table.ClearOffsets();
+  EXPECT_FALSE(table.GetNextOffset(100, &next));
+}
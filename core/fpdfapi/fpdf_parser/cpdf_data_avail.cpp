@@ -117,12 +117,11 @@ uint32_t CPDF_DataAvail::GetObjectSize(uint32_t objnum, FX_FILESIZE& offset) {
   if (offset == 0)
     return 0;
 
-  auto it = pParser->m_SortedOffset.find(offset);
-  if (it == pParser->m_SortedOffset.end() ||
-      ++it == pParser->m_SortedOffset.end()) {
+  FX_FILESIZE next_offset;
+  if (!pParser->m_CrossRefTable.GetNextOffset(offset, &next_offset))
     return 0;
-  }
-  return *it - offset;
+
+  return next_offset - offset;
 }
 
 FX_BOOL CPDF_DataAvail::IsObjectsAvail(
@@ -6,6 +6,7 @@
 
 #include "core/fpdfapi/fpdf_parser/cpdf_dictionary.h"
 
+#include <algorithm>
 #include <set>
 #include <utility>
 
@@ -19,6 +20,19 @@
 #include "third_party/base/logging.h"
 #include "third_party/base/stl_util.h"
 
+namespace {
+
+// Dictionaries up to this size are searched linearly, which beats a binary
+// search when most keys differ in length or compare equal by pointer.
+const size_t kMaxLinearSearchSize = 16;
+
+bool EntryKeyLess(const CPDF_Dictionary::Entry& entry,
+                  const CFX_ByteString& key) {
+  return entry.first < key;
+}
+
+}  // namespace
+
 CPDF_Dictionary::CPDF_Dictionary()
     : CPDF_Dictionary(CFX_WeakPtr<CFX_ByteStringPool>()) {}
 
@@ -66,10 +80,12 @@ CPDF_Object* CPDF_Dictionary::CloneNonCyclic(
     std::set<const CPDF_Object*>* pVisited) const {
   pVisited->insert(this);
   CPDF_Dictionary* pCopy = new CPDF_Dictionary(m_pPool);
+  pCopy->m_Map.reserve(m_Map.size());
   for (const auto& it : *this) {
     CPDF_Object* value = it.second;
     if (!pdfium::ContainsKey(*pVisited, value)) {
-      pCopy->m_Map.insert(
+      // Entries are visited in order, so the copy stays sorted.
+      pCopy->m_Map.push_back(
           std::make_pair(it.first, value->CloneNonCyclic(bDirect, pVisited)));
     }
   }
@@ -77,7 +93,7 @@ CPDF_Object* CPDF_Dictionary::CloneNonCyclic(
 }
 
 CPDF_Object* CPDF_Dictionary::GetObjectFor(const CFX_ByteString& key) const {
-  auto it = m_Map.find(key);
+  auto it = Find(key);
   return it != m_Map.end() ? it->second : nullptr;
 }
 
@@ -163,7 +179,7 @@ CFX_Matrix CPDF_Dictionary::GetMatrixFor(const CFX_ByteString& key) const {
 }
 
 FX_BOOL CPDF_Dictionary::KeyExist(const CFX_ByteString& key) const {
-  return pdfium::ContainsKey(m_Map, key);
+  return Find(key) != m_Map.end();
 }
 
 bool CPDF_Dictionary::IsSignatureDict() const {
@@ -175,10 +191,10 @@ bool CPDF_Dictionary::IsSignatureDict() const {
 
 void CPDF_Dictionary::SetFor(const CFX_ByteString& key, CPDF_Object* pObj) {
   CHECK(!pObj || pObj->GetObjNum() == 0);
-  auto it = m_Map.find(key);
+  auto it = Find(key);
   if (it == m_Map.end()) {
     if (pObj)
-      m_Map.insert(std::make_pair(MaybeIntern(key), pObj));
+      Insert(key, pObj);
     return;
   }
 
@@ -192,8 +208,31 @@ void CPDF_Dictionary::SetFor(const CFX_ByteString& key, CPDF_Object* pObj) {
     m_Map.erase(it);
 }
 
+void CPDF_Dictionary::AppendFor(const CFX_ByteString& key, CPDF_Object* pObj) {
+  CHECK(pObj && pObj->GetObjNum() == 0);
+  m_Map.push_back(std::make_pair(MaybeIntern(key), pObj));
+}
+
+void CPDF_Dictionary::SortAppended() {
+  std::stable_sort(m_Map.begin(), m_Map.end(),
+                   [](const Entry& lhs, const Entry& rhs) {
+                     return lhs.first < rhs.first;
+                   });
+  auto out = m_Map.begin();
+  for (auto it = m_Map.begin(); it != m_Map.end(); ++it) {
+    if (it + 1 != m_Map.end() && (it + 1)->first == it->first) {
+      it->second->Release();
+      continue;
+    }
+    if (out != it)
+      *out = std::move(*it);
+    ++out;
+  }
+  m_Map.erase(out, m_Map.end());
+}
+
 void CPDF_Dictionary::RemoveFor(const CFX_ByteString& key) {
-  auto it = m_Map.find(key);
+  auto it = Find(key);
   if (it == m_Map.end())
     return;
 
@@ -203,21 +242,24 @@ void CPDF_Dictionary::RemoveFor(const CFX_ByteString& key) {
 
 void CPDF_Dictionary::ReplaceKey(const CFX_ByteString& oldkey,
                                  const CFX_ByteString& newkey) {
-  auto old_it = m_Map.find(oldkey);
+  auto old_it = Find(oldkey);
   if (old_it == m_Map.end())
     return;
 
-  auto new_it = m_Map.find(newkey);
+  auto new_it = Find(newkey);
   if (new_it == old_it)
     return;
 
+  CPDF_Object* pObj = old_it->second;
   if (new_it != m_Map.end()) {
     new_it->second->Release();
-    new_it->second = old_it->second;
-  } else {
-    m_Map.insert(std::make_pair(MaybeIntern(newkey), old_it->second));
+    new_it->second = pObj;
+    m_Map.erase(old_it);
+    return;
   }
+  // |oldkey| may refer to the erased entry, so it must not be used below.
   m_Map.erase(old_it);
+  Insert(newkey, pObj);
 }
 
 void CPDF_Dictionary::SetIntegerFor(const CFX_ByteString& key, int i) {
@@ -273,3 +315,32 @@ void CPDF_Dictionary::SetMatrixFor(const CFX_ByteString& key,
 CFX_ByteString CPDF_Dictionary::MaybeIntern(const CFX_ByteString& str) {
   return m_pPool ? m_pPool->Intern(str) : str;
 }
+
+CPDF_Dictionary::const_iterator CPDF_Dictionary::Find(
+    const CFX_ByteString& key) const {
+  if (m_Map.size() <= kMaxLinearSearchSize) {
+    const FX_STRSIZE length = key.GetLength();
+    const FX_CHAR* data = key.c_str();
+    for (auto it = m_Map.begin(); it != m_Map.end(); ++it) {
+      const CFX_ByteString& entry_key = it->first;
+      if (entry_key.GetLength() == length &&
+          (entry_key.c_str() == data ||
+           FXSYS_memcmp(entry_key.c_str(), data, length) == 0)) {
+        return it;
+      }
+    }
+    return m_Map.end();
+  }
+  auto it = std::lower_bound(m_Map.begin(), m_Map.end(), key, EntryKeyLess);
+  return it != m_Map.end() && it->first == key ? it : m_Map.end();
+}
+
+CPDF_Dictionary::iterator CPDF_Dictionary::Find(const CFX_ByteString& key) {
+  const_iterator it = static_cast<const CPDF_Dictionary*>(this)->Find(key);
+  return m_Map.begin() + (it - m_Map.cbegin());
+}
+
+void CPDF_Dictionary::Insert(const CFX_ByteString& key, CPDF_Object* pObj) {
+  auto it = std::lower_bound(m_Map.begin(), m_Map.end(), key, EntryKeyLess);
+  m_Map.insert(it, std::make_pair(MaybeIntern(key), pObj));
+}
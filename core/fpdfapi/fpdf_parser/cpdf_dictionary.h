@@ -7,8 +7,9 @@
 #ifndef CORE_FPDFAPI_FPDF_PARSER_CPDF_DICTIONARY_H_
 #define CORE_FPDFAPI_FPDF_PARSER_CPDF_DICTIONARY_H_
 
-#include <map>
 #include <set>
+#include <utility>
+#include <vector>
 
 #include "core/fpdfapi/fpdf_parser/cpdf_object.h"
 #include "core/fxcrt/cfx_string_pool_template.h"
@@ -20,8 +21,9 @@ class CPDF_IndirectObjectHolder;
 
 class CPDF_Dictionary : public CPDF_Object {
  public:
-  using iterator = std::map<CFX_ByteString, CPDF_Object*>::iterator;
-  using const_iterator = std::map<CFX_ByteString, CPDF_Object*>::const_iterator;
+  using Entry = std::pair<CFX_ByteString, CPDF_Object*>;
+  using iterator = std::vector<Entry>::iterator;
+  using const_iterator = std::vector<Entry>::const_iterator;
 
   CPDF_Dictionary();
   explicit CPDF_Dictionary(const CFX_WeakPtr<CFX_ByteStringPool>& pPool);
@@ -57,7 +59,8 @@ class CPDF_Dictionary : public CPDF_Object {
   FX_BOOL KeyExist(const CFX_ByteString& key) const;
   bool IsSignatureDict() const;
 
-  // Set* functions invalidate iterators for the element with the key |key|.
+  // Set* functions invalidate all iterators when they add a new key, and
+  // iterators for the element with the key |key| otherwise.
   void SetFor(const CFX_ByteString& key, CPDF_Object* pObj);
   void SetNameFor(const CFX_ByteString& key, const CFX_ByteString& name);
   void SetStringFor(const CFX_ByteString& key, const CFX_ByteString& str);
@@ -70,10 +73,18 @@ class CPDF_Dictionary : public CPDF_Object {
   void SetMatrixFor(const CFX_ByteString& key, const CFX_Matrix& matrix);
   void SetBooleanFor(const CFX_ByteString& key, bool bValue);
 
-  // Invalidates iterators for the element with the key |key|.
+  // Adds |pObj| under |key| at the end, so that parsing a dictionary with
+  // many keys does not insert into the middle of it for every key. No keys
+  // may be looked up until SortAppended() has been called.
+  void AppendFor(const CFX_ByteString& key, CPDF_Object* pObj);
+  // Sorts the entries added by AppendFor(). Of several entries with the same
+  // key, the one added last is kept, as if they had been set by SetFor().
+  void SortAppended();
+
+  // Invalidates all iterators.
   void RemoveFor(const CFX_ByteString& key);
 
-  // Invalidates iterators for the element with the key |oldkey|.
+  // Invalidates all iterators.
   void ReplaceKey(const CFX_ByteString& oldkey, const CFX_ByteString& newkey);
 
   iterator begin() { return m_Map.begin(); }
@@ -87,12 +98,18 @@ class CPDF_Dictionary : public CPDF_Object {
   ~CPDF_Dictionary() override;
 
   CFX_ByteString MaybeIntern(const CFX_ByteString& str);
+  const_iterator Find(const CFX_ByteString& key) const;
+  iterator Find(const CFX_ByteString& key);
+  void Insert(const CFX_ByteString& key, CPDF_Object* pObj);
   CPDF_Object* CloneNonCyclic(
       bool bDirect,
       std::set<const CPDF_Object*>* visited) const override;
 
   CFX_WeakPtr<CFX_ByteStringPool> m_pPool;
-  std::map<CFX_ByteString, CPDF_Object*> m_Map;
+  // Sorted by key. Dictionaries rarely hold more than a dozen entries, so a
+  // flat vector is smaller and faster to search than a tree, and lookups of
+  // keys interned in |m_pPool| mostly compare by pointer.
+  std::vector<Entry> m_Map;
 };
 
 #endif  // CORE_FPDFAPI_FPDF_PARSER_CPDF_DICTIONARY_H_
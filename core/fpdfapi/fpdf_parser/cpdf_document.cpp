@@ -6,6 +6,8 @@
 
 #include "core/fpdfapi/fpdf_parser/cpdf_document.h"
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <set>
 #include <vector>
@@ -19,6 +21,7 @@
 #include "core/fpdfapi/fpdf_parser/cpdf_parser.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_reference.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_stream.h"
+#include "core/fpdfapi/fpdf_render/cpdf_docimagecache.h"
 #include "core/fpdfapi/fpdf_render/render_int.h"
 #include "core/fxcodec/JBig2_DocumentContext.h"
 #include "core/fxge/cfx_unicodeencoding.h"
@@ -314,6 +317,42 @@ int InsertNewPage(CPDF_Document* pDoc,
   return iPage;
 }
 
+// Appends the pages under |pNode| to |pages|, as long as the tree there is
+// well formed enough for GetPage() and GetPageIndex() to agree on where each
+// page is: every kid loads, is not an ancestor, and counts are accurate.
+bool CollectPages(CPDF_Dictionary* pNode,
+                  int nMaxPages,
+                  std::vector<uint32_t>* pages,
+                  std::set<CPDF_Dictionary*>* pVisited,
+                  int level) {
+  CPDF_Array* pKidList = pNode->GetArrayFor("Kids");
+  if (!pKidList || level >= FX_MAX_PAGE_LEVEL)
+    return false;
+
+  for (size_t i = 0; i < pKidList->GetCount(); i++) {
+    CPDF_Dictionary* pKid = pKidList->GetDictAt(i);
+    if (!pKid || !pKid->GetObjNum() || pdfium::ContainsKey(*pVisited, pKid))
+      return false;
+
+    if (!pKid->KeyExist("Kids")) {
+      if (static_cast<int>(pages->size()) >= nMaxPages)
+        return false;
+      pages->push_back(pKid->GetObjNum());
+      continue;
+    }
+    int nPages = pKid->GetIntegerFor("Count");
+    if (nPages <= 0)
+      return false;
+    size_t nPrevious = pages->size();
+    pdfium::ScopedSetInsertion<CPDF_Dictionary*> insertion(pVisited, pKid);
+    if (!CollectPages(pKid, nMaxPages, pages, pVisited, level + 1) ||
+        pages->size() - nPrevious != static_cast<size_t>(nPages)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 int CountPages(CPDF_Dictionary* pPages,
                std::set<CPDF_Dictionary*>* visited_pages) {
   int count = pPages->GetIntegerFor("Count");
@@ -415,12 +454,17 @@ CPDF_Document::CPDF_Document(std::unique_ptr<CPDF_Parser> pParser)
       m_dwFirstPageObjNum(0),
       m_pDocPage(new CPDF_DocPageData(this)),
       m_pDocRender(new CPDF_DocRenderData(this)),
+      m_bPageTreeCountsStale(false),
+      m_bPageIndexValid(false),
+      m_bPageListLoaded(false),
       m_pByteStringPool(WrapUnique(new CFX_ByteStringPool)) {
   if (pParser)
     SetLastObjNum(m_pParser->GetLastObjNum());
 }
 
 CPDF_Document::~CPDF_Document() {
+  // Cached images hold color spaces owned by the page data.
+  m_pDocRender->GetImageCache()->Clear();
   delete m_pDocPage;
   CPDF_ModuleMgr::Get()->GetPageModule()->ClearStockFont(this);
   m_pByteStringPool.Clear();  // Make weak.
@@ -430,6 +474,11 @@ CPDF_Object* CPDF_Document::ParseIndirectObject(uint32_t objnum) {
   return m_pParser ? m_pParser->ParseIndirectObject(this, objnum) : nullptr;
 }
 
+void CPDF_Document::OnIndirectObjectRemoved(uint32_t objnum) {
+  // A new object under the same number may decode to a different image.
+  m_pDocRender->GetImageCache()->RemoveObject(objnum);
+}
+
 void CPDF_Document::LoadDocInternal() {
   SetLastObjNum(m_pParser->GetLastObjNum());
 
@@ -449,6 +498,7 @@ void CPDF_Document::LoadDocInternal() {
 void CPDF_Document::LoadDoc() {
   LoadDocInternal();
   m_PageList.SetSize(RetrievePageCount());
+  ResetPageIndex();
 }
 
 void CPDF_Document::LoadLinearizedDoc(CPDF_Dictionary* pLinearizationParams) {
@@ -460,6 +510,7 @@ void CPDF_Document::LoadLinearizedDoc(CPDF_Dictionary* pLinearizationParams) {
   if (ToNumber(pCount))
     dwPageCount = pCount->GetInteger();
   m_PageList.SetSize(dwPageCount);
+  ResetPageIndex();
 
   CPDF_Object* pNo = pLinearizationParams->GetObjectFor("P");
   if (ToNumber(pNo))
@@ -472,6 +523,30 @@ void CPDF_Document::LoadLinearizedDoc(CPDF_Dictionary* pLinearizationParams) {
 
 void CPDF_Document::LoadPages() {
   m_PageList.SetSize(RetrievePageCount());
+  ResetPageIndex();
+}
+
+void CPDF_Document::LoadAllIndirectObjects() {
+  if (!m_pParser)
+    return;
+
+  // Decode the object streams first, in file order, rather than in the order
+  // their objects come up below. Streams already decoded by several threads
+  // through FPDF_LoadObjectStreams() are not decoded again.
+  m_pParser->LoadAllObjectStreams(1);
+
+  const uint32_t dwLastObjNum = m_pParser->GetLastObjNum();
+  for (uint32_t objnum = 1; objnum <= dwLastObjNum; ++objnum) {
+    if (!m_pParser->IsValidObjectNumber(objnum) ||
+        m_pParser->IsObjectFreeOrNull(objnum)) {
+      continue;
+    }
+    GetOrParseIndirectObject(objnum);
+  }
+
+  // Resolve the page tree too, so page lookups do not walk it later.
+  for (int i = 0; i < GetPageCount(); ++i)
+    GetPage(i);
 }
 
 CPDF_Dictionary* CPDF_Document::FindPDFPage(CPDF_Dictionary* pPages,
@@ -485,22 +560,58 @@ CPDF_Dictionary* CPDF_Document::FindPDFPage(CPDF_Dictionary* pPages,
   if (level >= FX_MAX_PAGE_LEVEL)
     return nullptr;
 
-  for (size_t i = 0; i < pKidList->GetCount(); i++) {
+  if (level == 0 && m_bPageTreeCountsStale) {
+    m_PageTreeCounts.clear();
+    m_bPageTreeCountsStale = false;
+  }
+
+  // Kids whose pages all come before the one we want are passed over below
+  // without returning, so skip the ones already counted. Their pages were
+  // recorded in |m_PageList| when they were first walked.
+  const int iBase = iPage - nPagesToGo;
+  auto result = m_PageTreeCounts.insert(
+      std::make_pair(pPages, PageTreeCounts{iBase, std::vector<int>()}));
+  std::vector<int>* pCounts = nullptr;
+  size_t i = 0;
+  if (!m_bPageTreeCountsStale && result.first->second.m_iBase == iBase) {
+    pCounts = &result.first->second.m_Counts;
+    i = std::upper_bound(pCounts->begin(), pCounts->end(), nPagesToGo) -
+        pCounts->begin();
+    if (i > 0)
+      nPagesToGo -= (*pCounts)[i - 1];
+  }
+
+  for (; i < pKidList->GetCount(); i++) {
     CPDF_Dictionary* pKid = pKidList->GetDictAt(i);
     if (!pKid) {
+      // Missing kids are not counted, as they may yet load.
       nPagesToGo--;
       continue;
     }
+    int nPages = 0;
+    if (pKid == pPages)
+      nPages = 0;
+    else if (!pKid->KeyExist("Kids"))
+      nPages = 1;
+    else
+      nPages = pKid->GetIntegerFor("Count");
+    if (pCounts && i == pCounts->size()) {
+      int nPrevious = pCounts->empty() ? 0 : pCounts->back();
+      if (nPages >= 0 &&
+          nPages <= std::numeric_limits<int>::max() - nPrevious) {
+        pCounts->push_back(nPrevious + nPages);
+      }
+    }
+
     if (pKid == pPages)
       continue;
     if (!pKid->KeyExist("Kids")) {
       if (nPagesToGo == 0)
         return pKid;
 
-      m_PageList.SetAt(iPage - nPagesToGo, pKid->GetObjNum());
+      SetPageObjNum(iPage - nPagesToGo, pKid->GetObjNum());
       nPagesToGo--;
     } else {
-      int nPages = pKid->GetIntegerFor("Count");
       if (nPagesToGo < nPages)
         return FindPDFPage(pKid, iPage, nPagesToGo, level + 1);
 
@@ -544,12 +655,36 @@ CPDF_Dictionary* CPDF_Document::GetPage(int iPage) {
   if (!pPage)
     return nullptr;
 
-  m_PageList.SetAt(iPage, pPage->GetObjNum());
+  SetPageObjNum(iPage, pPage->GetObjNum());
   return pPage;
 }
 
 void CPDF_Document::SetPageObjNum(int iPage, uint32_t objNum) {
+  if (iPage < 0 || iPage >= m_PageList.GetSize())
+    return;
+
+  uint32_t dwOldObjNum = m_PageList.GetAt(iPage);
   m_PageList.SetAt(iPage, objNum);
+  if (dwOldObjNum == objNum)
+    return;
+
+  // Only a malformed page tree puts different pages at the same index. The
+  // kids skipped by FindPDFPage() would have put the old one back.
+  if (dwOldObjNum)
+    m_bPageTreeCountsStale = true;
+  if (!m_bPageIndexValid)
+    return;
+
+  // If |dwOldObjNum| is also at a later index, GetPageIndex() finds it there
+  // with a scan.
+  auto it = m_PageIndex.find(dwOldObjNum);
+  if (it != m_PageIndex.end() && it->second == iPage)
+    m_PageIndex.erase(it);
+  if (objNum) {
+    auto result = m_PageIndex.insert(std::make_pair(objNum, iPage));
+    if (!result.second && result.first->second > iPage)
+      result.first->second = iPage;
+  }
 }
 
 int CPDF_Document::FindPageIndex(CPDF_Dictionary* pNode,
@@ -586,7 +721,7 @@ int CPDF_Document::FindPageIndex(CPDF_Dictionary* pNode,
     for (size_t i = 0; i < count; i++) {
       if (CPDF_Reference* pKid = ToReference(pKidList->GetObjectAt(i))) {
         if (pKid->GetRefObjNum() == objnum) {
-          m_PageList.SetAt(index + i, objnum);
+          SetPageObjNum(index + i, objnum);
           return static_cast<int>(index + i);
         }
       }
@@ -606,6 +741,27 @@ int CPDF_Document::FindPageIndex(CPDF_Dictionary* pNode,
 }
 
 int CPDF_Document::GetPageIndex(uint32_t objnum) {
+  if (!m_bPageIndexValid) {
+    m_PageIndex.clear();
+    for (int i = m_PageList.GetSize() - 1; i >= 0; i--) {
+      if (uint32_t dwObjNum = m_PageList.GetAt(i))
+        m_PageIndex[dwObjNum] = i;
+    }
+    m_bPageIndexValid = true;
+  }
+  auto it = m_PageIndex.find(objnum);
+  if (it != m_PageIndex.end())
+    return it->second;
+
+  // Callers resolving links and bookmarks ask for many pages, so look up all
+  // of them at once rather than walking the page tree each time.
+  if (!m_bPageListLoaded) {
+    LoadPageList();
+    it = m_PageIndex.find(objnum);
+    if (it != m_PageIndex.end())
+      return it->second;
+  }
+
   uint32_t nPages = m_PageList.GetSize();
   uint32_t skip_count = 0;
   bool bSkipped = false;
@@ -627,6 +783,32 @@ int CPDF_Document::GetPageIndex(uint32_t objnum) {
   return FindPageIndex(pPages, skip_count, objnum, index);
 }
 
+void CPDF_Document::LoadPageList() {
+  m_bPageListLoaded = true;
+  CPDF_Dictionary* pPages = GetPagesDict();
+  if (!pPages || pPages->GetIntegerFor("Count") != m_PageList.GetSize())
+    return;
+
+  std::vector<uint32_t> pages;
+  std::set<CPDF_Dictionary*> visited = {pPages};
+  if (!CollectPages(pPages, m_PageList.GetSize(), &pages, &visited, 0) ||
+      static_cast<int>(pages.size()) != m_PageList.GetSize()) {
+    return;
+  }
+  for (int i = 0; i < m_PageList.GetSize(); i++) {
+    if (!m_PageList.GetAt(i))
+      SetPageObjNum(i, pages[i]);
+  }
+}
+
+void CPDF_Document::ResetPageIndex() {
+  m_PageTreeCounts.clear();
+  m_bPageTreeCountsStale = false;
+  m_PageIndex.clear();
+  m_bPageIndexValid = false;
+  m_bPageListLoaded = false;
+}
+
 int CPDF_Document::GetPageCount() const {
   return m_PageList.GetSize();
 }
@@ -711,6 +893,7 @@ CPDF_Dictionary* CPDF_Document::CreateNewPage(int iPage) {
     ReleaseIndirectObject(dwObjNum);
     return nullptr;
   }
+  ResetPageIndex();
   return pDict;
 }
 
@@ -728,6 +911,7 @@ void CPDF_Document::DeletePage(int iPage) {
     return;
 
   m_PageList.RemoveAt(iPage);
+  ResetPageIndex();
 }
 
 CPDF_Font* CPDF_Document::AddStandardFont(const FX_CHAR* font,
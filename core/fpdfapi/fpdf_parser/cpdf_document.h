@@ -8,7 +8,10 @@
 #define CORE_FPDFAPI_FPDF_PARSER_CPDF_DOCUMENT_H_
 
 #include <functional>
+#include <map>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "core/fpdfapi/fpdf_parser/cpdf_indirect_object_holder.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_object.h"
@@ -88,6 +91,10 @@ class CPDF_Document : public CPDF_IndirectObjectHolder {
   void LoadLinearizedDoc(CPDF_Dictionary* pLinearizationParams);
   void LoadPages();
 
+  // Parses every object in the cross reference table, so later lookups are
+  // served from the object holder without touching the parser.
+  void LoadAllIndirectObjects();
+
   void CreateNewDoc();
   CPDF_Dictionary* CreateNewPage(int iPage);
 
@@ -116,7 +123,10 @@ class CPDF_Document : public CPDF_IndirectObjectHolder {
                     uint32_t objnum,
                     int& index,
                     int level = 0);
+  void LoadPageList();
+  void ResetPageIndex();
   CPDF_Object* ParseIndirectObject(uint32_t objnum) override;
+  void OnIndirectObjectRemoved(uint32_t objnum) override;
   void LoadDocInternal();
   size_t CalculateEncodingDict(int charset, CPDF_Dictionary* pBaseDict);
   CPDF_Dictionary* GetPagesDict() const;
@@ -139,6 +149,20 @@ class CPDF_Document : public CPDF_IndirectObjectHolder {
   std::unique_ptr<JBig2_DocumentContext> m_pCodecContext;
   std::unique_ptr<CPDF_LinkList> m_pLinksContext;
   CFX_ArrayTemplate<uint32_t> m_PageList;
+  // Running page counts over the kids of each page tree node, as far as
+  // FindPDFPage() has walked them from the page index |m_iBase|, so later
+  // lookups can skip those kids with a binary search.
+  struct PageTreeCounts {
+    int m_iBase;
+    std::vector<int> m_Counts;
+  };
+  std::map<const CPDF_Dictionary*, PageTreeCounts> m_PageTreeCounts;
+  bool m_bPageTreeCountsStale;
+  // Maps page object numbers to their lowest index in |m_PageList|. Only
+  // meaningful when |m_bPageIndexValid| is set.
+  std::unordered_map<uint32_t, int> m_PageIndex;
+  bool m_bPageIndexValid;
+  bool m_bPageListLoaded;
   CFX_WeakPtr<CFX_ByteStringPool> m_pByteStringPool;
 };
 
@@ -0,0 +1,129 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/fpdf_parser/cpdf_document.h"
+
+#include <memory>
+#include <vector>
+
+#include "core/fpdfapi/cpdf_modulemgr.h"
+#include "core/fpdfapi/fpdf_parser/cpdf_array.h"
+#include "core/fpdfapi/fpdf_parser/cpdf_dictionary.h"
+#include "core/fpdfapi/fpdf_parser/cpdf_parser.h"
+#include "core/fpdfapi/fpdf_parser/cpdf_reference.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const uint32_t kMissingObjNum = 10000;
+
+class CPDF_DocumentTest : public testing::Test {
+ public:
+  void SetUp() override {
+    CPDF_ModuleMgr::Get()->InitPageModule();
+    m_pDoc.reset(new CPDF_Document(std::unique_ptr<CPDF_Parser>()));
+    m_pDoc->CreateNewDoc();
+  }
+
+  void TearDown() override {
+    m_pDoc.reset();
+    CPDF_ModuleMgr::Destroy();
+  }
+
+  CPDF_Dictionary* GetPages() { return m_pDoc->GetRoot()->GetDictFor("Pages"); }
+
+  // Adds a leaf to |pNode| and returns its object number.
+  uint32_t AddPage(CPDF_Dictionary* pNode) {
+    CPDF_Dictionary* pPage = new CPDF_Dictionary;
+    pPage->SetNameFor("Type", "Page");
+    uint32_t objnum = m_pDoc->AddIndirectObject(pPage);
+    pNode->GetArrayFor("Kids")->AddReference(m_pDoc.get(), objnum);
+    return objnum;
+  }
+
+  CPDF_Dictionary* AddNode(CPDF_Dictionary* pNode, int count) {
+    CPDF_Dictionary* pKid = new CPDF_Dictionary;
+    pKid->SetNameFor("Type", "Pages");
+    pKid->SetIntegerFor("Count", count);
+    pKid->SetFor("Kids", new CPDF_Array);
+    pNode->GetArrayFor("Kids")->AddReference(m_pDoc.get(),
+                                             m_pDoc->AddIndirectObject(pKid));
+    return pKid;
+  }
+
+  // Checks every page both ways, in an order that does not follow the page
+  // tree.
+  void ExpectPages(const std::vector<uint32_t>& pages) {
+    ASSERT_EQ(static_cast<int>(pages.size()), m_pDoc->GetPageCount());
+    for (size_t i = pages.size(); i > 0; i--) {
+      size_t index = (i * 11) % pages.size();
+      CPDF_Dictionary* pPage = m_pDoc->GetPage(index);
+      if (pages[index]) {
+        ASSERT_TRUE(pPage) << " at " << index;
+        EXPECT_EQ(pages[index], pPage->GetObjNum()) << " at " << index;
+      } else {
+        EXPECT_FALSE(pPage) << " at " << index;
+      }
+    }
+    for (size_t i = 0; i < pages.size(); i++) {
+      size_t index = (i * 13 + 3) % pages.size();
+      if (pages[index])
+        EXPECT_EQ(static_cast<int>(index), m_pDoc->GetPageIndex(pages[index]));
+    }
+    EXPECT_EQ(-1, m_pDoc->GetPageIndex(GetPages()->GetObjNum()));
+    EXPECT_EQ(-1, m_pDoc->GetPageIndex(kMissingObjNum));
+  }
+
+ protected:
+  std::unique_ptr<CPDF_Document> m_pDoc;
+};
+
+}  // namespace
+
+TEST_F(CPDF_DocumentTest, NestedPageTree) {
+  CPDF_Dictionary* pPages = GetPages();
+  std::vector<uint32_t> pages;
+  pages.push_back(AddPage(pPages));
+  CPDF_Dictionary* pNode = AddNode(pPages, 3);
+  pages.push_back(AddPage(pNode));
+  CPDF_Dictionary* pInner = AddNode(pNode, 2);
+  pages.push_back(AddPage(pInner));
+  pages.push_back(AddPage(pInner));
+  // A kid that does not load still takes up a page.
+  pPages->GetArrayFor("Kids")->AddReference(m_pDoc.get(), kMissingObjNum);
+  pages.push_back(0);
+  AddNode(pPages, 0);
+  pNode = AddNode(pPages, 50);
+  for (int i = 0; i < 50; i++)
+    pages.push_back(AddPage(pNode));
+  pages.push_back(AddPage(pPages));
+  pPages->SetIntegerFor("Count", pages.size());
+  m_pDoc->LoadPages();
+
+  ExpectPages(pages);
+  // Again, from what is cached.
+  ExpectPages(pages);
+}
+
+TEST_F(CPDF_DocumentTest, InsertAndDeletePages) {
+  std::vector<uint32_t> pages;
+  for (int i = 0; i < 40; i++) {
+    int index = (i * 13) % (pages.size() + 1);
+    CPDF_Dictionary* pPage = m_pDoc->CreateNewPage(index);
+    ASSERT_TRUE(pPage);
+    pages.insert(pages.begin() + index, pPage->GetObjNum());
+    EXPECT_EQ(index, m_pDoc->GetPageIndex(pPage->GetObjNum()));
+  }
+  ExpectPages(pages);
+
+  for (int i = 0; i < 20; i++) {
+    int index = (i * 7) % pages.size();
+    m_pDoc->DeletePage(index);
+    pages.erase(pages.begin() + index);
+    EXPECT_EQ(-1, m_pDoc->GetPageIndex(kMissingObjNum));
+    if (!pages.empty())
+      EXPECT_EQ(0, m_pDoc->GetPageIndex(pages[0]));
+  }
+  ExpectPages(pages);
+}
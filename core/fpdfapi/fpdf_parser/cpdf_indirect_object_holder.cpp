@@ -42,6 +42,8 @@ CPDF_Object* CPDF_IndirectObjectHolder::ParseIndirectObject(uint32_t objnum) {
   return nullptr;
 }
 
+void CPDF_IndirectObjectHolder::OnIndirectObjectRemoved(uint32_t objnum) {}
+
 uint32_t CPDF_IndirectObjectHolder::AddIndirectObject(CPDF_Object* pObj) {
   if (pObj->m_ObjNum)
     return pObj->m_ObjNum;
@@ -64,6 +66,8 @@ bool CPDF_IndirectObjectHolder::ReplaceIndirectObjectIfHigherGeneration(
     delete pObj;
     return false;
   }
+  if (pOldObj)
+    OnIndirectObjectRemoved(objnum);
   pObj->m_ObjNum = objnum;
   m_IndirectObjs[objnum].reset(pObj);
   m_LastObjNum = std::max(m_LastObjNum, objnum);
@@ -75,5 +79,6 @@ void CPDF_IndirectObjectHolder::ReleaseIndirectObject(uint32_t objnum) {
   if (!pObj || pObj->GetObjNum() == CPDF_Object::kInvalidObjNum)
     return;
 
+  OnIndirectObjectRemoved(objnum);
   m_IndirectObjs.erase(objnum);
 }
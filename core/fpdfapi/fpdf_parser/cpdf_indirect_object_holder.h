@@ -40,6 +40,10 @@ class CPDF_IndirectObjectHolder {
  protected:
   virtual CPDF_Object* ParseIndirectObject(uint32_t objnum);
 
+  // Called before the object held under |objnum| is released or replaced, so
+  // that anything derived from it can be dropped.
+  virtual void OnIndirectObjectRemoved(uint32_t objnum);
+
  private:
   uint32_t m_LastObjNum;
   std::map<uint32_t, std::unique_ptr<CPDF_Object>> m_IndirectObjs;
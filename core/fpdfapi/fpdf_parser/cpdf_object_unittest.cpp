@@ -785,6 +785,60 @@ TEST(PDFDictionaryTest, CloneDirectObject) {
   EXPECT_FALSE(cloned_obj);
 }
 
+TEST(PDFDictionaryTest, KeysStaySorted) {
+  CFX_WeakPtr<CFX_ByteStringPool> pool(
+      std::unique_ptr<CFX_ByteStringPool>(new CFX_ByteStringPool));
+  ScopedDict dict(new CPDF_Dictionary(pool));
+  // Enough keys to go past the size that is searched linearly.
+  const char* const kKeys[] = {"Type", "A",  "Subtype", "BBox", "",
+                               "Z",    "AA", "Length",  "B",    "Resources",
+                               "a",    "Ab", "Filter"};
+  for (size_t i = 0; i < FX_ArraySize(kKeys); ++i)
+    dict->SetIntegerFor(kKeys[i], i);
+  ASSERT_EQ(FX_ArraySize(kKeys), dict->GetCount());
+  for (size_t i = 0; i < FX_ArraySize(kKeys); ++i) {
+    EXPECT_TRUE(dict->KeyExist(kKeys[i]));
+    EXPECT_EQ(static_cast<int>(i), dict->GetIntegerFor(kKeys[i]));
+  }
+  EXPECT_FALSE(dict->KeyExist("Typ"));
+  EXPECT_FALSE(dict->KeyExist("Types"));
+  EXPECT_FALSE(dict->KeyExist("0"));
+  EXPECT_FALSE(dict->KeyExist("zz"));
+
+  dict->SetIntegerFor("Type", 100);
+  dict->SetFor("BBox", nullptr);
+  dict->RemoveFor("Z");
+  dict->RemoveFor("Missing");
+  dict->ReplaceKey("A", "Zz");
+  dict->ReplaceKey("Subtype", "Length");
+  dict->ReplaceKey("Missing", "B");
+  EXPECT_EQ(100, dict->GetIntegerFor("Type"));
+  EXPECT_FALSE(dict->KeyExist("BBox"));
+  EXPECT_FALSE(dict->KeyExist("Z"));
+  EXPECT_FALSE(dict->KeyExist("A"));
+  EXPECT_EQ(1, dict->GetIntegerFor("Zz"));
+  EXPECT_FALSE(dict->KeyExist("Subtype"));
+  EXPECT_EQ(2, dict->GetIntegerFor("Length"));
+  EXPECT_EQ(8, dict->GetIntegerFor("B"));
+  EXPECT_EQ(FX_ArraySize(kKeys) - 3, dict->GetCount());
+
+  // Iteration is in key order, for the original dictionary and for clones.
+  ScopedDict cloned_dict(ToDictionary(dict->Clone()));
+  for (const CPDF_Dictionary* d : {dict.get(), cloned_dict.get()}) {
+    std::vector<CFX_ByteString> keys;
+    for (const auto& it : *d) {
+      keys.push_back(it.first);
+      EXPECT_EQ(it.second, d->GetObjectFor(it.first));
+    }
+    const char* const kExpected[] = {"",       "AA",     "Ab",        "B",
+                                     "Filter", "Length", "Resources", "Type",
+                                     "Zz",     "a"};
+    ASSERT_EQ(FX_ArraySize(kExpected), keys.size());
+    for (size_t i = 0; i < FX_ArraySize(kExpected); ++i)
+      EXPECT_EQ(kExpected[i], keys[i]);
+  }
+}
+
 TEST(PDFObjectTest, CloneCheckLoop) {
   {
     // Create an object with a reference loop.
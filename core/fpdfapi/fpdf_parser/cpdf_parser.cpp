@@ -6,8 +6,13 @@
 
 #include "core/fpdfapi/fpdf_parser/cpdf_parser.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include "core/fpdfapi/cpdf_modulemgr.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_array.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_crypto_handler.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_dictionary.h"
@@ -18,7 +23,9 @@
 #include "core/fpdfapi/fpdf_parser/cpdf_stream.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_stream_acc.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_syntax_parser.h"
+#include "core/fpdfapi/fpdf_parser/fpdf_parser_decode.h"
 #include "core/fpdfapi/fpdf_parser/fpdf_parser_utility.h"
+#include "core/fxcodec/fx_codec.h"
 #include "core/fxcrt/fx_ext.h"
 #include "core/fxcrt/fx_safe_types.h"
 #include "third_party/base/stl_util.h"
@@ -36,6 +43,78 @@ uint32_t GetVarInt(const uint8_t* p, int32_t n) {
   return result;
 }
 
+// An object stream that can be decompressed away from the parser: its only
+// filter is FlateDecode and its raw data is already in memory. Workers only
+// touch the fields below |pSrc|.
+struct FlateStreamJob {
+  uint32_t objnum;
+  const CPDF_Stream* pStream;
+  std::unique_ptr<uint8_t, FxFreeDeleter> pOwnedSrc;
+
+  const uint8_t* pSrc;
+  uint32_t src_size;
+  int predictor;
+  int colors;
+  int bits_per_component;
+  int columns;
+  uint32_t estimated_size;
+  uint8_t* pDest;
+  uint32_t dest_size;
+  uint32_t offset;
+};
+
+// Fills in everything |pJob| needs for decoding |pStream| the way
+// CPDF_StreamAcc::LoadAllData() would. Returns false if the stream has other
+// filters or its data cannot be read, and has to go through LoadAllData().
+bool PrepareFlateStreamJob(const CPDF_Stream* pStream, FlateStreamJob* pJob) {
+  const CPDF_Dictionary* pDict = pStream->GetDict();
+  if (!pDict)
+    return false;
+
+  CPDF_Object* pFilter = pDict->GetDirectObjectFor("Filter");
+  CPDF_Object* pParams = pDict->GetDirectObjectFor("DecodeParms");
+  CFX_ByteString filter;
+  const CPDF_Dictionary* pParamDict = nullptr;
+  if (CPDF_Array* pFilters = ToArray(pFilter)) {
+    if (pFilters->GetCount() != 1 || (pParams && !pParams->IsArray()))
+      return false;
+    filter = pFilters->GetStringAt(0);
+    if (pParams)
+      pParamDict = pParams->AsArray()->GetDictAt(0);
+  } else if (pFilter && pFilter->IsName()) {
+    if (pParams && !pParams->IsDictionary())
+      return false;
+    filter = pFilter->GetString();
+    pParamDict = ToDictionary(pParams);
+  }
+  if (filter != "FlateDecode" && filter != "Fl")
+    return false;
+
+  FX_BOOL bEarlyChange;
+  if (!PDF_GetFlateDecodeParams(pParamDict, &pJob->predictor, &bEarlyChange,
+                                &pJob->colors, &pJob->bits_per_component,
+                                &pJob->columns)) {
+    return false;
+  }
+
+  pJob->src_size = pStream->GetRawSize();
+  if (!pJob->src_size)
+    return false;
+
+  if (pStream->IsMemoryBased()) {
+    pJob->pSrc = pStream->GetRawData();
+  } else {
+    pJob->pOwnedSrc.reset(FX_Alloc(uint8_t, pJob->src_size));
+    if (!pStream->ReadRawData(0, pJob->pOwnedSrc.get(), pJob->src_size))
+      return false;
+    pJob->pSrc = pJob->pOwnedSrc.get();
+  }
+  int nDecodedLength = pDict->GetIntegerFor("DL");
+  pJob->estimated_size = nDecodedLength > 0 ? nDecodedLength : 0;
+  pJob->pStream = pStream;
+  return true;
+}
+
 int32_t GetStreamNCount(CPDF_StreamAcc* pObjStream) {
   return pObjStream->GetDict()->GetIntegerFor("N");
 }
@@ -83,28 +162,26 @@ CPDF_Parser::~CPDF_Parser() {
 }
 
 uint32_t CPDF_Parser::GetLastObjNum() const {
-  return m_ObjectInfo.empty() ? 0 : m_ObjectInfo.rbegin()->first;
+  return m_CrossRefTable.GetLastObjNum();
 }
 
 bool CPDF_Parser::IsValidObjectNumber(uint32_t objnum) const {
-  return !m_ObjectInfo.empty() && objnum <= m_ObjectInfo.rbegin()->first;
+  return !m_CrossRefTable.empty() &&
+         objnum <= m_CrossRefTable.GetLastObjNum();
 }
 
 FX_FILESIZE CPDF_Parser::GetObjectPositionOrZero(uint32_t objnum) const {
-  auto it = m_ObjectInfo.find(objnum);
-  return it != m_ObjectInfo.end() ? it->second.pos : 0;
+  return m_CrossRefTable.GetInfo(objnum).pos;
 }
 
 uint8_t CPDF_Parser::GetObjectType(uint32_t objnum) const {
   ASSERT(IsValidObjectNumber(objnum));
-  auto it = m_ObjectInfo.find(objnum);
-  return it != m_ObjectInfo.end() ? it->second.type : 0;
+  return m_CrossRefTable.GetInfo(objnum).type;
 }
 
 uint16_t CPDF_Parser::GetObjectGenNum(uint32_t objnum) const {
   ASSERT(IsValidObjectNumber(objnum));
-  auto it = m_ObjectInfo.find(objnum);
-  return it != m_ObjectInfo.end() ? it->second.gennum : 0;
+  return m_CrossRefTable.GetInfo(objnum).gennum;
 }
 
 bool CPDF_Parser::IsObjectFreeOrNull(uint32_t objnum) const {
@@ -125,19 +202,7 @@ IFX_FileRead* CPDF_Parser::GetFileAccess() const {
 }
 
 void CPDF_Parser::ShrinkObjectMap(uint32_t objnum) {
-  if (objnum == 0) {
-    m_ObjectInfo.clear();
-    return;
-  }
-
-  auto it = m_ObjectInfo.lower_bound(objnum);
-  while (it != m_ObjectInfo.end()) {
-    auto saved_it = it++;
-    m_ObjectInfo.erase(saved_it);
-  }
-
-  if (!pdfium::ContainsKey(m_ObjectInfo, objnum - 1))
-    m_ObjectInfo[objnum - 1].pos = 0;
+  m_CrossRefTable.Shrink(objnum);
 }
 
 CPDF_Parser::Error CPDF_Parser::StartParse(IFX_FileRead* pFileAccess,
@@ -176,7 +241,7 @@ CPDF_Parser::Error CPDF_Parser::StartParse(IFX_FileRead* pFileAccess,
 
   FX_BOOL bXRefRebuilt = FALSE;
   if (m_pSyntax->SearchWord("startxref", TRUE, FALSE, 4096)) {
-    m_SortedOffset.insert(m_pSyntax->SavePos());
+    m_CrossRefTable.AddOffset(m_pSyntax->SavePos());
     m_pSyntax->GetKeyword();
 
     bool bNumber;
@@ -303,25 +368,21 @@ FX_FILESIZE CPDF_Parser::GetObjectOffset(uint32_t objnum) const {
 // with the objects. crbug/602650 showed a case where object numbers
 // in the cross reference table are all off by one.
 bool CPDF_Parser::VerifyCrossRefV4() {
-  for (const auto& it : m_ObjectInfo) {
-    if (it.second.pos == 0)
-      continue;
-    // Find the first non-zero position.
-    FX_FILESIZE SavedPos = m_pSyntax->SavePos();
-    m_pSyntax->RestorePos(it.second.pos);
-    bool is_num = false;
-    CFX_ByteString num_str = m_pSyntax->GetNextWord(&is_num);
-    m_pSyntax->RestorePos(SavedPos);
-    if (!is_num || num_str.IsEmpty() ||
-        FXSYS_atoui(num_str.c_str()) != it.first) {
-      // If the object number read doesn't match the one stored,
-      // something is wrong with the cross reference table.
-      return false;
-    } else {
-      return true;
-    }
-  }
-  return true;
+  // Find the first non-zero position.
+  uint32_t objnum;
+  FX_FILESIZE pos;
+  if (!m_CrossRefTable.GetFirstPositioned(&objnum, &pos))
+    return true;
+
+  FX_FILESIZE SavedPos = m_pSyntax->SavePos();
+  m_pSyntax->RestorePos(pos);
+  bool is_num = false;
+  CFX_ByteString num_str = m_pSyntax->GetNextWord(&is_num);
+  m_pSyntax->RestorePos(SavedPos);
+  // If the object number read doesn't match the one stored,
+  // something is wrong with the cross reference table.
+  return is_num && !num_str.IsEmpty() &&
+         FXSYS_atoui(num_str.c_str()) == objnum;
 }
 
 FX_BOOL CPDF_Parser::LoadAllCrossRefV4(FX_FILESIZE xrefpos) {
@@ -438,7 +499,7 @@ FX_BOOL CPDF_Parser::LoadLinearizedCrossRefV4(FX_FILESIZE pos,
   FX_FILESIZE dwStartPos = pos - m_pSyntax->m_HeaderOffset;
 
   m_pSyntax->RestorePos(dwStartPos);
-  m_SortedOffset.insert(pos);
+  m_CrossRefTable.AddOffset(pos);
 
   uint32_t start_objnum = 0;
   uint32_t count = dwObjCount;
@@ -464,8 +525,9 @@ FX_BOOL CPDF_Parser::LoadLinearizedCrossRefV4(FX_FILESIZE pos,
       uint32_t objnum = start_objnum + block * 1024 + i;
       char* pEntry = &buf[i * recordsize];
       if (pEntry[17] == 'f') {
-        m_ObjectInfo[objnum].pos = 0;
-        m_ObjectInfo[objnum].type = 0;
+        CPDF_CrossRefTable::ObjectInfo& info = m_CrossRefTable[objnum];
+        info.pos = 0;
+        info.type = 0;
       } else {
         int32_t offset = FXSYS_atoi(pEntry);
         if (offset == 0) {
@@ -475,16 +537,16 @@ FX_BOOL CPDF_Parser::LoadLinearizedCrossRefV4(FX_FILESIZE pos,
           }
         }
 
-        m_ObjectInfo[objnum].pos = offset;
         int32_t version = FXSYS_atoi(pEntry + 11);
         if (version >= 1)
           m_bVersionUpdated = true;
 
-        m_ObjectInfo[objnum].gennum = version;
-        if (m_ObjectInfo[objnum].pos < m_pSyntax->m_FileLen)
-          m_SortedOffset.insert(m_ObjectInfo[objnum].pos);
-
-        m_ObjectInfo[objnum].type = 1;
+        CPDF_CrossRefTable::ObjectInfo& info = m_CrossRefTable[objnum];
+        info.pos = offset;
+        info.gennum = version;
+        info.type = 1;
+        if (offset < m_pSyntax->m_FileLen)
+          m_CrossRefTable.AddOffset(offset);
       }
     }
   }
@@ -499,9 +561,9 @@ bool CPDF_Parser::LoadCrossRefV4(FX_FILESIZE pos,
   if (m_pSyntax->GetKeyword() != "xref")
     return false;
 
-  m_SortedOffset.insert(pos);
+  m_CrossRefTable.AddOffset(pos);
   if (streampos)
-    m_SortedOffset.insert(streampos);
+    m_CrossRefTable.AddOffset(streampos);
 
   while (1) {
     FX_FILESIZE SavedPos = m_pSyntax->SavePos();
@@ -539,8 +601,9 @@ bool CPDF_Parser::LoadCrossRefV4(FX_FILESIZE pos,
           uint32_t objnum = start_objnum + block * 1024 + i;
           char* pEntry = &buf[i * recordsize];
           if (pEntry[17] == 'f') {
-            m_ObjectInfo[objnum].pos = 0;
-            m_ObjectInfo[objnum].type = 0;
+            CPDF_CrossRefTable::ObjectInfo& info = m_CrossRefTable[objnum];
+            info.pos = 0;
+            info.type = 0;
           } else {
             FX_FILESIZE offset = (FX_FILESIZE)FXSYS_atoi64(pEntry);
             if (offset == 0) {
@@ -550,16 +613,16 @@ bool CPDF_Parser::LoadCrossRefV4(FX_FILESIZE pos,
               }
             }
 
-            m_ObjectInfo[objnum].pos = offset;
             int32_t version = FXSYS_atoi(pEntry + 11);
             if (version >= 1)
               m_bVersionUpdated = true;
 
-            m_ObjectInfo[objnum].gennum = version;
-            if (m_ObjectInfo[objnum].pos < m_pSyntax->m_FileLen)
-              m_SortedOffset.insert(m_ObjectInfo[objnum].pos);
-
-            m_ObjectInfo[objnum].type = 1;
+            CPDF_CrossRefTable::ObjectInfo& info = m_CrossRefTable[objnum];
+            info.pos = offset;
+            info.gennum = version;
+            info.type = 1;
+            if (offset < m_pSyntax->m_FileLen)
+              m_CrossRefTable.AddOffset(offset);
           }
         }
       }
@@ -589,8 +652,8 @@ FX_BOOL CPDF_Parser::LoadAllCrossRefV5(FX_FILESIZE xrefpos) {
 }
 
 FX_BOOL CPDF_Parser::RebuildCrossRef() {
-  m_ObjectInfo.clear();
-  m_SortedOffset.clear();
+  m_CrossRefTable.clear();
+  m_CrossRefTable.ClearOffsets();
   if (m_pTrailer) {
     m_pTrailer->Release();
     m_pTrailer = nullptr;
@@ -613,16 +676,40 @@ FX_BOOL CPDF_Parser::RebuildCrossRef() {
   FX_FILESIZE last_xref = -1;
   FX_FILESIZE last_trailer = -1;
 
+  // The scan runs from start to end on this thread. Whether a byte can start
+  // a token depends on the string and comment state left by everything before
+  // it. After each object header, the scan also resumes wherever parsing the
+  // object ended, past any stream data. A range scanned from an arbitrary
+  // split point therefore cannot know its starting state. The objects are
+  // also parsed into |m_pDocument|, which only this thread may touch.
+  //
+  // Memory-resident files are scanned in place, a whole window at a time.
+  const uint8_t* pFileView = m_pSyntax->m_pFileView;
+  const uint32_t kViewWindowSize = 1 << 30;
+
   while (pos < m_pSyntax->m_FileLen) {
     const FX_FILESIZE saved_pos = pos;
     bool bOverFlow = false;
-    uint32_t size =
-        std::min((uint32_t)(m_pSyntax->m_FileLen - pos), kBufferSize);
-    if (!m_pSyntax->m_pFileAccess->ReadBlock(buffer.data(), pos, size))
+    uint32_t size = (uint32_t)std::min<FX_FILESIZE>(
+        m_pSyntax->m_FileLen - pos, pFileView ? kViewWindowSize : kBufferSize);
+    const uint8_t* pData = pFileView ? pFileView + pos : buffer.data();
+    if (!pFileView &&
+        !m_pSyntax->m_pFileAccess->ReadBlock(buffer.data(), pos, size)) {
       break;
+    }
 
     for (uint32_t i = 0; i < size; i++) {
-      uint8_t byte = buffer[i];
+      // Skip runs of bytes that leave the state as it is.
+      if (state == ParserState::kDefault)
+        i = PDFFindRebuildCandidate(pData + i, pData + size) - pData;
+      else if (state == ParserState::kComment)
+        i = PDFFindLineEnding(pData + i, pData + size) - pData;
+      else if (state == ParserState::kString)
+        i = PDFFindParenthesis(pData + i, pData + size) - pData;
+      if (i == size)
+        break;
+
+      uint8_t byte = pData[i];
       switch (state) {
         case ParserState::kDefault:
           if (PDFCharIsWhitespace(byte)) {
@@ -743,7 +830,7 @@ FX_BOOL CPDF_Parser::RebuildCrossRef() {
             case 3:
               if (PDFCharIsWhitespace(byte) || PDFCharIsDelimiter(byte)) {
                 FX_FILESIZE obj_pos = start_pos - m_pSyntax->m_HeaderOffset;
-                m_SortedOffset.insert(obj_pos);
+                m_CrossRefTable.AddOffset(obj_pos);
                 last_obj = start_pos;
                 FX_FILESIZE obj_end = 0;
                 CPDF_Object* pObject = ParseIndirectObjectAtByStrict(
@@ -780,19 +867,19 @@ FX_BOOL CPDF_Parser::RebuildCrossRef() {
                   i += (uint32_t)nLen;
                 }
 
-                if (!m_ObjectInfo.empty() && IsValidObjectNumber(objnum) &&
-                    m_ObjectInfo[objnum].pos) {
+                if (IsValidObjectNumber(objnum) &&
+                    GetObjectPositionOrZero(objnum)) {
                   if (pObject) {
                     uint32_t oldgen = GetObjectGenNum(objnum);
-                    m_ObjectInfo[objnum].pos = obj_pos;
-                    m_ObjectInfo[objnum].gennum = gennum;
+                    m_CrossRefTable[objnum].pos = obj_pos;
+                    m_CrossRefTable[objnum].gennum = gennum;
                     if (oldgen != gennum)
                       m_bVersionUpdated = true;
                   }
                 } else {
-                  m_ObjectInfo[objnum].pos = obj_pos;
-                  m_ObjectInfo[objnum].type = 1;
-                  m_ObjectInfo[objnum].gennum = gennum;
+                  m_CrossRefTable[objnum].pos = obj_pos;
+                  m_CrossRefTable[objnum].type = 1;
+                  m_CrossRefTable[objnum].gennum = gennum;
                 }
 
                 if (pObject)
@@ -823,7 +910,8 @@ FX_BOOL CPDF_Parser::RebuildCrossRef() {
                       CPDF_Reference* pRef = ToReference(pRoot);
                       if (!pRoot ||
                           (pRef && IsValidObjectNumber(pRef->GetRefObjNum()) &&
-                           m_ObjectInfo[pRef->GetRefObjNum()].pos != 0)) {
+                           GetObjectPositionOrZero(pRef->GetRefObjNum()) !=
+                               0)) {
                         auto it = pTrailer->begin();
                         while (it != pTrailer->end()) {
                           const CFX_ByteString& key = it->first;
@@ -951,8 +1039,8 @@ FX_BOOL CPDF_Parser::RebuildCrossRef() {
   else if (last_trailer == -1 || last_xref < last_obj)
     last_trailer = m_pSyntax->m_FileLen;
 
-  m_SortedOffset.insert(last_trailer - m_pSyntax->m_HeaderOffset);
-  return m_pTrailer && !m_ObjectInfo.empty();
+  m_CrossRefTable.AddOffset(last_trailer - m_pSyntax->m_HeaderOffset);
+  return m_pTrailer && !m_CrossRefTable.empty();
 }
 
 FX_BOOL CPDF_Parser::LoadCrossRefV5(FX_FILESIZE* pos, FX_BOOL bMainXRef) {
@@ -991,8 +1079,7 @@ FX_BOOL CPDF_Parser::LoadCrossRefV5(FX_FILESIZE* pos, FX_BOOL bMainXRef) {
   if (bMainXRef) {
     m_pTrailer = pNewTrailer;
     ShrinkObjectMap(size);
-    for (auto& it : m_ObjectInfo)
-      it.second.type = 0;
+    m_CrossRefTable.ResetTypes();
   } else {
     m_Trailers.Add(pNewTrailer);
   }
@@ -1061,7 +1148,7 @@ FX_BOOL CPDF_Parser::LoadCrossRefV5(FX_FILESIZE* pos, FX_BOOL bMainXRef) {
     const uint8_t* segstart = pData + segindex * totalWidth;
     FX_SAFE_UINT32 dwMaxObjNum = startnum;
     dwMaxObjNum += count;
-    uint32_t dwV5Size = m_ObjectInfo.empty() ? 0 : GetLastObjNum() + 1;
+    uint32_t dwV5Size = m_CrossRefTable.empty() ? 0 : GetLastObjNum() + 1;
     if (!dwMaxObjNum.IsValid() || dwMaxObjNum.ValueOrDie() > dwV5Size)
       continue;
 
@@ -1074,29 +1161,29 @@ FX_BOOL CPDF_Parser::LoadCrossRefV5(FX_FILESIZE* pos, FX_BOOL bMainXRef) {
       if (GetObjectType(startnum + j) == 255) {
         FX_FILESIZE offset =
             GetVarInt(entrystart + WidthArray[0], WidthArray[1]);
-        m_ObjectInfo[startnum + j].pos = offset;
-        m_SortedOffset.insert(offset);
+        m_CrossRefTable[startnum + j].pos = offset;
+        m_CrossRefTable.AddOffset(offset);
         continue;
       }
 
       if (GetObjectType(startnum + j))
         continue;
 
-      m_ObjectInfo[startnum + j].type = type;
+      m_CrossRefTable[startnum + j].type = type;
       if (type == 0) {
-        m_ObjectInfo[startnum + j].pos = 0;
+        m_CrossRefTable[startnum + j].pos = 0;
       } else {
         FX_FILESIZE offset =
             GetVarInt(entrystart + WidthArray[0], WidthArray[1]);
-        m_ObjectInfo[startnum + j].pos = offset;
+        m_CrossRefTable[startnum + j].pos = offset;
         if (type == 1) {
-          m_SortedOffset.insert(offset);
+          m_CrossRefTable.AddOffset(offset);
         } else {
           if (offset < 0 || !IsValidObjectNumber(offset)) {
             pStream->Release();
             return FALSE;
           }
-          m_ObjectInfo[offset].type = 255;
+          m_CrossRefTable[offset].type = 255;
         }
       }
     }
@@ -1142,7 +1229,7 @@ CPDF_Object* CPDF_Parser::ParseIndirectObject(
 
   pdfium::ScopedSetInsertion<uint32_t> local_insert(&m_ParsingObjNums, objnum);
   if (GetObjectType(objnum) == 1 || GetObjectType(objnum) == 255) {
-    FX_FILESIZE pos = m_ObjectInfo[objnum].pos;
+    FX_FILESIZE pos = GetObjectPositionOrZero(objnum);
     if (pos <= 0)
       return nullptr;
     return ParseIndirectObjectAt(pObjList, pos, objnum);
@@ -1150,31 +1237,135 @@ CPDF_Object* CPDF_Parser::ParseIndirectObject(
   if (GetObjectType(objnum) != 2)
     return nullptr;
 
-  CPDF_StreamAcc* pObjStream = GetObjectStream(m_ObjectInfo[objnum].pos);
+  CPDF_StreamAcc* pObjStream =
+      GetObjectStream(GetObjectPositionOrZero(objnum));
   if (!pObjStream)
     return nullptr;
 
+  IndexObjectStream(pObjStream);
+  const StreamObjectCache& cache = m_ObjCache[pObjStream];
+  const auto it = cache.find(objnum);
+  if (it == cache.end())
+    return nullptr;
+
   ScopedFileStream file(FX_CreateMemoryStream(
       (uint8_t*)pObjStream->GetData(), (size_t)pObjStream->GetSize(), FALSE));
   CPDF_SyntaxParser syntax;
   syntax.InitParser(file.get(), 0);
-  const int32_t offset = GetStreamFirst(pObjStream);
+  syntax.RestorePos(GetStreamFirst(pObjStream) + it->second);
+  return syntax.GetObject(pObjList, 0, 0, true);
+}
 
-  // Read object numbers from |pObjStream| into a cache.
-  if (!pdfium::ContainsKey(m_ObjCache, pObjStream)) {
-    for (int32_t i = GetStreamNCount(pObjStream); i > 0; --i) {
-      uint32_t thisnum = syntax.GetDirectNum();
-      uint32_t thisoff = syntax.GetDirectNum();
-      m_ObjCache[pObjStream][thisnum] = thisoff;
+void CPDF_Parser::IndexObjectStream(CPDF_StreamAcc* pObjStream) {
+  if (pdfium::ContainsKey(m_ObjCache, pObjStream))
+    return;
+
+  ScopedFileStream file(FX_CreateMemoryStream(
+      (uint8_t*)pObjStream->GetData(), (size_t)pObjStream->GetSize(), FALSE));
+  CPDF_SyntaxParser syntax;
+  syntax.InitParser(file.get(), 0);
+  StreamObjectCache& cache = m_ObjCache[pObjStream];
+  for (int32_t i = GetStreamNCount(pObjStream); i > 0; --i) {
+    uint32_t thisnum = syntax.GetDirectNum();
+    uint32_t thisoff = syntax.GetDirectNum();
+    cache[thisnum] = thisoff;
+  }
+}
+
+uint32_t CPDF_Parser::LoadAllObjectStreams(int nThreads) {
+  if (!m_pDocument || m_CrossRefTable.empty())
+    return 0;
+
+  std::set<uint32_t> stream_objnums;
+  const uint32_t dwLastObjNum =
+      std::min(GetLastObjNum(), kMaxObjectNumber - 1);
+  for (uint32_t objnum = 0; objnum <= dwLastObjNum; ++objnum) {
+    if (GetObjectType(objnum) == 2)
+      stream_objnums.insert(GetObjectPositionOrZero(objnum));
+  }
+
+  // Going through the streams in file order turns the reads into one forward
+  // pass over the file, instead of seeking back and forth as objects from
+  // different streams are needed.
+  std::vector<std::pair<FX_FILESIZE, uint32_t>> streams;
+  for (uint32_t objnum : stream_objnums) {
+    if (!IsValidObjectNumber(objnum))
+      continue;
+
+    // Object streams are marked with type 255 by cross reference streams.
+    uint8_t type = GetObjectType(objnum);
+    if (type != 1 && type != 255)
+      continue;
+
+    streams.push_back(std::make_pair(GetObjectPositionOrZero(objnum), objnum));
+  }
+  std::sort(streams.begin(), streams.end());
+
+  // Parsing and reading stay on this thread. Only decompressing, which works
+  // on buffers nothing else refers to, is handed to the workers.
+  std::vector<FlateStreamJob> jobs;
+  std::vector<uint32_t> serial_objnums;
+  for (const auto& stream : streams) {
+    uint32_t objnum = stream.second;
+    if (m_ObjectStreamMap.find(objnum) != m_ObjectStreamMap.end()) {
+      serial_objnums.push_back(objnum);
+      continue;
+    }
+    const CPDF_Stream* pStream =
+        ToStream(m_pDocument->GetOrParseIndirectObject(objnum));
+    if (!pStream)
+      continue;
+
+    jobs.emplace_back();
+    if (PrepareFlateStreamJob(pStream, &jobs.back())) {
+      jobs.back().objnum = objnum;
+    } else {
+      jobs.pop_back();
+      serial_objnums.push_back(objnum);
     }
   }
 
-  const auto it = m_ObjCache[pObjStream].find(objnum);
-  if (it == m_ObjCache[pObjStream].end())
-    return nullptr;
+  CCodec_FlateModule* pFlateModule = CPDF_ModuleMgr::Get()->GetFlateModule();
+  std::atomic<size_t> next_job(0);
+  auto decode_jobs = [&jobs, &next_job, pFlateModule]() {
+    for (size_t i = next_job++; i < jobs.size(); i = next_job++) {
+      FlateStreamJob& job = jobs[i];
+      job.offset = pFlateModule->FlateOrLZWDecode(
+          FALSE, job.pSrc, job.src_size, TRUE, job.predictor, job.colors,
+          job.bits_per_component, job.columns, job.estimated_size, job.pDest,
+          job.dest_size);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (int i = 1; i < nThreads && static_cast<size_t>(i) < jobs.size(); ++i)
+    workers.push_back(std::thread(decode_jobs));
+  decode_jobs();
+  for (std::thread& worker : workers)
+    worker.join();
+
+  uint32_t nLoaded = 0;
+  for (FlateStreamJob& job : jobs) {
+    if (job.offset == FX_INVALID_OFFSET) {
+      // Let LoadAllData() handle the failure, as it does for lazy loads.
+      FX_Free(job.pDest);
+      serial_objnums.push_back(job.objnum);
+      continue;
+    }
+    CPDF_StreamAcc* pStreamAcc = new CPDF_StreamAcc;
+    pStreamAcc->AttachDecodedData(job.pStream, job.pDest, job.dest_size);
+    m_ObjectStreamMap[job.objnum].reset(pStreamAcc);
+    IndexObjectStream(pStreamAcc);
+    ++nLoaded;
+  }
+  for (uint32_t objnum : serial_objnums) {
+    CPDF_StreamAcc* pObjStream = GetObjectStream(objnum);
+    if (!pObjStream)
+      continue;
 
-  syntax.RestorePos(offset + it->second);
-  return syntax.GetObject(pObjList, 0, 0, true);
+    IndexObjectStream(pObjStream);
+    ++nLoaded;
+  }
+  return nLoaded;
 }
 
 CPDF_StreamAcc* CPDF_Parser::GetObjectStream(uint32_t objnum) {
@@ -1210,11 +1401,11 @@ FX_FILESIZE CPDF_Parser::GetObjectSize(uint32_t objnum) const {
   if (offset == 0)
     return 0;
 
-  auto it = m_SortedOffset.find(offset);
-  if (it == m_SortedOffset.end() || ++it == m_SortedOffset.end())
+  FX_FILESIZE next_offset;
+  if (!m_CrossRefTable.GetNextOffset(offset, &next_offset))
     return 0;
 
-  return *it - offset;
+  return next_offset - offset;
 }
 
 void CPDF_Parser::GetIndirectBinary(uint32_t objnum,
@@ -1226,7 +1417,8 @@ void CPDF_Parser::GetIndirectBinary(uint32_t objnum,
     return;
 
   if (GetObjectType(objnum) == 2) {
-    CPDF_StreamAcc* pObjStream = GetObjectStream(m_ObjectInfo[objnum].pos);
+    CPDF_StreamAcc* pObjStream =
+        GetObjectStream(GetObjectPositionOrZero(objnum));
     if (!pObjStream)
       return;
 
@@ -1262,7 +1454,7 @@ void CPDF_Parser::GetIndirectBinary(uint32_t objnum,
   if (GetObjectType(objnum) != 1)
     return;
 
-  FX_FILESIZE pos = m_ObjectInfo[objnum].pos;
+  FX_FILESIZE pos = GetObjectPositionOrZero(objnum);
   if (pos == 0)
     return;
 
@@ -1293,13 +1485,12 @@ void CPDF_Parser::GetIndirectBinary(uint32_t objnum,
     return;
   }
 
-  auto it = m_SortedOffset.find(pos);
-  if (it == m_SortedOffset.end() || ++it == m_SortedOffset.end()) {
+  FX_FILESIZE nextoff;
+  if (!m_CrossRefTable.GetNextOffset(pos, &nextoff)) {
     m_pSyntax->RestorePos(SavedPos);
     return;
   }
 
-  FX_FILESIZE nextoff = *it;
   FX_BOOL bNextOffValid = FALSE;
   if (nextoff != pos) {
     m_pSyntax->RestorePos(nextoff);
@@ -11,6 +11,7 @@
 #include <memory>
 #include <set>
 
+#include "core/fpdfapi/fpdf_parser/cpdf_cross_ref_table.h"
 #include "core/fxcrt/fx_basic.h"
 
 class CPDF_Array;
@@ -73,6 +74,14 @@ class CPDF_Parser {
   FX_FILESIZE GetObjectSize(uint32_t objnum) const;
 
   void GetIndirectBinary(uint32_t objnum, uint8_t*& pBuffer, uint32_t& size);
+
+  // Decodes every object stream the cross reference table refers to and
+  // indexes the objects in them. Objects stored in object streams can then be
+  // parsed without any further decoding. Streams are read in file order on
+  // the calling thread; those whose only filter is FlateDecode are then
+  // decompressed by up to |nThreads| threads, the calling one included.
+  // Returns the number of object streams loaded.
+  uint32_t LoadAllObjectStreams(int nThreads);
   int GetFileVersion() const { return m_FileVersion; }
   FX_BOOL IsXRefStream() const { return m_bXRefStream; }
 
@@ -89,16 +98,8 @@ class CPDF_Parser {
   uint32_t GetFirstPageNo() const { return m_dwFirstPageNo; }
 
  protected:
-  struct ObjectInfo {
-    ObjectInfo() : pos(0), type(0), gennum(0) {}
-
-    FX_FILESIZE pos;
-    uint8_t type;
-    uint16_t gennum;
-  };
-
   std::unique_ptr<CPDF_SyntaxParser> m_pSyntax;
-  std::map<uint32_t, ObjectInfo> m_ObjectInfo;
+  CPDF_CrossRefTable m_CrossRefTable;
 
   bool LoadCrossRefV4(FX_FILESIZE pos, FX_FILESIZE streampos, FX_BOOL bSkip);
   FX_BOOL RebuildCrossRef();
@@ -135,6 +136,9 @@ class CPDF_Parser {
   FX_BOOL LoadLinearizedAllCrossRefV5(FX_FILESIZE pos);
   Error LoadLinearizedMainXRefTable();
   CPDF_StreamAcc* GetObjectStream(uint32_t number);
+  // Reads the object numbers and offsets at the start of |pObjStream| into
+  // |m_ObjCache|, unless that was done before.
+  void IndexObjectStream(CPDF_StreamAcc* pObjStream);
   FX_BOOL IsLinearizedFile(IFX_FileRead* pFileAccess, uint32_t offset);
   void SetEncryptDictionary(CPDF_Dictionary* pDict);
   void ShrinkObjectMap(uint32_t size);
@@ -152,7 +156,6 @@ class CPDF_Parser {
   FX_BOOL m_bXRefStream;
   std::unique_ptr<CPDF_SecurityHandler> m_pSecurityHandler;
   CFX_ByteString m_Password;
-  std::set<FX_FILESIZE> m_SortedOffset;
   CFX_ArrayTemplate<CPDF_Dictionary*> m_Trailers;
   bool m_bVersionUpdated;
   CPDF_Object* m_pLinearized;
@@ -84,9 +84,9 @@ TEST(cpdf_parser, RebuildCrossRefCorrectly) {
   const FX_FILESIZE offsets[] = {0, 15, 61, 154, 296, 374, 450};
   const uint16_t versions[] = {0, 0, 2, 4, 6, 8, 0};
   for (size_t i = 0; i < FX_ArraySize(offsets); ++i)
-    EXPECT_EQ(offsets[i], parser.m_ObjectInfo[i].pos);
+    EXPECT_EQ(offsets[i], parser.m_CrossRefTable[i].pos);
   for (size_t i = 0; i < FX_ArraySize(versions); ++i)
-    EXPECT_EQ(versions[i], parser.m_ObjectInfo[i].gennum);
+    EXPECT_EQ(versions[i], parser.m_CrossRefTable[i].gennum);
 }
 
 TEST(cpdf_parser, RebuildCrossRefFailed) {
@@ -119,8 +119,8 @@ TEST(cpdf_parser, LoadCrossRefV4) {
     const FX_FILESIZE offsets[] = {0, 17, 81, 0, 331, 409};
     const uint8_t types[] = {0, 1, 1, 0, 1, 1};
     for (size_t i = 0; i < FX_ArraySize(offsets); ++i) {
-      EXPECT_EQ(offsets[i], parser.m_ObjectInfo[i].pos);
-      EXPECT_EQ(types[i], parser.m_ObjectInfo[i].type);
+      EXPECT_EQ(offsets[i], parser.m_CrossRefTable[i].pos);
+      EXPECT_EQ(types[i], parser.m_CrossRefTable[i].type);
     }
   }
   {
@@ -145,8 +145,8 @@ TEST(cpdf_parser, LoadCrossRefV4) {
                                    0, 25518, 25635, 0,     0, 25777};
     const uint8_t types[] = {0, 0, 0, 1, 0, 0, 0, 0, 1, 1, 0, 0, 1};
     for (size_t i = 0; i < FX_ArraySize(offsets); ++i) {
-      EXPECT_EQ(offsets[i], parser.m_ObjectInfo[i].pos);
-      EXPECT_EQ(types[i], parser.m_ObjectInfo[i].type);
+      EXPECT_EQ(offsets[i], parser.m_CrossRefTable[i].pos);
+      EXPECT_EQ(types[i], parser.m_CrossRefTable[i].type);
     }
   }
   {
@@ -171,8 +171,8 @@ TEST(cpdf_parser, LoadCrossRefV4) {
                                    0, 0, 25635, 0,     0, 25777};
     const uint8_t types[] = {0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 1};
     for (size_t i = 0; i < FX_ArraySize(offsets); ++i) {
-      EXPECT_EQ(offsets[i], parser.m_ObjectInfo[i].pos);
-      EXPECT_EQ(types[i], parser.m_ObjectInfo[i].type);
+      EXPECT_EQ(offsets[i], parser.m_CrossRefTable[i].pos);
+      EXPECT_EQ(types[i], parser.m_CrossRefTable[i].type);
     }
   }
   {
@@ -195,8 +195,8 @@ TEST(cpdf_parser, LoadCrossRefV4) {
     const FX_FILESIZE offsets[] = {0, 23, 0, 0, 0, 45, 179};
     const uint8_t types[] = {0, 1, 0, 0, 0, 1, 1};
     for (size_t i = 0; i < FX_ArraySize(offsets); ++i) {
-      EXPECT_EQ(offsets[i], parser.m_ObjectInfo[i].pos);
-      EXPECT_EQ(types[i], parser.m_ObjectInfo[i].type);
+      EXPECT_EQ(offsets[i], parser.m_CrossRefTable[i].pos);
+      EXPECT_EQ(types[i], parser.m_CrossRefTable[i].type);
     }
   }
 }
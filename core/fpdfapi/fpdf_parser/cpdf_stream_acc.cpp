@@ -46,6 +46,12 @@ void CPDF_StreamAcc::LoadAllData(const CPDF_Stream* pStream,
     m_pData = pSrcData;
     m_dwSize = dwSrcSize;
   } else {
+    // /DL, when given, is the size of the fully decoded data.
+    if (!estimated_size) {
+      int nDecodedLength = pStream->GetDict()->GetIntegerFor("DL");
+      if (nDecodedLength > 0)
+        estimated_size = nDecodedLength;
+    }
     FX_BOOL bRet = PDF_DataDecode(pSrcData, dwSrcSize, m_pStream->GetDict(),
                                   m_pData, m_dwSize, m_ImageDecoder,
                                   m_pImageParam, estimated_size, bImageAcc);
@@ -60,6 +66,16 @@ void CPDF_StreamAcc::LoadAllData(const CPDF_Stream* pStream,
   m_bNewBuf = m_pData != pStream->GetRawData();
 }
 
+void CPDF_StreamAcc::AttachDecodedData(const CPDF_Stream* pStream,
+                                       uint8_t* pData,
+                                       uint32_t dwSize) {
+  ASSERT(!m_pStream);
+  m_pStream = pStream;
+  m_pData = pData;
+  m_dwSize = dwSize;
+  m_bNewBuf = TRUE;
+}
+
 CPDF_StreamAcc::~CPDF_StreamAcc() {
   if (m_bNewBuf)
     FX_Free(m_pData);
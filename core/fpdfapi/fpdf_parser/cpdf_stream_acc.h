@@ -33,6 +33,12 @@ class CPDF_StreamAcc {
   const CPDF_Dictionary* GetImageParam() const { return m_pImageParam; }
   uint8_t* DetachData();
 
+  // Takes |pData|, which must have been allocated with FX_Alloc(), as the
+  // decoded content of |pStream|, for data decoded by the caller.
+  void AttachDecodedData(const CPDF_Stream* pStream,
+                         uint8_t* pData,
+                         uint32_t dwSize);
+
  protected:
   uint8_t* m_pData;
   uint32_t m_dwSize;
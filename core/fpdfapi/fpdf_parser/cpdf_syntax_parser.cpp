@@ -6,6 +6,7 @@
 
 #include "core/fpdfapi/fpdf_parser/cpdf_syntax_parser.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "core/fpdfapi/cpdf_modulemgr.h"
@@ -43,6 +44,7 @@ CPDF_SyntaxParser::CPDF_SyntaxParser(
     const CFX_WeakPtr<CFX_ByteStringPool>& pPool)
     : m_MetadataObjnum(0),
       m_pFileAccess(nullptr),
+      m_pFileView(nullptr),
       m_pFileBuf(nullptr),
       m_BufSize(CPDF_ModuleMgr::kFileBufSize),
       m_pPool(pPool) {}
@@ -62,36 +64,77 @@ FX_BOOL CPDF_SyntaxParser::GetNextChar(uint8_t& ch) {
   if (pos >= m_FileLen)
     return FALSE;
 
-  if (m_BufOffset >= pos || (FX_FILESIZE)(m_BufOffset + m_BufSize) <= pos) {
-    FX_FILESIZE read_pos = pos;
-    uint32_t read_size = m_BufSize;
-    if ((FX_FILESIZE)read_size > m_FileLen)
-      read_size = (uint32_t)m_FileLen;
-
-    if ((FX_FILESIZE)(read_pos + read_size) > m_FileLen) {
-      if (m_FileLen < (FX_FILESIZE)read_size) {
-        read_pos = 0;
-        read_size = (uint32_t)m_FileLen;
-      } else {
-        read_pos = m_FileLen - read_size;
-      }
-    }
-
-    if (!m_pFileAccess->ReadBlock(m_pFileBuf, read_pos, read_size))
+  if (m_pFileView) {
+    if (pos < 0)
       return FALSE;
+    ch = m_pFileView[pos];
+    m_Pos++;
+    return TRUE;
+  }
 
-    m_BufOffset = read_pos;
+  if (m_BufOffset >= pos || (FX_FILESIZE)(m_BufOffset + m_BufSize) <= pos) {
+    if (!ReadFileBuf(pos))
+      return FALSE;
   }
   ch = m_pFileBuf[pos - m_BufOffset];
   m_Pos++;
   return TRUE;
 }
 
+FX_BOOL CPDF_SyntaxParser::ReadFileBuf(FX_FILESIZE pos) {
+  FX_FILESIZE read_pos = pos;
+  uint32_t read_size = m_BufSize;
+  if ((FX_FILESIZE)read_size > m_FileLen)
+    read_size = (uint32_t)m_FileLen;
+
+  if ((FX_FILESIZE)(read_pos + read_size) > m_FileLen) {
+    if (m_FileLen < (FX_FILESIZE)read_size) {
+      read_pos = 0;
+      read_size = (uint32_t)m_FileLen;
+    } else {
+      read_pos = m_FileLen - read_size;
+    }
+  }
+
+  if (!m_pFileAccess->ReadBlock(m_pFileBuf, read_pos, read_size))
+    return FALSE;
+
+  m_BufOffset = read_pos;
+  return TRUE;
+}
+
+const uint8_t* CPDF_SyntaxParser::GetCurrentSpan(uint32_t* pSize) {
+  FX_FILESIZE pos = m_Pos + m_HeaderOffset;
+  if (pos >= m_FileLen || pos < 0)
+    return nullptr;
+
+  if (m_pFileView) {
+    *pSize = (uint32_t)std::min<FX_FILESIZE>(m_FileLen - pos, 0x7FFFFFFF);
+    return m_pFileView + pos;
+  }
+
+  if (m_BufOffset > pos || (FX_FILESIZE)(m_BufOffset + m_BufSize) <= pos) {
+    if (!ReadFileBuf(pos))
+      return nullptr;
+  }
+  FX_FILESIZE buf_end =
+      std::min<FX_FILESIZE>(m_BufOffset + m_BufSize, m_FileLen);
+  *pSize = (uint32_t)(buf_end - pos);
+  return m_pFileBuf + (pos - m_BufOffset);
+}
+
 FX_BOOL CPDF_SyntaxParser::GetCharAtBackward(FX_FILESIZE pos, uint8_t& ch) {
   pos += m_HeaderOffset;
   if (pos >= m_FileLen)
     return FALSE;
 
+  if (m_pFileView) {
+    if (pos < 0)
+      return FALSE;
+    ch = m_pFileView[pos];
+    return TRUE;
+  }
+
   if (m_BufOffset >= pos || (FX_FILESIZE)(m_BufOffset + m_BufSize) <= pos) {
     FX_FILESIZE read_pos;
     if (pos < (FX_FILESIZE)m_BufSize)
@@ -125,31 +168,65 @@ FX_BOOL CPDF_SyntaxParser::ReadBlock(uint8_t* pBuf, uint32_t size) {
   return TRUE;
 }
 
-void CPDF_SyntaxParser::GetNextWordInternal(bool* bIsNumber) {
-  m_WordSize = 0;
-  if (bIsNumber)
-    *bIsNumber = true;
-
-  uint8_t ch;
-  if (!GetNextChar(ch))
-    return;
-
+bool CPDF_SyntaxParser::SkipWhitespaceAndComments() {
+  bool bInComment = false;
   while (1) {
-    while (PDFCharIsWhitespace(ch)) {
-      if (!GetNextChar(ch))
-        return;
+    uint32_t size;
+    const uint8_t* pData = GetCurrentSpan(&size);
+    if (!pData)
+      return false;
+
+    const uint8_t* pEnd = pData + size;
+    for (const uint8_t* p = pData; p < pEnd; ++p) {
+      if (bInComment) {
+        p = PDFFindLineEnding(p, pEnd);
+        if (p == pEnd)
+          break;
+        bInComment = false;
+      } else if (*p == '%') {
+        bInComment = true;
+      } else if (!PDFCharIsWhitespace(*p)) {
+        m_Pos += p - pData;
+        return true;
+      }
     }
+    m_Pos += size;
+  }
+}
 
-    if (ch != '%')
-      break;
+void CPDF_SyntaxParser::ReadRegularChars(bool* bIsNumber) {
+  while (1) {
+    uint32_t size;
+    const uint8_t* pData = GetCurrentSpan(&size);
+    if (!pData)
+      return;
 
-    while (1) {
-      if (!GetNextChar(ch))
-        return;
-      if (PDFCharIsLineEnding(ch))
+    uint32_t i = 0;
+    for (; i < size; ++i) {
+      uint8_t ch = pData[i];
+      if (PDFCharIsDelimiter(ch) || PDFCharIsWhitespace(ch))
         break;
+
+      if (m_WordSize < sizeof(m_WordBuffer) - 1)
+        m_WordBuffer[m_WordSize++] = ch;
+
+      if (bIsNumber && !PDFCharIsNumeric(ch))
+        *bIsNumber = false;
     }
+    m_Pos += i;
+    if (i < size)
+      return;
   }
+}
+
+void CPDF_SyntaxParser::GetNextWordInternal(bool* bIsNumber) {
+  m_WordSize = 0;
+  if (bIsNumber)
+    *bIsNumber = true;
+
+  uint8_t ch;
+  if (!SkipWhitespaceAndComments() || !GetNextChar(ch))
+    return;
 
   if (PDFCharIsDelimiter(ch)) {
     if (bIsNumber)
@@ -157,18 +234,7 @@ void CPDF_SyntaxParser::GetNextWordInternal(bool* bIsNumber) {
 
     m_WordBuffer[m_WordSize++] = ch;
     if (ch == '/') {
-      while (1) {
-        if (!GetNextChar(ch))
-          return;
-
-        if (!PDFCharIsOther(ch) && !PDFCharIsNumeric(ch)) {
-          m_Pos--;
-          return;
-        }
-
-        if (m_WordSize < sizeof(m_WordBuffer) - 1)
-          m_WordBuffer[m_WordSize++] = ch;
-      }
+      ReadRegularChars(nullptr);
     } else if (ch == '<') {
       if (!GetNextChar(ch))
         return;
@@ -189,23 +255,10 @@ void CPDF_SyntaxParser::GetNextWordInternal(bool* bIsNumber) {
     return;
   }
 
-  while (1) {
-    if (m_WordSize < sizeof(m_WordBuffer) - 1)
-      m_WordBuffer[m_WordSize++] = ch;
-
-    if (!PDFCharIsNumeric(ch)) {
-      if (bIsNumber)
-        *bIsNumber = false;
-    }
-
-    if (!GetNextChar(ch))
-      return;
-
-    if (PDFCharIsDelimiter(ch) || PDFCharIsWhitespace(ch)) {
-      m_Pos--;
-      break;
-    }
-  }
+  m_WordBuffer[m_WordSize++] = ch;
+  if (bIsNumber && !PDFCharIsNumeric(ch))
+    *bIsNumber = false;
+  ReadRegularChars(bIsNumber);
 }
 
 CFX_ByteString CPDF_SyntaxParser::ReadString() {
@@ -346,27 +399,7 @@ void CPDF_SyntaxParser::ToNextLine() {
 }
 
 void CPDF_SyntaxParser::ToNextWord() {
-  uint8_t ch;
-  if (!GetNextChar(ch))
-    return;
-
-  while (1) {
-    while (PDFCharIsWhitespace(ch)) {
-      if (!GetNextChar(ch))
-        return;
-    }
-
-    if (ch != '%')
-      break;
-
-    while (1) {
-      if (!GetNextChar(ch))
-        return;
-      if (PDFCharIsLineEnding(ch))
-        break;
-    }
-  }
-  m_Pos--;
+  SkipWhitespaceAndComments();
 }
 
 CFX_ByteString CPDF_SyntaxParser::GetNextWord(bool* bIsNumber) {
@@ -473,8 +506,9 @@ CPDF_Object* CPDF_SyntaxParser::GetObject(CPDF_IndirectObjectHolder* pObjList,
         continue;
 
       CFX_ByteString keyNoSlash(key.raw_str() + 1, key.GetLength() - 1);
-      pDict->SetFor(keyNoSlash, pObj);
+      pDict->AppendFor(keyNoSlash, pObj);
     }
+    pDict->SortAppended();
 
     // Only when this is a signature dictionary and has contents, we reset the
     // contents to the un-decrypted form.
@@ -591,10 +625,11 @@ CPDF_Object* CPDF_SyntaxParser::GetObjectForStrict(
       }
 
       if (key.GetLength() > 1) {
-        pDict->SetFor(CFX_ByteString(key.c_str() + 1, key.GetLength() - 1),
-                      obj.release());
+        pDict->AppendFor(CFX_ByteString(key.c_str() + 1, key.GetLength() - 1),
+                         obj.release());
       }
     }
+    pDict->SortAppended();
 
     FX_FILESIZE SavedPos = m_Pos;
     CFX_ByteString nextword = GetNextWord(nullptr);
@@ -689,10 +724,20 @@ CPDF_Stream* CPDF_SyntaxParser::ReadStream(CPDF_Dictionary* pDict,
         }
       }
 
+      // Only an "endobj" before "endstream" matters, so do not look past it.
       m_Pos = streamStartPos;
       FX_FILESIZE endObjOffset = 0;
       while (endObjOffset >= 0) {
-        endObjOffset = FindTag(kEndObjStr, 0);
+        FX_FILESIZE endObjLimit = 0;
+        if (endStreamOffset >= 0) {
+          endObjLimit = streamStartPos + endStreamOffset +
+                        kEndObjStr.GetLength() - m_Pos;
+          if (endObjLimit <= 0) {
+            endObjOffset = -1;
+            break;
+          }
+        }
+        endObjOffset = FindTag(kEndObjStr, endObjLimit);
 
         // Can't find "endobj".
         if (endObjOffset < 0)
@@ -785,13 +830,20 @@ CPDF_Stream* CPDF_SyntaxParser::ReadStream(CPDF_Dictionary* pDict,
 void CPDF_SyntaxParser::InitParser(IFX_FileRead* pFileAccess,
                                    uint32_t HeaderOffset) {
   FX_Free(m_pFileBuf);
+  m_pFileBuf = nullptr;
 
-  m_pFileBuf = FX_Alloc(uint8_t, m_BufSize);
   m_HeaderOffset = HeaderOffset;
   m_FileLen = pFileAccess->GetSize();
   m_Pos = 0;
   m_pFileAccess = pFileAccess;
   m_BufOffset = 0;
+
+  // Scan memory-resident files in place rather than through |m_pFileBuf|.
+  m_pFileView = pFileAccess->GetDirectBuffer();
+  if (m_pFileView)
+    return;
+
+  m_pFileBuf = FX_Alloc(uint8_t, m_BufSize);
   pFileAccess->ReadBlock(
       m_pFileBuf, 0,
       (size_t)((FX_FILESIZE)m_BufSize > m_FileLen ? m_FileLen : m_BufSize));
@@ -969,17 +1021,36 @@ FX_FILESIZE CPDF_SyntaxParser::FindTag(const CFX_ByteStringC& tag,
   FX_FILESIZE startpos = m_Pos;
 
   while (1) {
-    uint8_t ch;
-    if (!GetNextChar(ch))
+    uint32_t size;
+    const uint8_t* pData = GetCurrentSpan(&size);
+    if (!pData)
       return -1;
 
-    if (ch == tag[match]) {
-      match++;
-      if (match == taglen)
-        return m_Pos - startpos - taglen;
-    } else {
-      match = ch == tag[0] ? 1 : 0;
+    if (limit && m_Pos < limit && limit - m_Pos < size)
+      size = (uint32_t)(limit - m_Pos);
+
+    // With no partial match, only the first byte of |tag| matters, so jump
+    // straight to its next occurrence.
+    const uint8_t* pEnd = pData + size;
+    const uint8_t* p = pData;
+    while (p < pEnd) {
+      if (match == 0) {
+        p = static_cast<const uint8_t*>(memchr(p, tag[0], pEnd - p));
+        if (!p)
+          break;
+      }
+      uint8_t ch = *p++;
+      if (ch == tag[match]) {
+        match++;
+        if (match == taglen) {
+          m_Pos += p - pData;
+          return m_Pos - startpos - taglen;
+        }
+      } else {
+        match = ch == tag[0] ? 1 : 0;
+      }
     }
+    m_Pos += size;
 
     if (limit && m_Pos == limit)
       return -1;
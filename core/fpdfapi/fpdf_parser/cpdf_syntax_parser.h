@@ -68,6 +68,15 @@ class CPDF_SyntaxParser {
 
   uint32_t GetDirectNum();
   FX_BOOL GetNextChar(uint8_t& ch);
+  // Returns the bytes from |m_Pos| on that are in memory, refilling
+  // |m_pFileBuf| if needed, and sets |*pSize| to their number. Returns
+  // nullptr at the end of the file or on a read error.
+  const uint8_t* GetCurrentSpan(uint32_t* pSize);
+  FX_BOOL ReadFileBuf(FX_FILESIZE pos);
+  // Moves past whitespace and comments. Returns false at the end of the file.
+  bool SkipWhitespaceAndComments();
+  // Appends bytes up to the next whitespace or delimiter to |m_WordBuffer|.
+  void ReadRegularChars(bool* bIsNumber);
   FX_BOOL GetCharAtBackward(FX_FILESIZE pos, uint8_t& ch);
   void GetNextWordInternal(bool* bIsNumber);
   bool IsWholeWord(FX_FILESIZE startpos,
@@ -87,6 +96,8 @@ class CPDF_SyntaxParser {
   FX_FILESIZE m_Pos;
   int m_MetadataObjnum;
   IFX_FileRead* m_pFileAccess;
+  // Set when the whole file is resident in memory; |m_pFileBuf| is unused.
+  const uint8_t* m_pFileView;
   FX_FILESIZE m_HeaderOffset;
   FX_FILESIZE m_FileLen;
   uint8_t* m_pFileBuf;
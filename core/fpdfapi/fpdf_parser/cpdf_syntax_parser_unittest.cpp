@@ -3,8 +3,11 @@
 // found in the LICENSE file.
 
 #include <limits>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "core/fpdfapi/fpdf_parser/cpdf_dictionary.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_parser.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_syntax_parser.h"
 #include "core/fxcrt/fx_ext.h"
@@ -12,6 +15,39 @@
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/utils/path_service.h"
 
+namespace {
+
+// Reads from a string, either through ReadBlock() only or also by handing
+// out the whole buffer so that the parser scans it in place.
+class CFX_TestStringRead : public IFX_FileRead {
+ public:
+  CFX_TestStringRead(const std::string& data, bool bDirect)
+      : m_Data(data), m_bDirect(bDirect) {}
+
+  // IFX_Stream
+  void Release() override { delete this; }
+
+  // IFX_FileRead
+  FX_BOOL ReadBlock(void* buffer, FX_FILESIZE offset, size_t size) override {
+    if (offset < 0 || offset + size > m_Data.size())
+      return FALSE;
+
+    memcpy(buffer, m_Data.data() + offset, size);
+    return TRUE;
+  }
+  FX_FILESIZE GetSize() override { return m_Data.size(); }
+  const uint8_t* GetDirectBuffer() override {
+    return m_bDirect ? reinterpret_cast<const uint8_t*>(m_Data.data())
+                     : nullptr;
+  }
+
+ private:
+  const std::string m_Data;
+  const bool m_bDirect;
+};
+
+}  // namespace
+
 TEST(cpdf_syntax_parser, ReadHexString) {
   {
     // Empty string.
@@ -169,3 +205,108 @@ TEST(cpdf_syntax_parser, ReadHexString) {
     EXPECT_EQ(1, parser.SavePos());
   }
 }
+
+TEST(cpdf_syntax_parser, GetNextWord) {
+  const std::string kLongWord(300, 'a');
+  const std::string kWords =
+      "%comment\r\n/Name 123 -4.5 abc<<>>[ ]%c\n%\r\r<x> " + kLongWord +
+      " /#20()end";
+  struct {
+    const char* word;
+    bool bIsNumber;
+  } const kExpected[] = {
+      {"/Name", false}, {"123", true}, {"-4.5", true}, {"abc", false},
+      {"<<", false},    {">>", false}, {"[", false},   {"]", false},
+      {"<", false},     {"x", false},  {">", false},   {nullptr, false},
+      {"/#20", false},  {"(", false},  {")", false},   {"end", false},
+      {"", true},
+  };
+  // Move the words across the boundaries of the parser's read buffer.
+  for (int pad = 0; pad < 1100; pad += pad < 490 ? 70 : 1) {
+    for (bool bDirect : {false, true}) {
+      SCOPED_TRACE(testing::Message() << pad << " " << bDirect);
+      std::string data = std::string(pad, ' ') + kWords;
+      std::unique_ptr<IFX_FileRead, ReleaseDeleter<IFX_FileRead>> stream(
+          new CFX_TestStringRead(data, bDirect));
+      CPDF_SyntaxParser parser;
+      parser.InitParser(stream.get(), 0);
+      for (const auto& expected : kExpected) {
+        bool bIsNumber = !expected.bIsNumber;
+        CFX_ByteString word = parser.GetNextWord(&bIsNumber);
+        if (!expected.word) {
+          EXPECT_EQ(kLongWord.substr(0, 256), word.c_str());
+          EXPECT_FALSE(bIsNumber);
+          continue;
+        }
+        EXPECT_EQ(expected.word, word);
+        EXPECT_EQ(expected.bIsNumber, bIsNumber);
+      }
+      EXPECT_EQ(static_cast<FX_FILESIZE>(data.size()), parser.SavePos());
+
+      parser.RestorePos(pad);
+      parser.ToNextWord();
+      EXPECT_EQ(pad + 10, parser.SavePos());
+    }
+  }
+}
+
+TEST(cpdf_syntax_parser, FindTag) {
+  for (int pad = 0; pad < 1100; pad += pad < 490 ? 70 : 1) {
+    for (bool bDirect : {false, true}) {
+      SCOPED_TRACE(testing::Message() << pad << " " << bDirect);
+      // A partial match only restarts at the byte that broke it, so the
+      // first "endstream" here is not found.
+      std::string data = std::string(pad, 'e') + "endstrendstream endstream";
+      std::unique_ptr<IFX_FileRead, ReleaseDeleter<IFX_FileRead>> stream(
+          new CFX_TestStringRead(data, bDirect));
+      CPDF_SyntaxParser parser;
+      parser.InitParser(stream.get(), 0);
+      EXPECT_EQ(pad + 16, parser.FindTag("endstream", 0));
+      EXPECT_EQ(pad + 25, parser.SavePos());
+      EXPECT_EQ(-1, parser.FindTag("endstream", 0));
+      EXPECT_EQ(pad + 25, parser.SavePos());
+
+      parser.RestorePos(pad);
+      EXPECT_EQ(-1, parser.FindTag("endstream", 24));
+      EXPECT_EQ(pad + 24, parser.SavePos());
+      parser.RestorePos(pad);
+      EXPECT_EQ(16, parser.FindTag("endstream", 25));
+      parser.RestorePos(pad + 1);
+      EXPECT_EQ(0, parser.FindTag("n", 0));
+      EXPECT_EQ(pad + 2, parser.SavePos());
+    }
+  }
+}
+
+TEST(cpdf_syntax_parser, DictionaryKeys) {
+  // Enough keys to go past the size that is searched linearly, in reverse
+  // order and with some of them repeated.
+  std::string data = "<<";
+  for (int i = 0; i < 40; ++i)
+    data += " /K" + std::to_string(29 - i % 30) + " " + std::to_string(i);
+  data += " >>";
+  for (bool bStrict : {false, true}) {
+    SCOPED_TRACE(bStrict);
+    std::unique_ptr<IFX_FileRead, ReleaseDeleter<IFX_FileRead>> stream(
+        new CFX_TestStringRead(data, false));
+    CPDF_SyntaxParser parser;
+    parser.InitParser(stream.get(), 0);
+    std::unique_ptr<CPDF_Object, ReleaseDeleter<CPDF_Object>> obj(
+        bStrict ? parser.GetObjectForStrict(nullptr, 0, 0)
+                : parser.GetObject(nullptr, 0, 0, true));
+    ASSERT_TRUE(obj);
+    const CPDF_Dictionary* dict = obj->AsDictionary();
+    ASSERT_TRUE(dict);
+    ASSERT_EQ(30u, dict->GetCount());
+    // The last value for every key wins.
+    for (int i = 0; i < 30; ++i) {
+      EXPECT_EQ(i < 20 ? 29 - i : 59 - i,
+                dict->GetIntegerFor(("K" + std::to_string(i)).c_str()));
+    }
+    CFX_ByteString previous;
+    for (const auto& it : *dict) {
+      EXPECT_LT(previous, it.first);
+      previous = it.first;
+    }
+  }
+}
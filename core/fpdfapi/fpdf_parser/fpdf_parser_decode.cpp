@@ -297,6 +297,28 @@ CCodec_ScanlineDecoder* FPDFAPI_CreateFlateDecoder(
       BitsPerComponent, Columns);
 }
 
+bool PDF_GetFlateDecodeParams(const CPDF_Dictionary* pParams,
+                              int* predictor,
+                              FX_BOOL* bEarlyChange,
+                              int* Colors,
+                              int* BitsPerComponent,
+                              int* Columns) {
+  *predictor = 0;
+  *bEarlyChange = TRUE;
+  *Colors = 0;
+  *BitsPerComponent = 0;
+  *Columns = 0;
+  if (!pParams)
+    return true;
+
+  *predictor = pParams->GetIntegerFor("Predictor");
+  *bEarlyChange = pParams->GetIntegerFor("EarlyChange", 1);
+  *Colors = pParams->GetIntegerFor("Colors", 1);
+  *BitsPerComponent = pParams->GetIntegerFor("BitsPerComponent", 8);
+  *Columns = pParams->GetIntegerFor("Columns", 1);
+  return CheckFlateDecodeParams(*Colors, *BitsPerComponent, *Columns);
+}
+
 uint32_t FPDFAPI_FlateOrLZWDecode(FX_BOOL bLZW,
                                   const uint8_t* src_buf,
                                   uint32_t src_size,
@@ -304,18 +326,12 @@ uint32_t FPDFAPI_FlateOrLZWDecode(FX_BOOL bLZW,
                                   uint32_t estimated_size,
                                   uint8_t*& dest_buf,
                                   uint32_t& dest_size) {
-  int predictor = 0;
-  FX_BOOL bEarlyChange = TRUE;
-  int Colors = 0, BitsPerComponent = 0, Columns = 0;
-  if (pParams) {
-    predictor = pParams->GetIntegerFor("Predictor");
-    bEarlyChange = pParams->GetIntegerFor("EarlyChange", 1);
-    Colors = pParams->GetIntegerFor("Colors", 1);
-    BitsPerComponent = pParams->GetIntegerFor("BitsPerComponent", 8);
-    Columns = pParams->GetIntegerFor("Columns", 1);
-    if (!CheckFlateDecodeParams(Colors, BitsPerComponent, Columns)) {
-      return (uint32_t)-1;
-    }
+  int predictor;
+  FX_BOOL bEarlyChange;
+  int Colors, BitsPerComponent, Columns;
+  if (!PDF_GetFlateDecodeParams(pParams, &predictor, &bEarlyChange, &Colors,
+                                &BitsPerComponent, &Columns)) {
+    return (uint32_t)-1;
   }
   return CPDF_ModuleMgr::Get()->GetFlateModule()->FlateOrLZWDecode(
       bLZW, src_buf, src_size, bEarlyChange, predictor, Colors,
@@ -56,6 +56,14 @@ uint32_t HexDecode(const uint8_t* src_buf,
                    uint32_t src_size,
                    uint8_t*& dest_buf,
                    uint32_t& dest_size);
+// Reads the parameters of a FlateDecode or LZWDecode filter from |pParams|,
+// which may be null. Returns false if they are out of range.
+bool PDF_GetFlateDecodeParams(const CPDF_Dictionary* pParams,
+                              int* predictor,
+                              FX_BOOL* bEarlyChange,
+                              int* Colors,
+                              int* BitsPerComponent,
+                              int* Columns);
 // Public for testing.
 uint32_t FPDFAPI_FlateOrLZWDecode(FX_BOOL bLZW,
                                   const uint8_t* src_buf,
@@ -6,6 +6,8 @@
 
 #include "core/fpdfapi/fpdf_parser/fpdf_parser_utility.h"
 
+#include <cctype>
+
 #include "core/fpdfapi/fpdf_parser/cpdf_array.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_dictionary.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_number.h"
@@ -14,8 +16,50 @@
 #include "core/fpdfapi/fpdf_parser/cpdf_stream_acc.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_string.h"
 #include "core/fpdfapi/fpdf_parser/fpdf_parser_decode.h"
+#include "core/fxcrt/fx_cpu.h"
 #include "core/fxcrt/fx_ext.h"
 
+namespace {
+
+// The scanners below inline their SSE2 matchers as lambdas, so they only use
+// them where every CPU has SSE2.
+#ifdef FX_SSE2_BASELINE
+
+// Runs |Matches|, which maps 16 bytes to a mask with 0xFF in every lane that
+// ends the scan, over [begin, end) 16 bytes at a time. Returns the first
+// match, or the start of the remaining tail of fewer than 16 bytes.
+template <typename Matches>
+const uint8_t* FindFirstMatch(const uint8_t* begin,
+                              const uint8_t* end,
+                              Matches matches) {
+  while (end - begin >= 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    int mask = _mm_movemask_epi8(matches(bytes));
+    if (mask) {
+      while (!(mask & 1)) {
+        mask >>= 1;
+        ++begin;
+      }
+      return begin;
+    }
+    begin += 16;
+  }
+  return begin;
+}
+
+__m128i IsByte(__m128i bytes, char c) {
+  return _mm_cmpeq_epi8(bytes, _mm_set1_epi8(c));
+}
+
+#endif  // FX_SSE2_BASELINE
+
+bool IsRebuildCandidate(uint8_t c) {
+  return PDFCharIsWhitespace(c) || std::isdigit(c) || c == '%' || c == '(' ||
+         c == '<' || c == '\\' || c == 't';
+}
+
+}  // namespace
+
 // Indexed by 8-bit character code, contains either:
 //   'W' - for whitespace: NUL, TAB, CR, LF, FF, SPACE, 0x80, 0xff
 //   'N' - for numeric: 0123456789+-.
@@ -219,3 +263,54 @@ CFX_ByteTextBuf& operator<<(CFX_ByteTextBuf& buf, const CPDF_Object* pObj) {
   }
   return buf;
 }
+
+const uint8_t* PDFFindLineEnding(const uint8_t* begin, const uint8_t* end) {
+#ifdef FX_SSE2_BASELINE
+  begin = FindFirstMatch(begin, end, [](__m128i bytes) {
+    return _mm_or_si128(IsByte(bytes, '\r'), IsByte(bytes, '\n'));
+  });
+#endif
+  while (begin < end && !PDFCharIsLineEnding(*begin))
+    ++begin;
+  return begin;
+}
+
+const uint8_t* PDFFindParenthesis(const uint8_t* begin, const uint8_t* end) {
+#ifdef FX_SSE2_BASELINE
+  begin = FindFirstMatch(begin, end, [](__m128i bytes) {
+    return _mm_or_si128(IsByte(bytes, '('), IsByte(bytes, ')'));
+  });
+#endif
+  while (begin < end && *begin != '(' && *begin != ')')
+    ++begin;
+  return begin;
+}
+
+const uint8_t* PDFFindRebuildCandidate(const uint8_t* begin,
+                                       const uint8_t* end) {
+#ifdef FX_SSE2_BASELINE
+  begin = FindFirstMatch(begin, end, [](__m128i bytes) {
+    // Whitespace is NUL, TAB, LF, FF, CR, SPACE, 0x80 and 0xFF. Flipping the
+    // top bit turns the unsigned digit range into a signed one.
+    __m128i flipped = _mm_xor_si128(bytes, _mm_set1_epi8(-128));
+    __m128i digit =
+        _mm_and_si128(_mm_cmpgt_epi8(flipped, _mm_set1_epi8('0' - 1 - 128)),
+                      _mm_cmplt_epi8(flipped, _mm_set1_epi8('9' + 1 - 128)));
+    __m128i space = _mm_or_si128(
+        _mm_or_si128(IsByte(bytes, 0), IsByte(bytes, '\t')),
+        _mm_or_si128(IsByte(bytes, '\n'), IsByte(bytes, '\f')));
+    space = _mm_or_si128(
+        space, _mm_or_si128(IsByte(bytes, '\r'), IsByte(bytes, ' ')));
+    space = _mm_or_si128(space, _mm_or_si128(IsByte(bytes, '\x80'),
+                                             IsByte(bytes, '\xff')));
+    __m128i other = _mm_or_si128(
+        _mm_or_si128(IsByte(bytes, '%'), IsByte(bytes, '(')),
+        _mm_or_si128(IsByte(bytes, '<'), IsByte(bytes, '\\')));
+    other = _mm_or_si128(other, IsByte(bytes, 't'));
+    return _mm_or_si128(_mm_or_si128(digit, space), other);
+  });
+#endif
+  while (begin < end && !IsRebuildCandidate(*begin))
+    ++begin;
+  return begin;
+}
@@ -33,6 +33,21 @@ inline bool PDFCharIsLineEnding(uint8_t c) {
   return c == '\r' || c == '\n';
 }
 
+// Scanners for long runs of bytes that the parsers pass over. Each returns
+// the first byte in [begin, end) that ends the run, or |end| if none does.
+
+// Stops at CR or LF.
+const uint8_t* PDFFindLineEnding(const uint8_t* begin, const uint8_t* end);
+
+// Stops at '(' or ')'.
+const uint8_t* PDFFindParenthesis(const uint8_t* begin, const uint8_t* end);
+
+// Stops at whitespace, a decimal digit, '%', '(', '<', '\\' or 't': the bytes
+// that can start a comment, string, object header or trailer while rebuilding
+// the cross reference table of a damaged file.
+const uint8_t* PDFFindRebuildCandidate(const uint8_t* begin,
+                                       const uint8_t* end);
+
 int32_t GetHeaderOffset(IFX_FileRead* pFile);
 int32_t GetDirectInteger(CPDF_Dictionary* pDict, const CFX_ByteString& key);
 
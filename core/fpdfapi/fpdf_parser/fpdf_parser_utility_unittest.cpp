@@ -0,0 +1,52 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/fpdf_parser/fpdf_parser_utility.h"
+
+#include <ctype.h>
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+using Scanner = const uint8_t* (*)(const uint8_t*, const uint8_t*);
+
+// Places every byte value at every position of a buffer that is otherwise
+// passed over, and checks that |scanner| stops exactly where |stops| says.
+void CheckScanner(Scanner scanner, bool (*stops)(uint8_t)) {
+  std::vector<uint8_t> buf(45, 'a');
+  for (int c = 0; c < 256; ++c) {
+    for (size_t begin = 0; begin < 3; ++begin) {
+      for (size_t pos = begin; pos < buf.size(); ++pos) {
+        buf[pos] = c;
+        const uint8_t* end = buf.data() + buf.size();
+        const uint8_t* expected = stops(c) ? buf.data() + pos : end;
+        EXPECT_EQ(expected, scanner(buf.data() + begin, end))
+            << "byte " << c << " at " << pos << " from " << begin;
+        buf[pos] = 'a';
+      }
+    }
+  }
+  EXPECT_EQ(buf.data(), scanner(buf.data(), buf.data()));
+}
+
+}  // namespace
+
+TEST(fpdf_parser_utility, FindLineEnding) {
+  CheckScanner(PDFFindLineEnding, PDFCharIsLineEnding);
+}
+
+TEST(fpdf_parser_utility, FindParenthesis) {
+  CheckScanner(PDFFindParenthesis,
+               [](uint8_t c) { return c == '(' || c == ')'; });
+}
+
+TEST(fpdf_parser_utility, FindRebuildCandidate) {
+  CheckScanner(PDFFindRebuildCandidate, [](uint8_t c) {
+    return PDFCharIsWhitespace(c) || isdigit(c) || c == '%' || c == '(' ||
+           c == '<' || c == '\\' || c == 't';
+  });
+}
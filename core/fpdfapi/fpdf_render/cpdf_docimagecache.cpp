@@ -0,0 +1,146 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#include "core/fpdfapi/fpdf_render/cpdf_docimagecache.h"
+
+#include <utility>
+
+#include "core/fpdfapi/fpdf_parser/cpdf_stream.h"
+#include "core/fpdfapi/fpdf_render/render_int.h"
+
+namespace {
+
+// Matches the default of CPDF_RenderOptions::m_dwLimitCacheSize.
+const size_t kDefaultLimit = 100 * 1024 * 1024;
+
+}  // namespace
+
+bool CPDF_DocImageCache::Key::operator<(const Key& that) const {
+  if (objnum != that.objnum)
+    return objnum < that.objnum;
+  if (bStdCS != that.bStdCS)
+    return bStdCS < that.bStdCS;
+  if (GroupFamily != that.GroupFamily)
+    return GroupFamily < that.GroupFamily;
+  if (bLoadMask != that.bLoadMask)
+    return bLoadMask < that.bLoadMask;
+  return nDownScale < that.nDownScale;
+}
+
+CPDF_DocImageCache::CPDF_DocImageCache(CPDF_Document* pDoc)
+    : m_pDocument(pDoc),
+      m_nLimit(kDefaultLimit),
+      m_nSize(0),
+      m_nHits(0),
+      m_nMisses(0),
+      m_nActiveRenders(0) {}
+
+CPDF_DocImageCache::~CPDF_DocImageCache() {}
+
+CPDF_ImageCacheEntry* CPDF_DocImageCache::Find(CPDF_Stream* pStream,
+                                               FX_BOOL bStdCS,
+                                               uint32_t GroupFamily,
+                                               FX_BOOL bLoadMask,
+                                               int nDownScale) {
+  // Down scales are powers of two; try the requested one first.
+  for (; nDownScale >= 1; nDownScale /= 2) {
+    Key key = {pStream->GetObjNum(), bStdCS, GroupFamily, bLoadMask,
+               nDownScale};
+    auto it = m_Entries.find(key);
+    // Entries for failed loads get replaced by Add().
+    if (it == m_Entries.end() || !it->second.pEntry->HasCachedBitmap())
+      continue;
+
+    ASSERT(it->second.pEntry->GetStream() == pStream);
+
+    m_LruList.splice(m_LruList.begin(), m_LruList, it->second.lru);
+    m_nHits++;
+    return it->second.pEntry.get();
+  }
+  m_nMisses++;
+  return nullptr;
+}
+
+void CPDF_DocImageCache::Add(CPDF_Stream* pStream,
+                             FX_BOOL bStdCS,
+                             uint32_t GroupFamily,
+                             FX_BOOL bLoadMask,
+                             int nDownScale,
+                             std::unique_ptr<CPDF_ImageCacheEntry> pEntry) {
+  Key key = {pStream->GetObjNum(), bStdCS, GroupFamily, bLoadMask, nDownScale};
+  auto it = m_Entries.find(key);
+  if (it != m_Entries.end()) {
+    m_Retired.push_back(std::move(it->second.pEntry));
+    Remove(it);
+  }
+
+  m_LruList.push_front(key);
+  Entry& entry = m_Entries[key];
+  entry.nSize = pEntry->EstimateSize();
+  entry.pEntry = std::move(pEntry);
+  entry.lru = m_LruList.begin();
+  m_nSize += entry.nSize;
+  Trim();
+}
+
+void CPDF_DocImageCache::ResetBitmap(CPDF_Stream* pStream,
+                                     const CFX_DIBitmap* pBitmap) {
+  RemoveObject(pStream->GetObjNum());
+  if (!pBitmap)
+    return;
+
+  std::unique_ptr<CPDF_ImageCacheEntry> pEntry(
+      new CPDF_ImageCacheEntry(m_pDocument, pStream));
+  pEntry->Reset(pBitmap);
+  Add(pStream, FALSE, 0, FALSE, 1, std::move(pEntry));
+}
+
+void CPDF_DocImageCache::RemoveObject(uint32_t objnum) {
+  Key first = {objnum, FALSE, 0, FALSE, 0};
+  auto it = m_Entries.lower_bound(first);
+  while (it != m_Entries.end() && it->first.objnum == objnum) {
+    m_Retired.push_back(std::move(it->second.pEntry));
+    Remove(it++);
+  }
+  Trim();
+}
+
+void CPDF_DocImageCache::BeginRender() {
+  m_nActiveRenders++;
+}
+
+void CPDF_DocImageCache::EndRender() {
+  ASSERT(m_nActiveRenders > 0);
+  m_nActiveRenders--;
+  Trim();
+}
+
+void CPDF_DocImageCache::Clear() {
+  m_Entries.clear();
+  m_LruList.clear();
+  m_Retired.clear();
+  m_nSize = 0;
+}
+
+void CPDF_DocImageCache::SetLimit(size_t nLimit) {
+  m_nLimit = nLimit;
+  Trim();
+}
+
+void CPDF_DocImageCache::Remove(EntryMap::iterator it) {
+  m_nSize -= it->second.nSize;
+  m_LruList.erase(it->second.lru);
+  m_Entries.erase(it);
+}
+
+void CPDF_DocImageCache::Trim() {
+  if (m_nActiveRenders)
+    return;
+
+  m_Retired.clear();
+  while (m_nSize > m_nLimit && !m_LruList.empty())
+    Remove(m_Entries.find(m_LruList.back()));
+}
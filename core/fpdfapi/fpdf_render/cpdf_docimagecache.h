@@ -0,0 +1,109 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#ifndef CORE_FPDFAPI_FPDF_RENDER_CPDF_DOCIMAGECACHE_H_
+#define CORE_FPDFAPI_FPDF_RENDER_CPDF_DOCIMAGECACHE_H_
+
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "core/fxcrt/fx_system.h"
+
+class CFX_DIBitmap;
+class CPDF_Document;
+class CPDF_ImageCacheEntry;
+class CPDF_Stream;
+
+// Decoded image XObjects shared by all pages of a document, so that an image
+// used on many pages is only decoded once. Entries are keyed by the stream's
+// object number and the options that change how it decodes, including the
+// factor it was scaled down by while decoding. The document drops the entries
+// of an object number when the object under it is released or replaced, so a
+// lookup never needs to check which stream an entry was decoded from.
+//
+// Pages hand out raw pointers to cached bitmaps while they render, so entries
+// are only evicted once no page of the document is being rendered. At that
+// point the least recently used entries are dropped until the cache fits in
+// its byte limit.
+class CPDF_DocImageCache {
+ public:
+  explicit CPDF_DocImageCache(CPDF_Document* pDoc);
+  ~CPDF_DocImageCache();
+
+  // Returns the entry holding the decoded |pStream|, or nullptr if it has not
+  // been decoded with these options yet. An entry decoded at a finer scale
+  // than |nDownScale| serves as well. Counts a hit or a miss.
+  CPDF_ImageCacheEntry* Find(CPDF_Stream* pStream,
+                             FX_BOOL bStdCS,
+                             uint32_t GroupFamily,
+                             FX_BOOL bLoadMask,
+                             int nDownScale);
+
+  // Takes ownership of a freshly loaded |pEntry| for |pStream|. An entry
+  // already cached under the same key is replaced.
+  void Add(CPDF_Stream* pStream,
+           FX_BOOL bStdCS,
+           uint32_t GroupFamily,
+           FX_BOOL bLoadMask,
+           int nDownScale,
+           std::unique_ptr<CPDF_ImageCacheEntry> pEntry);
+
+  // Replaces the decoded images of |pStream| after its content changed.
+  void ResetBitmap(CPDF_Stream* pStream, const CFX_DIBitmap* pBitmap);
+
+  // Drops every decoded image of the object numbered |objnum|.
+  void RemoveObject(uint32_t objnum);
+
+  // Brackets the lifetime of every render context of the document.
+  void BeginRender();
+  void EndRender();
+
+  void Clear();
+
+  size_t GetLimit() const { return m_nLimit; }
+  void SetLimit(size_t nLimit);
+  size_t GetSize() const { return m_nSize; }
+  uint32_t GetHitCount() const { return m_nHits; }
+  uint32_t GetMissCount() const { return m_nMisses; }
+
+ private:
+  struct Key {
+    bool operator<(const Key& that) const;
+
+    uint32_t objnum;
+    FX_BOOL bStdCS;
+    uint32_t GroupFamily;
+    FX_BOOL bLoadMask;
+    int nDownScale;
+  };
+
+  struct Entry {
+    std::unique_ptr<CPDF_ImageCacheEntry> pEntry;
+    size_t nSize;
+    std::list<Key>::iterator lru;
+  };
+
+  using EntryMap = std::map<Key, Entry>;
+
+  void Remove(EntryMap::iterator it);
+  void Trim();
+
+  CPDF_Document* const m_pDocument;
+  EntryMap m_Entries;
+  // Most recently used first.
+  std::list<Key> m_LruList;
+  // Replaced entries whose bitmaps may still be in use by a render.
+  std::vector<std::unique_ptr<CPDF_ImageCacheEntry>> m_Retired;
+  size_t m_nLimit;
+  size_t m_nSize;
+  uint32_t m_nHits;
+  uint32_t m_nMisses;
+  int m_nActiveRenders;
+};
+
+#endif  // CORE_FPDFAPI_FPDF_RENDER_CPDF_DOCIMAGECACHE_H_
@@ -11,6 +11,7 @@
 
 #include "core/fxcrt/fx_system.h"
 
+class CPDF_DocImageCache;
 class CPDF_Stream;
 class CPDF_ImageCacheEntry;
 class CPDF_Page;
@@ -19,6 +20,9 @@ class CFX_DIBitmap;
 class CFX_DIBSource;
 class IFX_Pause;
 
+// Decoded images used by a page. Image XObjects are shared through the
+// document's CPDF_DocImageCache; only inline images, which belong to the
+// page's content, are kept here.
 class CPDF_PageRenderCache {
  public:
   explicit CPDF_PageRenderCache(CPDF_Page* pPage);
@@ -47,6 +51,8 @@ class CPDF_PageRenderCache {
     return m_pCurImageCacheEntry;
   }
 
+  // Image XObjects may be decoded at a reduced size that still covers
+  // |downsampleWidth| x |downsampleHeight| pixels.
   FX_BOOL StartGetCachedBitmap(CPDF_Stream* pStream,
                                FX_BOOL bStdCS = FALSE,
                                uint32_t GroupFamily = 0,
@@ -60,12 +66,31 @@ class CPDF_PageRenderCache {
  protected:
   friend class CPDF_Page;
 
+  // Returns the document cache for |pStream|, or nullptr if it is cached with
+  // the page.
+  CPDF_DocImageCache* GetDocImageCache(CPDF_Stream* pStream) const;
+  CPDF_ImageCacheEntry* FindEntry(CPDF_Stream* pStream,
+                                  FX_BOOL bStdCS,
+                                  uint32_t GroupFamily,
+                                  FX_BOOL bLoadMask,
+                                  int nDownScale);
+  void AddEntry(CPDF_ImageCacheEntry* pEntry,
+                FX_BOOL bStdCS,
+                uint32_t GroupFamily,
+                FX_BOOL bLoadMask,
+                int nDownScale);
+  void FinishCurImageCacheEntry(int ret);
+
   CPDF_Page* const m_pPage;
   CPDF_ImageCacheEntry* m_pCurImageCacheEntry;
   std::map<CPDF_Stream*, CPDF_ImageCacheEntry*> m_ImageCache;
   uint32_t m_nTimeCount;
   uint32_t m_nCacheSize;
   FX_BOOL m_bCurFindCache;
+  FX_BOOL m_bCurStdCS;
+  uint32_t m_CurGroupFamily;
+  FX_BOOL m_bCurLoadMask;
+  int m_nCurDownScale;
 };
 
 #endif  // CORE_FPDFAPI_FPDF_RENDER_CPDF_PAGERENDERCACHE_H_
@@ -24,6 +24,7 @@
 #include "core/fpdfapi/fpdf_parser/cpdf_array.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_dictionary.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_document.h"
+#include "core/fpdfapi/fpdf_render/cpdf_docimagecache.h"
 #include "core/fpdfapi/fpdf_render/cpdf_pagerendercache.h"
 #include "core/fpdfapi/fpdf_render/cpdf_progressiverenderer.h"
 #include "core/fpdfapi/fpdf_render/cpdf_renderoptions.h"
@@ -36,7 +37,7 @@
 #include "core/fxge/cfx_renderdevice.h"
 
 CPDF_DocRenderData::CPDF_DocRenderData(CPDF_Document* pPDFDoc)
-    : m_pPDFDoc(pPDFDoc) {}
+    : m_pPDFDoc(pPDFDoc), m_pImageCache(new CPDF_DocImageCache(pPDFDoc)) {}
 
 CPDF_DocRenderData::~CPDF_DocRenderData() {
   Clear(TRUE);
@@ -916,13 +917,19 @@ CPDF_GraphicStates* CPDF_RenderStatus::CloneObjStates(
 CPDF_RenderContext::CPDF_RenderContext(CPDF_Page* pPage)
     : m_pDocument(pPage->m_pDocument),
       m_pPageResources(pPage->m_pPageResources),
-      m_pPageCache(pPage->GetRenderCache()) {}
+      m_pPageCache(pPage->GetRenderCache()) {
+  m_pDocument->GetRenderData()->GetImageCache()->BeginRender();
+}
 
 CPDF_RenderContext::CPDF_RenderContext(CPDF_Document* pDoc,
                                        CPDF_PageRenderCache* pPageCache)
-    : m_pDocument(pDoc), m_pPageResources(nullptr), m_pPageCache(pPageCache) {}
+    : m_pDocument(pDoc), m_pPageResources(nullptr), m_pPageCache(pPageCache) {
+  m_pDocument->GetRenderData()->GetImageCache()->BeginRender();
+}
 
-CPDF_RenderContext::~CPDF_RenderContext() {}
+CPDF_RenderContext::~CPDF_RenderContext() {
+  m_pDocument->GetRenderData()->GetImageCache()->EndRender();
+}
 
 void CPDF_RenderContext::AppendLayer(CPDF_PageObjectHolder* pObjectHolder,
                                      const CFX_Matrix* pObject2Device) {
@@ -8,9 +8,51 @@
 
 #include "core/fpdfapi/fpdf_page/cpdf_page.h"
 #include "core/fpdfapi/fpdf_page/pageint.h"
+#include "core/fpdfapi/fpdf_parser/cpdf_array.h"
+#include "core/fpdfapi/fpdf_parser/cpdf_dictionary.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_document.h"
+#include "core/fpdfapi/fpdf_render/cpdf_docimagecache.h"
 #include "core/fpdfapi/fpdf_render/cpdf_rendercontext.h"
 #include "core/fpdfapi/fpdf_render/render_int.h"
+#include "core/fxcodec/codec/ccodec_jpegmodule.h"
+#include "core/fxcodec/codec/ccodec_jpxmodule.h"
+
+namespace {
+
+// Returns the factor by which image XObject |pStream| may be scaled down
+// while decoding when drawn at |downsampleWidth| x |downsampleHeight| pixels.
+// Only DCT and JPX-encoded images decode at reduced sizes.
+int GetDownScale(CPDF_Stream* pStream,
+                 int32_t downsampleWidth,
+                 int32_t downsampleHeight) {
+  CPDF_Dictionary* pDict = pStream->GetDict();
+  if (!pDict)
+    return 1;
+
+  CFX_ByteString bsDecodeType;
+  CPDF_Object* pFilter = pDict->GetDirectObjectFor("Filter");
+  if (pFilter && pFilter->IsName()) {
+    bsDecodeType = pFilter->GetString();
+  } else if (CPDF_Array* pArray = ToArray(pFilter)) {
+    if (pArray->GetCount())
+      bsDecodeType = pArray->GetStringAt(pArray->GetCount() - 1);
+  }
+  int width = pDict->GetIntegerFor("Width");
+  int height = pDict->GetIntegerFor("Height");
+  if (bsDecodeType == "DCTDecode") {
+    return CCodec_JpegModule::GetDownScale(width, height,
+                                           FXSYS_abs(downsampleWidth),
+                                           FXSYS_abs(downsampleHeight));
+  }
+  if (bsDecodeType == "JPXDecode") {
+    return CCodec_JpxModule::GetDownScale(width, height,
+                                          FXSYS_abs(downsampleWidth),
+                                          FXSYS_abs(downsampleHeight));
+  }
+  return 1;
+}
+
+}  // namespace
 
 struct CACHEINFO {
   uint32_t time;
@@ -28,7 +70,11 @@ CPDF_PageRenderCache::CPDF_PageRenderCache(CPDF_Page* pPage)
       m_pCurImageCacheEntry(nullptr),
       m_nTimeCount(0),
       m_nCacheSize(0),
-      m_bCurFindCache(FALSE) {}
+      m_bCurFindCache(FALSE),
+      m_bCurStdCS(FALSE),
+      m_CurGroupFamily(0),
+      m_bCurLoadMask(FALSE),
+      m_nCurDownScale(1) {}
 
 CPDF_PageRenderCache::~CPDF_PageRenderCache() {
   for (const auto& it : m_ImageCache)
@@ -92,12 +138,10 @@ void CPDF_PageRenderCache::GetCachedBitmap(CPDF_Stream* pStream,
                                            CPDF_RenderStatus* pRenderStatus,
                                            int32_t downsampleWidth,
                                            int32_t downsampleHeight) {
-  CPDF_ImageCacheEntry* pEntry;
-  const auto it = m_ImageCache.find(pStream);
-  FX_BOOL bFound = it != m_ImageCache.end();
-  if (bFound)
-    pEntry = it->second;
-  else
+  CPDF_ImageCacheEntry* pEntry =
+      FindEntry(pStream, bStdCS, GroupFamily, bLoadMask, 1);
+  FX_BOOL bFound = !!pEntry;
+  if (!bFound)
     pEntry = new CPDF_ImageCacheEntry(m_pPage->m_pDocument, pStream);
 
   m_nTimeCount++;
@@ -106,9 +150,8 @@ void CPDF_PageRenderCache::GetCachedBitmap(CPDF_Stream* pStream,
       GroupFamily, bLoadMask, pRenderStatus, downsampleWidth, downsampleHeight);
 
   if (!bFound)
-    m_ImageCache[pStream] = pEntry;
-
-  if (!bAlreadyCached)
+    AddEntry(pEntry, bStdCS, GroupFamily, bLoadMask, 1);
+  else if (!bAlreadyCached && !GetDocImageCache(pStream))
     m_nCacheSize += pEntry->EstimateSize();
 }
 FX_BOOL CPDF_PageRenderCache::StartGetCachedBitmap(
@@ -119,42 +162,89 @@ FX_BOOL CPDF_PageRenderCache::StartGetCachedBitmap(
     CPDF_RenderStatus* pRenderStatus,
     int32_t downsampleWidth,
     int32_t downsampleHeight) {
-  const auto it = m_ImageCache.find(pStream);
-  m_bCurFindCache = it != m_ImageCache.end();
-  if (m_bCurFindCache) {
-    m_pCurImageCacheEntry = it->second;
-  } else {
+  // Inline images are small and cached by stream alone, so they always
+  // decode at full size.
+  int nDownScale = 1;
+  if (GetDocImageCache(pStream))
+    nDownScale = GetDownScale(pStream, downsampleWidth, downsampleHeight);
+  m_pCurImageCacheEntry =
+      FindEntry(pStream, bStdCS, GroupFamily, bLoadMask, nDownScale);
+  m_bCurFindCache = !!m_pCurImageCacheEntry;
+  if (!m_bCurFindCache) {
     m_pCurImageCacheEntry =
         new CPDF_ImageCacheEntry(m_pPage->m_pDocument, pStream);
   }
+  m_bCurStdCS = bStdCS;
+  m_CurGroupFamily = GroupFamily;
+  m_bCurLoadMask = bLoadMask;
+  m_nCurDownScale = nDownScale;
   int ret = m_pCurImageCacheEntry->StartGetCachedBitmap(
       pRenderStatus->m_pFormResource, m_pPage->m_pPageResources, bStdCS,
-      GroupFamily, bLoadMask, pRenderStatus, downsampleWidth, downsampleHeight);
+      GroupFamily, bLoadMask, pRenderStatus, nDownScale);
   if (ret == 2)
     return TRUE;
 
-  m_nTimeCount++;
-  if (!m_bCurFindCache)
-    m_ImageCache[pStream] = m_pCurImageCacheEntry;
-
-  if (!ret)
-    m_nCacheSize += m_pCurImageCacheEntry->EstimateSize();
-
+  FinishCurImageCacheEntry(ret);
   return FALSE;
 }
 FX_BOOL CPDF_PageRenderCache::Continue(IFX_Pause* pPause) {
   int ret = m_pCurImageCacheEntry->Continue(pPause);
   if (ret == 2)
     return TRUE;
+  FinishCurImageCacheEntry(ret);
+  return FALSE;
+}
+void CPDF_PageRenderCache::FinishCurImageCacheEntry(int ret) {
   m_nTimeCount++;
-  if (!m_bCurFindCache)
-    m_ImageCache[m_pCurImageCacheEntry->GetStream()] = m_pCurImageCacheEntry;
-  if (!ret)
+  if (!m_bCurFindCache) {
+    AddEntry(m_pCurImageCacheEntry, m_bCurStdCS, m_CurGroupFamily,
+             m_bCurLoadMask, m_nCurDownScale);
+  } else if (!ret && !GetDocImageCache(m_pCurImageCacheEntry->GetStream())) {
     m_nCacheSize += m_pCurImageCacheEntry->EstimateSize();
-  return FALSE;
+  }
+}
+CPDF_DocImageCache* CPDF_PageRenderCache::GetDocImageCache(
+    CPDF_Stream* pStream) const {
+  // Inline images have no object number and go away with the page.
+  if (!pStream->GetObjNum())
+    return nullptr;
+  return m_pPage->m_pDocument->GetRenderData()->GetImageCache();
+}
+CPDF_ImageCacheEntry* CPDF_PageRenderCache::FindEntry(CPDF_Stream* pStream,
+                                                      FX_BOOL bStdCS,
+                                                      uint32_t GroupFamily,
+                                                      FX_BOOL bLoadMask,
+                                                      int nDownScale) {
+  CPDF_DocImageCache* pDocCache = GetDocImageCache(pStream);
+  if (pDocCache)
+    return pDocCache->Find(pStream, bStdCS, GroupFamily, bLoadMask, nDownScale);
+
+  const auto it = m_ImageCache.find(pStream);
+  return it != m_ImageCache.end() ? it->second : nullptr;
+}
+void CPDF_PageRenderCache::AddEntry(CPDF_ImageCacheEntry* pEntry,
+                                    FX_BOOL bStdCS,
+                                    uint32_t GroupFamily,
+                                    FX_BOOL bLoadMask,
+                                    int nDownScale) {
+  CPDF_Stream* pStream = pEntry->GetStream();
+  CPDF_DocImageCache* pDocCache = GetDocImageCache(pStream);
+  if (pDocCache) {
+    pDocCache->Add(pStream, bStdCS, GroupFamily, bLoadMask, nDownScale,
+                   WrapUnique(pEntry));
+    return;
+  }
+  m_ImageCache[pStream] = pEntry;
+  m_nCacheSize += pEntry->EstimateSize();
 }
 void CPDF_PageRenderCache::ResetBitmap(CPDF_Stream* pStream,
                                        const CFX_DIBitmap* pBitmap) {
+  CPDF_DocImageCache* pDocCache = GetDocImageCache(pStream);
+  if (pDocCache) {
+    pDocCache->ResetBitmap(pStream, pBitmap);
+    return;
+  }
+
   CPDF_ImageCacheEntry* pEntry;
   const auto it = m_ImageCache.find(pStream);
   if (it == m_ImageCache.end()) {
@@ -264,8 +354,7 @@ int CPDF_ImageCacheEntry::StartGetCachedBitmap(CPDF_Dictionary* pFormResources,
                                                uint32_t GroupFamily,
                                                FX_BOOL bLoadMask,
                                                CPDF_RenderStatus* pRenderStatus,
-                                               int32_t downsampleWidth,
-                                               int32_t downsampleHeight) {
+                                               int nDownScale) {
   if (m_pCachedBitmap) {
     m_pCurBitmap = m_pCachedBitmap;
     m_pCurMask = m_pCachedMask;
@@ -279,7 +368,8 @@ int CPDF_ImageCacheEntry::StartGetCachedBitmap(CPDF_Dictionary* pFormResources,
   int ret =
       ((CPDF_DIBSource*)m_pCurBitmap)
           ->StartLoadDIBSource(m_pDocument, m_pStream, TRUE, pFormResources,
-                               pPageResources, bStdCS, GroupFamily, bLoadMask);
+                               pPageResources, bStdCS, GroupFamily, bLoadMask,
+                               nDownScale);
   if (ret == 2) {
     return ret;
   }
@@ -369,8 +369,10 @@ FX_BOOL CPDF_ImageRenderer::StartLoadDIBSource() {
   if (!image_rect.Valid())
     return FALSE;
 
-  int dest_width = image_rect.Width();
-  int dest_height = image_rect.Height();
+  // The image may be decoded at a reduced size, as long as it still covers
+  // the device pixels along each of its own axes.
+  int dest_width = FXSYS_round(FXSYS_ceil(m_ImageMatrix.GetXUnit()));
+  int dest_height = FXSYS_round(FXSYS_ceil(m_ImageMatrix.GetYUnit()));
   if (m_ImageMatrix.a < 0) {
     dest_width = -dest_width;
   }
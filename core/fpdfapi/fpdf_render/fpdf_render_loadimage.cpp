@@ -114,7 +114,10 @@ CPDF_DIBSource::CPDF_DIBSource()
       m_pMaskedLine(nullptr),
       m_pMask(nullptr),
       m_pMaskStream(nullptr),
-      m_Status(0) {}
+      m_Status(0),
+      m_nDownScale(1),
+      m_SrcWidth(0),
+      m_SrcHeight(0) {}
 
 CPDF_DIBSource::~CPDF_DIBSource() {
   FX_Free(m_pMaskedLine);
@@ -161,6 +164,8 @@ FX_BOOL CPDF_DIBSource::Load(CPDF_Document* pDoc,
       m_Height > kMaxImageDimension) {
     return FALSE;
   }
+  m_SrcWidth = m_Width;
+  m_SrcHeight = m_Height;
   m_GroupFamily = GroupFamily;
   m_bLoadMask = bLoadMask;
   if (!LoadColorInfo(m_pStream->GetObjNum() != 0 ? nullptr : pFormResources,
@@ -268,7 +273,8 @@ int CPDF_DIBSource::StartLoadDIBSource(CPDF_Document* pDoc,
                                        CPDF_Dictionary* pPageResources,
                                        FX_BOOL bStdCS,
                                        uint32_t GroupFamily,
-                                       FX_BOOL bLoadMask) {
+                                       FX_BOOL bLoadMask,
+                                       int nDownScale) {
   if (!pStream) {
     return 0;
   }
@@ -277,12 +283,15 @@ int CPDF_DIBSource::StartLoadDIBSource(CPDF_Document* pDoc,
   m_pStream = pStream;
   m_bStdCS = bStdCS;
   m_bHasMask = bHasMask;
+  m_nDownScale = nDownScale;
   m_Width = m_pDict->GetIntegerFor("Width");
   m_Height = m_pDict->GetIntegerFor("Height");
   if (m_Width <= 0 || m_Height <= 0 || m_Width > kMaxImageDimension ||
       m_Height > kMaxImageDimension) {
     return 0;
   }
+  m_SrcWidth = m_Width;
+  m_SrcHeight = m_Height;
   m_GroupFamily = GroupFamily;
   m_bLoadMask = bLoadMask;
   if (!LoadColorInfo(m_pStream->GetObjNum() != 0 ? nullptr : pFormResources,
@@ -551,7 +560,8 @@ int CPDF_DIBSource::CreateDecoder() {
   } else if (decoder == "DCTDecode") {
     m_pDecoder.reset(CPDF_ModuleMgr::Get()->GetJpegModule()->CreateDecoder(
         src_data, src_size, m_Width, m_Height, m_nComponents,
-        pParams ? pParams->GetIntegerFor("ColorTransform", 1) : 1));
+        pParams ? pParams->GetIntegerFor("ColorTransform", 1) : 1,
+        m_nDownScale));
     if (!m_pDecoder) {
       bool bTransform = false;
       int comps;
@@ -559,6 +569,8 @@ int CPDF_DIBSource::CreateDecoder() {
       CCodec_JpegModule* pJpegModule = CPDF_ModuleMgr::Get()->GetJpegModule();
       if (pJpegModule->LoadInfo(src_data, src_size, &m_Width, &m_Height, &comps,
                                 &bpc, &bTransform)) {
+        m_SrcWidth = m_Width;
+        m_SrcHeight = m_Height;
         if (m_nComponents != static_cast<uint32_t>(comps)) {
           FX_Free(m_pCompData);
           m_pCompData = nullptr;
@@ -575,9 +587,16 @@ int CPDF_DIBSource::CreateDecoder() {
         }
         m_bpc = bpc;
         m_pDecoder.reset(CPDF_ModuleMgr::Get()->GetJpegModule()->CreateDecoder(
-            src_data, src_size, m_Width, m_Height, m_nComponents, bTransform));
+            src_data, src_size, m_Width, m_Height, m_nComponents, bTransform,
+            m_nDownScale));
       }
     }
+    // A decoder narrower than the image has been scaled down, and the rest of
+    // the image is read at its size.
+    if (m_pDecoder && m_pDecoder->GetWidth() < m_Width) {
+      m_Width = m_pDecoder->GetWidth();
+      m_Height = m_pDecoder->GetHeight();
+    }
   } else if (decoder == "FlateDecode") {
     m_pDecoder.reset(FPDFAPI_CreateFlateDecoder(
         src_data, src_size, m_Width, m_Height, m_nComponents, m_bpc, pParams));
@@ -624,7 +643,8 @@ void CPDF_DIBSource::LoadJpxBitmap() {
 
   std::unique_ptr<JpxBitMapContext> context(new JpxBitMapContext(pJpxModule));
   context->set_decoder(pJpxModule->CreateDecoder(
-      m_pStreamAcc->GetData(), m_pStreamAcc->GetSize(), m_pColorSpace));
+      m_pStreamAcc->GetData(), m_pStreamAcc->GetSize(), m_pColorSpace,
+      m_nDownScale));
   if (!context->decoder())
     return;
 
@@ -632,6 +652,12 @@ void CPDF_DIBSource::LoadJpxBitmap() {
   uint32_t height = 0;
   uint32_t components = 0;
   pJpxModule->GetImageInfo(context->decoder(), &width, &height, &components);
+  // A decoder that skipped resolution levels is narrower than the image, and
+  // the rest of the image is read at its size.
+  if (m_nDownScale > 1 && static_cast<int>(width) < m_Width) {
+    m_Width = width;
+    m_Height = height;
+  }
   if (static_cast<int>(width) < m_Width || static_cast<int>(height) < m_Height)
     return;
 
@@ -953,8 +979,8 @@ void CPDF_DIBSource::TranslateScanline24bpp(uint8_t* dest_scan,
     }
     if (m_bpc == 8) {
       if (m_nComponents == m_pColorSpace->CountComponents())
-        m_pColorSpace->TranslateImageLine(dest_scan, src_scan, m_Width, m_Width,
-                                          m_Height, TransMask());
+        m_pColorSpace->TranslateImageLine(dest_scan, src_scan, m_Width,
+                                          m_SrcWidth, m_SrcHeight, TransMask());
       return;
     }
   }
@@ -2,11 +2,29 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <stdlib.h>
+
 #include "testing/embedder_test.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 class FPDFRenderLoadImageEmbeddertest : public EmbedderTest {};
 
+namespace {
+
+// Checks the pixel at |x|, |y| of |bitmap| against the 0xRRGGBB |color|,
+// allowing for JPEG artifacts.
+void ExpectColor(FPDF_BITMAP bitmap, int x, int y, uint32_t color) {
+  const uint8_t* pixel =
+      static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap)) +
+      y * FPDFBitmap_GetStride(bitmap) + x * 4;
+  for (int i = 0; i < 3; ++i) {
+    int expected = (color >> (i * 8)) & 0xff;
+    EXPECT_GE(16, abs(expected - pixel[i])) << " at " << x << ", " << y;
+  }
+}
+
+}  // namespace
+
 TEST_F(FPDFRenderLoadImageEmbeddertest, Bug_554151) {
   // Test scanline downsampling with a BitsPerComponent of 4.
   // Should not crash.
@@ -37,3 +55,81 @@ TEST_F(FPDFRenderLoadImageEmbeddertest, Bug_603518) {
   FPDFBitmap_Destroy(bitmap);
   UnloadPage(page);
 }
+
+TEST_F(FPDFRenderLoadImageEmbeddertest, DownScaledJpeg) {
+  // A 512x512 JPEG with red, green, blue and white quadrants, drawn 50 points
+  // wide.
+  EXPECT_TRUE(OpenDocument("jpeg_image.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_NE(nullptr, page);
+
+  // At 50 pixels, the image decodes at an eighth of its size.
+  FPDF_BITMAP bitmap = RenderPage(page);
+  ExpectColor(bitmap, 87, 87, 0xff0000);
+  ExpectColor(bitmap, 112, 87, 0x00ff00);
+  ExpectColor(bitmap, 87, 112, 0x0000ff);
+  ExpectColor(bitmap, 112, 112, 0xffffff);
+  FPDFBitmap_Destroy(bitmap);
+  unsigned long hits = 0;
+  unsigned long misses = 0;
+  unsigned long size = 0;
+  EXPECT_TRUE(FPDF_GetImageCacheStats(document(), &hits, &misses, &size));
+  EXPECT_EQ(0u, hits);
+  EXPECT_EQ(1u, misses);
+  EXPECT_EQ(64u * 64u * 3u, size);
+
+  // At 200 pixels it decodes at half size, and gets cached separately.
+  bitmap = FPDFBitmap_Create(800, 800, 0);
+  FPDFBitmap_FillRect(bitmap, 0, 0, 800, 800, 0xFFFFFFFF);
+  FPDF_RenderPageBitmap(bitmap, page, 0, 0, 800, 800, 0, 0);
+  ExpectColor(bitmap, 310, 310, 0xff0000);
+  ExpectColor(bitmap, 490, 490, 0xffffff);
+  FPDFBitmap_Destroy(bitmap);
+  EXPECT_TRUE(FPDF_GetImageCacheStats(document(), &hits, &misses, &size));
+  EXPECT_EQ(0u, hits);
+  EXPECT_EQ(2u, misses);
+  EXPECT_EQ(64u * 64u * 3u + 256u * 256u * 3u, size);
+
+  // Either decoded size serves the small view.
+  bitmap = RenderPage(page);
+  FPDFBitmap_Destroy(bitmap);
+  EXPECT_TRUE(FPDF_GetImageCacheStats(document(), &hits, &misses, &size));
+  EXPECT_EQ(1u, hits);
+  EXPECT_EQ(2u, misses);
+  UnloadPage(page);
+}
+
+TEST_F(FPDFRenderLoadImageEmbeddertest, DownScaledJpx) {
+  // The same image as a JPX codestream with three resolution levels.
+  EXPECT_TRUE(OpenDocument("jpx_image.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_NE(nullptr, page);
+
+  // At 50 pixels, an eighth of the size would do, but only two levels can be
+  // skipped.
+  FPDF_BITMAP bitmap = RenderPage(page);
+  ExpectColor(bitmap, 87, 87, 0xff0000);
+  ExpectColor(bitmap, 112, 87, 0x00ff00);
+  ExpectColor(bitmap, 87, 112, 0x0000ff);
+  ExpectColor(bitmap, 112, 112, 0xffffff);
+  FPDFBitmap_Destroy(bitmap);
+  unsigned long hits = 0;
+  unsigned long misses = 0;
+  unsigned long size = 0;
+  EXPECT_TRUE(FPDF_GetImageCacheStats(document(), &hits, &misses, &size));
+  EXPECT_EQ(0u, hits);
+  EXPECT_EQ(1u, misses);
+  EXPECT_EQ(128u * 128u * 3u, size);
+
+  bitmap = FPDFBitmap_Create(800, 800, 0);
+  FPDFBitmap_FillRect(bitmap, 0, 0, 800, 800, 0xFFFFFFFF);
+  FPDF_RenderPageBitmap(bitmap, page, 0, 0, 800, 800, 0, 0);
+  ExpectColor(bitmap, 310, 310, 0xff0000);
+  ExpectColor(bitmap, 490, 490, 0xffffff);
+  FPDFBitmap_Destroy(bitmap);
+  EXPECT_TRUE(FPDF_GetImageCacheStats(document(), &hits, &misses, &size));
+  EXPECT_EQ(0u, hits);
+  EXPECT_EQ(2u, misses);
+  EXPECT_EQ(128u * 128u * 3u + 256u * 256u * 3u, size);
+  UnloadPage(page);
+}
@@ -7,6 +7,7 @@
 #include "core/fpdfapi/fpdf_render/render_int.h"
 
 #include <algorithm>
+#include <vector>
 
 #include "core/fpdfapi/fpdf_page/cpdf_form.h"
 #include "core/fpdfapi/fpdf_page/cpdf_graphicstates.h"
@@ -38,6 +39,34 @@ uint32_t CountOutputs(
   return total;
 }
 
+// Evaluates |funcs| at |count| points of |nInputs| values each, and stores
+// the outputs of the functions one after another at |results| +
+// i * |nResults| for the i-th point. Functions that do not take |nInputs|
+// values are skipped.
+void CallFunctions(const std::vector<std::unique_ptr<CPDF_Function>>& funcs,
+                   const FX_FLOAT* inputs,
+                   uint32_t nInputs,
+                   size_t count,
+                   FX_FLOAT* results,
+                   uint32_t nResults) {
+  std::vector<FX_FLOAT> func_results;
+  uint32_t offset = 0;
+  for (const auto& func : funcs) {
+    if (!func || func->CountInputs() != nInputs)
+      continue;
+
+    uint32_t nOutputs = func->CountOutputs();
+    func_results.assign(count * nOutputs, 0.0f);
+    func->CallBatch(inputs, count, func_results.data());
+    for (size_t i = 0; i < count; i++) {
+      FXSYS_memcpy(results + i * nResults + offset,
+                   func_results.data() + i * nOutputs,
+                   nOutputs * sizeof(FX_FLOAT));
+    }
+    offset += nOutputs;
+  }
+}
+
 #define SHADING_STEPS 256
 void DrawAxialShading(CFX_DIBitmap* pBitmap,
                       CFX_Matrix* pObject2Bitmap,
@@ -75,22 +104,16 @@ void DrawAxialShading(CFX_DIBitmap* pBitmap,
   matrix.SetReverse(*pObject2Bitmap);
   uint32_t total_results =
       std::max(CountOutputs(funcs), pCS->CountComponents());
-  CFX_FixedBufGrow<FX_FLOAT, 16> result_array(total_results);
-  FX_FLOAT* pResults = result_array;
-  FXSYS_memset(pResults, 0, total_results * sizeof(FX_FLOAT));
+  FX_FLOAT inputs[SHADING_STEPS];
+  for (int i = 0; i < SHADING_STEPS; i++)
+    inputs[i] = (t_max - t_min) * i / SHADING_STEPS + t_min;
+  std::vector<FX_FLOAT> results(SHADING_STEPS * total_results);
+  CallFunctions(funcs, inputs, 1, SHADING_STEPS, results.data(),
+                total_results);
   uint32_t rgb_array[SHADING_STEPS];
   for (int i = 0; i < SHADING_STEPS; i++) {
-    FX_FLOAT input = (t_max - t_min) * i / SHADING_STEPS + t_min;
-    int offset = 0;
-    for (const auto& func : funcs) {
-      if (func) {
-        int nresults = 0;
-        if (func->Call(&input, 1, pResults + offset, nresults))
-          offset += nresults;
-      }
-    }
     FX_FLOAT R = 0.0f, G = 0.0f, B = 0.0f;
-    pCS->GetRGB(pResults, R, G, B);
+    pCS->GetRGB(&results[i * total_results], R, G, B);
     rgb_array[i] =
         FXARGB_TODIB(FXARGB_MAKE(alpha, FXSYS_round(R * 255),
                                  FXSYS_round(G * 255), FXSYS_round(B * 255)));
@@ -153,22 +176,16 @@ void DrawRadialShading(CFX_DIBitmap* pBitmap,
   }
   uint32_t total_results =
       std::max(CountOutputs(funcs), pCS->CountComponents());
-  CFX_FixedBufGrow<FX_FLOAT, 16> result_array(total_results);
-  FX_FLOAT* pResults = result_array;
-  FXSYS_memset(pResults, 0, total_results * sizeof(FX_FLOAT));
+  FX_FLOAT inputs[SHADING_STEPS];
+  for (int i = 0; i < SHADING_STEPS; i++)
+    inputs[i] = (t_max - t_min) * i / SHADING_STEPS + t_min;
+  std::vector<FX_FLOAT> results(SHADING_STEPS * total_results);
+  CallFunctions(funcs, inputs, 1, SHADING_STEPS, results.data(),
+                total_results);
   uint32_t rgb_array[SHADING_STEPS];
   for (int i = 0; i < SHADING_STEPS; i++) {
-    FX_FLOAT input = (t_max - t_min) * i / SHADING_STEPS + t_min;
-    int offset = 0;
-    for (const auto& func : funcs) {
-      if (func) {
-        int nresults;
-        if (func->Call(&input, 1, pResults + offset, nresults))
-          offset += nresults;
-      }
-    }
     FX_FLOAT R = 0.0f, G = 0.0f, B = 0.0f;
-    pCS->GetRGB(pResults, R, G, B);
+    pCS->GetRGB(&results[i * total_results], R, G, B);
     rgb_array[i] =
         FXARGB_TODIB(FXARGB_MAKE(alpha, FXSYS_round(R * 255),
                                  FXSYS_round(G * 255), FXSYS_round(B * 255)));
@@ -274,31 +291,34 @@ void DrawFuncShading(CFX_DIBitmap* pBitmap,
   int pitch = pBitmap->GetPitch();
   uint32_t total_results =
       std::max(CountOutputs(funcs), pCS->CountComponents());
-  CFX_FixedBufGrow<FX_FLOAT, 16> result_array(total_results);
-  FX_FLOAT* pResults = result_array;
-  FXSYS_memset(pResults, 0, total_results * sizeof(FX_FLOAT));
+  std::vector<int> columns(width);
+  std::vector<FX_FLOAT> inputs(width * 2);
+  std::vector<FX_FLOAT> results(width * total_results);
   for (int row = 0; row < height; row++) {
-    uint32_t* dib_buf = (uint32_t*)(pBitmap->GetBuffer() + row * pitch);
+    // Evaluate the functions for all the pixels of the row that are in the
+    // domain at once.
+    size_t count = 0;
     for (int column = 0; column < width; column++) {
       FX_FLOAT x = (FX_FLOAT)column, y = (FX_FLOAT)row;
       matrix.Transform(x, y);
       if (x < xmin || x > xmax || y < ymin || y > ymax) {
         continue;
       }
-      FX_FLOAT input[2];
-      int offset = 0;
-      input[0] = x;
-      input[1] = y;
-      for (const auto& func : funcs) {
-        if (func) {
-          int nresults;
-          if (func->Call(input, 2, pResults + offset, nresults))
-            offset += nresults;
-        }
-      }
+      columns[count] = column;
+      inputs[count * 2] = x;
+      inputs[count * 2 + 1] = y;
+      count++;
+    }
+    if (count == 0)
+      continue;
+
+    CallFunctions(funcs, inputs.data(), 2, count, results.data(),
+                  total_results);
+    uint32_t* dib_buf = (uint32_t*)(pBitmap->GetBuffer() + row * pitch);
+    for (size_t i = 0; i < count; i++) {
       FX_FLOAT R = 0.0f, G = 0.0f, B = 0.0f;
-      pCS->GetRGB(pResults, R, G, B);
-      dib_buf[column] = FXARGB_TODIB(FXARGB_MAKE(
+      pCS->GetRGB(&results[i * total_results], R, G, B);
+      dib_buf[columns[i]] = FXARGB_TODIB(FXARGB_MAKE(
           alpha, (int32_t)(R * 255), (int32_t)(G * 255), (int32_t)(B * 255)));
     }
   }
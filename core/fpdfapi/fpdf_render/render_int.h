@@ -26,6 +26,7 @@ class CFX_ImageTransformer;
 class CFX_PathData;
 class CPDF_Color;
 class CPDF_Dictionary;
+class CPDF_DocImageCache;
 class CPDF_Document;
 class CPDF_Font;
 class CPDF_FormObject;
@@ -73,6 +74,7 @@ class CPDF_DocRenderData {
   void Clear(FX_BOOL bRelease = FALSE);
   void ReleaseCachedType3(CPDF_Type3Font* pFont);
   void ReleaseTransferFunc(CPDF_Object* pObj);
+  CPDF_DocImageCache* GetImageCache() const { return m_pImageCache.get(); }
 
  private:
   using CPDF_Type3CacheMap =
@@ -83,6 +85,7 @@ class CPDF_DocRenderData {
   CPDF_Document* m_pPDFDoc;
   CPDF_Type3CacheMap m_Type3FaceMap;
   CPDF_TransferFuncMap m_TransferFuncMap;
+  std::unique_ptr<CPDF_DocImageCache> m_pImageCache;
 };
 
 class CPDF_RenderStatus {
@@ -415,6 +418,7 @@ class CPDF_ImageCacheEntry {
                           int32_t downsampleWidth = 0,
                           int32_t downsampleHeight = 0);
   uint32_t EstimateSize() const { return m_dwCacheSize; }
+  bool HasCachedBitmap() const { return !!m_pCachedBitmap; }
   uint32_t GetTimeCount() const { return m_dwTimeCount; }
   CPDF_Stream* GetStream() const { return m_pStream; }
   void SetTimeCount(uint32_t dwTimeCount) { m_dwTimeCount = dwTimeCount; }
@@ -427,8 +431,7 @@ class CPDF_ImageCacheEntry {
                            uint32_t GroupFamily = 0,
                            FX_BOOL bLoadMask = FALSE,
                            CPDF_RenderStatus* pRenderStatus = nullptr,
-                           int32_t downsampleWidth = 0,
-                           int32_t downsampleHeight = 0);
+                           int nDownScale = 1);
   int Continue(IFX_Pause* pPause);
   CFX_DIBSource* DetachBitmap();
   CFX_DIBSource* DetachMask();
@@ -492,7 +495,8 @@ class CPDF_DIBSource : public CFX_DIBSource {
                          CPDF_Dictionary* pPageResources,
                          FX_BOOL bStdCS = FALSE,
                          uint32_t GroupFamily = 0,
-                         FX_BOOL bLoadMask = FALSE);
+                         FX_BOOL bLoadMask = FALSE,
+                         int nDownScale = 1);
   int ContinueLoadDIBSource(IFX_Pause* pPause);
   int StratLoadMask();
   int StartLoadMaskDIB();
@@ -570,6 +574,13 @@ class CPDF_DIBSource : public CFX_DIBSource {
   std::unique_ptr<CCodec_Jbig2Context> m_pJbig2Context;
   CPDF_Stream* m_pMaskStream;
   int m_Status;
+  // Factor by which DCT and JPX-encoded images may be scaled down while
+  // decoding.
+  int m_nDownScale;
+  // Size of the image before any scaling down. Color conversion picks its
+  // method by this size, so that the colors do not depend on the zoom.
+  int m_SrcWidth;
+  int m_SrcHeight;
 };
 
 #define FPDF_HUGE_IMAGE_SIZE 60000000
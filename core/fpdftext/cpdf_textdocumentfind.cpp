@@ -0,0 +1,130 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#include "core/fpdftext/cpdf_textdocumentfind.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "core/fpdfapi/fpdf_page/cpdf_page.h"
+#include "core/fpdfapi/fpdf_parser/cpdf_array.h"
+#include "core/fpdfapi/fpdf_parser/cpdf_document.h"
+#include "core/fpdfapi/fpdf_parser/cpdf_stream.h"
+#include "core/fpdftext/cpdf_textpagefind.h"
+#include "third_party/base/stl_util.h"
+
+CPDF_TextDocumentFind::CPDF_TextDocumentFind(CPDF_Document* pDoc,
+                                             FPDFText_Direction direction,
+                                             bool bKeepText)
+    : m_pDocument(pDoc), m_Direction(direction), m_bKeepText(bKeepText) {}
+
+CPDF_TextDocumentFind::~CPDF_TextDocumentFind() {}
+
+int CPDF_TextDocumentFind::Find(const CFX_WideString& findwhat,
+                                int flags,
+                                int start_page,
+                                int page_count,
+                                Delegate* pDelegate) {
+  // An empty string would match at every position forever.
+  if (findwhat.IsEmpty())
+    return -1;
+
+  int nPages = m_pDocument->GetPageCount();
+  if (m_bKeepText && pdfium::CollectionSize<int>(m_PageTexts) < nPages)
+    m_PageTexts.resize(nPages);
+
+  start_page = std::max(start_page, 0);
+  int end_page = nPages;
+  if (page_count >= 0 && page_count < nPages - start_page)
+    end_page = start_page + page_count;
+  int nMatches = 0;
+  for (int page_index = start_page; page_index < end_page; ++page_index) {
+    CPDF_Dictionary* pPageDict = m_pDocument->GetPage(page_index);
+    std::unique_ptr<PageText> pLoadedText;
+    const PageText* pText = nullptr;
+    if (m_bKeepText && pPageDict) {
+      pText = m_PageTexts[page_index].get();
+      if (pText && (pText->m_PageObjNum != pPageDict->GetObjNum() ||
+                    pText->m_Contents != GetContentKey(pPageDict))) {
+        pText = nullptr;
+      }
+    }
+    if (!pText && pPageDict) {
+      pLoadedText = LoadPageText(pPageDict);
+      pText = pLoadedText.get();
+      if (m_bKeepText && pLoadedText)
+        m_PageTexts[page_index] = std::move(pLoadedText);
+    }
+    if (pText && !pText->m_Text.IsEmpty()) {
+      CPDF_TextPageFind find(pText->m_Text, pText->m_CharIndex);
+      // Only fails for some |findwhat|, hence on the first page searched.
+      if (!find.FindFirst(findwhat, flags))
+        return -1;
+      while (find.FindNext()) {
+        ++nMatches;
+        if (!pDelegate->OnMatch(page_index, find.GetCurOrder(),
+                                find.GetMatchedCount())) {
+          return nMatches;
+        }
+      }
+    }
+    if (!pDelegate->OnPageSearched(page_index))
+      break;
+  }
+  return nMatches;
+}
+
+int CPDF_TextDocumentFind::GetKeptPageCount() const {
+  return std::count_if(m_PageTexts.begin(), m_PageTexts.end(),
+                       [](const std::unique_ptr<PageText>& pText) {
+                         return !!pText;
+                       });
+}
+
+// static
+CPDF_TextDocumentFind::ContentKey CPDF_TextDocumentFind::GetContentKey(
+    CPDF_Dictionary* pPageDict) {
+  ContentKey key;
+  CPDF_Object* pContents = pPageDict->GetDirectObjectFor("Contents");
+  if (!pContents)
+    return key;
+
+  // Streams are edited through SetData(), which leaves them memory based, so
+  // only those can change in place. Hashing is cheap next to extracting text.
+  auto add_stream = [&key](CPDF_Stream* pStream) {
+    ContentStreamKey stream_key = {pStream->GetObjNum(), pStream->GetRawSize(),
+                                   0};
+    if (pStream->IsMemoryBased() && pStream->GetRawData()) {
+      stream_key.m_DataHash = FX_HashCode_GetA(
+          CFX_ByteStringC(pStream->GetRawData(), pStream->GetRawSize()),
+          false);
+    }
+    key.push_back(stream_key);
+  };
+  if (CPDF_Array* pArray = pContents->AsArray()) {
+    for (size_t i = 0; i < pArray->GetCount(); ++i) {
+      if (CPDF_Stream* pStream = ToStream(pArray->GetDirectObjectAt(i)))
+        add_stream(pStream);
+    }
+  } else if (CPDF_Stream* pStream = pContents->AsStream()) {
+    add_stream(pStream);
+  }
+  return key;
+}
+
+std::unique_ptr<CPDF_TextDocumentFind::PageText>
+CPDF_TextDocumentFind::LoadPageText(CPDF_Dictionary* pPageDict) const {
+  CPDF_Page page(m_pDocument, pPageDict, false);
+  page.ParseContent();
+  CPDF_TextPage text_page(&page, m_Direction);
+  text_page.ParseTextPage();
+  std::unique_ptr<PageText> pText(new PageText);
+  pText->m_PageObjNum = pPageDict->GetObjNum();
+  pText->m_Contents = GetContentKey(pPageDict);
+  pText->m_Text = text_page.GetPageText();
+  pText->m_CharIndex = text_page.GetCharIndexRanges();
+  return pText;
+}
@@ -0,0 +1,99 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#ifndef CORE_FPDFTEXT_CPDF_TEXTDOCUMENTFIND_H_
+#define CORE_FPDFTEXT_CPDF_TEXTDOCUMENTFIND_H_
+
+#include <memory>
+#include <vector>
+
+#include "core/fpdftext/cpdf_textpage.h"
+#include "core/fxcrt/fx_string.h"
+#include "core/fxcrt/fx_system.h"
+
+class CPDF_Dictionary;
+class CPDF_Document;
+
+// Searches the text of many pages of a document, one page after another on
+// the calling thread; a document cannot be used by several threads, so the
+// pages are not searched in parallel. Every page is loaded only for as long
+// as it takes to extract its text. The text can be kept with the map from
+// text to character indices, which takes a small fraction of the memory of
+// the loaded page, so that later searches do not load the page again.
+//
+// Kept text is extracted again when another page dictionary is at its index,
+// or when the page's content streams are replaced or their data changes, as
+// after FPDFPage_GenerateContent() or when pages are added or removed. Only
+// the page's own /Contents is checked. Edits to its resources, such as the
+// streams of form XObjects or a font's /ToUnicode map, leave the kept text
+// as it was.
+class CPDF_TextDocumentFind {
+ public:
+  class Delegate {
+   public:
+    virtual ~Delegate() {}
+
+    // Receives a match of |count| characters from character |start| of the
+    // text page of |page_index|. Returns false to stop the search.
+    virtual bool OnMatch(int page_index, int start, int count) = 0;
+
+    // Called after |page_index| is searched. Returns false to stop the
+    // search.
+    virtual bool OnPageSearched(int page_index) = 0;
+  };
+
+  CPDF_TextDocumentFind(CPDF_Document* pDoc,
+                        FPDFText_Direction direction,
+                        bool bKeepText);
+  ~CPDF_TextDocumentFind();
+
+  // Searches |page_count| pages from |start_page| in page order, with
+  // |flags| as for CPDF_TextPageFind::FindFirst(). Pages that cannot be
+  // loaded are skipped. Returns the number of matches passed to
+  // |pDelegate|, or -1 if |findwhat| is empty.
+  int Find(const CFX_WideString& findwhat,
+           int flags,
+           int start_page,
+           int page_count,
+           Delegate* pDelegate);
+
+  // The number of pages whose text is kept.
+  int GetKeptPageCount() const;
+
+ private:
+  // Identifies the data of a content stream.
+  struct ContentStreamKey {
+    bool operator==(const ContentStreamKey& other) const {
+      return m_ObjNum == other.m_ObjNum && m_RawSize == other.m_RawSize &&
+             m_DataHash == other.m_DataHash;
+    }
+
+    uint32_t m_ObjNum;
+    uint32_t m_RawSize;
+    // Hash of the raw data, or 0 if it is still in the file.
+    uint32_t m_DataHash;
+  };
+  using ContentKey = std::vector<ContentStreamKey>;
+
+  struct PageText {
+    // What the text was extracted from.
+    uint32_t m_PageObjNum;
+    ContentKey m_Contents;
+    CFX_WideString m_Text;
+    std::vector<uint16_t> m_CharIndex;
+  };
+
+  static ContentKey GetContentKey(CPDF_Dictionary* pPageDict);
+  std::unique_ptr<PageText> LoadPageText(CPDF_Dictionary* pPageDict) const;
+
+  CPDF_Document* const m_pDocument;
+  const FPDFText_Direction m_Direction;
+  const bool m_bKeepText;
+  // Indexed by page, null for pages that were not searched yet.
+  std::vector<std::unique_ptr<PageText>> m_PageTexts;
+};
+
+#endif  // CORE_FPDFTEXT_CPDF_TEXTDOCUMENTFIND_H_
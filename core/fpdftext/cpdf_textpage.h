@@ -88,6 +88,11 @@ class CPDF_TextPage {
   bool IsParsed() const { return m_bIsParsed; }
   int CharIndexFromTextIndex(int TextIndex) const;
   int TextIndexFromCharIndex(int CharIndex) const;
+  // The runs of characters that have text, as pairs of the index of the
+  // first character and the number of characters, in text order.
+  const std::vector<uint16_t>& GetCharIndexRanges() const {
+    return m_CharIndex;
+  }
   int CountChars() const;
   void GetCharInfo(int index, FPDF_CHAR_INFO* info) const;
   std::vector<CFX_FloatRect> GetRectArray(int start, int nCount) const;
@@ -34,7 +34,10 @@ FX_BOOL IsIgnoreSpaceCharacter(FX_WCHAR curChar) {
 }  // namespace
 
 CPDF_TextPageFind::CPDF_TextPageFind(const CPDF_TextPage* pTextPage)
-    : m_pTextPage(pTextPage),
+    : m_CharIndex(pTextPage->GetCharIndexRanges()),
+      m_pTextPage(pTextPage),
+      m_strPageText(pTextPage->GetPageText()),
+      m_strText(m_strPageText),
       m_flags(0),
       m_findNextStart(-1),
       m_findPreStart(-1),
@@ -42,52 +45,42 @@ CPDF_TextPageFind::CPDF_TextPageFind(const CPDF_TextPage* pTextPage)
       m_bMatchWholeWord(FALSE),
       m_resStart(0),
       m_resEnd(-1),
-      m_IsFind(FALSE) {
-  m_strText = m_pTextPage->GetPageText();
-  int nCount = pTextPage->CountChars();
-  if (nCount)
-    m_CharIndex.push_back(0);
-  for (int i = 0; i < nCount; i++) {
-    FPDF_CHAR_INFO info;
-    pTextPage->GetCharInfo(i, &info);
-    int indexSize = pdfium::CollectionSize<int>(m_CharIndex);
-    if (info.m_Flag == FPDFTEXT_CHAR_NORMAL ||
-        info.m_Flag == FPDFTEXT_CHAR_GENERATED) {
-      if (indexSize % 2) {
-        m_CharIndex.push_back(1);
-      } else {
-        if (indexSize <= 0)
-          continue;
-        m_CharIndex[indexSize - 1] += 1;
-      }
-    } else {
-      if (indexSize % 2) {
-        if (indexSize <= 0)
-          continue;
-        m_CharIndex[indexSize - 1] = i + 1;
-      } else {
-        m_CharIndex.push_back(i + 1);
-      }
-    }
-  }
-  int indexSize = pdfium::CollectionSize<int>(m_CharIndex);
-  if (indexSize % 2)
-    m_CharIndex.erase(m_CharIndex.begin() + indexSize - 1);
-}
+      m_IsFind(FALSE) {}
+
+CPDF_TextPageFind::CPDF_TextPageFind(const CFX_WideString& strPageText,
+                                     const std::vector<uint16_t>& charIndex)
+    : m_CharIndex(charIndex),
+      m_pTextPage(nullptr),
+      m_strPageText(strPageText),
+      m_strText(m_strPageText),
+      m_flags(0),
+      m_findNextStart(-1),
+      m_findPreStart(-1),
+      m_bMatchCase(FALSE),
+      m_bMatchWholeWord(FALSE),
+      m_resStart(0),
+      m_resEnd(-1),
+      m_IsFind(FALSE) {}
 
 CPDF_TextPageFind::~CPDF_TextPageFind() {}
 
 int CPDF_TextPageFind::GetCharIndex(int index) const {
-  return m_pTextPage->CharIndexFromTextIndex(index);
+  // Same as CPDF_TextPage::CharIndexFromTextIndex(), which may be gone.
+  int indexSize = pdfium::CollectionSize<int>(m_CharIndex);
+  int count = 0;
+  for (int i = 0; i < indexSize; i += 2) {
+    count += m_CharIndex[i + 1];
+    if (count > index)
+      return index - count + m_CharIndex[i + 1] + m_CharIndex[i];
+  }
+  return -1;
 }
 
 FX_BOOL CPDF_TextPageFind::FindFirst(const CFX_WideString& findwhat,
                                      int flags,
                                      int startPos) {
-  if (!m_pTextPage)
-    return FALSE;
   if (m_strText.IsEmpty() || m_bMatchCase != (flags & FPDFTEXT_MATCHCASE))
-    m_strText = m_pTextPage->GetPageText();
+    m_strText = m_strPageText;
   CFX_WideString findwhatStr = findwhat;
   m_findWhat = findwhatStr;
   m_flags = flags;
@@ -127,8 +120,6 @@ FX_BOOL CPDF_TextPageFind::FindFirst(const CFX_WideString& findwhat,
 }
 
 FX_BOOL CPDF_TextPageFind::FindNext() {
-  if (!m_pTextPage)
-    return FALSE;
   m_resArray.clear();
   if (m_findNextStart == -1)
     return FALSE;
@@ -216,9 +207,11 @@ FX_BOOL CPDF_TextPageFind::FindNext() {
   }
   m_resEnd = nResultPos + m_csFindWhatArray.back().GetLength() - 1;
   m_IsFind = TRUE;
-  int resStart = GetCharIndex(m_resStart);
-  int resEnd = GetCharIndex(m_resEnd);
-  m_resArray = m_pTextPage->GetRectArray(resStart, resEnd - resStart + 1);
+  if (m_pTextPage) {
+    int resStart = GetCharIndex(m_resStart);
+    int resEnd = GetCharIndex(m_resEnd);
+    m_resArray = m_pTextPage->GetRectArray(resStart, resEnd - resStart + 1);
+  }
   if (m_flags & FPDFTEXT_CONSECUTIVE) {
     m_findNextStart = m_resStart + 1;
     m_findPreStart = m_resEnd - 1;
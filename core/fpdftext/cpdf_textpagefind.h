@@ -18,6 +18,11 @@ class CPDF_TextPage;
 class CPDF_TextPageFind {
  public:
   explicit CPDF_TextPageFind(const CPDF_TextPage* pTextPage);
+  // Searches the text of a page that is no longer loaded, as returned by
+  // CPDF_TextPage::GetPageText() and GetCharIndexRanges(). FindPrev() needs
+  // the text page and always fails.
+  CPDF_TextPageFind(const CFX_WideString& strPageText,
+                    const std::vector<uint16_t>& charIndex);
   ~CPDF_TextPageFind();
 
   FX_BOOL FindFirst(const CFX_WideString& findwhat,
@@ -43,6 +48,8 @@ class CPDF_TextPageFind {
  private:
   std::vector<uint16_t> m_CharIndex;
   const CPDF_TextPage* m_pTextPage;
+  const CFX_WideString m_strPageText;
+  // |m_strPageText| in lower case unless matching case.
   CFX_WideString m_strText;
   CFX_WideString m_findWhat;
   int m_flags;
@@ -13,6 +13,9 @@
 
 class CCodec_IccModule {
  public:
+  // Number of colors in the grid of TranslateScanlineByGrid().
+  static const int kGridPoints = 16 * 16 * 16 * 16;
+
   CCodec_IccModule();
   ~CCodec_IccModule();
 
@@ -27,6 +30,23 @@ class CCodec_IccModule {
                          uint8_t* pDest,
                          const uint8_t* pSrc,
                          int pixels);
+
+  // Same as TranslateScanline() for transforms from 4 components to RGB, but
+  // interpolates between the colors at the points of a grid that is built
+  // with the first call. Conversion is several times faster, which pays for
+  // the grid once the transform converts more than kGridPoints pixels.
+  // Other transforms fall back to TranslateScanline().
+  //
+  // Results match TranslateScanline() exactly where every component is a
+  // multiple of 17, and otherwise differ by the error of interpolating across
+  // 17 levels. For a press-like CMYK profile, about 98% of the values are
+  // within 1 level and 99.5% within 3. Where the exact transform clips to the
+  // sRGB gamut inside a grid cell, interpolation cuts the corner, and a value
+  // can be off by up to 15 levels.
+  void TranslateScanlineByGrid(void* pTransform,
+                               uint8_t* pDest,
+                               const uint8_t* pSrc,
+                               int pixels);
   void SetComponents(uint32_t nComponents) { m_nComponents = nComponents; }
 
  protected:
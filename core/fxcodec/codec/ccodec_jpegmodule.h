@@ -21,12 +21,24 @@ class CCodec_JpegModule {
  public:
   CCodec_JpegModule() {}
 
+  // Returns the largest factor libjpeg can shrink a |width| x |height| image
+  // by while decoding, such that the result still covers |dest_width| x
+  // |dest_height| pixels. That is 1, 2, 4 or 8.
+  static int GetDownScale(int width,
+                          int height,
+                          int dest_width,
+                          int dest_height);
+
+  // A |down_scale| other than 1 makes the decoder produce an image that many
+  // times smaller in each direction, rounded up, if the image has the given
+  // |width| and |height|.
   CCodec_ScanlineDecoder* CreateDecoder(const uint8_t* src_buf,
                                         uint32_t src_size,
                                         int width,
                                         int height,
                                         int nComps,
-                                        FX_BOOL ColorTransform);
+                                        FX_BOOL ColorTransform,
+                                        int down_scale);
   bool LoadInfo(const uint8_t* src_buf,
                 uint32_t src_size,
                 int* width,
@@ -19,9 +19,21 @@ class CCodec_JpxModule {
   CCodec_JpxModule();
   ~CCodec_JpxModule();
 
+  // Returns the largest power of two a |width| x |height| image can shrink by
+  // while decoding, such that the result still covers |dest_width| x
+  // |dest_height| pixels.
+  static int GetDownScale(int width,
+                          int height,
+                          int dest_width,
+                          int dest_height);
+
+  // A |down_scale| other than 1 skips the finest wavelet resolution levels,
+  // making the image up to that many times smaller in each direction,
+  // rounded up. GetImageInfo() returns the decoded size.
   CJPX_Decoder* CreateDecoder(const uint8_t* src_buf,
                               uint32_t src_size,
-                              CPDF_ColorSpace* cs);
+                              CPDF_ColorSpace* cs,
+                              int down_scale);
   void GetImageInfo(CJPX_Decoder* pDecoder,
                     uint32_t* width,
                     uint32_t* height,
@@ -8,9 +8,12 @@
 
 #include <algorithm>
 #include <memory>
+#include <vector>
 
 #include "core/fxcodec/fx_codec.h"
+#include "core/fxcrt/fx_cpu.h"
 #include "core/fxcrt/fx_ext.h"
+#include "core/fxcrt/fx_safe_types.h"
 #include "third_party/zlib_v128/zlib.h"
 
 extern "C" {
@@ -275,6 +278,162 @@ void PNG_PredictorEncode(uint8_t** data_buf, uint32_t* data_size) {
                (last_row_size > 0 ? (row_size - last_row_size) : 0);
 }
 
+// The SSE2 code below is inlined into the scalar loops, so it is only built
+// where every CPU has SSE2.
+#ifdef FX_SSE2_BASELINE
+
+__m128i Load4Bytes(const uint8_t* p) {
+  int32_t v;
+  FXSYS_memcpy(&v, p, sizeof(v));
+  return _mm_cvtsi32_si128(v);
+}
+
+void StorePixel(uint8_t* p, __m128i pixel, int bpp) {
+  int32_t v = _mm_cvtsi128_si32(pixel);
+  FXSYS_memcpy(p, &v, bpp);
+}
+
+__m128i IfThenElse(__m128i cond, __m128i t, __m128i e) {
+  return _mm_or_si128(_mm_and_si128(cond, t), _mm_andnot_si128(cond, e));
+}
+
+__m128i Abs16(__m128i x) {
+  return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+#endif  // FX_SSE2_BASELINE
+
+// The PNG_Unfilter* functions undo one PNG filter type over |count| bytes of
+// |raw| into |dest|, given the reconstructed row above in |up|. The first
+// |bpp| bytes of the row have no left neighbor. |dest| may lie before |raw|
+// in the same buffer: every byte of |raw| is read before the bytes of |dest|
+// at or after its position are written.
+
+void PNG_UnfilterSub(uint8_t* dest, const uint8_t* raw, int bpp, int count) {
+  int i = 0;
+  for (; i < bpp && i < count; ++i)
+    dest[i] = raw[i];
+#ifdef FX_SSE2_BASELINE
+  if ((bpp == 3 || bpp == 4) && bpp + 4 <= count) {
+    // Each pixel reads four bytes, so stop where that would pass the row.
+    __m128i a = Load4Bytes(dest);
+    for (; i + 4 <= count; i += bpp) {
+      a = _mm_add_epi8(Load4Bytes(raw + i), a);
+      StorePixel(dest + i, a, bpp);
+    }
+  }
+#endif
+  for (; i < count; ++i)
+    dest[i] = raw[i] + dest[i - bpp];
+}
+
+void PNG_UnfilterUp(uint8_t* dest,
+                    const uint8_t* raw,
+                    const uint8_t* up,
+                    int count) {
+  int i = 0;
+#ifdef FX_SSE2_BASELINE
+  for (; i + 16 <= count; i += 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + i));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(up + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_add_epi8(x, b));
+  }
+#endif
+  for (; i < count; ++i)
+    dest[i] = raw[i] + up[i];
+}
+
+void PNG_UnfilterAverage(uint8_t* dest,
+                         const uint8_t* raw,
+                         const uint8_t* up,
+                         int bpp,
+                         int count) {
+  int i = 0;
+  for (; i < bpp && i < count; ++i)
+    dest[i] = raw[i] + up[i] / 2;
+#ifdef FX_SSE2_BASELINE
+  if ((bpp == 3 || bpp == 4) && bpp + 4 <= count) {
+    const __m128i kOne = _mm_set1_epi8(1);
+    __m128i a = Load4Bytes(dest);
+    for (; i + 4 <= count; i += bpp) {
+      __m128i b = Load4Bytes(up + i);
+      // _mm_avg_epu8() rounds up; take the carry back off where it did.
+      __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+                                 _mm_and_si128(_mm_xor_si128(a, b), kOne));
+      a = _mm_add_epi8(Load4Bytes(raw + i), avg);
+      StorePixel(dest + i, a, bpp);
+    }
+  }
+#endif
+  for (; i < count; ++i)
+    dest[i] = raw[i] + (dest[i - bpp] + up[i]) / 2;
+}
+
+void PNG_UnfilterPaeth(uint8_t* dest,
+                       const uint8_t* raw,
+                       const uint8_t* up,
+                       int bpp,
+                       int count) {
+  // With neither a left nor an upper left neighbor, Paeth picks the byte
+  // above.
+  int i = 0;
+  for (; i < bpp && i < count; ++i)
+    dest[i] = raw[i] + up[i];
+#ifdef FX_SSE2_BASELINE
+  if ((bpp == 3 || bpp == 4) && bpp + 4 <= count) {
+    const __m128i kZero = _mm_setzero_si128();
+    __m128i a = _mm_unpacklo_epi8(Load4Bytes(dest), kZero);
+    __m128i c = _mm_unpacklo_epi8(Load4Bytes(up), kZero);
+    for (; i + 4 <= count; i += bpp) {
+      __m128i b = _mm_unpacklo_epi8(Load4Bytes(up + i), kZero);
+      // With p = a + b - c, these are |p - a|, |p - b| and |p - c|.
+      __m128i pa = Abs16(_mm_sub_epi16(b, c));
+      __m128i pb = Abs16(_mm_sub_epi16(a, c));
+      __m128i pc = Abs16(_mm_add_epi16(_mm_sub_epi16(b, c),
+                                       _mm_sub_epi16(a, c)));
+      __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+      // Ties go to a, then b.
+      __m128i nearest =
+          IfThenElse(_mm_cmpeq_epi16(smallest, pa), a,
+                     IfThenElse(_mm_cmpeq_epi16(smallest, pb), b, c));
+      __m128i x = _mm_add_epi8(Load4Bytes(raw + i),
+                               _mm_packus_epi16(nearest, nearest));
+      StorePixel(dest + i, x, bpp);
+      a = _mm_unpacklo_epi8(x, kZero);
+      c = b;
+    }
+  }
+#endif
+  for (; i < count; ++i)
+    dest[i] = raw[i] + PathPredictor(dest[i - bpp], up[i], up[i - bpp]);
+}
+
+// Undoes PNG filter |tag| over |count| bytes; see above.
+void PNG_UnfilterRow(uint8_t* dest,
+                     const uint8_t* raw,
+                     const uint8_t* up,
+                     int bpp,
+                     int count,
+                     uint8_t tag) {
+  switch (tag) {
+    case 1:
+      PNG_UnfilterSub(dest, raw, bpp, count);
+      break;
+    case 2:
+      PNG_UnfilterUp(dest, raw, up, count);
+      break;
+    case 3:
+      PNG_UnfilterAverage(dest, raw, up, bpp, count);
+      break;
+    case 4:
+      PNG_UnfilterPaeth(dest, raw, up, bpp, count);
+      break;
+    default:
+      FXSYS_memmove(dest, raw, count);
+      break;
+  }
+}
+
 void PNG_PredictLine(uint8_t* pDestData,
                      const uint8_t* pSrcData,
                      const uint8_t* pLastLine,
@@ -283,63 +442,13 @@ void PNG_PredictLine(uint8_t* pDestData,
                      int nPixels) {
   int row_size = (nPixels * bpc * nColors + 7) / 8;
   int BytesPerPixel = (bpc * nColors + 7) / 8;
-  uint8_t tag = pSrcData[0];
-  if (tag == 0) {
-    FXSYS_memmove(pDestData, pSrcData + 1, row_size);
-    return;
-  }
-  for (int byte = 0; byte < row_size; byte++) {
-    uint8_t raw_byte = pSrcData[byte + 1];
-    switch (tag) {
-      case 1: {
-        uint8_t left = 0;
-        if (byte >= BytesPerPixel) {
-          left = pDestData[byte - BytesPerPixel];
-        }
-        pDestData[byte] = raw_byte + left;
-        break;
-      }
-      case 2: {
-        uint8_t up = 0;
-        if (pLastLine) {
-          up = pLastLine[byte];
-        }
-        pDestData[byte] = raw_byte + up;
-        break;
-      }
-      case 3: {
-        uint8_t left = 0;
-        if (byte >= BytesPerPixel) {
-          left = pDestData[byte - BytesPerPixel];
-        }
-        uint8_t up = 0;
-        if (pLastLine) {
-          up = pLastLine[byte];
-        }
-        pDestData[byte] = raw_byte + (up + left) / 2;
-        break;
-      }
-      case 4: {
-        uint8_t left = 0;
-        if (byte >= BytesPerPixel) {
-          left = pDestData[byte - BytesPerPixel];
-        }
-        uint8_t up = 0;
-        if (pLastLine) {
-          up = pLastLine[byte];
-        }
-        uint8_t upper_left = 0;
-        if (byte >= BytesPerPixel && pLastLine) {
-          upper_left = pLastLine[byte - BytesPerPixel];
-        }
-        pDestData[byte] = raw_byte + PathPredictor(left, up, upper_left);
-        break;
-      }
-      default:
-        pDestData[byte] = raw_byte;
-        break;
-    }
+  std::vector<uint8_t> zero_line;
+  if (!pLastLine) {
+    zero_line.resize(row_size);
+    pLastLine = zero_line.data();
   }
+  PNG_UnfilterRow(pDestData, pSrcData + 1, pLastLine, BytesPerPixel, row_size,
+                  pSrcData[0]);
 }
 
 FX_BOOL PNG_Predictor(uint8_t*& data_buf,
@@ -355,82 +464,22 @@ FX_BOOL PNG_Predictor(uint8_t*& data_buf,
   if (row_count <= 0)
     return FALSE;
   const int last_row_size = data_size % (row_size + 1);
-  uint8_t* dest_buf = FX_Alloc2D(uint8_t, row_size, row_count);
-  int byte_cnt = 0;
-  uint8_t* pSrcData = data_buf;
-  uint8_t* pDestData = dest_buf;
+  // Rows are reconstructed in place, each moving back by one byte for every
+  // tag byte before it.
+  std::vector<uint8_t> zero_row(row_size);
+  const uint8_t* pLastLine = zero_row.data();
+  const uint8_t* pSrcData = data_buf;
+  uint8_t* pDestData = data_buf;
   for (int row = 0; row < row_count; row++) {
-    uint8_t tag = pSrcData[0];
-    byte_cnt++;
-    if (tag == 0) {
-      int move_size = row_size;
-      if ((row + 1) * (move_size + 1) > (int)data_size) {
-        move_size = last_row_size - 1;
-      }
-      FXSYS_memmove(pDestData, pSrcData + 1, move_size);
-      pSrcData += move_size + 1;
-      pDestData += move_size;
-      byte_cnt += move_size;
-      continue;
-    }
-    for (int byte = 0; byte < row_size && byte_cnt < (int)data_size; byte++) {
-      uint8_t raw_byte = pSrcData[byte + 1];
-      switch (tag) {
-        case 1: {
-          uint8_t left = 0;
-          if (byte >= BytesPerPixel) {
-            left = pDestData[byte - BytesPerPixel];
-          }
-          pDestData[byte] = raw_byte + left;
-          break;
-        }
-        case 2: {
-          uint8_t up = 0;
-          if (row) {
-            up = pDestData[byte - row_size];
-          }
-          pDestData[byte] = raw_byte + up;
-          break;
-        }
-        case 3: {
-          uint8_t left = 0;
-          if (byte >= BytesPerPixel) {
-            left = pDestData[byte - BytesPerPixel];
-          }
-          uint8_t up = 0;
-          if (row) {
-            up = pDestData[byte - row_size];
-          }
-          pDestData[byte] = raw_byte + (up + left) / 2;
-          break;
-        }
-        case 4: {
-          uint8_t left = 0;
-          if (byte >= BytesPerPixel) {
-            left = pDestData[byte - BytesPerPixel];
-          }
-          uint8_t up = 0;
-          if (row) {
-            up = pDestData[byte - row_size];
-          }
-          uint8_t upper_left = 0;
-          if (byte >= BytesPerPixel && row) {
-            upper_left = pDestData[byte - row_size - BytesPerPixel];
-          }
-          pDestData[byte] = raw_byte + PathPredictor(left, up, upper_left);
-          break;
-        }
-        default:
-          pDestData[byte] = raw_byte;
-          break;
-      }
-      byte_cnt++;
-    }
+    int count = row_size;
+    if (row == row_count - 1 && last_row_size > 0)
+      count = last_row_size - 1;
+    PNG_UnfilterRow(pDestData, pSrcData + 1, pLastLine, BytesPerPixel, count,
+                    pSrcData[0]);
+    pLastLine = pDestData;
     pSrcData += row_size + 1;
     pDestData += row_size;
   }
-  FX_Free(data_buf);
-  data_buf = dest_buf;
   data_size = row_size * row_count -
               (last_row_size > 0 ? (row_size + 1 - last_row_size) : 0);
   return TRUE;
@@ -469,6 +518,10 @@ void TIFF_PredictLine(uint8_t* dest_buf,
       dest_buf[i] = pixel >> 8;
       dest_buf[i + 1] = (uint8_t)pixel;
     }
+  } else if (BytesPerPixel == 3 || BytesPerPixel == 4) {
+    // Horizontal differencing is PNG's Sub filter, which is vectorized for
+    // these sizes.
+    PNG_UnfilterSub(dest_buf, dest_buf, BytesPerPixel, row_size);
   } else {
     for (uint32_t i = BytesPerPixel; i < row_size; i++) {
       dest_buf[i] += dest_buf[i - BytesPerPixel];
@@ -502,16 +555,17 @@ void FlateUncompress(const uint8_t* src_buf,
                      uint8_t*& dest_buf,
                      uint32_t& dest_size,
                      uint32_t& offset) {
-  uint32_t guess_size = orig_size ? orig_size : src_size * 2;
+  // Deflate expands data by at most about 1032:1, so a larger |orig_size|
+  // cannot be right and is ignored. Smaller ones still come from the file, so
+  // no more than kMaxInitialAllocSize is allocated before the output shows
+  // that the hint is real.
+  const uint32_t kMaxInflateRatio = 1032;
+  const uint32_t kMaxInitialAllocSize = 10000000;
   const uint32_t kStepSize = 10240;
-  uint32_t alloc_step = orig_size ? kStepSize : std::min(src_size, kStepSize);
-  static const uint32_t kMaxInitialAllocSize = 10000000;
-  if (guess_size > kMaxInitialAllocSize) {
-    guess_size = kMaxInitialAllocSize;
-    alloc_step = kMaxInitialAllocSize;
-  }
-  uint32_t buf_size = guess_size;
-  uint32_t last_buf_size = buf_size;
+  // FPDFAPI_FlateOutput() zero fills whatever it is given but does not use,
+  // so it is handed at most this much at a time to leave the spare capacity
+  // of the buffer untouched.
+  const uint32_t kMaxOutputWindow = 1024 * 1024;
 
   dest_buf = nullptr;
   dest_size = 0;
@@ -519,93 +573,59 @@ void FlateUncompress(const uint8_t* src_buf,
   if (!context)
     return;
 
-  std::unique_ptr<uint8_t, FxFreeDeleter> guess_buf(
-      FX_Alloc(uint8_t, guess_size + 1));
-  guess_buf.get()[guess_size] = '\0';
+  // With a known output size, the buffer starts at that size, up to
+  // kMaxInitialAllocSize, and then doubles until it reaches it exactly.
+  // Otherwise, or if the hint turns out too small, the buffer grows by half
+  // its size at a time. Large blocks are reallocated by remapping their
+  // pages, so growing and the final trim do not copy the output.
+  if (!orig_size || orig_size == 0xFFFFFFFF ||
+      orig_size / kMaxInflateRatio > src_size) {
+    orig_size = 0;
+  }
+  std::unique_ptr<uint8_t, FxFreeDeleter> buf;
+  uint32_t buf_size = 0;
+  if (orig_size) {
+    uint32_t initial_size = std::min(orig_size, kMaxInitialAllocSize);
+    buf.reset(FX_TryAlloc(uint8_t, initial_size + 1));
+    if (buf)
+      buf_size = initial_size;
+  }
+  if (!buf) {
+    buf_size = std::max(std::min(src_size, kMaxInitialAllocSize / 2) * 2,
+                        kStepSize);
+    buf.reset(FX_Alloc(uint8_t, buf_size + 1));
+  }
 
   FPDFAPI_FlateInput(context, src_buf, src_size);
-
-  if (src_size < kStepSize) {
-    // This is the old implementation.
-    uint8_t* cur_buf = guess_buf.get();
-    while (1) {
-      int32_t ret = FPDFAPI_FlateOutput(context, cur_buf, buf_size);
-      if (ret != Z_OK)
-        break;
-      int32_t avail_buf_size = FPDFAPI_FlateGetAvailOut(context);
-      if (avail_buf_size != 0)
-        break;
-
-      uint32_t old_size = guess_size;
-      guess_size += alloc_step;
-      if (guess_size < old_size || guess_size + 1 < guess_size) {
+  uint32_t used = 0;
+  while (1) {
+    if (used == buf_size) {
+      uint32_t step = orig_size > buf_size
+                          ? std::min(orig_size - buf_size, buf_size)
+                          : std::max(buf_size / 2, kStepSize);
+      if (buf_size > 0xFFFFFFFF - 1 - step) {
         FPDFAPI_FlateEnd(context);
         return;
       }
-
-      {
-        uint8_t* new_buf =
-            FX_Realloc(uint8_t, guess_buf.release(), guess_size + 1);
-        guess_buf.reset(new_buf);
-      }
-      guess_buf.get()[guess_size] = '\0';
-      cur_buf = guess_buf.get() + old_size;
-      buf_size = guess_size - old_size;
-    }
-    dest_size = FPDFAPI_FlateGetTotalOut(context);
-    offset = FPDFAPI_FlateGetTotalIn(context);
-    if (guess_size / 2 > dest_size) {
-      {
-        uint8_t* new_buf =
-            FX_Realloc(uint8_t, guess_buf.release(), dest_size + 1);
-        guess_buf.reset(new_buf);
-      }
-      guess_size = dest_size;
-      guess_buf.get()[guess_size] = '\0';
-    }
-    dest_buf = guess_buf.release();
-  } else {
-    CFX_ArrayTemplate<uint8_t*> result_tmp_bufs;
-    uint8_t* cur_buf = guess_buf.release();
-    while (1) {
-      int32_t ret = FPDFAPI_FlateOutput(context, cur_buf, buf_size);
-      int32_t avail_buf_size = FPDFAPI_FlateGetAvailOut(context);
-      if (ret != Z_OK) {
-        last_buf_size = buf_size - avail_buf_size;
-        result_tmp_bufs.Add(cur_buf);
-        break;
-      }
-      if (avail_buf_size != 0) {
-        last_buf_size = buf_size - avail_buf_size;
-        result_tmp_bufs.Add(cur_buf);
-        break;
-      }
-
-      result_tmp_bufs.Add(cur_buf);
-      cur_buf = FX_Alloc(uint8_t, buf_size + 1);
-      cur_buf[buf_size] = '\0';
-    }
-    dest_size = FPDFAPI_FlateGetTotalOut(context);
-    offset = FPDFAPI_FlateGetTotalIn(context);
-    if (result_tmp_bufs.GetSize() == 1) {
-      dest_buf = result_tmp_bufs[0];
-    } else {
-      uint8_t* result_buf = FX_Alloc(uint8_t, dest_size);
-      uint32_t result_pos = 0;
-      for (int32_t i = 0; i < result_tmp_bufs.GetSize(); i++) {
-        uint8_t* tmp_buf = result_tmp_bufs[i];
-        uint32_t tmp_buf_size = buf_size;
-        if (i == result_tmp_bufs.GetSize() - 1) {
-          tmp_buf_size = last_buf_size;
-        }
-        FXSYS_memcpy(result_buf + result_pos, tmp_buf, tmp_buf_size);
-        result_pos += tmp_buf_size;
-        FX_Free(result_tmp_bufs[i]);
-      }
-      dest_buf = result_buf;
+      buf_size += step;
+      uint8_t* new_buf = FX_Realloc(uint8_t, buf.release(), buf_size + 1);
+      buf.reset(new_buf);
     }
+    uint32_t window = std::min(buf_size - used, kMaxOutputWindow);
+    int32_t ret = FPDFAPI_FlateOutput(context, buf.get() + used, window);
+    used = FPDFAPI_FlateGetTotalOut(context);
+    if (ret != Z_OK || FPDFAPI_FlateGetAvailOut(context) != 0)
+      break;
   }
+  dest_size = FPDFAPI_FlateGetTotalOut(context);
+  offset = FPDFAPI_FlateGetTotalIn(context);
   FPDFAPI_FlateEnd(context);
+  if (dest_size < buf_size) {
+    uint8_t* new_buf = FX_Realloc(uint8_t, buf.release(), dest_size + 1);
+    buf.reset(new_buf);
+  }
+  buf.get()[dest_size] = '\0';
+  dest_buf = buf.release();
 }
 
 }  // namespace
@@ -826,6 +846,17 @@ uint32_t CCodec_FlateModule::FlateOrLZWDecode(FX_BOOL bLZW,
       decoder->Decode(dest_buf, dest_size, src_buf, offset, bEarlyChange);
     }
   } else {
+    if (predictor_type == 2 && estimated_size) {
+      // The estimate is for the data after prediction. Before that, every
+      // row also starts with a filter tag byte.
+      int row_size = (Colors * BitsPerComponent * Columns + 7) / 8;
+      if (row_size > 0) {
+        FX_SAFE_UINT32 size = estimated_size;
+        size += estimated_size / row_size + (estimated_size % row_size != 0);
+        if (size.IsValid())
+          estimated_size = size.ValueOrDie();
+      }
+    }
     FlateUncompress(src_buf, src_size, estimated_size, dest_buf, dest_size,
                     offset);
   }
@@ -0,0 +1,243 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "core/fxcodec/codec/ccodec_flatemodule.h"
+#include "core/fxcodec/codec/ccodec_scanlinedecoder.h"
+#include "core/fxcrt/fx_memory.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+struct PredictorCase {
+  int colors;
+  int bpc;
+};
+
+// Pixel sizes of 1, 2, 3, 4, 6 and 8 bytes, and some below a byte.
+const PredictorCase kPredictorCases[] = {{1, 8}, {2, 8},  {3, 8}, {4, 8},
+                                         {3, 16}, {4, 16}, {1, 1}, {3, 4}};
+const int kColumns[] = {1, 2, 5, 37, 300};
+
+uint32_t g_seed = 1;
+
+uint8_t RandomByte() {
+  g_seed = g_seed * 1103515245 + 12345;
+  return g_seed >> 24;
+}
+
+int ReferencePaeth(int a, int b, int c) {
+  int p = a + b - c;
+  int pa = abs(p - a);
+  int pb = abs(p - b);
+  int pc = abs(p - c);
+  if (pa <= pb && pa <= pc)
+    return a;
+  return pb <= pc ? b : c;
+}
+
+// Undoes the PNG filters in |filtered| byte by byte, as the PNG specification
+// describes them. A truncated last row comes out truncated.
+std::vector<uint8_t> ReferencePNGUnfilter(const std::vector<uint8_t>& filtered,
+                                          int bpp,
+                                          int row_size) {
+  std::vector<uint8_t> result;
+  std::vector<uint8_t> prior(row_size);
+  for (size_t pos = 0; pos < filtered.size(); pos += row_size + 1) {
+    uint8_t tag = filtered[pos];
+    int count = std::min<int>(row_size, filtered.size() - pos - 1);
+    std::vector<uint8_t> row(row_size);
+    for (int i = 0; i < count; ++i) {
+      int raw = filtered[pos + 1 + i];
+      int a = i >= bpp ? row[i - bpp] : 0;
+      int b = prior[i];
+      int c = i >= bpp ? prior[i - bpp] : 0;
+      switch (tag) {
+        case 1:
+          row[i] = raw + a;
+          break;
+        case 2:
+          row[i] = raw + b;
+          break;
+        case 3:
+          row[i] = raw + (a + b) / 2;
+          break;
+        case 4:
+          row[i] = raw + ReferencePaeth(a, b, c);
+          break;
+        default:
+          row[i] = raw;
+          break;
+      }
+    }
+    result.insert(result.end(), row.begin(), row.begin() + count);
+    prior = row;
+  }
+  return result;
+}
+
+// Returns |rows| rows of random filtered data, using every filter type and an
+// invalid one.
+std::vector<uint8_t> MakePNGFilteredRows(int row_size, int rows) {
+  std::vector<uint8_t> filtered;
+  for (int row = 0; row < rows; ++row) {
+    filtered.push_back(row % 6);
+    for (int i = 0; i < row_size; ++i)
+      filtered.push_back(RandomByte());
+  }
+  return filtered;
+}
+
+std::vector<uint8_t> FlateDecode(const std::vector<uint8_t>& data,
+                                 int predictor,
+                                 int colors,
+                                 int bpc,
+                                 int columns,
+                                 uint32_t estimated_size = 0) {
+  CCodec_FlateModule module;
+  uint8_t* encoded = nullptr;
+  uint32_t encoded_size = 0;
+  EXPECT_TRUE(
+      module.Encode(data.data(), data.size(), &encoded, &encoded_size));
+  uint8_t* decoded = nullptr;
+  uint32_t decoded_size = 0;
+  module.FlateOrLZWDecode(FALSE, encoded, encoded_size, FALSE, predictor,
+                          colors, bpc, columns, estimated_size, decoded,
+                          decoded_size);
+  std::vector<uint8_t> result(decoded, decoded + decoded_size);
+  FX_Free(encoded);
+  FX_Free(decoded);
+  return result;
+}
+
+}  // namespace
+
+TEST(CCodec_FlateModule, PNGPredictor) {
+  for (const PredictorCase& test_case : kPredictorCases) {
+    int bits = test_case.colors * test_case.bpc;
+    for (int columns : kColumns) {
+      SCOPED_TRACE(testing::Message() << test_case.colors << " colors, "
+                                      << test_case.bpc << " bpc, " << columns
+                                      << " columns");
+      int row_size = (bits * columns + 7) / 8;
+      std::vector<uint8_t> filtered = MakePNGFilteredRows(row_size, 13);
+      std::vector<uint8_t> expected =
+          ReferencePNGUnfilter(filtered, (bits + 7) / 8, row_size);
+      EXPECT_EQ(expected, FlateDecode(filtered, 12, test_case.colors,
+                                      test_case.bpc, columns));
+
+      // A truncated last row decodes as far as it goes.
+      for (int cut : {1, 2, 3, 4, 5, 8, row_size / 2 + 1, row_size}) {
+        if (cut > row_size)
+          continue;
+
+        std::vector<uint8_t> truncated(filtered.begin(), filtered.end() - cut);
+        EXPECT_EQ(ReferencePNGUnfilter(truncated, (bits + 7) / 8, row_size),
+                  FlateDecode(truncated, 12, test_case.colors, test_case.bpc,
+                              columns));
+      }
+    }
+  }
+}
+
+TEST(CCodec_FlateModule, PNGPredictorEstimatedSize) {
+  // The estimate is the size after prediction, so the inflated data, with a
+  // tag byte per row, is larger than that.
+  std::vector<uint8_t> filtered = MakePNGFilteredRows(111, 50);
+  std::vector<uint8_t> expected = ReferencePNGUnfilter(filtered, 3, 111);
+  EXPECT_EQ(expected, FlateDecode(filtered, 12, 3, 8, 37, expected.size()));
+  EXPECT_EQ(expected, FlateDecode(filtered, 12, 3, 8, 37, 0xFFFFFFFF));
+}
+
+TEST(CCodec_FlateModule, PNGPredictorScanlines) {
+  for (const PredictorCase& test_case : kPredictorCases) {
+    if (test_case.bpc > 8)
+      continue;
+
+    for (int columns : kColumns) {
+      SCOPED_TRACE(testing::Message() << test_case.colors << " colors, "
+                                      << test_case.bpc << " bpc, " << columns
+                                      << " columns");
+      int bits = test_case.colors * test_case.bpc;
+      int row_size = (bits * columns + 7) / 8;
+      const int kRows = 13;
+      std::vector<uint8_t> filtered = MakePNGFilteredRows(row_size, kRows);
+      std::vector<uint8_t> expected =
+          ReferencePNGUnfilter(filtered, (bits + 7) / 8, row_size);
+
+      CCodec_FlateModule module;
+      uint8_t* encoded = nullptr;
+      uint32_t encoded_size = 0;
+      ASSERT_TRUE(module.Encode(filtered.data(), filtered.size(), &encoded,
+                                &encoded_size));
+      std::unique_ptr<CCodec_ScanlineDecoder> decoder(module.CreateDecoder(
+          encoded, encoded_size, columns, kRows, test_case.colors,
+          test_case.bpc, 12, test_case.colors, test_case.bpc, columns));
+      for (int row = 0; row < kRows; ++row) {
+        const uint8_t* scanline = decoder->GetScanline(row);
+        ASSERT_TRUE(scanline);
+        EXPECT_TRUE(std::equal(scanline, scanline + row_size,
+                               expected.begin() + row * row_size))
+            << " at row " << row;
+      }
+      decoder.reset();
+      FX_Free(encoded);
+    }
+  }
+}
+
+TEST(CCodec_FlateModule, TIFFPredictor) {
+  for (const PredictorCase& test_case : kPredictorCases) {
+    if (test_case.bpc != 8)
+      continue;
+
+    for (int columns : kColumns) {
+      SCOPED_TRACE(testing::Message() << test_case.colors << " colors, "
+                                      << columns << " columns");
+      int bpp = test_case.colors;
+      int row_size = bpp * columns;
+      std::vector<uint8_t> data(row_size * 5 + row_size / 2);
+      for (uint8_t& byte : data)
+        byte = RandomByte();
+      std::vector<uint8_t> expected = data;
+      for (size_t i = 0; i < expected.size(); ++i) {
+        if (i % row_size >= static_cast<size_t>(bpp))
+          expected[i] += expected[i - bpp];
+      }
+      EXPECT_EQ(expected,
+                FlateDecode(data, 2, test_case.colors, 8, columns));
+    }
+  }
+}
+
+TEST(CCodec_FlateModule, DecodeEstimatedSize) {
+  for (uint32_t size : {0u, 1u, 1000u, 10240u, 10241u, 300000u}) {
+    std::vector<uint8_t> data;
+    for (uint32_t i = 0; i < size; ++i)
+      data.push_back(i % 7 ? RandomByte() % 4 : RandomByte());
+    // Estimates that are right, too small, too large and impossible all
+    // decode the same.
+    for (uint32_t estimate :
+         {0u, size, size / 2, size + 1, size * 2 + 7, 0x7FFFFFFFu,
+          0xFFFFFFFFu}) {
+      SCOPED_TRACE(testing::Message() << size << " bytes, estimated "
+                                      << estimate);
+      EXPECT_EQ(data, FlateDecode(data, 0, 1, 8, 1, estimate));
+    }
+  }
+}
+
+TEST(CCodec_FlateModule, DecodeLargeEstimatedSize) {
+  // Beyond the initial allocation limit, the buffer grows up to the estimate.
+  std::vector<uint8_t> data(25000000);
+  for (size_t i = 0; i < data.size(); i += 4096)
+    data[i] = RandomByte();
+  for (uint32_t estimate : {0u, 25000000u, 24999999u, 25000001u}) {
+    SCOPED_TRACE(testing::Message() << "estimated " << estimate);
+    EXPECT_TRUE(data == FlateDecode(data, 0, 1, 8, 1, estimate));
+  }
+}
@@ -4,6 +4,9 @@
 
 // Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
 
+#include <algorithm>
+#include <vector>
+
 #include "core/fxcodec/codec/codec_int.h"
 #include "core/fxcodec/fx_codec.h"
 #include "third_party/lcms2-2.6/include/lcms2.h"
@@ -14,11 +17,26 @@ const uint32_t N_COMPONENT_RGB = 3;
 const uint32_t N_COMPONENT_CMYK = 4;
 const uint32_t N_COMPONENT_DEFAULT = 3;
 
+namespace {
+
+// Samples at the points of the CMYK grid are multiples of this, so that the
+// grid reproduces the transform exactly there.
+const int kGridStep = 17;
+const int kGridSize = 255 / kGridStep + 1;
+static_assert(CCodec_IccModule::kGridPoints ==
+                  kGridSize * kGridSize * kGridSize * kGridSize,
+              "kGridPoints must match kGridSize");
+
+}  // namespace
+
 struct CLcmsCmm {
   cmsHTRANSFORM m_hTransform;
   int m_nSrcComponents;
   int m_nDstComponents;
   FX_BOOL m_bLab;
+  // Output of the transform at the points of the CMYK grid, in the order of
+  // the samples.
+  std::vector<uint8_t> m_Grid;
 };
 FX_BOOL CheckComponents(cmsColorSpaceSignature cs,
                         int nComponents,
@@ -230,6 +248,80 @@ void IccLib_TranslateImage(void* pTransform,
   cmsDoTransform(((CLcmsCmm*)pTransform)->m_hTransform, (void*)pSrc, pDest,
                  pixels);
 }
+void IccLib_BuildGrid(CLcmsCmm* pCmm) {
+  const int nPoints = CCodec_IccModule::kGridPoints;
+  std::vector<uint8_t> samples(nPoints * 4);
+  uint8_t* pSample = samples.data();
+  for (int c = 0; c < kGridSize; ++c) {
+    for (int m = 0; m < kGridSize; ++m) {
+      for (int y = 0; y < kGridSize; ++y) {
+        for (int k = 0; k < kGridSize; ++k) {
+          *pSample++ = c * kGridStep;
+          *pSample++ = m * kGridStep;
+          *pSample++ = y * kGridStep;
+          *pSample++ = k * kGridStep;
+        }
+      }
+    }
+  }
+  pCmm->m_Grid.resize(nPoints * 3);
+  cmsDoTransform(pCmm->m_hTransform, samples.data(), pCmm->m_Grid.data(),
+                 nPoints);
+}
+void IccLib_TranslateImageByGrid(const CLcmsCmm* pCmm,
+                                 uint8_t* pDest,
+                                 const uint8_t* pSrc,
+                                 int32_t pixels) {
+  const int kMaxStep = kGridSize - 1;
+  const int strides[4] = {kGridSize * kGridSize * kGridSize * 3,
+                          kGridSize * kGridSize * 3, kGridSize * 3, 3};
+  const uint8_t* pGrid = pCmm->m_Grid.data();
+  for (int32_t i = 0; i < pixels; ++i) {
+    // Find the grid cell of the pixel, and its position in the cell in units
+    // of 1 / kGridStep.
+    int offset = 0;
+    int fractions[4];
+    for (int c = 0; c < 4; ++c) {
+      int step = pSrc[c] / kGridStep;
+      int fraction = pSrc[c] % kGridStep;
+      if (step == kMaxStep) {
+        step = kMaxStep - 1;
+        fraction = kGridStep;
+      }
+      offset += step * strides[c];
+      fractions[c] = fraction;
+    }
+
+    // The cell splits into 24 simplices, one per ordering of the fractions.
+    // The pixel lies in the one whose vertices step along the components in
+    // order of decreasing fraction.
+    int order[4] = {0, 1, 2, 3};
+    for (int c = 1; c < 4; ++c) {
+      int j = c;
+      while (j > 0 && fractions[order[j - 1]] < fractions[order[j]]) {
+        std::swap(order[j - 1], order[j]);
+        --j;
+      }
+    }
+    const uint8_t* pVertex = pGrid + offset;
+    int weight = kGridStep - fractions[order[0]];
+    int sum0 = pVertex[0] * weight;
+    int sum1 = pVertex[1] * weight;
+    int sum2 = pVertex[2] * weight;
+    for (int c = 0; c < 4; ++c) {
+      pVertex += strides[order[c]];
+      weight = fractions[order[c]] - (c < 3 ? fractions[order[c + 1]] : 0);
+      sum0 += pVertex[0] * weight;
+      sum1 += pVertex[1] * weight;
+      sum2 += pVertex[2] * weight;
+    }
+    pDest[0] = (sum0 + kGridStep / 2) / kGridStep;
+    pDest[1] = (sum1 + kGridStep / 2) / kGridStep;
+    pDest[2] = (sum2 + kGridStep / 2) / kGridStep;
+    pSrc += 4;
+    pDest += 3;
+  }
+}
 
 CCodec_IccModule::CCodec_IccModule() : m_nComponents(0) {}
 
@@ -258,6 +350,19 @@ void CCodec_IccModule::TranslateScanline(void* pTransform,
                                          int32_t pixels) {
   IccLib_TranslateImage(pTransform, pDest, pSrc, pixels);
 }
+void CCodec_IccModule::TranslateScanlineByGrid(void* pTransform,
+                                               uint8_t* pDest,
+                                               const uint8_t* pSrc,
+                                               int32_t pixels) {
+  CLcmsCmm* pCmm = static_cast<CLcmsCmm*>(pTransform);
+  if (pCmm->m_nSrcComponents != 4 || pCmm->m_nDstComponents != 3) {
+    IccLib_TranslateImage(pTransform, pDest, pSrc, pixels);
+    return;
+  }
+  if (pCmm->m_Grid.empty())
+    IccLib_BuildGrid(pCmm);
+  IccLib_TranslateImageByGrid(pCmm, pDest, pSrc, pixels);
+}
 const uint8_t g_CMYKSamples[81 * 81 * 3] = {
     255, 255, 255, 225, 226, 228, 199, 200, 202, 173, 174, 178, 147, 149, 152,
     123, 125, 128, 99,  99,  102, 69,  70,  71,  34,  30,  31,  255, 253, 229,
@@ -0,0 +1,142 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "core/fxcodec/codec/ccodec_iccmodule.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/lcms2-2.6/include/lcms2.h"
+
+namespace {
+
+// A smooth but far from linear mapping from CMYK to Lab, standing in for the
+// A2B table of a press profile.
+cmsInt32Number SampleCMYK(const cmsUInt16Number in[],
+                          cmsUInt16Number out[],
+                          void* cargo) {
+  double c = in[0] / 65535.0;
+  double m = in[1] / 65535.0;
+  double y = in[2] / 65535.0;
+  double k = in[3] / 65535.0;
+  cmsCIELab lab;
+  lab.L = 100 * (1 - 0.9 * k) * (1 - 0.45 * c * c - 0.55 * m + 0.2 * m * m) *
+          (1 - 0.1 * y);
+  lab.a = (90 * m - 40 * c - 10 * y) * (1 - k * k);
+  lab.b = (95 * y - 55 * c - 20 * m * y) * (1 - 0.8 * k) + 10 * sin(4 * c);
+  cmsFloat2LabEncoded(out, &lab);
+  return TRUE;
+}
+
+std::vector<uint8_t> CreateCMYKProfile() {
+  std::vector<uint8_t> data;
+  cmsHPROFILE hProfile = cmsCreateProfilePlaceholder(nullptr);
+  cmsSetProfileVersion(hProfile, 4.3);
+  cmsSetDeviceClass(hProfile, cmsSigOutputClass);
+  cmsSetColorSpace(hProfile, cmsSigCmykData);
+  cmsSetPCS(hProfile, cmsSigLabData);
+  cmsPipeline* pPipeline = cmsPipelineAlloc(nullptr, 4, 3);
+  cmsStage* pCLUT = cmsStageAllocCLut16bit(nullptr, 9, 4, 3, nullptr);
+  cmsStageSampleCLut16bit(pCLUT, SampleCMYK, nullptr, 0);
+  cmsPipelineInsertStage(pPipeline, cmsAT_END,
+                         cmsStageAllocToneCurves(nullptr, 4, nullptr));
+  cmsPipelineInsertStage(pPipeline, cmsAT_END, pCLUT);
+  cmsPipelineInsertStage(pPipeline, cmsAT_END,
+                         cmsStageAllocToneCurves(nullptr, 3, nullptr));
+  cmsWriteTag(hProfile, cmsSigAToB0Tag, pPipeline);
+  cmsPipelineFree(pPipeline);
+  cmsUInt32Number size = 0;
+  if (cmsSaveProfileToMem(hProfile, nullptr, &size)) {
+    data.resize(size);
+    cmsSaveProfileToMem(hProfile, data.data(), &size);
+  }
+  cmsCloseProfile(hProfile);
+  return data;
+}
+
+}  // namespace
+
+TEST(CCodec_IccModule, TranslateScanlineByGrid) {
+  std::vector<uint8_t> profile = CreateCMYKProfile();
+  ASSERT_FALSE(profile.empty());
+  CCodec_IccModule module;
+  uint32_t nComponents = 0;
+  void* pTransform = module.CreateTransform_sRGB(
+      profile.data(), profile.size(), nComponents);
+  ASSERT_TRUE(pTransform);
+  EXPECT_EQ(4u, nComponents);
+
+  // Every grid point, plus pseudo-random colors in between.
+  std::vector<uint8_t> src;
+  for (int i = 0; i < 16 * 16 * 16 * 16; ++i) {
+    for (int c = 0; c < 4; ++c)
+      src.push_back((i >> (c * 4)) % 16 * 17);
+  }
+  uint32_t seed = 1;
+  for (int i = 0; i < 200000; ++i) {
+    seed = seed * 1103515245 + 12345;
+    src.push_back(seed >> 24);
+  }
+  const int pixels = src.size() / 4;
+  std::vector<uint8_t> expected(pixels * 3);
+  std::vector<uint8_t> actual(pixels * 3);
+  module.TranslateScanline(pTransform, expected.data(), src.data(), pixels);
+  module.TranslateScanlineByGrid(pTransform, actual.data(), src.data(),
+                                 pixels);
+
+  const size_t kGridValues = 16 * 16 * 16 * 16 * 3;
+  for (size_t i = 0; i < kGridValues; ++i)
+    ASSERT_EQ(expected[i], actual[i]) << " at grid point " << i / 3;
+
+  // Away from the grid, these are the bounds documented for
+  // TranslateScanlineByGrid(). The largest errors are where the transform
+  // clips to the sRGB gamut, since interpolation smooths over the kinks there.
+  int nMaxError = 0;
+  int nTotalError = 0;
+  int nWithinOne = 0;
+  int nWithinThree = 0;
+  for (size_t i = kGridValues; i < expected.size(); ++i) {
+    int error = abs(expected[i] - actual[i]);
+    nMaxError = std::max(nMaxError, error);
+    nTotalError += error;
+    if (error <= 1)
+      ++nWithinOne;
+    if (error <= 3)
+      ++nWithinThree;
+  }
+  const double nValues = expected.size() - kGridValues;
+  EXPECT_GE(15, nMaxError);
+  EXPECT_GE(0.3, nTotalError / nValues);
+  EXPECT_LE(0.975, nWithinOne / nValues);
+  EXPECT_LE(0.995, nWithinThree / nValues);
+  module.DestroyTransform(pTransform);
+}
+
+TEST(CCodec_IccModule, TranslateScanlineByGridFallback) {
+  // Transforms that do not start from CMYK translate as usual.
+  cmsHPROFILE hProfile = cmsCreate_sRGBProfile();
+  cmsUInt32Number size = 0;
+  cmsSaveProfileToMem(hProfile, nullptr, &size);
+  std::vector<uint8_t> profile(size);
+  cmsSaveProfileToMem(hProfile, profile.data(), &size);
+  cmsCloseProfile(hProfile);
+
+  CCodec_IccModule module;
+  uint32_t nComponents = 0;
+  void* pTransform = module.CreateTransform_sRGB(
+      profile.data(), profile.size(), nComponents);
+  ASSERT_TRUE(pTransform);
+  EXPECT_EQ(3u, nComponents);
+  const uint8_t src[] = {0, 0, 0, 10, 200, 30, 255, 128, 1};
+  uint8_t expected[9];
+  uint8_t actual[9];
+  module.TranslateScanline(pTransform, expected, src, 3);
+  module.TranslateScanlineByGrid(pTransform, actual, src, 3);
+  for (size_t i = 0; i < FX_ArraySize(expected); ++i)
+    EXPECT_EQ(expected[i], actual[i]);
+  module.DestroyTransform(pTransform);
+}
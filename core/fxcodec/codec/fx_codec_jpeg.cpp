@@ -151,7 +151,8 @@ class CCodec_JpegDecoder : public CCodec_ScanlineDecoder {
                  int width,
                  int height,
                  int nComps,
-                 FX_BOOL ColorTransform);
+                 FX_BOOL ColorTransform,
+                 int down_scale);
 
   // CCodec_ScanlineDecoder
   FX_BOOL v_Rewind() override;
@@ -173,7 +174,10 @@ class CCodec_JpegDecoder : public CCodec_ScanlineDecoder {
   FX_BOOL m_bJpegTransform;
 
  protected:
+  void CalcOutputSize();
+
   uint32_t m_nDefaultScaleDenom;
+  int m_nDownScale;
 };
 
 CCodec_JpegDecoder::CCodec_JpegDecoder() {
@@ -184,6 +188,7 @@ CCodec_JpegDecoder::CCodec_JpegDecoder() {
   FXSYS_memset(&jerr, 0, sizeof(jerr));
   FXSYS_memset(&src, 0, sizeof(src));
   m_nDefaultScaleDenom = 1;
+  m_nDownScale = 1;
 }
 
 CCodec_JpegDecoder::~CCodec_JpegDecoder() {
@@ -222,18 +227,26 @@ FX_BOOL CCodec_JpegDecoder::InitDecode() {
 
   m_OrigWidth = cinfo.image_width;
   m_OrigHeight = cinfo.image_height;
-  m_OutputWidth = m_OrigWidth;
-  m_OutputHeight = m_OrigHeight;
   m_nDefaultScaleDenom = cinfo.scale_denom;
+  CalcOutputSize();
   return TRUE;
 }
 
+void CCodec_JpegDecoder::CalcOutputSize() {
+  cinfo.scale_num = 1;
+  cinfo.scale_denom = m_nDefaultScaleDenom * m_nDownScale;
+  jpeg_calc_output_dimensions(&cinfo);
+  m_OutputWidth = cinfo.output_width;
+  m_OutputHeight = cinfo.output_height;
+}
+
 FX_BOOL CCodec_JpegDecoder::Create(const uint8_t* src_buf,
                                    uint32_t src_size,
                                    int width,
                                    int height,
                                    int nComps,
-                                   FX_BOOL ColorTransform) {
+                                   FX_BOOL ColorTransform,
+                                   int down_scale) {
   JpegScanSOI(&src_buf, &src_size);
   m_SrcBuf = src_buf;
   m_SrcSize = src_size;
@@ -264,6 +277,13 @@ FX_BOOL CCodec_JpegDecoder::Create(const uint8_t* src_buf,
   if ((int)cinfo.image_width < width)
     return FALSE;
 
+  // Callers crop or pad images whose size differs from what they expect, so
+  // only scale those that match.
+  if (down_scale > 1 && m_OrigWidth == width && m_OrigHeight == height) {
+    m_nDownScale = down_scale;
+    CalcOutputSize();
+  }
+
   m_Pitch =
       (static_cast<uint32_t>(cinfo.image_width) * cinfo.num_components + 3) /
       4 * 4;
@@ -284,9 +304,7 @@ FX_BOOL CCodec_JpegDecoder::v_Rewind() {
   if (setjmp(m_JmpBuf) == -1) {
     return FALSE;
   }
-  cinfo.scale_denom = m_nDefaultScaleDenom;
-  m_OutputWidth = m_OrigWidth;
-  m_OutputHeight = m_OrigHeight;
+  CalcOutputSize();
   if (!jpeg_start_decompress(&cinfo)) {
     jpeg_destroy_decompress(&cinfo);
     return FALSE;
@@ -317,18 +335,39 @@ CCodec_ScanlineDecoder* CCodec_JpegModule::CreateDecoder(
     int width,
     int height,
     int nComps,
-    FX_BOOL ColorTransform) {
+    FX_BOOL ColorTransform,
+    int down_scale) {
   if (!src_buf || src_size == 0)
     return nullptr;
 
   std::unique_ptr<CCodec_JpegDecoder> pDecoder(new CCodec_JpegDecoder);
   if (!pDecoder->Create(src_buf, src_size, width, height, nComps,
-                        ColorTransform)) {
+                        ColorTransform, down_scale)) {
     return nullptr;
   }
   return pDecoder.release();
 }
 
+// static
+int CCodec_JpegModule::GetDownScale(int width,
+                                    int height,
+                                    int dest_width,
+                                    int dest_height) {
+  int down_scale = 1;
+  if (dest_width <= 0 || dest_height <= 0)
+    return down_scale;
+
+  while (down_scale < 8) {
+    int next = down_scale * 2;
+    if ((width + next - 1) / next < dest_width ||
+        (height + next - 1) / next < dest_height) {
+      break;
+    }
+    down_scale = next;
+  }
+  return down_scale;
+}
+
 bool CCodec_JpegModule::LoadInfo(const uint8_t* src_buf,
                                  uint32_t src_size,
                                  int* width,
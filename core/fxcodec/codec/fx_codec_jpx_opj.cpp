@@ -136,38 +136,31 @@ opj_stream_t* fx_opj_stream_create_memory_stream(DecodeData* data,
   opj_stream_set_seek_function(l_stream, opj_seek_from_memory);
   return l_stream;
 }
-static void sycc_to_rgb(int offset,
-                        int upb,
-                        int y,
-                        int cb,
-                        int cr,
-                        int* out_r,
-                        int* out_g,
-                        int* out_b) {
-  int r, g, b;
-  cb -= offset;
-  cr -= offset;
-  r = y + (int)(1.402 * (float)cr);
-  if (r < 0) {
-    r = 0;
-  } else if (r > upb) {
-    r = upb;
-  }
-  *out_r = r;
-  g = y - (int)(0.344 * (float)cb + 0.714 * (float)cr);
-  if (g < 0) {
-    g = 0;
-  } else if (g > upb) {
-    g = upb;
-  }
-  *out_g = g;
-  b = y + (int)(1.772 * (float)cb);
-  if (b < 0) {
-    b = 0;
-  } else if (b > upb) {
-    b = upb;
-  }
-  *out_b = b;
+// Converts |count| pixels from YCbCr to RGB. The loop has no branches, so
+// that compilers can vectorize it.
+static void sycc_to_rgb_row(int offset,
+                            int upb,
+                            const int* y,
+                            const int* cb,
+                            const int* cr,
+                            int* r,
+                            int* g,
+                            int* b,
+                            size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    int u = cb[i] - offset;
+    int v = cr[i] - offset;
+    r[i] = std::min(std::max(y[i] + (int)(1.402 * (float)v), 0), upb);
+    g[i] = std::min(
+        std::max(y[i] - (int)(0.344 * (float)u + 0.714 * (float)v), 0), upb);
+    b[i] = std::min(std::max(y[i] + (int)(1.772 * (float)u), 0), upb);
+  }
+}
+
+// Widens a row of chroma samples taken every other pixel to |width| pixels.
+static void upsample_chroma_row(const int* src, int* dest, OPJ_UINT32 width) {
+  for (OPJ_UINT32 i = 0; i < width; ++i)
+    dest[i] = src[i / 2];
 }
 
 static void sycc444_to_rgb(opj_image_t* img) {
@@ -192,24 +185,13 @@ static void sycc444_to_rgb(opj_image_t* img) {
   int* r = FX_Alloc(int, max_size.ValueOrDie());
   int* g = FX_Alloc(int, max_size.ValueOrDie());
   int* b = FX_Alloc(int, max_size.ValueOrDie());
-  int* d0 = r;
-  int* d1 = g;
-  int* d2 = b;
-  for (size_t i = 0; i < max_size.ValueOrDie(); ++i) {
-    sycc_to_rgb(offset, upb, *y, *cb, *cr, r, g, b);
-    ++y;
-    ++cb;
-    ++cr;
-    ++r;
-    ++g;
-    ++b;
-  }
+  sycc_to_rgb_row(offset, upb, y, cb, cr, r, g, b, max_size.ValueOrDie());
   FX_Free(img->comps[0].data);
   FX_Free(img->comps[1].data);
   FX_Free(img->comps[2].data);
-  img->comps[0].data = d0;
-  img->comps[1].data = d1;
-  img->comps[2].data = d2;
+  img->comps[0].data = r;
+  img->comps[1].data = g;
+  img->comps[2].data = b;
 }
 
 static bool sycc420_422_size_is_valid(opj_image_t* img) {
@@ -226,10 +208,10 @@ static bool sycc420_size_is_valid(opj_image_t* img) {
 static bool sycc422_size_is_valid(opj_image_t* img) {
   return (sycc420_422_size_is_valid(img) && img->comps[0].h == img->comps[1].h);
 }
-static void sycc422_to_rgb(opj_image_t* img) {
-  if (!sycc422_size_is_valid(img))
-    return;
 
+// Converts an image whose chroma is subsampled horizontally, and vertically
+// if |bVertical|, to full-size RGB planes.
+static void sycc_subsampled_to_rgb(opj_image_t* img, bool bVertical) {
   int prec = img->comps[0].prec;
   if (prec <= 0 || prec >= 32)
     return;
@@ -239,6 +221,7 @@ static void sycc422_to_rgb(opj_image_t* img) {
 
   OPJ_UINT32 maxw = img->comps[0].w;
   OPJ_UINT32 maxh = img->comps[0].h;
+  OPJ_UINT32 cbw = img->comps[1].w;
   FX_SAFE_SIZE_T max_size = maxw;
   max_size *= maxh;
   if (!max_size.IsValid())
@@ -250,35 +233,22 @@ static void sycc422_to_rgb(opj_image_t* img) {
   if (!y || !cb || !cr)
     return;
 
-  int *d0, *d1, *d2, *r, *g, *b;
-  d0 = r = FX_Alloc(int, max_size.ValueOrDie());
-  d1 = g = FX_Alloc(int, max_size.ValueOrDie());
-  d2 = b = FX_Alloc(int, max_size.ValueOrDie());
-  for (uint32_t i = 0; i < maxh; ++i) {
-    OPJ_UINT32 j;
-    for (j = 0; j < (maxw & ~static_cast<OPJ_UINT32>(1)); j += 2) {
-      sycc_to_rgb(offset, upb, *y, *cb, *cr, r, g, b);
-      ++y;
-      ++r;
-      ++g;
-      ++b;
-      sycc_to_rgb(offset, upb, *y, *cb, *cr, r, g, b);
-      ++y;
-      ++r;
-      ++g;
-      ++b;
-      ++cb;
-      ++cr;
-    }
-    if (j < maxw) {
-      sycc_to_rgb(offset, upb, *y, *cb, *cr, r, g, b);
-      ++y;
-      ++r;
-      ++g;
-      ++b;
-      ++cb;
-      ++cr;
+  int* d0 = FX_Alloc(int, max_size.ValueOrDie());
+  int* d1 = FX_Alloc(int, max_size.ValueOrDie());
+  int* d2 = FX_Alloc(int, max_size.ValueOrDie());
+  std::vector<int> row_cb(maxw);
+  std::vector<int> row_cr(maxw);
+  for (OPJ_UINT32 i = 0; i < maxh; ++i) {
+    OPJ_UINT32 cbrow = bVertical ? i / 2 : i;
+    if (!bVertical || i % 2 == 0) {
+      upsample_chroma_row(cb + static_cast<size_t>(cbrow) * cbw,
+                          row_cb.data(), maxw);
+      upsample_chroma_row(cr + static_cast<size_t>(cbrow) * cbw,
+                          row_cr.data(), maxw);
     }
+    size_t start = static_cast<size_t>(i) * maxw;
+    sycc_to_rgb_row(offset, upb, y + start, row_cb.data(), row_cr.data(),
+                    d0 + start, d1 + start, d2 + start, maxw);
   }
   FX_Free(img->comps[0].data);
   img->comps[0].data = d0;
@@ -295,145 +265,17 @@ static void sycc422_to_rgb(opj_image_t* img) {
   img->comps[1].dy = img->comps[0].dy;
   img->comps[2].dy = img->comps[0].dy;
 }
-static bool sycc420_must_extend_cbcr(OPJ_UINT32 y, OPJ_UINT32 cbcr) {
-  return (y & 1) && (cbcr == y / 2);
+static void sycc422_to_rgb(opj_image_t* img) {
+  if (!sycc422_size_is_valid(img))
+    return;
+
+  sycc_subsampled_to_rgb(img, false);
 }
 void sycc420_to_rgb(opj_image_t* img) {
   if (!sycc420_size_is_valid(img))
     return;
 
-  OPJ_UINT32 prec = img->comps[0].prec;
-  if (!prec)
-    return;
-  OPJ_UINT32 offset = 1 << (prec - 1);
-  OPJ_UINT32 upb = (1 << prec) - 1;
-  OPJ_UINT32 yw = img->comps[0].w;
-  OPJ_UINT32 yh = img->comps[0].h;
-  OPJ_UINT32 cbw = img->comps[1].w;
-  OPJ_UINT32 cbh = img->comps[1].h;
-  OPJ_UINT32 crw = img->comps[2].w;
-  bool extw = sycc420_must_extend_cbcr(yw, cbw);
-  bool exth = sycc420_must_extend_cbcr(yh, cbh);
-  FX_SAFE_UINT32 safeSize = yw;
-  safeSize *= yh;
-  if (!safeSize.IsValid())
-    return;
-  int* r = FX_Alloc(int, safeSize.ValueOrDie());
-  int* g = FX_Alloc(int, safeSize.ValueOrDie());
-  int* b = FX_Alloc(int, safeSize.ValueOrDie());
-  int* d0 = r;
-  int* d1 = g;
-  int* d2 = b;
-  const int* y = img->comps[0].data;
-  const int* cb = img->comps[1].data;
-  const int* cr = img->comps[2].data;
-  if (!y || !cb || !cr)
-    return;
-
-  const int* ny = nullptr;
-  int* nr = nullptr;
-  int* ng = nullptr;
-  int* nb = nullptr;
-  OPJ_UINT32 i = 0;
-  OPJ_UINT32 j = 0;
-  for (i = 0; i < (yh & ~(OPJ_UINT32)1); i += 2) {
-    ny = y + yw;
-    nr = r + yw;
-    ng = g + yw;
-    nb = b + yw;
-    for (j = 0; j < (yw & ~(OPJ_UINT32)1); j += 2) {
-      sycc_to_rgb(offset, upb, *y, *cb, *cr, r, g, b);
-      ++y;
-      ++r;
-      ++g;
-      ++b;
-      sycc_to_rgb(offset, upb, *y, *cb, *cr, r, g, b);
-      ++y;
-      ++r;
-      ++g;
-      ++b;
-      sycc_to_rgb(offset, upb, *ny, *cb, *cr, nr, ng, nb);
-      ++ny;
-      ++nr;
-      ++ng;
-      ++nb;
-      sycc_to_rgb(offset, upb, *ny, *cb, *cr, nr, ng, nb);
-      ++ny;
-      ++nr;
-      ++ng;
-      ++nb;
-      ++cb;
-      ++cr;
-    }
-    if (j < yw) {
-      if (extw) {
-        --cb;
-        --cr;
-      }
-      sycc_to_rgb(offset, upb, *y, *cb, *cr, r, g, b);
-      ++y;
-      ++r;
-      ++g;
-      ++b;
-      sycc_to_rgb(offset, upb, *ny, *cb, *cr, nr, ng, nb);
-      ++ny;
-      ++nr;
-      ++ng;
-      ++nb;
-      ++cb;
-      ++cr;
-    }
-    y += yw;
-    r += yw;
-    g += yw;
-    b += yw;
-  }
-  if (i < yh) {
-    if (exth) {
-      cb -= cbw;
-      cr -= crw;
-    }
-    for (j = 0; j < (yw & ~(OPJ_UINT32)1); j += 2) {
-      sycc_to_rgb(offset, upb, *y, *cb, *cr, r, g, b);
-      ++y;
-      ++r;
-      ++g;
-      ++b;
-      sycc_to_rgb(offset, upb, *y, *cb, *cr, r, g, b);
-      ++y;
-      ++r;
-      ++g;
-      ++b;
-      ++cb;
-      ++cr;
-    }
-    if (j < yw) {
-      if (extw) {
-        --cb;
-        --cr;
-      }
-      sycc_to_rgb(offset, upb, *y, *cb, *cr, r, g, b);
-    }
-  }
-
-  FX_Free(img->comps[0].data);
-  img->comps[0].data = d0;
-  FX_Free(img->comps[1].data);
-  img->comps[1].data = d1;
-  FX_Free(img->comps[2].data);
-  img->comps[2].data = d2;
-  img->comps[1].w = yw;
-  img->comps[1].h = yh;
-  img->comps[2].w = yw;
-  img->comps[2].h = yh;
-  img->comps[1].w = yw;
-  img->comps[1].h = yh;
-  img->comps[2].w = yw;
-  img->comps[2].h = yh;
-  img->comps[1].dx = img->comps[0].dx;
-  img->comps[2].dx = img->comps[0].dx;
-  img->comps[1].dy = img->comps[0].dy;
-  img->comps[2].dy = img->comps[0].dy;
+  sycc_subsampled_to_rgb(img, true);
 }
 void color_sycc_to_rgb(opj_image_t* img) {
   if (img->numcomps < 3) {
@@ -687,27 +529,39 @@ void color_apply_conversion(opj_image_t* image) {
     return;
   }
 }
+static const unsigned char szJP2Header[] = {
+    0x00, 0x00, 0x00, 0x0c, 0x6a, 0x50, 0x20, 0x20, 0x0d, 0x0a, 0x87, 0x0a};
+
 class CJPX_Decoder {
  public:
   explicit CJPX_Decoder(CPDF_ColorSpace* cs);
   ~CJPX_Decoder();
-  FX_BOOL Init(const unsigned char* src_data, uint32_t src_size);
+  FX_BOOL Init(const unsigned char* src_data,
+               uint32_t src_size,
+               uint32_t reduce);
   void GetInfo(uint32_t* width, uint32_t* height, uint32_t* components);
   bool Decode(uint8_t* dest_buf,
               int pitch,
               const std::vector<uint8_t>& offsets);
 
  private:
+  FX_BOOL ReadHeader(DecodeData* pSrcData, opj_dparameters_t* pParameters);
+
   const uint8_t* m_SrcData;
   uint32_t m_SrcSize;
   opj_image_t* image;
   opj_codec_t* l_codec;
   opj_stream_t* l_stream;
   const CPDF_ColorSpace* const m_ColorSpace;
+  uint32_t m_nReduce;
 };
 
 CJPX_Decoder::CJPX_Decoder(CPDF_ColorSpace* cs)
-    : image(nullptr), l_codec(nullptr), l_stream(nullptr), m_ColorSpace(cs) {}
+    : image(nullptr),
+      l_codec(nullptr),
+      l_stream(nullptr),
+      m_ColorSpace(cs),
+      m_nReduce(0) {}
 
 CJPX_Decoder::~CJPX_Decoder() {
   if (l_codec) {
@@ -721,9 +575,9 @@ CJPX_Decoder::~CJPX_Decoder() {
   }
 }
 
-FX_BOOL CJPX_Decoder::Init(const unsigned char* src_data, uint32_t src_size) {
-  static const unsigned char szJP2Header[] = {
-      0x00, 0x00, 0x00, 0x0c, 0x6a, 0x50, 0x20, 0x20, 0x0d, 0x0a, 0x87, 0x0a};
+FX_BOOL CJPX_Decoder::Init(const unsigned char* src_data,
+                           uint32_t src_size,
+                           uint32_t reduce) {
   if (!src_data || src_size < sizeof(szJP2Header))
     return FALSE;
 
@@ -731,38 +585,29 @@ FX_BOOL CJPX_Decoder::Init(const unsigned char* src_data, uint32_t src_size) {
   m_SrcData = src_data;
   m_SrcSize = src_size;
   DecodeData srcData(const_cast<unsigned char*>(src_data), src_size);
-  l_stream = fx_opj_stream_create_memory_stream(&srcData,
-                                                OPJ_J2K_STREAM_CHUNK_SIZE, 1);
-  if (!l_stream) {
-    return FALSE;
-  }
   opj_dparameters_t parameters;
   opj_set_default_decoder_parameters(&parameters);
   parameters.decod_format = 0;
   parameters.cod_format = 3;
-  if (FXSYS_memcmp(m_SrcData, szJP2Header, sizeof(szJP2Header)) == 0) {
-    l_codec = opj_create_decompress(OPJ_CODEC_JP2);
-    parameters.decod_format = 1;
-  } else {
-    l_codec = opj_create_decompress(OPJ_CODEC_J2K);
-  }
-  if (!l_codec) {
-    return FALSE;
-  }
+  parameters.cp_reduce = reduce;
   if (m_ColorSpace && m_ColorSpace->GetFamily() == PDFCS_INDEXED)
     parameters.flags |= OPJ_DPARAMETERS_IGNORE_PCLR_CMAP_CDEF_FLAG;
-  opj_set_info_handler(l_codec, fx_info_callback, 00);
-  opj_set_warning_handler(l_codec, fx_warning_callback, 00);
-  opj_set_error_handler(l_codec, fx_error_callback, 00);
-  if (!opj_setup_decoder(l_codec, &parameters)) {
-    return FALSE;
-  }
-  if (!opj_read_header(l_stream, l_codec, &image)) {
-    image = nullptr;
-    return FALSE;
+  // Dropping at least as many resolution levels as the codestream has fails
+  // in the header, so drop fewer until it reads.
+  while (!ReadHeader(&srcData, &parameters)) {
+    if (!parameters.cp_reduce)
+      return FALSE;
+
+    parameters.cp_reduce--;
   }
+  m_nReduce = parameters.cp_reduce;
   image->pdfium_use_colorspace = !!m_ColorSpace;
 
+  // Decoding stays on this thread. The bundled OpenJPEG keeps the stream
+  // position and all tile and code-block state in |l_codec|, and has no way
+  // to split one decode across threads. Decoding tiles in parallel would take
+  // a codec and stream per thread, each reading the main header again, and
+  // would not help single-tile codestreams at all.
   if (!parameters.nb_tile_to_decode) {
     if (!opj_set_decode_area(l_codec, image, parameters.DA_x0, parameters.DA_y0,
                              parameters.DA_x1, parameters.DA_y1)) {
@@ -804,24 +649,71 @@ FX_BOOL CJPX_Decoder::Init(const unsigned char* src_data, uint32_t src_size) {
   return TRUE;
 }
 
+FX_BOOL CJPX_Decoder::ReadHeader(DecodeData* pSrcData,
+                                 opj_dparameters_t* pParameters) {
+  if (l_codec) {
+    opj_destroy_codec(l_codec);
+    l_codec = nullptr;
+  }
+  if (l_stream) {
+    opj_stream_destroy(l_stream);
+    l_stream = nullptr;
+  }
+  pSrcData->offset = 0;
+  l_stream = fx_opj_stream_create_memory_stream(pSrcData,
+                                                OPJ_J2K_STREAM_CHUNK_SIZE, 1);
+  if (!l_stream)
+    return FALSE;
+
+  if (FXSYS_memcmp(m_SrcData, szJP2Header, sizeof(szJP2Header)) == 0) {
+    l_codec = opj_create_decompress(OPJ_CODEC_JP2);
+    pParameters->decod_format = 1;
+  } else {
+    l_codec = opj_create_decompress(OPJ_CODEC_J2K);
+  }
+  if (!l_codec)
+    return FALSE;
+
+  opj_set_info_handler(l_codec, fx_info_callback, 00);
+  opj_set_warning_handler(l_codec, fx_warning_callback, 00);
+  opj_set_error_handler(l_codec, fx_error_callback, 00);
+  if (!opj_setup_decoder(l_codec, pParameters))
+    return FALSE;
+
+  if (!opj_read_header(l_stream, l_codec, &image)) {
+    image = nullptr;
+    return FALSE;
+  }
+  return TRUE;
+}
+
 void CJPX_Decoder::GetInfo(uint32_t* width,
                            uint32_t* height,
                            uint32_t* components) {
-  *width = (uint32_t)image->x1;
-  *height = (uint32_t)image->y1;
+  // Each dropped resolution level halves the size, rounding up.
+  *width = static_cast<uint32_t>(
+      ((static_cast<uint64_t>(image->x1) + (1 << m_nReduce)) - 1) >>
+      m_nReduce);
+  *height = static_cast<uint32_t>(
+      ((static_cast<uint64_t>(image->y1) + (1 << m_nReduce)) - 1) >>
+      m_nReduce);
   *components = (uint32_t)image->numcomps;
 }
 
 bool CJPX_Decoder::Decode(uint8_t* dest_buf,
                           int pitch,
                           const std::vector<uint8_t>& offsets) {
-  if (image->comps[0].w != image->x1 || image->comps[0].h != image->y1)
+  uint32_t image_width;
+  uint32_t image_height;
+  uint32_t components;
+  GetInfo(&image_width, &image_height, &components);
+  if (image->comps[0].w != image_width || image->comps[0].h != image_height)
     return false;
 
   if (pitch<(int)(image->comps[0].w * 8 * image->numcomps + 31)>> 5 << 2)
     return false;
 
-  FXSYS_memset(dest_buf, 0xff, image->y1 * pitch);
+  FXSYS_memset(dest_buf, 0xff, image_height * pitch);
   std::vector<uint8_t*> channel_bufs(image->numcomps);
   std::vector<int> adjust_comps(image->numcomps);
   for (uint32_t i = 0; i < image->numcomps; i++) {
@@ -894,9 +786,34 @@ CCodec_JpxModule::~CCodec_JpxModule() {}
 
 CJPX_Decoder* CCodec_JpxModule::CreateDecoder(const uint8_t* src_buf,
                                               uint32_t src_size,
-                                              CPDF_ColorSpace* cs) {
+                                              CPDF_ColorSpace* cs,
+                                              int down_scale) {
+  uint32_t reduce = 0;
+  while (reduce < 30 && (2 << reduce) <= down_scale)
+    reduce++;
   std::unique_ptr<CJPX_Decoder> decoder(new CJPX_Decoder(cs));
-  return decoder->Init(src_buf, src_size) ? decoder.release() : nullptr;
+  return decoder->Init(src_buf, src_size, reduce) ? decoder.release()
+                                                  : nullptr;
+}
+
+// static
+int CCodec_JpxModule::GetDownScale(int width,
+                                   int height,
+                                   int dest_width,
+                                   int dest_height) {
+  int down_scale = 1;
+  if (dest_width <= 0 || dest_height <= 0)
+    return down_scale;
+
+  while (down_scale <= width / 2 && down_scale <= height / 2) {
+    int next = down_scale * 2;
+    if ((width - 1) / next + 1 < dest_width ||
+        (height - 1) / next + 1 < dest_height) {
+      break;
+    }
+    down_scale = next;
+  }
+  return down_scale;
 }
 
 void CCodec_JpxModule::GetImageInfo(CJPX_Decoder* pDecoder,
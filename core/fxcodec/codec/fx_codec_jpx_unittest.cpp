@@ -6,6 +6,7 @@
 
 #include <limits>
 
+#include "core/fxcodec/codec/ccodec_jpxmodule.h"
 #include "core/fxcodec/codec/codec_int.h"
 #include "testing/fx_string_testhelpers.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -530,3 +531,15 @@ TEST(fxcodec, YUV420ToRGB) {
   }
   FX_Free(img.comps);
 }
+
+TEST(fxcodec, JpxGetDownScale) {
+  EXPECT_EQ(1, CCodec_JpxModule::GetDownScale(512, 512, 512, 512));
+  EXPECT_EQ(1, CCodec_JpxModule::GetDownScale(512, 512, 257, 100));
+  EXPECT_EQ(2, CCodec_JpxModule::GetDownScale(512, 512, 256, 100));
+  EXPECT_EQ(8, CCodec_JpxModule::GetDownScale(512, 512, 50, 50));
+  EXPECT_EQ(4, CCodec_JpxModule::GetDownScale(501, 301, 126, 76));
+  EXPECT_EQ(8, CCodec_JpxModule::GetDownScale(501, 301, 1, 38));
+  EXPECT_EQ(64, CCodec_JpxModule::GetDownScale(10000, 14000, 100, 140));
+  EXPECT_EQ(1, CCodec_JpxModule::GetDownScale(512, 512, 0, 50));
+  EXPECT_EQ(1, CCodec_JpxModule::GetDownScale(1, 1, 1, 1));
+}
@@ -0,0 +1,33 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcrt/fx_cpu.h"
+
+#if defined(FX_SSE2_SUPPORTED) && !defined(FX_SSE2_BASELINE)
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+bool DetectSSE2() {
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 1);
+  // CPUID leaf 1 reports SSE2 in bit 26 of EDX.
+  return !!(info[3] & (1 << 26));
+#else
+  return !!__builtin_cpu_supports("sse2");
+#endif
+}
+
+}  // namespace
+
+bool FXSYS_HasSSE2() {
+  static const bool s_bHasSSE2 = DetectSSE2();
+  return s_bHasSSE2;
+}
+
+#endif
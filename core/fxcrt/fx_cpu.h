@@ -0,0 +1,48 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FXCRT_FX_CPU_H_
+#define CORE_FXCRT_FX_CPU_H_
+
+// FX_SSE2_SUPPORTED is defined when SSE2 code can be built, i.e. for x86 and
+// x86-64. Such code has to live in functions marked FX_SSE2_TARGET, which may
+// only be called once FXSYS_HasSSE2() returned true.
+//
+// FX_SSE2_BASELINE is defined as well when every CPU the build targets has
+// SSE2: always on x86-64, and on 32-bit x86 when built with -msse2 or
+// /arch:SSE2. SSE2 code may then also be inlined into other functions, and
+// FXSYS_HasSSE2() is a constant. Other 32-bit x86 builds check the CPU on the
+// first call.
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FX_SSE2_BASELINE
+#define FX_SSE2_SUPPORTED
+#elif defined(__i386__) || defined(_M_IX86)
+#define FX_SSE2_SUPPORTED
+#endif
+
+#ifdef FX_SSE2_SUPPORTED
+#include <emmintrin.h>
+#endif
+
+#if defined(FX_SSE2_SUPPORTED) && !defined(FX_SSE2_BASELINE)
+#if defined(__GNUC__) || defined(__clang__)
+#define FX_SSE2_TARGET __attribute__((target("sse2")))
+#endif
+bool FXSYS_HasSSE2();
+#else
+inline bool FXSYS_HasSSE2() {
+#ifdef FX_SSE2_BASELINE
+  return true;
+#else
+  return false;
+#endif
+}
+#endif
+
+#ifndef FX_SSE2_TARGET
+#define FX_SSE2_TARGET
+#endif
+
+#endif  // CORE_FXCRT_FX_CPU_H_
@@ -9,6 +9,7 @@
 #include "core/fxcrt/extension.h"
 #include "core/fxcrt/fx_basic.h"
 #include "core/fxcrt/fx_ext.h"
+#include "core/fxcrt/fxcrt_posix.h"
 
 #if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
 #include <wincrypt.h>
@@ -353,6 +354,15 @@ IFX_FileStream* FX_CreateFileStream(const FX_WCHAR* filename,
 IFX_FileRead* FX_CreateFileRead(const FX_CHAR* filename) {
   return FX_CreateFileStream(filename, FX_FILEMODE_ReadOnly);
 }
+IFX_FileRead* FX_CreateMappedFileRead(const FX_CHAR* filename) {
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_LINUX_ || \
+    _FXM_PLATFORM_ == _FXM_PLATFORM_APPLE_ || \
+    _FXM_PLATFORM_ == _FXM_PLATFORM_ANDROID_
+  if (IFX_FileRead* pFile = CFXCRT_MappedFileRead_Posix::Create(filename))
+    return pFile;
+#endif
+  return FX_CreateFileRead(filename);
+}
 IFX_FileRead* FX_CreateFileRead(const FX_WCHAR* filename) {
   return FX_CreateFileStream(filename, FX_FILEMODE_ReadOnly);
 }
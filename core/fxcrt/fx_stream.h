@@ -89,10 +89,20 @@ class IFX_FileRead : public IFX_StreamRead {
 
   virtual FX_BOOL ReadBlock(void* buffer, FX_FILESIZE offset, size_t size) = 0;
   virtual FX_FILESIZE GetSize() = 0;
+
+  // Returns the whole file as one read-only buffer of GetSize() bytes that
+  // stays valid for the lifetime of this object, or nullptr when the data is
+  // not resident in contiguous memory. Callers may then read it directly
+  // instead of copying it out with ReadBlock().
+  virtual const uint8_t* GetDirectBuffer();
 };
 
 IFX_FileRead* FX_CreateFileRead(const FX_CHAR* filename);
 IFX_FileRead* FX_CreateFileRead(const FX_WCHAR* filename);
+// Like FX_CreateFileRead(), but on POSIX platforms the file is memory-mapped
+// when possible. The file must then not be truncated while it is open, or
+// reading the cut-off part raises SIGBUS instead of failing.
+IFX_FileRead* FX_CreateMappedFileRead(const FX_CHAR* filename);
 
 class IFX_FileStream : public IFX_FileRead, public IFX_FileWrite {
  public:
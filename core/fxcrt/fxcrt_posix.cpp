@@ -12,6 +12,8 @@
     _FXM_PLATFORM_ == _FXM_PLATFORM_APPLE_ || \
     _FXM_PLATFORM_ == _FXM_PLATFORM_ANDROID_
 
+#include <sys/mman.h>
+
 // static
 IFXCRT_FileAccess* IFXCRT_FileAccess::Create() {
   return new CFXCRT_FileAccess_Posix;
@@ -99,10 +101,14 @@ size_t CFXCRT_FileAccess_Posix::ReadPos(void* pBuffer,
   if (pos >= GetSize()) {
     return 0;
   }
-  if (SetPosition(pos) == (FX_FILESIZE)-1) {
+  // Read with pread() so that the data is right even when forked processes
+  // move the shared file offset in between, then leave the offset after the
+  // block read, as a seek and read would.
+  ssize_t nRead = pread(m_nFD, pBuffer, szBuffer, pos);
+  if (nRead < 0)
     return 0;
-  }
-  return Read(pBuffer, szBuffer);
+  SetPosition(pos + nRead);
+  return nRead;
 }
 size_t CFXCRT_FileAccess_Posix::WritePos(const void* pBuffer,
                                          size_t szBuffer,
@@ -128,4 +134,57 @@ FX_BOOL CFXCRT_FileAccess_Posix::Truncate(FX_FILESIZE szFile) {
   return !ftruncate(m_nFD, szFile);
 }
 
+// static
+CFXCRT_MappedFileRead_Posix* CFXCRT_MappedFileRead_Posix::Create(
+    const CFX_ByteStringC& fileName) {
+  int fd = open(fileName.c_str(), O_RDONLY | O_BINARY | O_LARGEFILE);
+  if (fd < 0)
+    return nullptr;
+
+  struct stat st;
+  void* pData = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+      static_cast<uint64_t>(st.st_size) <= SIZE_MAX) {
+    pData = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  // The mapping keeps the file alive; the descriptor is no longer needed.
+  close(fd);
+  if (pData == MAP_FAILED)
+    return nullptr;
+
+  return new CFXCRT_MappedFileRead_Posix(static_cast<uint8_t*>(pData),
+                                         st.st_size);
+}
+
+CFXCRT_MappedFileRead_Posix::CFXCRT_MappedFileRead_Posix(uint8_t* pData,
+                                                         size_t size)
+    : m_pData(pData), m_Size(size) {}
+
+CFXCRT_MappedFileRead_Posix::~CFXCRT_MappedFileRead_Posix() {
+  munmap(m_pData, m_Size);
+}
+
+void CFXCRT_MappedFileRead_Posix::Release() {
+  delete this;
+}
+
+FX_BOOL CFXCRT_MappedFileRead_Posix::ReadBlock(void* buffer,
+                                               FX_FILESIZE offset,
+                                               size_t size) {
+  if (offset < 0 || static_cast<size_t>(offset) > m_Size ||
+      size > m_Size - offset) {
+    return FALSE;
+  }
+  FXSYS_memcpy(buffer, m_pData + offset, size);
+  return TRUE;
+}
+
+FX_FILESIZE CFXCRT_MappedFileRead_Posix::GetSize() {
+  return m_Size;
+}
+
+const uint8_t* CFXCRT_MappedFileRead_Posix::GetDirectBuffer() {
+  return m_pData;
+}
+
 #endif
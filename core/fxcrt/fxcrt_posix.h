@@ -36,6 +36,28 @@ class CFXCRT_FileAccess_Posix : public IFXCRT_FileAccess {
  protected:
   int32_t m_nFD;
 };
+
+// Read-only file access through a memory mapping of the whole file. The file
+// must not shrink while it is mapped, or reading past its new end raises
+// SIGBUS instead of failing.
+class CFXCRT_MappedFileRead_Posix final : public IFX_FileRead {
+ public:
+  // Returns nullptr if |fileName| cannot be opened or mapped.
+  static CFXCRT_MappedFileRead_Posix* Create(const CFX_ByteStringC& fileName);
+
+  // IFX_FileRead
+  void Release() override;
+  FX_BOOL ReadBlock(void* buffer, FX_FILESIZE offset, size_t size) override;
+  FX_FILESIZE GetSize() override;
+  const uint8_t* GetDirectBuffer() override;
+
+ private:
+  CFXCRT_MappedFileRead_Posix(uint8_t* pData, size_t size);
+  ~CFXCRT_MappedFileRead_Posix() override;
+
+  uint8_t* const m_pData;
+  const size_t m_Size;
+};
 #endif
 
 #endif  // CORE_FXCRT_FXCRT_POSIX_H_
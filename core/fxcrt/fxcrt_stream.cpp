@@ -22,6 +22,10 @@ size_t IFX_FileRead::ReadBlock(void* buffer, size_t size) {
   return 0;
 }
 
+const uint8_t* IFX_FileRead::GetDirectBuffer() {
+  return nullptr;
+}
+
 FX_BOOL IFX_FileStream::WriteBlock(const void* buffer, size_t size) {
   return WriteBlock(buffer, GetSize(), size);
 }
@@ -4,6 +4,9 @@
 
 // Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
 
+#include <memory>
+#include <utility>
+
 #include "core/fxge/apple/apple_int.h"
 #include "core/fxge/cfx_gemodule.h"
 #include "core/fxge/ge/cfx_folderfontinfo.h"
@@ -130,7 +133,13 @@ std::unique_ptr<IFX_SystemFontInfo> IFX_SystemFontInfo::CreateDefault(
 
 void CFX_GEModule::InitPlatform() {
   m_pPlatformData = new CApplePlatform;
-  m_pFontMgr->SetSystemFontInfo(IFX_SystemFontInfo::CreateDefault(nullptr));
+  std::unique_ptr<IFX_SystemFontInfo> pInfo =
+      IFX_SystemFontInfo::CreateDefault(nullptr);
+  if (m_pFontIndexPath) {
+    static_cast<CFX_MacFontInfo*>(pInfo.get())
+        ->SetIndexPath(m_pFontIndexPath);
+  }
+  m_pFontMgr->SetSystemFontInfo(std::move(pInfo));
 }
 
 void CFX_GEModule::DestroyPlatform() {
@@ -11,6 +11,7 @@
 
 #include "core/fxge/fx_font.h"
 #include "core/fxge/fx_freetype.h"
+#include "core/fxge/ge/cfx_persistentglyphcache.h"
 
 class CFX_FaceCache {
  public:
@@ -50,10 +51,25 @@ class CFX_FaceCache {
                                      FX_BOOL bFontStyle,
                                      int dest_width,
                                      int anti_alias);
+  // Fills in the key of a glyph in the persistent glyph cache. Returns false
+  // if the glyph cannot be cached there.
+  bool GetPersistentKey(const CFX_Font* pFont,
+                        uint32_t glyph_index,
+                        FX_BOOL bFontStyle,
+                        const CFX_Matrix* pMatrix,
+                        int dest_width,
+                        int anti_alias,
+                        CFX_PersistentGlyphCache::Key* pKey);
   void InitPlatform();
   void DestroyPlatform();
 
   FXFT_Face const m_Face;
+  // Identity of the font program for persistent keys, computed on first use
+  // by GetPersistentKey(). |m_bFontPersistable| is false for fonts that are
+  // too costly to identify.
+  uint64_t m_FontHash;
+  bool m_bFontHashed;
+  bool m_bFontPersistable;
   std::map<CFX_ByteString, std::unique_ptr<CFX_SizeGlyphCache>> m_SizeMap;
   std::map<uint32_t, std::unique_ptr<CFX_PathData>> m_PathMap;
 #ifdef _SKIA_SUPPORT_
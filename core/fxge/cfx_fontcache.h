@@ -22,6 +22,10 @@ class CFX_FontCache {
   ~CFX_FontCache();
   CFX_FaceCache* GetCachedFace(const CFX_Font* pFont);
   void ReleaseCachedFace(const CFX_Font* pFont);
+  // Like the above, for holders of |face| other than CFX_Font, such as
+  // CFX_EmbeddedFontRegistry keeping an unused face for later documents.
+  CFX_FaceCache* RetainFaceCache(FXFT_Face face);
+  void ReleaseFaceCache(FXFT_Face face);
 #ifdef _SKIA_SUPPORT_
   CFX_TypeFace* GetDeviceCache(const CFX_Font* pFont);
 #endif
@@ -7,14 +7,14 @@
 #ifndef CORE_FXGE_CFX_FONTMAPPER_H_
 #define CORE_FXGE_CFX_FONTMAPPER_H_
 
+#include <map>
 #include <memory>
 #include <vector>
 
 #include "core/fxge/cfx_fontmgr.h"
+#include "core/fxge/cfx_substfont.h"
 #include "core/fxge/fx_font.h"
 
-class CFX_SubstFont;
-
 class CFX_FontMapper {
  public:
   explicit CFX_FontMapper(CFX_FontMgr* mgr);
@@ -25,6 +25,9 @@ class CFX_FontMapper {
   void AddInstalledFont(const CFX_ByteString& name, int charset);
   void LoadInstalledFonts();
 
+  // The result is remembered by the mapper, within the limits below, so
+  // later calls with the same arguments skip the name matching and the system
+  // font lookups. |pSubstFont| is overwritten with the substitution details.
   FXFT_Face FindSubstFont(const CFX_ByteString& face_name,
                           FX_BOOL bTrueType,
                           uint32_t flags,
@@ -44,11 +47,46 @@ class CFX_FontMapper {
     return m_FaceArray[index].name;
   }
 
+  uint32_t GetSubstCacheHitCount() const { return m_nSubstCacheHits; }
+  uint32_t GetSubstCacheMissCount() const { return m_nSubstCacheMisses; }
+  // An estimate of the time the cache saved, in milliseconds: for every hit,
+  // how long the lookup that filled the entry took.
+  double GetSubstCacheSavedTime() const { return m_SubstCacheSavedMs; }
+  // The size of the font data of the system faces kept loaded by the cache.
+  size_t GetSubstCacheFaceBytes() const { return m_SubstCacheFaceBytes; }
+  void SetSubstCacheFaceBudgetForTesting(size_t bytes) {
+    m_SubstCacheFaceBudget = bytes;
+  }
+
   std::vector<CFX_ByteString> m_InstalledTTFonts;
 
  private:
   static const size_t MM_FACE_COUNT = 2;
   static const size_t FOXIT_FACE_COUNT = 14;
+  // The cache is emptied when it grows beyond this many entries, or when the
+  // system faces it keeps loaded would grow beyond this many bytes. Faces
+  // larger than that are not cached at all.
+  static const size_t kMaxSubstCacheSize = 4096;
+  static const size_t kMaxSubstCacheFaceBytes = 64 * 1024 * 1024;
+
+  struct SubstCacheEntry {
+    // Holds a reference to the face, unless it is a built-in one.
+    FXFT_Face m_Face;
+    CFX_SubstFont m_SubstFont;
+    // How long the lookup took, in milliseconds.
+    double m_Milliseconds;
+  };
+
+  FXFT_Face FindSubstFontUncached(const CFX_ByteString& face_name,
+                                  FX_BOOL bTrueType,
+                                  uint32_t flags,
+                                  int weight,
+                                  int italic_angle,
+                                  int CharsetCP,
+                                  CFX_SubstFont* pSubstFont);
+  void ClearSubstCache();
+  // The bytes that |face| adds to |m_SubstCacheFaceBytes| when cached.
+  size_t GetNewSubstCacheFaceBytes(FXFT_Face face) const;
 
   CFX_ByteString GetPSNameFromTT(void* hFont);
   CFX_ByteString MatchInstalledFonts(const CFX_ByteString& norm_name);
@@ -79,6 +117,12 @@ class CFX_FontMapper {
   std::unique_ptr<IFX_SystemFontInfo> m_pFontInfo;
   FXFT_Face m_FoxitFaces[FOXIT_FACE_COUNT];
   CFX_FontMgr* const m_pFontMgr;
+  std::map<CFX_ByteString, SubstCacheEntry> m_SubstCache;
+  uint32_t m_nSubstCacheHits;
+  uint32_t m_nSubstCacheMisses;
+  double m_SubstCacheSavedMs;
+  size_t m_SubstCacheFaceBytes;
+  size_t m_SubstCacheFaceBudget;
 };
 
 #endif  // CORE_FXGE_CFX_FONTMAPPER_H_
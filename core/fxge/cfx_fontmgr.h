@@ -45,6 +45,9 @@ class CFX_FontMgr {
                              int font_offset);
   FXFT_Face GetFileFace(const FX_CHAR* filename, int face_index);
   FXFT_Face GetFixedFace(const uint8_t* pData, uint32_t size, int face_index);
+  // Adds a reference to a face returned by one of the functions above, to be
+  // dropped with another call to ReleaseFace().
+  void RetainFace(FXFT_Face face);
   void ReleaseFace(FXFT_Face face);
   void SetSystemFontInfo(std::unique_ptr<IFX_SystemFontInfo> pFontInfo);
   FXFT_Face FindSubstFont(const CFX_ByteString& face_name,
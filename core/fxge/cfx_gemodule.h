@@ -13,8 +13,10 @@
 #include "core/fxge/fx_font.h"
 
 class CCodec_ModuleMgr;
+class CFX_EmbeddedFontRegistry;
 class CFX_FontCache;
 class CFX_FontMgr;
+class CFX_PersistentGlyphCache;
 
 class CFX_GEModule {
  public:
@@ -22,11 +24,29 @@ class CFX_GEModule {
   static void Destroy();
 
   void Init(const char** pUserFontPaths, CCodec_ModuleMgr* pCodecModule);
+  // Makes the platform font list come from the index file at |path|, where
+  // the platform scans font folders. Must be called before Init().
+  void SetFontIndexPath(const char* path) { m_pFontIndexPath = path; }
   CFX_FontCache* GetFontCache();
   CFX_FontMgr* GetFontMgr() { return m_pFontMgr.get(); }
   void SetTextGamma(FX_FLOAT gammaValue);
   const uint8_t* GetTextGammaTable() const;
 
+  // Makes glyph rendering go through the cache file at |path|. Must be called
+  // after Init(), and before any text is rendered.
+  void InitGlyphCache(const char* path);
+  CFX_PersistentGlyphCache* GetGlyphCache() const {
+    return m_pGlyphCache.get();
+  }
+
+  // Makes embedded fonts with identical programs share one face, and keeps
+  // up to |unused_budget| bytes of programs no longer in use for later
+  // documents. Must be called before any font is loaded.
+  void InitEmbeddedFontRegistry(size_t unused_budget);
+  CFX_EmbeddedFontRegistry* GetEmbeddedFontRegistry() const {
+    return m_pEmbeddedFontRegistry.get();
+  }
+
   CCodec_ModuleMgr* GetCodecModule() { return m_pCodecModule; }
   void* GetPlatformData() { return m_pPlatformData; }
 
@@ -45,6 +65,11 @@ class CFX_GEModule {
   CCodec_ModuleMgr* m_pCodecModule;
   void* m_pPlatformData;
   const char** m_pUserFontPaths;
+  const char* m_pFontIndexPath;
+  std::unique_ptr<CFX_PersistentGlyphCache> m_pGlyphCache;
+  // Declared after |m_pFontMgr|, so that its faces are freed before the
+  // FreeType library.
+  std::unique_ptr<CFX_EmbeddedFontRegistry> m_pEmbeddedFontRegistry;
 };
 
 #endif  // CORE_FXGE_CFX_GEMODULE_H_
@@ -55,6 +55,10 @@ class CWeightTable {
             int flags);
   PixelWeight* GetPixelWeight(int pixel) const;
   int* GetValueFromPixelWeight(PixelWeight* pWeight, int index) const;
+
+  // Returns the weights for source pixels m_SrcStart through m_SrcEnd of
+  // |pWeight|, or nullptr if they run past the end of the table.
+  const int* GetWeights(const PixelWeight* pWeight) const;
   size_t GetPixelWeightSize() const;
 
  private:
@@ -113,4 +117,32 @@ FX_RECT FXDIB_SwapClipBox(FX_RECT& clip,
                           FX_BOOL bFlipX,
                           FX_BOOL bFlipY);
 
+// Vectorized FXDIB_BLEND_NORMAL kernels for the hottest row compositors in
+// fx_dib_composite.cpp. Each one processes a prefix of the row and returns
+// how many pixels it handled, leaving the rest to the scalar code; the return
+// value is 0 on targets and CPUs without a vector implementation. Results are
+// identical to the scalar code. |src_color| is the mask color as stored in a
+// destination pixel, i.e. already swapped for RGB byte order.
+int CompositeRow_Argb2Argb_NoBlend_SIMD(uint8_t* dest_scan,
+                                        const uint8_t* src_scan,
+                                        int pixel_count,
+                                        const uint8_t* clip_scan,
+                                        FX_BOOL bRgbByteOrder);
+int CompositeRow_Rgb2Argb_NoBlend_NoClip_SIMD(uint8_t* dest_scan,
+                                              const uint8_t* src_scan,
+                                              int width,
+                                              FX_BOOL bRgbByteOrder);
+int CompositeRow_ByteMask2Argb_NoBlend_SIMD(uint8_t* dest_scan,
+                                            const uint8_t* src_scan,
+                                            int mask_alpha,
+                                            uint32_t src_color,
+                                            int pixel_count,
+                                            const uint8_t* clip_scan);
+int CompositeRow_ByteMask2Rgb32_NoBlend_SIMD(uint8_t* dest_scan,
+                                             const uint8_t* src_scan,
+                                             int mask_alpha,
+                                             uint32_t src_color,
+                                             int pixel_count,
+                                             const uint8_t* clip_scan);
+
 #endif  // CORE_FXGE_DIB_DIB_INT_H_
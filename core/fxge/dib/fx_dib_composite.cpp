@@ -750,6 +750,15 @@ void CompositeRow_Argb2Argb(uint8_t* dest_scan,
   FX_BOOL bNonseparableBlend = blend_type >= FXDIB_BLEND_NONSEPARABLE;
   if (!dest_alpha_scan) {
     if (!src_alpha_scan) {
+      if (blend_type == FXDIB_BLEND_NORMAL) {
+        int done = CompositeRow_Argb2Argb_NoBlend_SIMD(
+            dest_scan, src_scan, pixel_count, clip_scan, FALSE);
+        dest_scan += done * 4;
+        src_scan += done * 4;
+        if (clip_scan)
+          clip_scan += done;
+        pixel_count -= done;
+      }
       uint8_t back_alpha = 0;
       for (int col = 0; col < pixel_count; col++) {
         back_alpha = dest_scan[3];
@@ -1201,6 +1210,13 @@ void CompositeRow_Rgb2Argb_NoBlend_NoClip(uint8_t* dest_scan,
       src_scan += src_gap;
     }
   } else {
+    if (src_Bpp == 4) {
+      int done = CompositeRow_Rgb2Argb_NoBlend_NoClip_SIMD(dest_scan, src_scan,
+                                                           width, FALSE);
+      dest_scan += done * 4;
+      src_scan += done * 4;
+      width -= done;
+    }
     for (int col = 0; col < width; col++) {
       if (src_Bpp == 4) {
         FXARGB_SETDIB(dest_scan, 0xff000000 | FXARGB_GETDIB(src_scan));
@@ -2491,6 +2507,16 @@ void CompositeRow_ByteMask2Argb(uint8_t* dest_scan,
                                 int pixel_count,
                                 int blend_type,
                                 const uint8_t* clip_scan) {
+  if (blend_type == FXDIB_BLEND_NORMAL) {
+    int done = CompositeRow_ByteMask2Argb_NoBlend_SIMD(
+        dest_scan, src_scan, mask_alpha, FXARGB_MAKE(0, src_r, src_g, src_b),
+        pixel_count, clip_scan);
+    dest_scan += done * 4;
+    src_scan += done;
+    if (clip_scan)
+      clip_scan += done;
+    pixel_count -= done;
+  }
   for (int col = 0; col < pixel_count; col++) {
     int src_alpha;
     if (clip_scan) {
@@ -2630,6 +2656,16 @@ void CompositeRow_ByteMask2Rgb(uint8_t* dest_scan,
                                int blend_type,
                                int Bpp,
                                const uint8_t* clip_scan) {
+  if (blend_type == FXDIB_BLEND_NORMAL && Bpp == 4) {
+    int done = CompositeRow_ByteMask2Rgb32_NoBlend_SIMD(
+        dest_scan, src_scan, mask_alpha, FXARGB_MAKE(0, src_r, src_g, src_b),
+        pixel_count, clip_scan);
+    dest_scan += done * 4;
+    src_scan += done;
+    if (clip_scan)
+      clip_scan += done;
+    pixel_count -= done;
+  }
   for (int col = 0; col < pixel_count; col++) {
     int src_alpha;
     if (clip_scan) {
@@ -2988,6 +3024,15 @@ void CompositeRow_Argb2Argb_RgbByteOrder(uint8_t* dest_scan,
                                          int pixel_count,
                                          int blend_type,
                                          const uint8_t* clip_scan) {
+  if (blend_type == FXDIB_BLEND_NORMAL) {
+    int done = CompositeRow_Argb2Argb_NoBlend_SIMD(
+        dest_scan, src_scan, pixel_count, clip_scan, TRUE);
+    dest_scan += done * 4;
+    src_scan += done * 4;
+    if (clip_scan)
+      clip_scan += done;
+    pixel_count -= done;
+  }
   int blended_colors[3];
   FX_BOOL bNonseparableBlend = blend_type >= FXDIB_BLEND_NONSEPARABLE;
   for (int col = 0; col < pixel_count; col++) {
@@ -3135,6 +3180,13 @@ void CompositeRow_Rgb2Argb_NoBlend_NoClip_RgbByteOrder(uint8_t* dest_scan,
                                                        const uint8_t* src_scan,
                                                        int width,
                                                        int src_Bpp) {
+  if (src_Bpp == 4) {
+    int done = CompositeRow_Rgb2Argb_NoBlend_NoClip_SIMD(dest_scan, src_scan,
+                                                         width, TRUE);
+    dest_scan += done * 4;
+    src_scan += done * 4;
+    width -= done;
+  }
   for (int col = 0; col < width; col++) {
     if (src_Bpp == 4) {
       FXARGB_SETRGBORDERDIB(dest_scan, 0xff000000 | FXARGB_GETDIB(src_scan));
@@ -3557,6 +3609,16 @@ void CompositeRow_ByteMask2Argb_RgbByteOrder(uint8_t* dest_scan,
                                              int pixel_count,
                                              int blend_type,
                                              const uint8_t* clip_scan) {
+  if (blend_type == FXDIB_BLEND_NORMAL) {
+    int done = CompositeRow_ByteMask2Argb_NoBlend_SIMD(
+        dest_scan, src_scan, mask_alpha, FXARGB_MAKE(0, src_b, src_g, src_r),
+        pixel_count, clip_scan);
+    dest_scan += done * 4;
+    src_scan += done;
+    if (clip_scan)
+      clip_scan += done;
+    pixel_count -= done;
+  }
   for (int col = 0; col < pixel_count; col++) {
     int src_alpha;
     if (clip_scan) {
@@ -3620,6 +3682,16 @@ void CompositeRow_ByteMask2Rgb_RgbByteOrder(uint8_t* dest_scan,
                                             int blend_type,
                                             int Bpp,
                                             const uint8_t* clip_scan) {
+  if (blend_type == FXDIB_BLEND_NORMAL && Bpp == 4) {
+    int done = CompositeRow_ByteMask2Rgb32_NoBlend_SIMD(
+        dest_scan, src_scan, mask_alpha, FXARGB_MAKE(0, src_b, src_g, src_r),
+        pixel_count, clip_scan);
+    dest_scan += done * 4;
+    src_scan += done;
+    if (clip_scan)
+      clip_scan += done;
+    pixel_count -= done;
+  }
   for (int col = 0; col < pixel_count; col++) {
     int src_alpha;
     if (clip_scan) {
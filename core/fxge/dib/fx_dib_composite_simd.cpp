@@ -0,0 +1,267 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string.h>
+
+#include "core/fxcrt/fx_cpu.h"
+#include "core/fxge/dib/dib_int.h"
+
+// The SSE2 kernels are built for x86 and x86-64, and only run where
+// FXSYS_HasSSE2(), so 32-bit x86 builds that do not assume SSE2 pick them at
+// runtime. Other targets get the scalar code only; a NEON version of the
+// kernels would slot in the same way.
+
+namespace {
+
+#ifdef FX_SSE2_SUPPORTED
+
+// Computes x / 255, rounded down, for every 16-bit lane holding at most
+// 255 * 255. This is exact over that range.
+FX_SSE2_TARGET __m128i Div255Epi16(__m128i x) {
+  __m128i t = _mm_add_epi16(_mm_srli_epi16(x, 8), _mm_set1_epi16(1));
+  return _mm_srli_epi16(_mm_add_epi16(x, t), 8);
+}
+
+// Same as above for 32-bit lanes.
+FX_SSE2_TARGET __m128i Div255Epi32(__m128i x) {
+  __m128i t = _mm_add_epi32(_mm_srli_epi32(x, 8), _mm_set1_epi32(1));
+  return _mm_srli_epi32(_mm_add_epi32(x, t), 8);
+}
+
+// Multiplies 32-bit lanes whose values are both below 256.
+FX_SSE2_TARGET __m128i MulSmallEpi32(__m128i a, __m128i b) {
+  // The products fit in the low 16 bits and the high halves are zero.
+  return _mm_mullo_epi16(a, b);
+}
+
+FX_SSE2_TARGET __m128i Load4Bytes(const uint8_t* p) {
+  int32_t v;
+  memcpy(&v, p, sizeof(v));
+  __m128i zero = _mm_setzero_si128();
+  return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zero),
+                            zero);
+}
+
+// Swaps the first and third byte of every pixel, i.e. BGRA <-> RGBA.
+FX_SSE2_TARGET __m128i SwapRedBlue(__m128i pixels) {
+  const __m128i kGreenAlpha = _mm_set1_epi32(0xff00ff00);
+  const __m128i kLowByte = _mm_set1_epi32(0xff);
+  __m128i blue = _mm_and_si128(pixels, kLowByte);
+  __m128i red = _mm_and_si128(_mm_srli_epi32(pixels, 16), kLowByte);
+  return _mm_or_si128(_mm_and_si128(pixels, kGreenAlpha),
+                      _mm_or_si128(red, _mm_slli_epi32(blue, 16)));
+}
+
+// Returns (d * (255 - ratio) + s * ratio) / 255 for all 16 channels, with
+// |ratio| holding one value per pixel in each 32-bit lane.
+FX_SSE2_TARGET __m128i MergeChannels(__m128i dest, __m128i src, __m128i ratio) {
+  const __m128i zero = _mm_setzero_si128();
+  ratio = _mm_or_si128(ratio, _mm_slli_epi32(ratio, 16));
+  __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), ratio);
+
+  __m128i ratio_lo = _mm_unpacklo_epi32(ratio, ratio);
+  __m128i inverse_lo = _mm_unpacklo_epi32(inverse, inverse);
+  __m128i merged_lo = Div255Epi16(
+      _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dest, zero), inverse_lo),
+                    _mm_mullo_epi16(_mm_unpacklo_epi8(src, zero), ratio_lo)));
+
+  __m128i ratio_hi = _mm_unpackhi_epi32(ratio, ratio);
+  __m128i inverse_hi = _mm_unpackhi_epi32(inverse, inverse);
+  __m128i merged_hi = Div255Epi16(
+      _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dest, zero), inverse_hi),
+                    _mm_mullo_epi16(_mm_unpackhi_epi8(src, zero), ratio_hi)));
+  return _mm_packus_epi16(merged_lo, merged_hi);
+}
+
+// Composites four source pixels, whose alpha already includes any clip or
+// mask, onto four destination pixels with alpha. Matches the scalar
+// FXDIB_BLEND_NORMAL code: a fully transparent backdrop takes the source
+// as is, otherwise the colors are merged by src_alpha * 255 / dest_alpha.
+FX_SSE2_TARGET __m128i CompositeArgbPixels(__m128i dest, __m128i src) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i kAlpha = _mm_set1_epi32(0xff000000);
+  __m128i back_alpha = _mm_srli_epi32(dest, 24);
+  __m128i src_alpha = _mm_srli_epi32(src, 24);
+  __m128i dest_alpha =
+      _mm_sub_epi32(_mm_add_epi32(back_alpha, src_alpha),
+                    Div255Epi32(MulSmallEpi32(back_alpha, src_alpha)));
+
+  // The quotient is at most 255, so single precision division followed by
+  // truncation gives exactly the integer division result. |dest_alpha| is
+  // only zero where the backdrop is transparent, and those lanes are
+  // replaced below.
+  __m128 numerator =
+      _mm_cvtepi32_ps(MulSmallEpi32(src_alpha, _mm_set1_epi32(255)));
+  __m128 denominator =
+      _mm_cvtepi32_ps(_mm_max_epi16(dest_alpha, _mm_set1_epi32(1)));
+  __m128i alpha_ratio =
+      _mm_cvttps_epi32(_mm_div_ps(numerator, denominator));
+
+  __m128i result = _mm_or_si128(
+      _mm_andnot_si128(kAlpha, MergeChannels(dest, src, alpha_ratio)),
+      _mm_slli_epi32(dest_alpha, 24));
+  __m128i transparent = _mm_cmpeq_epi32(back_alpha, zero);
+  return _mm_or_si128(_mm_and_si128(transparent, src),
+                      _mm_andnot_si128(transparent, result));
+}
+
+FX_SSE2_TARGET int Argb2Argb_NoBlend_SSE2(uint8_t* dest_scan,
+                                          const uint8_t* src_scan,
+                                          int pixel_count,
+                                          const uint8_t* clip_scan,
+                                          FX_BOOL bRgbByteOrder) {
+  const __m128i kColor = _mm_set1_epi32(0x00ffffff);
+  int col = 0;
+  for (; col + 4 <= pixel_count; col += 4) {
+    __m128i src = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(src_scan + col * 4));
+    if (bRgbByteOrder)
+      src = SwapRedBlue(src);
+    if (clip_scan) {
+      __m128i src_alpha = Div255Epi32(
+          MulSmallEpi32(Load4Bytes(clip_scan + col), _mm_srli_epi32(src, 24)));
+      src = _mm_or_si128(_mm_and_si128(src, kColor),
+                         _mm_slli_epi32(src_alpha, 24));
+    }
+    __m128i* dest = reinterpret_cast<__m128i*>(dest_scan + col * 4);
+    _mm_storeu_si128(dest, CompositeArgbPixels(_mm_loadu_si128(dest), src));
+  }
+  return col;
+}
+
+FX_SSE2_TARGET int Rgb2Argb_NoBlend_NoClip_SSE2(uint8_t* dest_scan,
+                                                const uint8_t* src_scan,
+                                                int width,
+                                                FX_BOOL bRgbByteOrder) {
+  const __m128i kAlpha = _mm_set1_epi32(0xff000000);
+  int col = 0;
+  for (; col + 4 <= width; col += 4) {
+    __m128i src = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(src_scan + col * 4));
+    if (bRgbByteOrder)
+      src = SwapRedBlue(src);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest_scan + col * 4),
+                     _mm_or_si128(src, kAlpha));
+  }
+  return col;
+}
+
+FX_SSE2_TARGET int ByteMask2Argb_NoBlend_SSE2(uint8_t* dest_scan,
+                                              const uint8_t* src_scan,
+                                              int mask_alpha,
+                                              uint32_t src_color,
+                                              int pixel_count,
+                                              const uint8_t* clip_scan) {
+  const __m128i color = _mm_set1_epi32(src_color & 0x00ffffff);
+  const __m128i alpha = _mm_set1_epi32(mask_alpha);
+  int col = 0;
+  for (; col + 4 <= pixel_count; col += 4) {
+    __m128i src_alpha;
+    if (clip_scan) {
+      // mask_alpha * clip * src needs more than 16 bits, so this stays
+      // scalar to keep the two rounding steps of the reference code.
+      int32_t alphas[4];
+      for (int i = 0; i < 4; ++i) {
+        alphas[i] =
+            mask_alpha * clip_scan[col + i] * src_scan[col + i] / 255 / 255;
+      }
+      src_alpha = _mm_loadu_si128(reinterpret_cast<const __m128i*>(alphas));
+    } else {
+      src_alpha = Div255Epi32(MulSmallEpi32(Load4Bytes(src_scan + col), alpha));
+    }
+    __m128i src = _mm_or_si128(color, _mm_slli_epi32(src_alpha, 24));
+    __m128i* dest = reinterpret_cast<__m128i*>(dest_scan + col * 4);
+    _mm_storeu_si128(dest, CompositeArgbPixels(_mm_loadu_si128(dest), src));
+  }
+  return col;
+}
+
+FX_SSE2_TARGET int ByteMask2Rgb32_NoBlend_SSE2(uint8_t* dest_scan,
+                                               const uint8_t* src_scan,
+                                               int mask_alpha,
+                                               uint32_t src_color,
+                                               int pixel_count,
+                                               const uint8_t* clip_scan) {
+  const __m128i kAlpha = _mm_set1_epi32(0xff000000);
+  const __m128i color = _mm_set1_epi32(src_color & 0x00ffffff);
+  const __m128i alpha = _mm_set1_epi32(mask_alpha);
+  int col = 0;
+  for (; col + 4 <= pixel_count; col += 4) {
+    __m128i src_alpha;
+    if (clip_scan) {
+      int32_t alphas[4];
+      for (int i = 0; i < 4; ++i) {
+        alphas[i] =
+            mask_alpha * clip_scan[col + i] * src_scan[col + i] / 255 / 255;
+      }
+      src_alpha = _mm_loadu_si128(reinterpret_cast<const __m128i*>(alphas));
+    } else {
+      src_alpha = Div255Epi32(MulSmallEpi32(Load4Bytes(src_scan + col), alpha));
+    }
+    // The fourth byte of each pixel is not a color and is left alone.
+    __m128i* dest = reinterpret_cast<__m128i*>(dest_scan + col * 4);
+    __m128i pixels = _mm_loadu_si128(dest);
+    __m128i merged = MergeChannels(pixels, color, src_alpha);
+    _mm_storeu_si128(dest, _mm_or_si128(_mm_and_si128(pixels, kAlpha),
+                                        _mm_andnot_si128(kAlpha, merged)));
+  }
+  return col;
+}
+
+#endif  // FX_SSE2_SUPPORTED
+
+}  // namespace
+
+int CompositeRow_Argb2Argb_NoBlend_SIMD(uint8_t* dest_scan,
+                                        const uint8_t* src_scan,
+                                        int pixel_count,
+                                        const uint8_t* clip_scan,
+                                        FX_BOOL bRgbByteOrder) {
+#ifdef FX_SSE2_SUPPORTED
+  if (FXSYS_HasSSE2())
+    return Argb2Argb_NoBlend_SSE2(dest_scan, src_scan, pixel_count, clip_scan,
+                                  bRgbByteOrder);
+#endif
+  return 0;
+}
+
+int CompositeRow_Rgb2Argb_NoBlend_NoClip_SIMD(uint8_t* dest_scan,
+                                              const uint8_t* src_scan,
+                                              int width,
+                                              FX_BOOL bRgbByteOrder) {
+#ifdef FX_SSE2_SUPPORTED
+  if (FXSYS_HasSSE2())
+    return Rgb2Argb_NoBlend_NoClip_SSE2(dest_scan, src_scan, width,
+                                        bRgbByteOrder);
+#endif
+  return 0;
+}
+
+int CompositeRow_ByteMask2Argb_NoBlend_SIMD(uint8_t* dest_scan,
+                                            const uint8_t* src_scan,
+                                            int mask_alpha,
+                                            uint32_t src_color,
+                                            int pixel_count,
+                                            const uint8_t* clip_scan) {
+#ifdef FX_SSE2_SUPPORTED
+  if (FXSYS_HasSSE2())
+    return ByteMask2Argb_NoBlend_SSE2(dest_scan, src_scan, mask_alpha,
+                                      src_color, pixel_count, clip_scan);
+#endif
+  return 0;
+}
+
+int CompositeRow_ByteMask2Rgb32_NoBlend_SIMD(uint8_t* dest_scan,
+                                             const uint8_t* src_scan,
+                                             int mask_alpha,
+                                             uint32_t src_color,
+                                             int pixel_count,
+                                             const uint8_t* clip_scan) {
+#ifdef FX_SSE2_SUPPORTED
+  if (FXSYS_HasSSE2())
+    return ByteMask2Rgb32_NoBlend_SSE2(dest_scan, src_scan, mask_alpha,
+                                       src_color, pixel_count, clip_scan);
+#endif
+  return 0;
+}
@@ -0,0 +1,99 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdlib.h>
+
+#include <vector>
+
+#include "core/fxge/fx_dib.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// Not a multiple of 4, so rows end with pixels the vector code leaves over.
+const int kWidth = 67;
+
+std::vector<uint8_t> RandomBytes(size_t size) {
+  std::vector<uint8_t> bytes(size);
+  for (uint8_t& byte : bytes) {
+    // Favor the extremes, which take separate paths in the compositors.
+    int value = rand() % 320;
+    byte = value < 255 ? value : (value < 288 ? 0 : 255);
+  }
+  return bytes;
+}
+
+// Composites a whole row at once and one pixel at a time, which only ever
+// uses the scalar code, and checks that both give the same result.
+void CheckRgbLine(FXDIB_Format dest_format,
+                  FXDIB_Format src_format,
+                  FX_BOOL bClip,
+                  FX_BOOL bRgbByteOrder) {
+  for (int run = 0; run < 20; ++run) {
+    std::vector<uint8_t> src = RandomBytes(kWidth * 4);
+    std::vector<uint8_t> clip = RandomBytes(kWidth);
+    std::vector<uint8_t> row = RandomBytes(kWidth * 4);
+    std::vector<uint8_t> expected = row;
+
+    CFX_ScanlineCompositor compositor;
+    ASSERT_TRUE(compositor.Init(dest_format, src_format, kWidth, nullptr, 0,
+                                FXDIB_BLEND_NORMAL, bClip, bRgbByteOrder));
+    const uint8_t* clip_scan = bClip ? clip.data() : nullptr;
+    compositor.CompositeRgbBitmapLine(row.data(), src.data(), kWidth,
+                                      clip_scan);
+    for (int i = 0; i < kWidth; ++i) {
+      compositor.CompositeRgbBitmapLine(&expected[i * 4], &src[i * 4], 1,
+                                        bClip ? &clip[i] : nullptr);
+    }
+    ASSERT_EQ(expected, row);
+  }
+}
+
+void CheckByteMaskLine(FXDIB_Format dest_format,
+                       FX_BOOL bClip,
+                       FX_BOOL bRgbByteOrder) {
+  for (int run = 0; run < 20; ++run) {
+    std::vector<uint8_t> mask = RandomBytes(kWidth);
+    std::vector<uint8_t> clip = RandomBytes(kWidth);
+    std::vector<uint8_t> row = RandomBytes(kWidth * 4);
+    std::vector<uint8_t> expected = row;
+    uint32_t color = ArgbEncode(run * 13 % 256, rand() % 256, rand() % 256,
+                                rand() % 256);
+
+    CFX_ScanlineCompositor compositor;
+    ASSERT_TRUE(compositor.Init(dest_format, FXDIB_8bppMask, kWidth, nullptr,
+                                color, FXDIB_BLEND_NORMAL, bClip,
+                                bRgbByteOrder));
+    const uint8_t* clip_scan = bClip ? clip.data() : nullptr;
+    compositor.CompositeByteMaskLine(row.data(), mask.data(), kWidth,
+                                     clip_scan);
+    for (int i = 0; i < kWidth; ++i) {
+      compositor.CompositeByteMaskLine(&expected[i * 4], &mask[i], 1,
+                                       bClip ? &clip[i] : nullptr);
+    }
+    ASSERT_EQ(expected, row);
+  }
+}
+
+}  // namespace
+
+TEST(CFX_ScanlineCompositor, Argb2Argb) {
+  for (int i = 0; i < 4; ++i)
+    CheckRgbLine(FXDIB_Argb, FXDIB_Argb, i & 1, i & 2);
+}
+
+TEST(CFX_ScanlineCompositor, Rgb32ToArgb) {
+  for (int i = 0; i < 4; ++i)
+    CheckRgbLine(FXDIB_Argb, FXDIB_Rgb32, i & 1, i & 2);
+}
+
+TEST(CFX_ScanlineCompositor, ByteMask2Argb) {
+  for (int i = 0; i < 4; ++i)
+    CheckByteMaskLine(FXDIB_Argb, i & 1, i & 2);
+}
+
+TEST(CFX_ScanlineCompositor, ByteMask2Rgb32) {
+  for (int i = 0; i < 4; ++i)
+    CheckByteMaskLine(FXDIB_Rgb32, i & 1, i & 2);
+}
@@ -7,7 +7,9 @@
 #include <limits.h>
 
 #include <algorithm>
+#include <vector>
 
+#include "core/fxcrt/fx_cpu.h"
 #include "core/fxge/dib/dib_int.h"
 #include "core/fxge/fx_dib.h"
 
@@ -29,6 +31,60 @@ FXDIB_Format GetStretchedFormat(const CFX_DIBSource& src) {
   return format;
 }
 
+#ifdef FX_SSE2_SUPPORTED
+// Does the work of AccumulateWeightedRow() below for a multiple of 16
+// entries, and returns how many it did.
+FX_SSE2_TARGET size_t AccumulateWeightedRow_SSE2(const uint8_t* src,
+                                                 int weight,
+                                                 int* sums,
+                                                 size_t count) {
+  // SSE2 has no 32-bit multiply, so split the weight into its low and high
+  // 16 bits. The low half times a byte needs both halves of the 16-bit
+  // product, while the high half only contributes to the upper 16 bits of the
+  // result. That is exact modulo 2^32 and so equal to the scalar product.
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i weight_lo = _mm_set1_epi16(static_cast<int16_t>(weight));
+  const __m128i weight_hi = _mm_set1_epi16(static_cast<int16_t>(weight >> 16));
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i halves[2] = {_mm_unpacklo_epi8(bytes, zero),
+                         _mm_unpackhi_epi8(bytes, zero)};
+    for (int h = 0; h < 2; ++h) {
+      __m128i lo = _mm_mullo_epi16(halves[h], weight_lo);
+      __m128i hi = _mm_add_epi16(_mm_mulhi_epu16(halves[h], weight_lo),
+                                 _mm_mullo_epi16(halves[h], weight_hi));
+      __m128i* dest = reinterpret_cast<__m128i*>(sums + i + h * 8);
+      _mm_storeu_si128(dest, _mm_add_epi32(_mm_loadu_si128(dest),
+                                           _mm_unpacklo_epi16(lo, hi)));
+      _mm_storeu_si128(dest + 1,
+                       _mm_add_epi32(_mm_loadu_si128(dest + 1),
+                                     _mm_unpackhi_epi16(lo, hi)));
+    }
+  }
+  return i;
+}
+#endif  // FX_SSE2_SUPPORTED
+
+// Adds |weight| * |src|[i] to |sums|[i] for |count| entries. Weights are
+// 16.16 fixed point and may be negative for bicubic interpolation.
+void AccumulateWeightedRow(const uint8_t* src,
+                           int weight,
+                           int* sums,
+                           size_t count) {
+  if (weight == 0)
+    return;
+
+  size_t i = 0;
+#ifdef FX_SSE2_SUPPORTED
+  if (FXSYS_HasSSE2())
+    i = AccumulateWeightedRow_SSE2(src, weight, sums, count);
+#endif
+  for (; i < count; ++i)
+    sums[i] += weight * src[i];
+}
+
 }  // namespace
 
 CWeightTable::CWeightTable()
@@ -262,6 +318,15 @@ int* CWeightTable::GetValueFromPixelWeight(PixelWeight* pWeight,
   return idx < GetPixelWeightSize() ? &pWeight->m_Weights[idx] : nullptr;
 }
 
+const int* CWeightTable::GetWeights(const PixelWeight* pWeight) const {
+  if (pWeight->m_SrcEnd > pWeight->m_SrcStart &&
+      static_cast<size_t>(pWeight->m_SrcEnd - pWeight->m_SrcStart) >=
+          GetPixelWeightSize()) {
+    return nullptr;
+  }
+  return pWeight->m_Weights;
+}
+
 CStretchEngine::CStretchEngine(IFX_ScanlineComposer* pDestBitmap,
                                FXDIB_Format dest_format,
                                int dest_width,
@@ -457,15 +522,14 @@ FX_BOOL CStretchEngine::ContinueStretchHorz(IFX_Pause* pPause) {
       case 2: {
         for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
           PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+          const int* pWeight = m_WeightTable.GetWeights(pPixelWeights);
+          if (!pWeight)
+            return FALSE;
+
           int dest_a = 0;
           for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
                j++) {
-            int* pWeight =
-                m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return FALSE;
-
-            int pixel_weight = *pWeight;
+            int pixel_weight = *pWeight++;
             if (src_scan[j / 8] & (1 << (7 - j % 8))) {
               dest_a += pixel_weight * 255;
             }
@@ -480,16 +544,15 @@ FX_BOOL CStretchEngine::ContinueStretchHorz(IFX_Pause* pPause) {
       case 3: {
         for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
           PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+          const int* pWeight = m_WeightTable.GetWeights(pPixelWeights);
+          if (!pWeight)
+            return FALSE;
+
           int dest_a = 0;
+          const uint8_t* src_pixel = src_scan + pPixelWeights->m_SrcStart;
           for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
                j++) {
-            int* pWeight =
-                m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return FALSE;
-
-            int pixel_weight = *pWeight;
-            dest_a += pixel_weight * src_scan[j];
+            dest_a += *pWeight++ * *src_pixel++;
           }
           if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
             dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
@@ -501,15 +564,14 @@ FX_BOOL CStretchEngine::ContinueStretchHorz(IFX_Pause* pPause) {
       case 4: {
         for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
           PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+          const int* pWeight = m_WeightTable.GetWeights(pPixelWeights);
+          if (!pWeight)
+            return FALSE;
+
           int dest_a = 0, dest_r = 0;
           for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
                j++) {
-            int* pWeight =
-                m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return FALSE;
-
-            int pixel_weight = *pWeight;
+            int pixel_weight = *pWeight++;
             pixel_weight = pixel_weight * src_scan_mask[j] / 255;
             dest_r += pixel_weight * src_scan[j];
             dest_a += pixel_weight;
@@ -524,27 +586,24 @@ FX_BOOL CStretchEngine::ContinueStretchHorz(IFX_Pause* pPause) {
         break;
       }
       case 5: {
+        // Palette entries are ARGB for RGB output and CMYK otherwise.
+        const int shift_r_y = m_DestFormat == FXDIB_Rgb ? 16 : 8;
+        const int shift_g_m = m_DestFormat == FXDIB_Rgb ? 8 : 16;
+        const int shift_b_c = m_DestFormat == FXDIB_Rgb ? 0 : 24;
         for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
           PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+          const int* pWeight = m_WeightTable.GetWeights(pPixelWeights);
+          if (!pWeight)
+            return FALSE;
+
           int dest_r_y = 0, dest_g_m = 0, dest_b_c = 0;
           for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
                j++) {
-            int* pWeight =
-                m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return FALSE;
-
-            int pixel_weight = *pWeight;
-            unsigned long argb_cmyk = m_pSrcPalette[src_scan[j]];
-            if (m_DestFormat == FXDIB_Rgb) {
-              dest_r_y += pixel_weight * (uint8_t)(argb_cmyk >> 16);
-              dest_g_m += pixel_weight * (uint8_t)(argb_cmyk >> 8);
-              dest_b_c += pixel_weight * (uint8_t)argb_cmyk;
-            } else {
-              dest_b_c += pixel_weight * (uint8_t)(argb_cmyk >> 24);
-              dest_g_m += pixel_weight * (uint8_t)(argb_cmyk >> 16);
-              dest_r_y += pixel_weight * (uint8_t)(argb_cmyk >> 8);
-            }
+            int pixel_weight = *pWeight++;
+            uint32_t argb_cmyk = m_pSrcPalette[src_scan[j]];
+            dest_r_y += pixel_weight * (uint8_t)(argb_cmyk >> shift_r_y);
+            dest_g_m += pixel_weight * (uint8_t)(argb_cmyk >> shift_g_m);
+            dest_b_c += pixel_weight * (uint8_t)(argb_cmyk >> shift_b_c);
           }
           if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
             dest_r_y =
@@ -561,28 +620,24 @@ FX_BOOL CStretchEngine::ContinueStretchHorz(IFX_Pause* pPause) {
         break;
       }
       case 6: {
+        const int shift_r_y = m_DestFormat == FXDIB_Rgba ? 16 : 8;
+        const int shift_g_m = m_DestFormat == FXDIB_Rgba ? 8 : 16;
+        const int shift_b_c = m_DestFormat == FXDIB_Rgba ? 0 : 24;
         for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
           PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+          const int* pWeight = m_WeightTable.GetWeights(pPixelWeights);
+          if (!pWeight)
+            return FALSE;
+
           int dest_a = 0, dest_r_y = 0, dest_g_m = 0, dest_b_c = 0;
           for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
                j++) {
-            int* pWeight =
-                m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return FALSE;
-
-            int pixel_weight = *pWeight;
+            int pixel_weight = *pWeight++;
             pixel_weight = pixel_weight * src_scan_mask[j] / 255;
-            unsigned long argb_cmyk = m_pSrcPalette[src_scan[j]];
-            if (m_DestFormat == FXDIB_Rgba) {
-              dest_r_y += pixel_weight * (uint8_t)(argb_cmyk >> 16);
-              dest_g_m += pixel_weight * (uint8_t)(argb_cmyk >> 8);
-              dest_b_c += pixel_weight * (uint8_t)argb_cmyk;
-            } else {
-              dest_b_c += pixel_weight * (uint8_t)(argb_cmyk >> 24);
-              dest_g_m += pixel_weight * (uint8_t)(argb_cmyk >> 16);
-              dest_r_y += pixel_weight * (uint8_t)(argb_cmyk >> 8);
-            }
+            uint32_t argb_cmyk = m_pSrcPalette[src_scan[j]];
+            dest_r_y += pixel_weight * (uint8_t)(argb_cmyk >> shift_r_y);
+            dest_g_m += pixel_weight * (uint8_t)(argb_cmyk >> shift_g_m);
+            dest_b_c += pixel_weight * (uint8_t)(argb_cmyk >> shift_b_c);
             dest_a += pixel_weight;
           }
           if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
@@ -604,19 +659,19 @@ FX_BOOL CStretchEngine::ContinueStretchHorz(IFX_Pause* pPause) {
       case 7: {
         for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
           PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+          const int* pWeight = m_WeightTable.GetWeights(pPixelWeights);
+          if (!pWeight)
+            return FALSE;
+
           int dest_r_y = 0, dest_g_m = 0, dest_b_c = 0;
+          const uint8_t* src_pixel = src_scan + pPixelWeights->m_SrcStart * Bpp;
           for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
                j++) {
-            int* pWeight =
-                m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return FALSE;
-
-            int pixel_weight = *pWeight;
-            const uint8_t* src_pixel = src_scan + j * Bpp;
-            dest_b_c += pixel_weight * (*src_pixel++);
-            dest_g_m += pixel_weight * (*src_pixel++);
-            dest_r_y += pixel_weight * (*src_pixel);
+            int pixel_weight = *pWeight++;
+            dest_b_c += pixel_weight * src_pixel[0];
+            dest_g_m += pixel_weight * src_pixel[1];
+            dest_r_y += pixel_weight * src_pixel[2];
+            src_pixel += Bpp;
           }
           if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
             dest_b_c =
@@ -634,27 +689,26 @@ FX_BOOL CStretchEngine::ContinueStretchHorz(IFX_Pause* pPause) {
         break;
       }
       case 8: {
+        // The alpha comes from the pixels themselves for ARGB and from the
+        // separate mask otherwise.
+        const bool bArgb = m_DestFormat == FXDIB_Argb;
         for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
           PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+          const int* pWeight = m_WeightTable.GetWeights(pPixelWeights);
+          if (!pWeight)
+            return FALSE;
+
           int dest_a = 0, dest_r_y = 0, dest_g_m = 0, dest_b_c = 0;
+          const uint8_t* src_pixel = src_scan + pPixelWeights->m_SrcStart * Bpp;
           for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
                j++) {
-            int* pWeight =
-                m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return FALSE;
-
-            int pixel_weight = *pWeight;
-            const uint8_t* src_pixel = src_scan + j * Bpp;
-            if (m_DestFormat == FXDIB_Argb) {
-              pixel_weight = pixel_weight * src_pixel[3] / 255;
-            } else {
-              pixel_weight = pixel_weight * src_scan_mask[j] / 255;
-            }
-            dest_b_c += pixel_weight * (*src_pixel++);
-            dest_g_m += pixel_weight * (*src_pixel++);
-            dest_r_y += pixel_weight * (*src_pixel);
+            int alpha = bArgb ? src_pixel[3] : src_scan_mask[j];
+            int pixel_weight = *pWeight++ * alpha / 255;
+            dest_b_c += pixel_weight * src_pixel[0];
+            dest_g_m += pixel_weight * src_pixel[1];
+            dest_r_y += pixel_weight * src_pixel[2];
             dest_a += pixel_weight;
+            src_pixel += Bpp;
           }
           if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
             dest_r_y =
@@ -668,7 +722,7 @@ FX_BOOL CStretchEngine::ContinueStretchHorz(IFX_Pause* pPause) {
           *dest_scan++ = (uint8_t)((dest_b_c) >> 16);
           *dest_scan++ = (uint8_t)((dest_g_m) >> 16);
           *dest_scan++ = (uint8_t)((dest_r_y) >> 16);
-          if (m_DestFormat == FXDIB_Argb) {
+          if (bArgb) {
             *dest_scan = (uint8_t)((dest_a * 255) >> 16);
           }
           if (dest_scan_mask) {
@@ -694,85 +748,77 @@ void CStretchEngine::StretchVert() {
   if (!ret)
     return;
 
+  // Each destination row is the weighted sum of whole intermediate rows, so
+  // the sums are built a row at a time in |sums|, and |mask_sums| for the
+  // separate alpha mask, and only then converted per pixel. This reads the
+  // intermediate buffer sequentially instead of one column at a time.
   const int DestBpp = m_DestBpp / 8;
+  const int dest_width = m_DestClip.Width();
+  const bool bArgb = m_DestFormat == FXDIB_Argb;
+  const bool bUseMask =
+      m_TransMethod == 4 ||
+      ((m_TransMethod == 6 || m_TransMethod == 8) && !bArgb);
+  std::vector<int> sums(dest_width * DestBpp);
+  std::vector<int> mask_sums(bUseMask ? dest_width : 0);
   for (int row = m_DestClip.top; row < m_DestClip.bottom; row++) {
+    PixelWeight* pPixelWeights = table.GetPixelWeight(row);
+    const int* pWeight = table.GetWeights(pPixelWeights);
+    if (!pWeight)
+      return;
+
+    std::fill(sums.begin(), sums.end(), 0);
+    std::fill(mask_sums.begin(), mask_sums.end(), 0);
+    for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
+         j++) {
+      int pixel_weight = *pWeight++;
+      AccumulateWeightedRow(m_pInterBuf + (j - m_SrcClip.top) * m_InterPitch,
+                            pixel_weight, sums.data(), sums.size());
+      if (bUseMask) {
+        AccumulateWeightedRow(
+            m_pExtraAlphaBuf + (j - m_SrcClip.top) * m_ExtraMaskPitch,
+            pixel_weight, mask_sums.data(), mask_sums.size());
+      }
+    }
+
     unsigned char* dest_scan = m_pDestScanline;
     unsigned char* dest_scan_mask = m_pDestMaskScanline;
-    PixelWeight* pPixelWeights = table.GetPixelWeight(row);
+    const int* src_sums = sums.data();
     switch (m_TransMethod) {
       case 1:
       case 2:
       case 3: {
-        for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
-          unsigned char* src_scan =
-              m_pInterBuf + (col - m_DestClip.left) * DestBpp;
-          int dest_a = 0;
-          for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
-               j++) {
-            int* pWeight = table.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return;
-
-            int pixel_weight = *pWeight;
-            dest_a +=
-                pixel_weight * src_scan[(j - m_SrcClip.top) * m_InterPitch];
-          }
+        for (int col = 0; col < dest_width; col++) {
+          int dest_a = src_sums[0];
           if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
             dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
           }
           *dest_scan = (uint8_t)(dest_a >> 16);
           dest_scan += DestBpp;
+          src_sums += DestBpp;
         }
         break;
       }
       case 4: {
-        for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
-          unsigned char* src_scan =
-              m_pInterBuf + (col - m_DestClip.left) * DestBpp;
-          unsigned char* src_scan_mask =
-              m_pExtraAlphaBuf + (col - m_DestClip.left);
-          int dest_a = 0, dest_k = 0;
-          for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
-               j++) {
-            int* pWeight = table.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return;
-
-            int pixel_weight = *pWeight;
-            dest_k +=
-                pixel_weight * src_scan[(j - m_SrcClip.top) * m_InterPitch];
-            dest_a += pixel_weight *
-                      src_scan_mask[(j - m_SrcClip.top) * m_ExtraMaskPitch];
-          }
+        for (int col = 0; col < dest_width; col++) {
+          int dest_k = src_sums[0];
+          int dest_a = mask_sums[col];
           if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
             dest_k = dest_k < 0 ? 0 : dest_k > 16711680 ? 16711680 : dest_k;
             dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
           }
           *dest_scan = (uint8_t)(dest_k >> 16);
           dest_scan += DestBpp;
+          src_sums += DestBpp;
           *dest_scan_mask++ = (uint8_t)(dest_a >> 16);
         }
         break;
       }
       case 5:
       case 7: {
-        for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
-          unsigned char* src_scan =
-              m_pInterBuf + (col - m_DestClip.left) * DestBpp;
-          int dest_r_y = 0, dest_g_m = 0, dest_b_c = 0;
-          for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
-               j++) {
-            int* pWeight = table.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return;
-
-            int pixel_weight = *pWeight;
-            const uint8_t* src_pixel =
-                src_scan + (j - m_SrcClip.top) * m_InterPitch;
-            dest_b_c += pixel_weight * (*src_pixel++);
-            dest_g_m += pixel_weight * (*src_pixel++);
-            dest_r_y += pixel_weight * (*src_pixel);
-          }
+        for (int col = 0; col < dest_width; col++) {
+          int dest_b_c = src_sums[0];
+          int dest_g_m = src_sums[1];
+          int dest_r_y = src_sums[2];
           if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
             dest_r_y =
                 dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
@@ -785,41 +831,17 @@ void CStretchEngine::StretchVert() {
           dest_scan[1] = (uint8_t)((dest_g_m) >> 16);
           dest_scan[2] = (uint8_t)((dest_r_y) >> 16);
           dest_scan += DestBpp;
+          src_sums += DestBpp;
         }
         break;
       }
       case 6:
       case 8: {
-        for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
-          unsigned char* src_scan =
-              m_pInterBuf + (col - m_DestClip.left) * DestBpp;
-          unsigned char* src_scan_mask = nullptr;
-          if (m_DestFormat != FXDIB_Argb) {
-            src_scan_mask = m_pExtraAlphaBuf + (col - m_DestClip.left);
-          }
-          int dest_a = 0, dest_r_y = 0, dest_g_m = 0, dest_b_c = 0;
-          for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
-               j++) {
-            int* pWeight = table.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return;
-
-            int pixel_weight = *pWeight;
-            const uint8_t* src_pixel =
-                src_scan + (j - m_SrcClip.top) * m_InterPitch;
-            int mask_v = 255;
-            if (src_scan_mask) {
-              mask_v = src_scan_mask[(j - m_SrcClip.top) * m_ExtraMaskPitch];
-            }
-            dest_b_c += pixel_weight * (*src_pixel++);
-            dest_g_m += pixel_weight * (*src_pixel++);
-            dest_r_y += pixel_weight * (*src_pixel);
-            if (m_DestFormat == FXDIB_Argb) {
-              dest_a += pixel_weight * (*(src_pixel + 1));
-            } else {
-              dest_a += pixel_weight * mask_v;
-            }
-          }
+        for (int col = 0; col < dest_width; col++) {
+          int dest_b_c = src_sums[0];
+          int dest_g_m = src_sums[1];
+          int dest_r_y = src_sums[2];
+          int dest_a = bArgb ? src_sums[3] : mask_sums[col];
           if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
             dest_r_y =
                 dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
@@ -837,12 +859,13 @@ void CStretchEngine::StretchVert() {
             dest_scan[1] = g > 255 ? 255 : g < 0 ? 0 : g;
             dest_scan[2] = r > 255 ? 255 : r < 0 ? 0 : r;
           }
-          if (m_DestFormat == FXDIB_Argb) {
+          if (bArgb) {
             dest_scan[3] = (uint8_t)((dest_a) >> 16);
           } else {
             *dest_scan_mask = (uint8_t)((dest_a) >> 16);
           }
           dest_scan += DestBpp;
+          src_sums += DestBpp;
           if (dest_scan_mask) {
             dest_scan_mask++;
           }
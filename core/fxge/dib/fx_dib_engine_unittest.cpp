@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include <memory>
+#include <vector>
 
 #include "core/fpdfapi/fpdf_parser/cpdf_dictionary.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_number.h"
@@ -28,3 +29,231 @@ TEST(CStretchEngine, OverflowInCtor) {
                         &dib_source, 0);
   EXPECT_EQ(FXDIB_INTERPOL, engine.m_Flags);
 }
+
+namespace {
+
+class ScanlineCollector : public IFX_ScanlineComposer {
+ public:
+  ScanlineCollector(int height, int pitch) : m_Rows(height), m_Pitch(pitch) {}
+
+  // IFX_ScanlineComposer:
+  void ComposeScanline(int line,
+                       const uint8_t* scanline,
+                       const uint8_t* scan_extra_alpha) override {
+    m_Rows[line].assign(scanline, scanline + m_Pitch);
+  }
+  FX_BOOL SetInfo(int width,
+                  int height,
+                  FXDIB_Format src_format,
+                  uint32_t* pSrcPalette) override {
+    return TRUE;
+  }
+
+  std::vector<std::vector<uint8_t>> m_Rows;
+  int m_Pitch;
+};
+
+int ClampSum(int value, int max) {
+  return value < 0 ? 0 : value > max ? max : value;
+}
+
+// Per-pixel two-pass stretch with the same fixed point arithmetic as
+// CStretchEngine, using the clip and flags the engine settled on. Only the
+// formats the test stretches are handled.
+std::vector<std::vector<uint8_t>> ReferenceStretch(
+    const CFX_DIBitmap& source,
+    const CStretchEngine& engine) {
+  const FXDIB_Format format = source.GetFormat();
+  const int Bpp = source.GetBPP() / 8;
+  const int channels = format == FXDIB_8bppMask ? 1 : 3;
+  const bool bAlpha = format == FXDIB_Argb;
+  const bool bBicubic = !!(engine.m_Flags & FXDIB_BICUBIC_INTERPOL);
+  const FX_RECT& dest_clip = engine.m_DestClip;
+  const FX_RECT& src_clip = engine.m_SrcClip;
+  const int width = dest_clip.Width();
+
+  CWeightTable horz;
+  EXPECT_TRUE(horz.Calc(engine.m_DestWidth, dest_clip.left, dest_clip.right,
+                        engine.m_SrcWidth, src_clip.left, src_clip.right,
+                        engine.m_Flags));
+  std::vector<std::vector<uint8_t>> inter(src_clip.Height(),
+                                          std::vector<uint8_t>(width * Bpp));
+  for (int row = src_clip.top; row < src_clip.bottom; ++row) {
+    const uint8_t* src_scan = source.GetScanline(row);
+    uint8_t* dest_scan = inter[row - src_clip.top].data();
+    for (int col = dest_clip.left; col < dest_clip.right; ++col) {
+      PixelWeight* pWeights = horz.GetPixelWeight(col);
+      int sums[4] = {0, 0, 0, 0};
+      for (int j = pWeights->m_SrcStart; j <= pWeights->m_SrcEnd; ++j) {
+        int weight = *horz.GetValueFromPixelWeight(pWeights, j);
+        const uint8_t* src_pixel = src_scan + j * Bpp;
+        if (bAlpha)
+          weight = weight * src_pixel[3] / 255;
+        for (int i = 0; i < channels; ++i)
+          sums[i] += weight * src_pixel[i];
+        sums[3] += weight;
+      }
+      uint8_t* dest_pixel = dest_scan + (col - dest_clip.left) * Bpp;
+      if (bBicubic) {
+        for (int i = 0; i < channels; ++i)
+          sums[i] = ClampSum(sums[i], 16711680);
+        sums[3] = ClampSum(sums[3], 65536);
+      }
+      for (int i = 0; i < channels; ++i)
+        dest_pixel[i] = sums[i] >> 16;
+      if (bAlpha)
+        dest_pixel[3] = (sums[3] * 255) >> 16;
+    }
+  }
+
+  CWeightTable vert;
+  EXPECT_TRUE(vert.Calc(engine.m_DestHeight, dest_clip.top, dest_clip.bottom,
+                        engine.m_SrcHeight, src_clip.top, src_clip.bottom,
+                        engine.m_Flags));
+  std::vector<std::vector<uint8_t>> result;
+  // Like the engine, keep the color of the previous row where a pixel ends up
+  // fully transparent, and leave the padding byte of Rgb32 at 255.
+  std::vector<uint8_t> dest_scan(width * Bpp, format == FXDIB_Rgb32 ? 255 : 0);
+  for (int row = dest_clip.top; row < dest_clip.bottom; ++row) {
+    PixelWeight* pWeights = vert.GetPixelWeight(row);
+    for (int col = 0; col < width; ++col) {
+      int sums[4] = {0, 0, 0, 0};
+      for (int j = pWeights->m_SrcStart; j <= pWeights->m_SrcEnd; ++j) {
+        int weight = *vert.GetValueFromPixelWeight(pWeights, j);
+        const uint8_t* src_pixel = inter[j - src_clip.top].data() + col * Bpp;
+        for (int i = 0; i < channels; ++i)
+          sums[i] += weight * src_pixel[i];
+        if (bAlpha)
+          sums[3] += weight * src_pixel[3];
+      }
+      uint8_t* dest_pixel = dest_scan.data() + col * Bpp;
+      if (bBicubic) {
+        for (int i = 0; i < 4; ++i)
+          sums[i] = ClampSum(sums[i], 16711680);
+      }
+      if (!bAlpha) {
+        for (int i = 0; i < channels; ++i)
+          dest_pixel[i] = sums[i] >> 16;
+        continue;
+      }
+      if (sums[3]) {
+        for (int i = 0; i < 3; ++i) {
+          dest_pixel[i] = static_cast<uint8_t>(
+              ClampSum(static_cast<uint32_t>(sums[i]) * 255 / sums[3], 255));
+        }
+      }
+      dest_pixel[3] = sums[3] >> 16;
+    }
+    result.push_back(dest_scan);
+  }
+  return result;
+}
+
+void FillGradient(CFX_DIBitmap* bitmap) {
+  int Bpp = bitmap->GetBPP() / 8;
+  int width = bitmap->GetWidth();
+  int height = bitmap->GetHeight();
+  for (int row = 0; row < height; ++row) {
+    uint8_t* scan = bitmap->GetBuffer() + row * bitmap->GetPitch();
+    for (int col = 0; col < width; ++col) {
+      for (int i = 0; i < Bpp; ++i) {
+        int value = i % 2 ? col * 255 / (width - 1) : row * 255 / (height - 1);
+        scan[col * Bpp + i] = static_cast<uint8_t>(i == 3 ? 255 - value / 2
+                                                          : value);
+      }
+    }
+  }
+}
+
+void FillNoise(CFX_DIBitmap* bitmap) {
+  int Bpp = bitmap->GetBPP() / 8;
+  uint32_t seed = 12345;
+  for (int row = 0; row < bitmap->GetHeight(); ++row) {
+    uint8_t* scan = bitmap->GetBuffer() + row * bitmap->GetPitch();
+    for (int col = 0; col < bitmap->GetWidth() * Bpp; ++col) {
+      seed = seed * 1103515245 + 12345;
+      uint8_t value = static_cast<uint8_t>(seed >> 16);
+      // Keep alpha away from 0 so that no pixel's color depends on what the
+      // destination scanline held before.
+      scan[col] = col % Bpp == 3 ? 64 + value % 192 : value;
+    }
+  }
+}
+
+}  // namespace
+
+TEST(CStretchEngine, MatchesReference) {
+  const FXDIB_Format kFormats[] = {FXDIB_8bppMask, FXDIB_Rgb, FXDIB_Rgb32,
+                                   FXDIB_Argb};
+  const uint32_t kFlags[] = {0, FXDIB_INTERPOL, FXDIB_BICUBIC_INTERPOL};
+  const int kSizes[][2] = {
+      {37, 23}, {19, 7}, {203, 101}, {-91, 45}, {503, 29}, {61, 400}};
+  for (FXDIB_Format format : kFormats) {
+    for (int pattern = 0; pattern < 2; ++pattern) {
+      CFX_DIBitmap source;
+      ASSERT_TRUE(source.Create(157, 113, format));
+      if (pattern)
+        FillNoise(&source);
+      else
+        FillGradient(&source);
+      for (uint32_t flags : kFlags) {
+        for (const auto& size : kSizes) {
+          int width = FXSYS_abs(size[0]);
+          int height = FXSYS_abs(size[1]);
+          ScanlineCollector collector(height, width * source.GetBPP() / 8);
+          CStretchEngine engine(&collector, format, size[0], size[1],
+                                FX_RECT(0, 0, width, height), &source, flags);
+          ASSERT_TRUE(engine.StartStretchHorz());
+          engine.Continue(nullptr);
+          std::vector<std::vector<uint8_t>> expected =
+              ReferenceStretch(source, engine);
+          ASSERT_EQ(expected.size(), collector.m_Rows.size());
+          for (int row = 0; row < height; ++row) {
+            ASSERT_EQ(expected[row], collector.m_Rows[row])
+                << "format " << format << " pattern " << pattern << " flags "
+                << flags << " size " << size[0] << "x" << size[1] << " row "
+                << row;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(CStretchEngine, FlatColor) {
+  const FXDIB_Format kFormats[] = {FXDIB_8bppMask, FXDIB_Rgb, FXDIB_Rgb32,
+                                   FXDIB_Argb};
+  const uint32_t kFlags[] = {0, FXDIB_INTERPOL, FXDIB_BICUBIC_INTERPOL};
+  const int kSizes[][2] = {{37, 23}, {203, 101}, {-91, 45}};
+  const uint8_t kPixel[] = {30, 140, 250, 200};
+  for (FXDIB_Format format : kFormats) {
+    CFX_DIBitmap source;
+    ASSERT_TRUE(source.Create(157, 113, format));
+    int Bpp = source.GetBPP() / 8;
+    for (int row = 0; row < source.GetHeight(); ++row) {
+      uint8_t* scan = source.GetBuffer() + row * source.GetPitch();
+      for (int col = 0; col < source.GetWidth(); ++col)
+        memcpy(scan + col * Bpp, kPixel, Bpp);
+    }
+    int channels = format == FXDIB_Rgb32 ? 3 : Bpp;
+    for (uint32_t flags : kFlags) {
+      for (const auto& size : kSizes) {
+        std::unique_ptr<CFX_DIBitmap> dest(
+            source.StretchTo(size[0], size[1], flags));
+        ASSERT_TRUE(dest);
+        ASSERT_EQ(format, dest->GetFormat());
+        for (int row = 0; row < dest->GetHeight(); ++row) {
+          const uint8_t* scan = dest->GetScanline(row);
+          for (int col = 0; col < dest->GetWidth(); ++col) {
+            for (int i = 0; i < channels; ++i) {
+              // Rounded weights may not add up to exactly 1, and each pass
+              // truncates.
+              EXPECT_NEAR(kPixel[i], scan[col * Bpp + i], 2)
+                  << format << " " << flags << " " << row << " " << col;
+            }
+          }
+        }
+      }
+    }
+  }
+}
@@ -136,7 +136,7 @@ FX_ARGB ArgbEncode(int a, FX_COLORREF rgb);
   *((uint8_t*)(dest) + 2) = *((uint8_t*)(src) + 2), \
   *((uint8_t*)(dest) + 3) = *((uint8_t*)(src) + 3)
 #define FXARGB_SETRGBORDERDIB(p, argb)          \
-  ((uint8_t*)(p))[3] = (uint8_t)(argb >> 24),   \
+  ((uint8_t*)(p))[3] = (uint8_t)((argb) >> 24), \
   ((uint8_t*)(p))[0] = (uint8_t)((argb) >> 16), \
   ((uint8_t*)(p))[1] = (uint8_t)((argb) >> 8),  \
   ((uint8_t*)(p))[2] = (uint8_t)(argb)
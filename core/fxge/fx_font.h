@@ -151,6 +151,10 @@ class CFX_Font {
   int GetULthickness() const;
   int GetMaxAdvanceWidth() const;
   FX_BOOL IsEmbedded() const { return m_bEmbedded; }
+  // Whether the face is shared with other fonts through
+  // CFX_EmbeddedFontRegistry, which means that another font may change its
+  // state, such as the selected charmap, at any time.
+  bool IsShared() const { return m_bShared; }
   uint8_t* GetSubData() const { return m_pGsubData; }
   void SetSubData(uint8_t* data) { m_pGsubData = data; }
 #if _FXM_PLATFORM_ == _FXM_PLATFORM_APPLE_
@@ -199,6 +203,7 @@ class CFX_Font {
   void* m_pPlatformFont;
 #endif
   bool m_bEmbedded;
+  bool m_bShared;
   bool m_bVertical;
 };
 
@@ -0,0 +1,114 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#include "core/fxge/ge/cfx_embeddedfontregistry.h"
+
+#include <iterator>
+#include <utility>
+
+#include "core/fxge/cfx_fontcache.h"
+#include "core/fxge/cfx_fontmgr.h"
+#include "core/fxge/ge/cfx_persistentglyphcache.h"
+
+CFX_EmbeddedFontRegistry::CFX_EmbeddedFontRegistry(CFX_FontMgr* pFontMgr,
+                                                   CFX_FontCache* pFontCache,
+                                                   size_t unused_budget)
+    : m_pFontMgr(pFontMgr),
+      m_pFontCache(pFontCache),
+      m_nUnusedBudget(unused_budget),
+      m_nSize(0),
+      m_nUnusedSize(0),
+      m_nHits(0),
+      m_nMisses(0) {}
+
+CFX_EmbeddedFontRegistry::~CFX_EmbeddedFontRegistry() {
+  for (const auto& pair : m_Entries) {
+    if (m_pFontCache)
+      m_pFontCache->ReleaseFaceCache(pair.second->m_Face);
+    FXFT_Done_Face(pair.second->m_Face);
+  }
+}
+
+FXFT_Face CFX_EmbeddedFontRegistry::Acquire(const uint8_t* pData,
+                                            uint32_t size,
+                                            uint8_t** pSharedData) {
+  // The hash only narrows down the candidates; the bytes are compared, so
+  // that a collision can never hand out the wrong font.
+  uint64_t hash = CFX_PersistentGlyphCache::HashData(pData, size);
+  auto range = m_Entries.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    Entry* pEntry = it->second.get();
+    if (pEntry->m_Data.size() != size ||
+        FXSYS_memcmp(pEntry->m_Data.data(), pData, size) != 0) {
+      continue;
+    }
+    if (pEntry->m_RefCount == 0) {
+      m_Unused.erase(pEntry->m_UnusedPos);
+      m_nUnusedSize -= size;
+    }
+    pEntry->m_RefCount++;
+    m_nHits++;
+    *pSharedData = pEntry->m_Data.data();
+    return pEntry->m_Face;
+  }
+
+  m_nMisses++;
+  std::unique_ptr<Entry> pEntry(new Entry);
+  pEntry->m_Hash = hash;
+  pEntry->m_Data.assign(pData, pData + size);
+  pEntry->m_Face = m_pFontMgr->GetFixedFace(pEntry->m_Data.data(), size, 0);
+  if (!pEntry->m_Face)
+    return nullptr;
+
+  if (m_pFontCache)
+    m_pFontCache->RetainFaceCache(pEntry->m_Face);
+  pEntry->m_RefCount = 1;
+  m_nSize += size;
+  m_FaceEntries[pEntry->m_Face] = pEntry.get();
+  *pSharedData = pEntry->m_Data.data();
+  FXFT_Face face = pEntry->m_Face;
+  m_Entries.insert(std::make_pair(hash, std::move(pEntry)));
+  return face;
+}
+
+void CFX_EmbeddedFontRegistry::Release(FXFT_Face face) {
+  auto it = m_FaceEntries.find(face);
+  if (it == m_FaceEntries.end())
+    return;
+
+  Entry* pEntry = it->second;
+  if (--pEntry->m_RefCount > 0)
+    return;
+
+  m_Unused.push_back(pEntry);
+  pEntry->m_UnusedPos = std::prev(m_Unused.end());
+  m_nUnusedSize += pEntry->m_Data.size();
+  Trim();
+}
+
+void CFX_EmbeddedFontRegistry::Trim() {
+  while (m_nUnusedSize > m_nUnusedBudget) {
+    Entry* pEntry = m_Unused.front();
+    m_Unused.pop_front();
+    m_nUnusedSize -= pEntry->m_Data.size();
+    Erase(pEntry);
+  }
+}
+
+void CFX_EmbeddedFontRegistry::Erase(Entry* pEntry) {
+  m_FaceEntries.erase(pEntry->m_Face);
+  m_nSize -= pEntry->m_Data.size();
+  if (m_pFontCache)
+    m_pFontCache->ReleaseFaceCache(pEntry->m_Face);
+  FXFT_Done_Face(pEntry->m_Face);
+  auto range = m_Entries.equal_range(pEntry->m_Hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second.get() == pEntry) {
+      m_Entries.erase(it);
+      return;
+    }
+  }
+}
@@ -0,0 +1,81 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#ifndef CORE_FXGE_GE_CFX_EMBEDDEDFONTREGISTRY_H_
+#define CORE_FXGE_GE_CFX_EMBEDDEDFONTREGISTRY_H_
+
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "core/fxge/fx_font.h"
+
+class CFX_FontCache;
+class CFX_FontMgr;
+
+// Faces of embedded font programs, shared by every font whose program has the
+// same bytes, whichever document it comes from. Documents produced by the
+// same generator tend to embed identical subsets, which then take one copy
+// of the program, one FreeType face and one CFX_FaceCache between them.
+//
+// Faces are reference counted. Once the last reference is released, a face
+// is kept for later documents until the programs of such unused faces take
+// more than the budget, at which point the least recently used are freed.
+// Every face holds on to its CFX_FaceCache in |pFontCache| until then, so the
+// glyphs rendered for an unused face are still there when it is used again.
+class CFX_EmbeddedFontRegistry {
+ public:
+  // |pFontCache| may be null, in which case glyphs are only shared while the
+  // face is in use.
+  CFX_EmbeddedFontRegistry(CFX_FontMgr* pFontMgr,
+                           CFX_FontCache* pFontCache,
+                           size_t unused_budget);
+  ~CFX_EmbeddedFontRegistry();
+
+  // Returns a face for the |size| bytes at |pData|, with a reference that has
+  // to be released with Release(), or nullptr if FreeType cannot load it.
+  // |*pSharedData| receives the copy of the program that the face reads,
+  // which lives as long as the face.
+  FXFT_Face Acquire(const uint8_t* pData,
+                    uint32_t size,
+                    uint8_t** pSharedData);
+  void Release(FXFT_Face face);
+
+  uint32_t GetHitCount() const { return m_nHits; }
+  uint32_t GetMissCount() const { return m_nMisses; }
+  // The size of the programs of all faces, in use or not.
+  size_t GetSize() const { return m_nSize; }
+  size_t GetUnusedSize() const { return m_nUnusedSize; }
+
+ private:
+  struct Entry {
+    uint64_t m_Hash;
+    std::vector<uint8_t> m_Data;
+    FXFT_Face m_Face;
+    int m_RefCount;
+    // Position in |m_Unused| while |m_RefCount| is zero.
+    std::list<Entry*>::iterator m_UnusedPos;
+  };
+
+  void Trim();
+  void Erase(Entry* pEntry);
+
+  CFX_FontMgr* const m_pFontMgr;
+  CFX_FontCache* const m_pFontCache;
+  const size_t m_nUnusedBudget;
+  // Keyed by the hash of the program.
+  std::multimap<uint64_t, std::unique_ptr<Entry>> m_Entries;
+  std::map<FXFT_Face, Entry*> m_FaceEntries;
+  // Unused entries, least recently used first.
+  std::list<Entry*> m_Unused;
+  size_t m_nSize;
+  size_t m_nUnusedSize;
+  uint32_t m_nHits;
+  uint32_t m_nMisses;
+};
+
+#endif  // CORE_FXGE_GE_CFX_EMBEDDEDFONTREGISTRY_H_
@@ -0,0 +1,151 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxge/ge/cfx_embeddedfontregistry.h"
+
+#include <memory>
+#include <vector>
+
+#include "core/fxge/cfx_fontcache.h"
+#include "core/fxge/cfx_fontmgr.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+class CFX_EmbeddedFontRegistryTest : public testing::Test {
+ public:
+  void SetUp() override {
+    m_pFontMgr.reset(new CFX_FontMgr);
+    m_pFontCache.reset(new CFX_FontCache);
+  }
+
+  void TearDown() override {
+    m_pRegistry.reset();
+    m_pFontCache.reset();
+    m_pFontMgr.reset();
+  }
+
+  void CreateRegistry(size_t unused_budget) {
+    m_pRegistry.reset(new CFX_EmbeddedFontRegistry(
+        m_pFontMgr.get(), m_pFontCache.get(), unused_budget));
+  }
+
+  // Returns a private copy of a built-in font, the way a document would hold
+  // the decoded program of an embedded font.
+  std::vector<uint8_t> GetProgram(size_t index) {
+    const uint8_t* pFontData = nullptr;
+    uint32_t size = 0;
+    EXPECT_TRUE(m_pFontMgr->GetBuiltinFont(index, &pFontData, &size));
+    return std::vector<uint8_t>(pFontData, pFontData + size);
+  }
+
+  FXFT_Face Acquire(const std::vector<uint8_t>& program) {
+    uint8_t* pSharedData = nullptr;
+    FXFT_Face face =
+        m_pRegistry->Acquire(program.data(), program.size(), &pSharedData);
+    if (face) {
+      EXPECT_NE(program.data(), pSharedData);
+      EXPECT_EQ(0, FXSYS_memcmp(program.data(), pSharedData, program.size()));
+    }
+    return face;
+  }
+
+ protected:
+  std::unique_ptr<CFX_FontMgr> m_pFontMgr;
+  std::unique_ptr<CFX_FontCache> m_pFontCache;
+  std::unique_ptr<CFX_EmbeddedFontRegistry> m_pRegistry;
+};
+
+}  // namespace
+
+TEST_F(CFX_EmbeddedFontRegistryTest, SharesIdenticalPrograms) {
+  CreateRegistry(0);
+  std::vector<uint8_t> program1 = GetProgram(0);
+  std::vector<uint8_t> program2 = GetProgram(0);
+  std::vector<uint8_t> other = GetProgram(1);
+  FXFT_Face face1 = Acquire(program1);
+  ASSERT_TRUE(face1);
+  EXPECT_EQ(face1, Acquire(program2));
+  FXFT_Face face2 = Acquire(other);
+  ASSERT_TRUE(face2);
+  EXPECT_NE(face1, face2);
+  EXPECT_EQ(1u, m_pRegistry->GetHitCount());
+  EXPECT_EQ(2u, m_pRegistry->GetMissCount());
+  EXPECT_EQ(program1.size() + other.size(), m_pRegistry->GetSize());
+
+  // The face stays until its last user lets go.
+  m_pRegistry->Release(face1);
+  EXPECT_EQ(program1.size() + other.size(), m_pRegistry->GetSize());
+  m_pRegistry->Release(face1);
+  m_pRegistry->Release(face2);
+  EXPECT_EQ(0u, m_pRegistry->GetSize());
+  EXPECT_EQ(0u, m_pRegistry->GetUnusedSize());
+}
+
+TEST_F(CFX_EmbeddedFontRegistryTest, SameSizeOtherBytes) {
+  CreateRegistry(0);
+  std::vector<uint8_t> program = GetProgram(0);
+  FXFT_Face face1 = Acquire(program);
+  ASSERT_TRUE(face1);
+  // Flip a byte of the glyph data, well past the table directory.
+  program[program.size() / 2] ^= 1;
+  FXFT_Face face2 = Acquire(program);
+  EXPECT_NE(face1, face2);
+  EXPECT_EQ(0u, m_pRegistry->GetHitCount());
+  m_pRegistry->Release(face1);
+  m_pRegistry->Release(face2);
+}
+
+TEST_F(CFX_EmbeddedFontRegistryTest, EvictsLeastRecentlyUsed) {
+  std::vector<uint8_t> program1 = GetProgram(0);
+  std::vector<uint8_t> program2 = GetProgram(1);
+  // Room for one of the two programs once both are unused.
+  CreateRegistry(program1.size() + program2.size() - 1);
+  FXFT_Face face1 = Acquire(program1);
+  FXFT_Face face2 = Acquire(program2);
+  ASSERT_TRUE(face1);
+  ASSERT_TRUE(face2);
+  m_pRegistry->Release(face1);
+  EXPECT_EQ(program1.size(), m_pRegistry->GetUnusedSize());
+  m_pRegistry->Release(face2);
+  EXPECT_EQ(program2.size(), m_pRegistry->GetUnusedSize());
+  EXPECT_EQ(program2.size(), m_pRegistry->GetSize());
+
+  // The unused face is handed out again; the evicted one is loaded anew.
+  EXPECT_EQ(face2, Acquire(program2));
+  EXPECT_EQ(0u, m_pRegistry->GetUnusedSize());
+  EXPECT_EQ(1u, m_pRegistry->GetHitCount());
+  FXFT_Face face3 = Acquire(program1);
+  ASSERT_TRUE(face3);
+  EXPECT_EQ(3u, m_pRegistry->GetMissCount());
+  m_pRegistry->Release(face2);
+  m_pRegistry->Release(face3);
+}
+
+TEST_F(CFX_EmbeddedFontRegistryTest, KeepsFaceCacheWhileUnused) {
+  std::vector<uint8_t> program = GetProgram(0);
+  CreateRegistry(program.size());
+  FXFT_Face face = Acquire(program);
+  ASSERT_TRUE(face);
+  // The last font using the face renders with its cache and goes away.
+  CFX_FaceCache* face_cache = m_pFontCache->RetainFaceCache(face);
+  ASSERT_TRUE(face_cache);
+  m_pFontCache->ReleaseFaceCache(face);
+  m_pRegistry->Release(face);
+  EXPECT_EQ(program.size(), m_pRegistry->GetUnusedSize());
+
+  // A later document gets the unused face back with the same cache.
+  EXPECT_EQ(face, Acquire(program));
+  EXPECT_EQ(face_cache, m_pFontCache->RetainFaceCache(face));
+  m_pFontCache->ReleaseFaceCache(face);
+  m_pRegistry->Release(face);
+}
+
+TEST_F(CFX_EmbeddedFontRegistryTest, BadProgram) {
+  CreateRegistry(1024 * 1024);
+  std::vector<uint8_t> program(1000, 'x');
+  EXPECT_FALSE(Acquire(program));
+  EXPECT_EQ(0u, m_pRegistry->GetSize());
+  EXPECT_EQ(1u, m_pRegistry->GetMissCount());
+}
@@ -25,6 +25,48 @@ namespace {
 
 constexpr uint32_t kInvalidGlyphIndex = static_cast<uint32_t>(-1);
 
+// Fonts without a usable table directory are hashed in full, up to this size.
+const uint32_t kMaxFullyHashedFontSize = 256 * 1024;
+
+// Computes the identity of face |face_index| of the font program in |pData|
+// for persistent glyph keys. For TrueType and OpenType fonts that is the
+// table directory, whose records hold the length and checksum of every table,
+// so the cost does not grow with the glyph count. Subsetters that leave the
+// checksums zero defeat that, so such fonts are treated like those without a
+// directory. Returns false if identifying the font would mean hashing more
+// than kMaxFullyHashedFontSize bytes.
+bool HashFontProgram(const uint8_t* pData,
+                     uint32_t size,
+                     int face_index,
+                     uint64_t* pHash) {
+  uint32_t dir_offset = 0;
+  if (size >= 12 && GET_TT_LONG(pData) == 0x74746366 && face_index >= 0 &&
+      static_cast<uint32_t>(face_index) < GET_TT_LONG(pData + 8) &&
+      static_cast<uint32_t>(face_index) < (size - 12) / 4) {
+    dir_offset = GET_TT_LONG(pData + 12 + 4 * face_index);
+  }
+  if (size >= 12 && dir_offset <= size - 12) {
+    const uint8_t* pDir = pData + dir_offset;
+    uint32_t version = GET_TT_LONG(pDir);
+    uint32_t num_tables = GET_TT_SHORT(pDir + 4);
+    uint32_t dir_size = 12 + 16 * num_tables;
+    bool bValid = (version == 0x00010000 || version == 0x74727565 ||
+                   version == 0x4f54544f) &&
+                  num_tables > 0 && dir_size <= size - dir_offset;
+    for (uint32_t i = 0; bValid && i < num_tables; ++i)
+      bValid = GET_TT_LONG(pDir + 12 + 16 * i + 4) != 0;
+    if (bValid) {
+      *pHash = CFX_PersistentGlyphCache::HashData(pDir, dir_size);
+      return true;
+    }
+  }
+  if (size > kMaxFullyHashedFontSize)
+    return false;
+
+  *pHash = CFX_PersistentGlyphCache::HashData(pData, size);
+  return true;
+}
+
 void GammaAdjust(uint8_t* pData,
                  int nHeight,
                  int src_pitch,
@@ -75,7 +117,10 @@ void ContrastAdjust(uint8_t* pDataIn,
 }  // namespace
 
 CFX_FaceCache::CFX_FaceCache(FXFT_Face face)
-    : m_Face(face)
+    : m_Face(face),
+      m_FontHash(0),
+      m_bFontHashed(false),
+      m_bFontPersistable(false)
 #ifdef _SKIA_SUPPORT_
       ,
       m_pTypeface(nullptr)
@@ -384,8 +429,76 @@ CFX_GlyphBitmap* CFX_FaceCache::LookUpGlyphBitmap(
   if (it2 != pSizeCache->m_GlyphMap.end())
     return it2->second;
 
+  CFX_PersistentGlyphCache* pGlyphCache = CFX_GEModule::Get()->GetGlyphCache();
+  CFX_PersistentGlyphCache::Key key;
+  bool bPersistent =
+      pGlyphCache && GetPersistentKey(pFont, glyph_index, bFontStyle, pMatrix,
+                                      dest_width, anti_alias, &key);
+  if (bPersistent) {
+    std::unique_ptr<CFX_GlyphBitmap> pCached = pGlyphCache->Lookup(key);
+    if (pCached) {
+      pSizeCache->m_GlyphMap[glyph_index] = pCached.get();
+      return pCached.release();
+    }
+  }
+
   CFX_GlyphBitmap* pGlyphBitmap = RenderGlyph(pFont, glyph_index, bFontStyle,
                                               pMatrix, dest_width, anti_alias);
   pSizeCache->m_GlyphMap[glyph_index] = pGlyphBitmap;
+  if (bPersistent && pGlyphBitmap)
+    pGlyphCache->Add(key, *pGlyphBitmap);
   return pGlyphBitmap;
 }
+
+bool CFX_FaceCache::GetPersistentKey(const CFX_Font* pFont,
+                                     uint32_t glyph_index,
+                                     FX_BOOL bFontStyle,
+                                     const CFX_Matrix* pMatrix,
+                                     int dest_width,
+                                     int anti_alias,
+                                     CFX_PersistentGlyphCache::Key* pKey) {
+  if (!m_Face || !pFont->GetFontData())
+    return false;
+
+  if (!m_bFontHashed) {
+    m_bFontPersistable = HashFontProgram(pFont->GetFontData(), pFont->GetSize(),
+                                         m_Face->face_index, &m_FontHash);
+    m_bFontHashed = true;
+  }
+  if (!m_bFontPersistable)
+    return false;
+
+  pKey->font_hash = m_FontHash;
+  pKey->font_size = pFont->GetSize();
+  pKey->face_index = static_cast<uint32_t>(m_Face->face_index);
+  pKey->glyph_index = glyph_index;
+  // Same quantization as the keys of |m_SizeMap|.
+  pKey->matrix[0] = static_cast<int32_t>(pMatrix->a * 10000);
+  pKey->matrix[1] = static_cast<int32_t>(pMatrix->b * 10000);
+  pKey->matrix[2] = static_cast<int32_t>(pMatrix->c * 10000);
+  pKey->matrix[3] = static_cast<int32_t>(pMatrix->d * 10000);
+  pKey->dest_width = dest_width;
+  pKey->anti_alias = anti_alias;
+
+  // Mirror the substitution adjustments made by RenderGlyph().
+  const CFX_SubstFont* pSubstFont = pFont->GetSubstFont();
+  if (pSubstFont) {
+    bool bUseCJKSubFont = pSubstFont->m_bSubstCJK && bFontStyle;
+    pKey->flags |= 1;
+    if (bUseCJKSubFont) {
+      pKey->flags |= 2;
+      pKey->weight = pSubstFont->m_WeightCJK;
+      pKey->italic_angle = pSubstFont->m_bItalicCJK ? 1 : 0;
+    } else {
+      pKey->weight = pSubstFont->m_Weight;
+      pKey->italic_angle = pSubstFont->m_ItalicAngle;
+    }
+    if (pSubstFont->m_SubstFlags & FXFONT_SUBST_MM)
+      pKey->flags |= 4;
+    if (pSubstFont->m_Charset == FXFONT_SHIFTJIS_CHARSET)
+      pKey->flags |= 8;
+    if (pFont->IsVertical())
+      pKey->flags |= 16;
+  }
+  return true;
+}
@@ -8,7 +8,7 @@
 
 #include "core/fxge/cfx_fontmapper.h"
 #include "core/fxge/fx_font.h"
-
+#include "core/fxge/ge/cfx_fontindex.h"
 #include "third_party/base/stl_util.h"
 
 namespace {
@@ -108,14 +108,36 @@ void CFX_FolderFontInfo::AddPath(const CFX_ByteStringC& path) {
   m_PathList.push_back(CFX_ByteString(path));
 }
 
+void CFX_FolderFontInfo::SetIndexPath(const CFX_ByteString& path) {
+  m_IndexPath = path;
+}
+
 FX_BOOL CFX_FolderFontInfo::EnumFontList(CFX_FontMapper* pMapper) {
   m_pMapper = pMapper;
+  if (!m_IndexPath.IsEmpty()) {
+    CFX_FontIndex index(m_PathList);
+    if (index.Load(m_IndexPath)) {
+      for (const CFX_FontFaceInfo& face : index.GetFaces())
+        AddFace(new CFX_FontFaceInfo(face));
+      return TRUE;
+    }
+    m_pIndex.reset(new CFX_FontIndex(m_PathList));
+  }
   for (const auto& path : m_PathList)
     ScanPath(path);
+  if (m_pIndex) {
+    m_pIndex->Save(m_IndexPath);
+    m_pIndex.reset();
+  }
   return TRUE;
 }
 
 void CFX_FolderFontInfo::ScanPath(const CFX_ByteString& path) {
+  // Folders that are missing are recorded too, so that creating them later
+  // invalidates the index.
+  if (m_pIndex)
+    m_pIndex->AddStamp(path);
+
   void* handle = FX_OpenFolder(path.c_str());
   if (!handle)
     return;
@@ -147,6 +169,9 @@ void CFX_FolderFontInfo::ScanPath(const CFX_ByteString& path) {
 }
 
 void CFX_FolderFontInfo::ScanFile(const CFX_ByteString& path) {
+  if (m_pIndex)
+    m_pIndex->AddStamp(path);
+
   FXSYS_FILE* pFile = FXSYS_fopen(path.c_str(), "rb");
   if (!pFile)
     return;
@@ -226,28 +251,17 @@ void CFX_FolderFontInfo::ReportFace(const CFX_ByteString& path,
   if (os2.GetLength() >= 86) {
     const uint8_t* p = os2.raw_str() + 78;
     uint32_t codepages = GET_TT_LONG(p);
-    if (codepages & (1 << 17)) {
-      m_pMapper->AddInstalledFont(facename, FXFONT_SHIFTJIS_CHARSET);
+    if (codepages & (1 << 17))
       pInfo->m_Charsets |= CHARSET_FLAG_SHIFTJIS;
-    }
-    if (codepages & (1 << 18)) {
-      m_pMapper->AddInstalledFont(facename, FXFONT_GB2312_CHARSET);
+    if (codepages & (1 << 18))
       pInfo->m_Charsets |= CHARSET_FLAG_GB;
-    }
-    if (codepages & (1 << 20)) {
-      m_pMapper->AddInstalledFont(facename, FXFONT_CHINESEBIG5_CHARSET);
+    if (codepages & (1 << 20))
       pInfo->m_Charsets |= CHARSET_FLAG_BIG5;
-    }
-    if ((codepages & (1 << 19)) || (codepages & (1 << 21))) {
-      m_pMapper->AddInstalledFont(facename, FXFONT_HANGUL_CHARSET);
+    if ((codepages & (1 << 19)) || (codepages & (1 << 21)))
       pInfo->m_Charsets |= CHARSET_FLAG_KOREAN;
-    }
-    if (codepages & (1 << 31)) {
-      m_pMapper->AddInstalledFont(facename, FXFONT_SYMBOL_CHARSET);
+    if (codepages & (1 << 31))
       pInfo->m_Charsets |= CHARSET_FLAG_SYMBOL;
-    }
   }
-  m_pMapper->AddInstalledFont(facename, FXFONT_ANSI_CHARSET);
   pInfo->m_Charsets |= CHARSET_FLAG_ANSI;
   pInfo->m_Styles = 0;
   if (style.Find("Bold") > -1)
@@ -257,7 +271,30 @@ void CFX_FolderFontInfo::ReportFace(const CFX_ByteString& path,
   if (facename.Find("Serif") > -1)
     pInfo->m_Styles |= FXFONT_SERIF;
 
+  AddFace(pInfo);
+}
+
+void CFX_FolderFontInfo::AddFace(CFX_FontFaceInfo* pInfo) {
+  const CFX_ByteString& facename = pInfo->m_FaceName;
+  if (pdfium::ContainsKey(m_FontList, facename)) {
+    delete pInfo;
+    return;
+  }
+
+  if (pInfo->m_Charsets & CHARSET_FLAG_SHIFTJIS)
+    m_pMapper->AddInstalledFont(facename, FXFONT_SHIFTJIS_CHARSET);
+  if (pInfo->m_Charsets & CHARSET_FLAG_GB)
+    m_pMapper->AddInstalledFont(facename, FXFONT_GB2312_CHARSET);
+  if (pInfo->m_Charsets & CHARSET_FLAG_BIG5)
+    m_pMapper->AddInstalledFont(facename, FXFONT_CHINESEBIG5_CHARSET);
+  if (pInfo->m_Charsets & CHARSET_FLAG_KOREAN)
+    m_pMapper->AddInstalledFont(facename, FXFONT_HANGUL_CHARSET);
+  if (pInfo->m_Charsets & CHARSET_FLAG_SYMBOL)
+    m_pMapper->AddInstalledFont(facename, FXFONT_SYMBOL_CHARSET);
+  m_pMapper->AddInstalledFont(facename, FXFONT_ANSI_CHARSET);
   m_FontList[facename] = pInfo;
+  if (m_pIndex)
+    m_pIndex->AddFace(*pInfo);
 }
 
 void* CFX_FolderFontInfo::GetSubstFont(const CFX_ByteString& face) {
@@ -8,18 +8,24 @@
 #define CORE_FXGE_GE_CFX_FOLDERFONTINFO_H_
 
 #include <map>
+#include <memory>
 #include <vector>
 
 #include "core/fxge/cfx_fontmapper.h"
 #include "core/fxge/fx_font.h"
 #include "core/fxge/ifx_systemfontinfo.h"
 
+class CFX_FontIndex;
+
 class CFX_FolderFontInfo : public IFX_SystemFontInfo {
  public:
   CFX_FolderFontInfo();
   ~CFX_FolderFontInfo() override;
 
   void AddPath(const CFX_ByteStringC& path);
+  // Makes EnumFontList() take the fonts from the index file at |path| when
+  // the font folders did not change, and update it when they did.
+  void SetIndexPath(const CFX_ByteString& path);
 
   // IFX_SytemFontInfo:
   FX_BOOL EnumFontList(CFX_FontMapper* pMapper) override;
@@ -51,6 +57,7 @@ class CFX_FolderFontInfo : public IFX_SystemFontInfo {
                   FXSYS_FILE* pFile,
                   uint32_t filesize,
                   uint32_t offset);
+  void AddFace(CFX_FontFaceInfo* pInfo);
   void* GetSubstFont(const CFX_ByteString& face);
   void* FindFont(int weight,
                  FX_BOOL bItalic,
@@ -62,6 +69,9 @@ class CFX_FolderFontInfo : public IFX_SystemFontInfo {
   std::map<CFX_ByteString, CFX_FontFaceInfo*> m_FontList;
   std::vector<CFX_ByteString> m_PathList;
   CFX_FontMapper* m_pMapper;
+  CFX_ByteString m_IndexPath;
+  // Collects what ScanPath() finds, while the index file is being rebuilt.
+  std::unique_ptr<CFX_FontIndex> m_pIndex;
 };
 
 #endif  // CORE_FXGE_GE_CFX_FOLDERFONTINFO_H_
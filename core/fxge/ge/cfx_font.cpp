@@ -14,6 +14,7 @@
 #include "core/fxge/cfx_pathdata.h"
 #include "core/fxge/cfx_substfont.h"
 #include "core/fxge/fx_freetype.h"
+#include "core/fxge/ge/cfx_embeddedfontregistry.h"
 #include "core/fxge/ge/fx_text_int.h"
 
 #define EM_ADJUST(em, a) (em == 0 ? (a) : (a)*1000 / em)
@@ -234,6 +235,7 @@ CFX_Font::CFX_Font()
       m_pPlatformFont(nullptr),
 #endif
       m_bEmbedded(false),
+      m_bShared(false),
       m_bVertical(false) {
 }
 
@@ -257,6 +259,7 @@ FX_BOOL CFX_Font::LoadClone(const CFX_Font* pFont) {
   }
   m_Face = pFont->m_Face;
   m_bEmbedded = pFont->m_bEmbedded;
+  m_bShared = pFont->m_bShared;
   m_bVertical = pFont->m_bVertical;
   m_dwSize = pFont->m_dwSize;
   m_pFontData = pFont->m_pFontData;
@@ -302,7 +305,9 @@ CFX_Font::~CFX_Font() {
 
 void CFX_Font::DeleteFace() {
   ClearFaceCache();
-  if (m_bEmbedded) {
+  if (m_bShared) {
+    CFX_GEModule::Get()->GetEmbeddedFontRegistry()->Release(m_Face);
+  } else if (m_bEmbedded) {
     FXFT_Done_Face(m_Face);
   } else {
     CFX_GEModule::Get()->GetFontMgr()->ReleaseFace(m_Face);
@@ -367,6 +372,16 @@ int CFX_Font::GetGlyphWidth(uint32_t glyph_index) {
 }
 
 FX_BOOL CFX_Font::LoadEmbedded(const uint8_t* data, uint32_t size) {
+  CFX_EmbeddedFontRegistry* pRegistry =
+      CFX_GEModule::Get()->GetEmbeddedFontRegistry();
+  if (pRegistry) {
+    m_Face = pRegistry->Acquire(data, size, &m_pFontData);
+    m_bEmbedded = true;
+    m_bShared = !!m_Face;
+    m_dwSize = size;
+    return !!m_Face;
+  }
+
   std::vector<uint8_t> temp(data, data + size);
   m_pFontDataAllocation.swap(temp);
   m_Face = FT_LoadFont(m_pFontDataAllocation.data(), size);
@@ -22,7 +22,10 @@ CFX_FontCache::~CFX_FontCache() {
 }
 
 CFX_FaceCache* CFX_FontCache::GetCachedFace(const CFX_Font* pFont) {
-  FXFT_Face face = pFont->GetFace();
+  return RetainFaceCache(pFont->GetFace());
+}
+
+CFX_FaceCache* CFX_FontCache::RetainFaceCache(FXFT_Face face) {
   const bool bExternal = !face;
   CFX_FTCacheMap& map = bExternal ? m_ExtFaceMap : m_FTFaceMap;
   auto it = map.find(face);
@@ -47,7 +50,10 @@ CFX_TypeFace* CFX_FontCache::GetDeviceCache(const CFX_Font* pFont) {
 #endif
 
 void CFX_FontCache::ReleaseCachedFace(const CFX_Font* pFont) {
-  FXFT_Face face = pFont->GetFace();
+  ReleaseFaceCache(pFont->GetFace());
+}
+
+void CFX_FontCache::ReleaseFaceCache(FXFT_Face face) {
   const bool bExternal = !face;
   CFX_FTCacheMap& map = bExternal ? m_ExtFaceMap : m_FTFaceMap;
 
@@ -0,0 +1,264 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#include "core/fxge/ge/cfx_fontindex.h"
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <memory>
+
+#include "core/fxcrt/fx_basic.h"
+#include "core/fxcrt/fx_stream.h"
+
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+#include <process.h>
+#define FXSYS_getpid _getpid
+#else
+#include <unistd.h>
+#define FXSYS_getpid getpid
+#endif
+
+// The file starts with a FileHeader, followed by the root folders, the
+// stamps and the faces. Strings are stored as their length followed by their
+// bytes. All values are in native byte order; the file is only meant to be
+// shared between processes on one machine.
+
+namespace {
+
+const char kMagic[8] = {'P', 'D', 'F', 'F', 'O', 'N', 'T', 'S'};
+const uint32_t kVersion = 1;
+
+// Stamps of folders and files that do not exist.
+const int64_t kMissing = -1;
+// Stamps that were taken too recently to tell whether anything changed in the
+// same second. They never match, so the next process scans again.
+const int64_t kUnknown = -2;
+
+// The smallest sizes of a stamp and a face in the file, to reject counts that
+// cannot possibly fit before allocating for them.
+const size_t kMinStampSize = 4 + 8 + 8;
+const size_t kMinFaceSize = 4 * 3 + 4 * 4;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t root_count;
+  uint32_t stamp_count;
+  uint32_t face_count;
+};
+
+class IndexReader {
+ public:
+  IndexReader(const uint8_t* pData, size_t size)
+      : m_pData(pData), m_nSize(size), m_nPos(0) {}
+
+  size_t GetRemaining() const { return m_nSize - m_nPos; }
+
+  bool Read(void* pBuf, size_t size) {
+    if (size > GetRemaining())
+      return false;
+    FXSYS_memcpy(pBuf, m_pData + m_nPos, size);
+    m_nPos += size;
+    return true;
+  }
+
+  template <typename T>
+  bool ReadValue(T* value) {
+    return Read(value, sizeof(T));
+  }
+
+  bool ReadString(CFX_ByteString* str) {
+    uint32_t length;
+    if (!ReadValue(&length) || length > GetRemaining())
+      return false;
+    *str = CFX_ByteString(m_pData + m_nPos, length);
+    m_nPos += length;
+    return true;
+  }
+
+ private:
+  const uint8_t* const m_pData;
+  const size_t m_nSize;
+  size_t m_nPos;
+};
+
+template <typename T>
+void AppendValue(CFX_BinaryBuf* pBuf, T value) {
+  pBuf->AppendBlock(&value, sizeof(T));
+}
+
+void AppendString(CFX_BinaryBuf* pBuf, const CFX_ByteString& str) {
+  AppendValue<uint32_t>(pBuf, str.GetLength());
+  pBuf->AppendString(str);
+}
+
+}  // namespace
+
+CFX_FontIndex::CFX_FontIndex(const std::vector<CFX_ByteString>& roots)
+    : m_Roots(roots) {}
+
+CFX_FontIndex::~CFX_FontIndex() {}
+
+// static
+CFX_FontIndex::Stamp CFX_FontIndex::GetStamp(const CFX_ByteString& path) {
+  Stamp stamp = {path, kMissing, kMissing};
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+  struct _stat64 st;
+  if (_stat64(path.c_str(), &st) == 0) {
+#else
+  struct stat st;
+  if (stat(path.c_str(), &st) == 0) {
+#endif
+    stamp.m_MTime = st.st_mtime;
+    stamp.m_Size = st.st_size;
+  }
+  return stamp;
+}
+
+void CFX_FontIndex::AddStamp(const CFX_ByteString& path) {
+  m_Stamps.push_back(GetStamp(path));
+}
+
+void CFX_FontIndex::AddFace(const CFX_FontFaceInfo& face) {
+  m_Faces.push_back(face);
+}
+
+bool CFX_FontIndex::Load(const CFX_ByteString& path) {
+  m_Stamps.clear();
+  m_Faces.clear();
+  std::unique_ptr<IFX_FileRead, ReleaseDeleter<IFX_FileRead>> pFile(
+      FX_CreateFileRead(path.c_str()));
+  if (!pFile)
+    return false;
+
+  size_t size = static_cast<size_t>(pFile->GetSize());
+  const uint8_t* pData = pFile->GetDirectBuffer();
+  std::vector<uint8_t> buffer;
+  if (!pData) {
+    buffer.resize(size);
+    if (!size || !pFile->ReadBlock(buffer.data(), 0, size))
+      return false;
+    pData = buffer.data();
+  }
+
+  IndexReader reader(pData, size);
+  FileHeader header;
+  if (!reader.ReadValue(&header) ||
+      FXSYS_memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion || header.root_count != m_Roots.size()) {
+    return false;
+  }
+  for (const CFX_ByteString& root : m_Roots) {
+    CFX_ByteString recorded;
+    if (!reader.ReadString(&recorded) || recorded != root)
+      return false;
+  }
+
+  if (header.stamp_count > reader.GetRemaining() / kMinStampSize)
+    return false;
+  // Check every stamp before reading the faces, as the point of the index is
+  // that this is much cheaper than opening the fonts.
+  std::vector<Stamp> stamps;
+  stamps.reserve(header.stamp_count);
+  for (uint32_t i = 0; i < header.stamp_count; i++) {
+    Stamp recorded;
+    if (!reader.ReadString(&recorded.m_Path) ||
+        !reader.ReadValue(&recorded.m_MTime) ||
+        !reader.ReadValue(&recorded.m_Size)) {
+      return false;
+    }
+    Stamp current = GetStamp(recorded.m_Path);
+    if (recorded.m_MTime != current.m_MTime ||
+        recorded.m_Size != current.m_Size) {
+      return false;
+    }
+    stamps.push_back(recorded);
+  }
+
+  if (header.face_count > reader.GetRemaining() / kMinFaceSize)
+    return false;
+  std::vector<CFX_FontFaceInfo> faces;
+  faces.reserve(header.face_count);
+  for (uint32_t i = 0; i < header.face_count; i++) {
+    CFX_ByteString file_path;
+    CFX_ByteString face_name;
+    CFX_ByteString font_tables;
+    uint32_t font_offset;
+    uint32_t file_size;
+    uint32_t styles;
+    uint32_t charsets;
+    if (!reader.ReadString(&file_path) || !reader.ReadString(&face_name) ||
+        !reader.ReadString(&font_tables) || !reader.ReadValue(&font_offset) ||
+        !reader.ReadValue(&file_size) || !reader.ReadValue(&styles) ||
+        !reader.ReadValue(&charsets)) {
+      return false;
+    }
+    faces.push_back(CFX_FontFaceInfo(file_path, face_name, font_tables,
+                                     font_offset, file_size));
+    faces.back().m_Styles = styles;
+    faces.back().m_Charsets = charsets;
+  }
+  m_Stamps.swap(stamps);
+  m_Faces.swap(faces);
+  return true;
+}
+
+bool CFX_FontIndex::Save(const CFX_ByteString& path) const {
+  FileHeader header;
+  FXSYS_memset(&header, 0, sizeof(header));
+  FXSYS_memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.root_count = m_Roots.size();
+  header.stamp_count = m_Stamps.size();
+  header.face_count = m_Faces.size();
+
+  CFX_BinaryBuf buf;
+  AppendValue(&buf, header);
+  for (const CFX_ByteString& root : m_Roots)
+    AppendString(&buf, root);
+  const int64_t now = time(nullptr);
+  for (const Stamp& stamp : m_Stamps) {
+    AppendString(&buf, stamp.m_Path);
+    AppendValue(&buf, stamp.m_MTime >= now - 1 ? kUnknown : stamp.m_MTime);
+    AppendValue(&buf, stamp.m_Size);
+  }
+  for (const CFX_FontFaceInfo& face : m_Faces) {
+    AppendString(&buf, face.m_FilePath);
+    AppendString(&buf, face.m_FaceName);
+    AppendString(&buf, face.m_FontTables);
+    AppendValue(&buf, face.m_FontOffset);
+    AppendValue(&buf, face.m_FileSize);
+    AppendValue(&buf, face.m_Styles);
+    AppendValue(&buf, face.m_Charsets);
+  }
+
+  // Write to a file of our own first, so that readers never see a partially
+  // written index.
+  CFX_ByteString temp_path = path;
+  temp_path += ".";
+  temp_path += CFX_ByteString::FormatInteger(FXSYS_getpid());
+  temp_path += ".tmp";
+  std::unique_ptr<IFX_FileStream, ReleaseDeleter<IFX_FileStream>> pOut(
+      FX_CreateFileStream(temp_path.c_str(), FX_FILEMODE_Truncate));
+  if (!pOut)
+    return false;
+
+  bool bWritten = pOut->WriteBlock(buf.GetBuffer(), 0, buf.GetSize()) &&
+                  pOut->Flush();
+  pOut.reset();
+  if (bWritten && rename(temp_path.c_str(), path.c_str()) != 0) {
+    // Windows does not replace existing files.
+    remove(path.c_str());
+    bWritten = rename(temp_path.c_str(), path.c_str()) == 0;
+  }
+  if (!bWritten) {
+    remove(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
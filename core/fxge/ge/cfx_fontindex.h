@@ -0,0 +1,57 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#ifndef CORE_FXGE_GE_CFX_FONTINDEX_H_
+#define CORE_FXGE_GE_CFX_FONTINDEX_H_
+
+#include <vector>
+
+#include "core/fxcrt/fx_string.h"
+#include "core/fxge/fx_font.h"
+
+// The faces that CFX_FolderFontInfo found in a set of font folders, stored in
+// a file so that later processes can skip opening every font file.
+//
+// Along with the faces, the index records the modification time and size of
+// every folder and font file that was scanned. The index is only loaded if
+// none of them changed since, so adding, removing or replacing a font makes
+// the next process scan again.
+class CFX_FontIndex {
+ public:
+  // |roots| are the folders that are scanned. An index for other folders is
+  // ignored.
+  explicit CFX_FontIndex(const std::vector<CFX_ByteString>& roots);
+  ~CFX_FontIndex();
+
+  // Records the current state of the folder or file at |path|, which need not
+  // exist.
+  void AddStamp(const CFX_ByteString& path);
+  // Faces are kept in the order they are added.
+  void AddFace(const CFX_FontFaceInfo& face);
+
+  // Replaces the contents with those of the file at |path|. Returns false if
+  // the file is missing or broken, or if any recorded folder or file changed.
+  bool Load(const CFX_ByteString& path);
+  // Returns false if the file could not be written.
+  bool Save(const CFX_ByteString& path) const;
+
+  const std::vector<CFX_FontFaceInfo>& GetFaces() const { return m_Faces; }
+
+ private:
+  struct Stamp {
+    CFX_ByteString m_Path;
+    int64_t m_MTime;
+    int64_t m_Size;
+  };
+
+  static Stamp GetStamp(const CFX_ByteString& path);
+
+  const std::vector<CFX_ByteString> m_Roots;
+  std::vector<Stamp> m_Stamps;
+  std::vector<CFX_FontFaceInfo> m_Faces;
+};
+
+#endif  // CORE_FXGE_GE_CFX_FONTINDEX_H_
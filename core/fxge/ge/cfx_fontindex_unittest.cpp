@@ -0,0 +1,168 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxge/ge/cfx_fontindex.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/utils/path_service.h"
+
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+#include <sys/utime.h>
+#define FXSYS_utime _utime
+#define FXSYS_utimbuf _utimbuf
+#else
+#include <utime.h>
+#define FXSYS_utime utime
+#define FXSYS_utimbuf utimbuf
+#endif
+
+namespace {
+
+CFX_ByteString GetTestPath(const char* name) {
+  std::string path;
+  EXPECT_TRUE(PathService::GetExecutableDir(&path));
+  if (!PathService::EndsWithSeparator(path))
+    path.push_back(PATH_SEPARATOR);
+  path.append(name);
+  return CFX_ByteString(path.c_str());
+}
+
+// Writes |size| bytes to |path|, dated an hour ago. Files changed within the
+// last second are never trusted by the index.
+void WriteFile(const CFX_ByteString& path, size_t size) {
+  FILE* file = fopen(path.c_str(), "wb");
+  ASSERT_TRUE(file);
+  std::vector<char> data(size, 'x');
+  fwrite(data.data(), 1, data.size(), file);
+  fclose(file);
+  struct FXSYS_utimbuf times;
+  times.actime = times.modtime = time(nullptr) - 3600;
+  ASSERT_EQ(0, FXSYS_utime(path.c_str(), &times));
+}
+
+CFX_FontFaceInfo MakeFace(const CFX_ByteString& path,
+                          const char* name,
+                          uint32_t offset) {
+  const char kTables[] = "OS/2\0\0\0\0\0\0\0\x10\0\0\0\x20";
+  CFX_FontFaceInfo face(path, name, CFX_ByteString(kTables, 16), offset,
+                        1000);
+  face.m_Styles = FXFONT_BOLD;
+  face.m_Charsets = CHARSET_FLAG_ANSI | CHARSET_FLAG_GB;
+  return face;
+}
+
+class CFX_FontIndexTest : public testing::Test {
+ public:
+  void SetUp() override {
+    m_IndexPath = GetTestPath("cfx_fontindex_unittest.idx");
+    m_FontPath = GetTestPath("cfx_fontindex_unittest.ttc");
+    m_MissingPath = GetTestPath("cfx_fontindex_unittest_missing.ttf");
+    m_Roots.push_back("/fonts");
+    m_Roots.push_back("/more/fonts");
+    remove(m_IndexPath.c_str());
+    remove(m_MissingPath.c_str());
+    WriteFile(m_FontPath, 1000);
+  }
+
+  void TearDown() override {
+    remove(m_IndexPath.c_str());
+    remove(m_FontPath.c_str());
+    remove(m_MissingPath.c_str());
+  }
+
+  void SaveIndex() {
+    CFX_FontIndex index(m_Roots);
+    index.AddStamp(m_FontPath);
+    index.AddStamp(m_MissingPath);
+    index.AddFace(MakeFace(m_FontPath, "Sans Bold", 12));
+    index.AddFace(MakeFace(m_FontPath, "Sans Light", 512));
+    EXPECT_TRUE(index.Save(m_IndexPath));
+  }
+
+ protected:
+  CFX_ByteString m_IndexPath;
+  CFX_ByteString m_FontPath;
+  CFX_ByteString m_MissingPath;
+  std::vector<CFX_ByteString> m_Roots;
+};
+
+}  // namespace
+
+TEST_F(CFX_FontIndexTest, RoundTrip) {
+  SaveIndex();
+  CFX_FontIndex index(m_Roots);
+  ASSERT_TRUE(index.Load(m_IndexPath));
+  const std::vector<CFX_FontFaceInfo>& faces = index.GetFaces();
+  ASSERT_EQ(2u, faces.size());
+  EXPECT_EQ(m_FontPath, faces[0].m_FilePath);
+  EXPECT_EQ("Sans Bold", faces[0].m_FaceName);
+  EXPECT_EQ("Sans Light", faces[1].m_FaceName);
+  EXPECT_EQ(CFX_ByteString("OS/2\0\0\0\0\0\0\0\x10\0\0\0\x20", 16),
+            faces[1].m_FontTables);
+  EXPECT_EQ(12u, faces[0].m_FontOffset);
+  EXPECT_EQ(512u, faces[1].m_FontOffset);
+  EXPECT_EQ(1000u, faces[1].m_FileSize);
+  EXPECT_EQ(static_cast<uint32_t>(FXFONT_BOLD), faces[1].m_Styles);
+  EXPECT_EQ(CHARSET_FLAG_ANSI | CHARSET_FLAG_GB, faces[1].m_Charsets);
+}
+
+TEST_F(CFX_FontIndexTest, OtherRoots) {
+  SaveIndex();
+  m_Roots.pop_back();
+  CFX_FontIndex index(m_Roots);
+  EXPECT_FALSE(index.Load(m_IndexPath));
+  EXPECT_TRUE(index.GetFaces().empty());
+}
+
+TEST_F(CFX_FontIndexTest, ChangedFile) {
+  SaveIndex();
+  WriteFile(m_FontPath, 2000);
+  CFX_FontIndex index(m_Roots);
+  EXPECT_FALSE(index.Load(m_IndexPath));
+}
+
+TEST_F(CFX_FontIndexTest, AddedFile) {
+  SaveIndex();
+  WriteFile(m_MissingPath, 10);
+  CFX_FontIndex index(m_Roots);
+  EXPECT_FALSE(index.Load(m_IndexPath));
+}
+
+TEST_F(CFX_FontIndexTest, RecentFile) {
+  // The file may still change within the second it was stamped in.
+  FILE* file = fopen(m_FontPath.c_str(), "ab");
+  ASSERT_TRUE(file);
+  fputc('x', file);
+  fclose(file);
+  SaveIndex();
+  CFX_FontIndex index(m_Roots);
+  EXPECT_FALSE(index.Load(m_IndexPath));
+}
+
+TEST_F(CFX_FontIndexTest, BadFile) {
+  SaveIndex();
+  FILE* file = fopen(m_IndexPath.c_str(), "rb");
+  ASSERT_TRUE(file);
+  std::vector<char> data(4096);
+  size_t size = fread(data.data(), 1, data.size(), file);
+  fclose(file);
+  ASSERT_LT(0u, size);
+  ASSERT_GT(data.size(), size);
+
+  // Every truncation of the file is rejected.
+  for (size_t i = 0; i < size; i++) {
+    file = fopen(m_IndexPath.c_str(), "wb");
+    ASSERT_TRUE(file);
+    fwrite(data.data(), 1, i, file);
+    fclose(file);
+    CFX_FontIndex index(m_Roots);
+    EXPECT_FALSE(index.Load(m_IndexPath)) << " at " << i;
+  }
+}
@@ -6,6 +6,7 @@
 
 #include "core/fxge/cfx_fontmapper.h"
 
+#include <chrono>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -192,6 +193,35 @@ CFX_ByteString TT_NormalizeName(const FX_CHAR* family) {
   return norm;
 }
 
+// Returns the name that FindSubstFont() looks for.
+CFX_ByteString GetSubstName(const CFX_ByteString& name, FX_BOOL bTrueType) {
+  CFX_ByteString SubstName = name;
+  SubstName.Remove(' ');
+  if (bTrueType && name[0] == '@')
+    SubstName = name.Mid(1);
+  PDF_GetStandardFontName(&SubstName);
+  return SubstName;
+}
+
+CFX_ByteString KeyNameFromSubst(const CFX_ByteString& subst_name,
+                                FX_BOOL bTrueType,
+                                uint32_t flags,
+                                int weight,
+                                int italic_angle,
+                                int CharsetCP) {
+  CFX_ByteString key;
+  key.Format("%d:%u:%d:%d:%d:", bTrueType ? 1 : 0, flags, weight,
+             italic_angle, CharsetCP);
+  key += subst_name;
+  return key;
+}
+
+double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
 uint8_t GetCharsetFromCodePage(uint16_t codepage) {
   const CODEPAGE_MAP* pEnd =
       g_Codepage2CharsetTable + FX_ArraySize(g_Codepage2CharsetTable);
@@ -278,13 +308,21 @@ void UpdatePitchFamily(uint32_t flags, int& PitchFamily) {
 }  // namespace
 
 CFX_FontMapper::CFX_FontMapper(CFX_FontMgr* mgr)
-    : m_bListLoaded(FALSE), m_pFontMgr(mgr) {
+    : m_bListLoaded(FALSE),
+      m_pFontMgr(mgr),
+      m_nSubstCacheHits(0),
+      m_nSubstCacheMisses(0),
+      m_SubstCacheSavedMs(0),
+      m_SubstCacheFaceBytes(0),
+      m_SubstCacheFaceBudget(kMaxSubstCacheFaceBytes) {
   m_MMFaces[0] = nullptr;
   m_MMFaces[1] = nullptr;
   FXSYS_memset(m_FoxitFaces, 0, sizeof(m_FoxitFaces));
 }
 
 CFX_FontMapper::~CFX_FontMapper() {
+  // The references held by |m_SubstCache| are not released here, as
+  // |m_pFontMgr| destroys its cached faces before the mapper.
   for (size_t i = 0; i < FX_ArraySize(m_FoxitFaces); ++i) {
     if (m_FoxitFaces[i])
       FXFT_Done_Face(m_FoxitFaces[i]);
@@ -301,6 +339,7 @@ void CFX_FontMapper::SetSystemFontInfo(
     return;
 
   m_pFontInfo = std::move(pFontInfo);
+  ClearSubstCache();
 }
 
 CFX_ByteString CFX_FontMapper::GetPSNameFromTT(void* hFont) {
@@ -433,11 +472,79 @@ FXFT_Face CFX_FontMapper::FindSubstFont(const CFX_ByteString& name,
     weight = FXFONT_FW_NORMAL;
     italic_angle = 0;
   }
-  CFX_ByteString SubstName = name;
-  SubstName.Remove(' ');
-  if (bTrueType && name[0] == '@')
-    SubstName = name.Mid(1);
-  PDF_GetStandardFontName(&SubstName);
+  CFX_ByteString key =
+      KeyNameFromSubst(GetSubstName(name, bTrueType), bTrueType, flags, weight,
+                       italic_angle, WindowCP);
+  auto it = m_SubstCache.find(key);
+  if (it != m_SubstCache.end()) {
+    const SubstCacheEntry& entry = it->second;
+    m_nSubstCacheHits++;
+    m_SubstCacheSavedMs += entry.m_Milliseconds;
+    if (entry.m_Face && !IsBuiltinFace(entry.m_Face))
+      m_pFontMgr->RetainFace(entry.m_Face);
+    *pSubstFont = entry.m_SubstFont;
+    return entry.m_Face;
+  }
+
+  m_nSubstCacheMisses++;
+  // The installed fonts are listed once whether or not lookups are cached,
+  // so that is not counted as part of what later hits save.
+  LoadInstalledFonts();
+  auto start = std::chrono::steady_clock::now();
+  SubstCacheEntry entry;
+  entry.m_Face = FindSubstFontUncached(name, bTrueType, flags, weight,
+                                       italic_angle, WindowCP,
+                                       &entry.m_SubstFont);
+  entry.m_Milliseconds = MillisecondsSince(start);
+  *pSubstFont = entry.m_SubstFont;
+  size_t face_bytes = GetNewSubstCacheFaceBytes(entry.m_Face);
+  if (face_bytes > m_SubstCacheFaceBudget)
+    return entry.m_Face;
+
+  if (m_SubstCache.size() >= kMaxSubstCacheSize ||
+      m_SubstCacheFaceBytes + face_bytes > m_SubstCacheFaceBudget) {
+    ClearSubstCache();
+    face_bytes = GetNewSubstCacheFaceBytes(entry.m_Face);
+  }
+  if (entry.m_Face && !IsBuiltinFace(entry.m_Face))
+    m_pFontMgr->RetainFace(entry.m_Face);
+  m_SubstCacheFaceBytes += face_bytes;
+  m_SubstCache[key] = entry;
+  return entry.m_Face;
+}
+
+void CFX_FontMapper::ClearSubstCache() {
+  for (const auto& pair : m_SubstCache) {
+    FXFT_Face face = pair.second.m_Face;
+    if (face && !IsBuiltinFace(face))
+      m_pFontMgr->ReleaseFace(face);
+  }
+  m_SubstCache.clear();
+  m_SubstCacheFaceBytes = 0;
+}
+
+size_t CFX_FontMapper::GetNewSubstCacheFaceBytes(FXFT_Face face) const {
+  if (!face || IsBuiltinFace(face))
+    return 0;
+  for (const auto& pair : m_SubstCache) {
+    if (pair.second.m_Face == face)
+      return 0;
+  }
+  return FXFT_Get_Face_Stream_Size(face);
+}
+
+FXFT_Face CFX_FontMapper::FindSubstFontUncached(const CFX_ByteString& name,
+                                                FX_BOOL bTrueType,
+                                                uint32_t flags,
+                                                int weight,
+                                                int italic_angle,
+                                                int WindowCP,
+                                                CFX_SubstFont* pSubstFont) {
+  if (!(flags & FXFONT_USEEXTERNATTR)) {
+    weight = FXFONT_FW_NORMAL;
+    italic_angle = 0;
+  }
+  CFX_ByteString SubstName = GetSubstName(name, bTrueType);
   if (SubstName == "Symbol" && !bTrueType) {
     pSubstFont->m_Family = "Chrome Symbol";
     pSubstFont->m_Charset = FXFONT_SYMBOL_CHARSET;
@@ -668,8 +775,9 @@ FXFT_Face CFX_FontMapper::FindSubstFont(const CFX_ByteString& name,
         }
 #endif
         pSubstFont->m_SubstFlags |= FXFONT_SUBST_NONSYMBOL;
-        return FindSubstFont(family, bTrueType, flags & ~FXFONT_SYMBOLIC,
-                             weight, italic_angle, 0, pSubstFont);
+        return FindSubstFontUncached(family, bTrueType,
+                                     flags & ~FXFONT_SYMBOLIC, weight,
+                                     italic_angle, 0, pSubstFont);
       }
       if (Charset == FXFONT_ANSI_CHARSET) {
         pSubstFont->m_SubstFlags |= FXFONT_SUBST_STANDARD;
@@ -0,0 +1,245 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxge/cfx_fontmapper.h"
+
+#include <memory>
+#include <vector>
+
+#include "core/fxge/cfx_fontmgr.h"
+#include "core/fxge/cfx_substfont.h"
+#include "core/fxge/ifx_systemfontinfo.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// Installs two of the built-in fonts as system fonts named "Sans" and
+// "Serif", and counts how often the mapper asks for a font.
+class TestSystemFontInfo : public IFX_SystemFontInfo {
+ public:
+  explicit TestSystemFontInfo(CFX_FontMgr* pFontMgr)
+      : m_pFontMgr(pFontMgr), m_nMapFontCalls(0) {}
+
+  FX_BOOL EnumFontList(CFX_FontMapper* pMapper) override {
+    pMapper->AddInstalledFont("Sans", FXFONT_ANSI_CHARSET);
+    pMapper->AddInstalledFont("Serif", FXFONT_ANSI_CHARSET);
+    return TRUE;
+  }
+
+  void* MapFont(int weight,
+                FX_BOOL bItalic,
+                int charset,
+                int pitch_family,
+                const FX_CHAR* face,
+                int& iExact) override {
+    m_nMapFontCalls++;
+    return GetFont(face);
+  }
+
+  void* GetFont(const FX_CHAR* face) override {
+    CFX_ByteStringC name(face);
+    if (name == "Sans")
+      return reinterpret_cast<void*>(4);
+    if (name == "Serif")
+      return reinterpret_cast<void*>(8);
+    return nullptr;
+  }
+
+  uint32_t GetFontData(void* hFont,
+                       uint32_t table,
+                       uint8_t* buffer,
+                       uint32_t size) override {
+    if (table != 0)
+      return 0;
+    const uint8_t* pFontData = nullptr;
+    uint32_t font_size = 0;
+    if (!m_pFontMgr->GetBuiltinFont(reinterpret_cast<size_t>(hFont),
+                                    &pFontData, &font_size)) {
+      return 0;
+    }
+    if (buffer && size >= font_size)
+      FXSYS_memcpy(buffer, pFontData, font_size);
+    return font_size;
+  }
+
+  FX_BOOL GetFaceName(void* hFont, CFX_ByteString& name) override {
+    name = reinterpret_cast<size_t>(hFont) == 4 ? "Sans" : "Serif";
+    return TRUE;
+  }
+
+  FX_BOOL GetFontCharset(void* hFont, int& charset) override {
+    charset = FXFONT_ANSI_CHARSET;
+    return TRUE;
+  }
+
+  void DeleteFont(void* hFont) override {}
+
+  int GetMapFontCalls() const { return m_nMapFontCalls; }
+
+ private:
+  CFX_FontMgr* const m_pFontMgr;
+  int m_nMapFontCalls;
+};
+
+struct SubstRequest {
+  const char* name;
+  FX_BOOL bTrueType;
+  uint32_t flags;
+  int weight;
+  int italic_angle;
+  int CharsetCP;
+};
+
+const SubstRequest kRequests[] = {
+    {"Sans", TRUE, 0, 0, 0, 0},
+    {"Sans,Bold", TRUE, 0, 0, 0, 0},
+    {"Serif-Italic", FALSE, FXFONT_SERIF, 0, 0, 0},
+    {"Serif", TRUE, FXFONT_USEEXTERNATTR, 700, -12, 0},
+    {"Arial", FALSE, FXFONT_FIXED_PITCH, 0, 0, 0},
+    {"Unknown", FALSE, FXFONT_SERIF | FXFONT_ITALIC, 0, 0, 0},
+    {"Unknown", FALSE, FXFONT_SYMBOLIC, 0, 0, 0},
+    {"Symbol", FALSE, 0, 0, 0, 0},
+    {"Unknown", FALSE, 0, 0, 0, 936},
+};
+
+void ExpectSameSubst(const CFX_SubstFont& expected,
+                     const CFX_SubstFont& actual) {
+  EXPECT_EQ(expected.m_Family, actual.m_Family);
+  EXPECT_EQ(expected.m_Charset, actual.m_Charset);
+  EXPECT_EQ(expected.m_SubstFlags, actual.m_SubstFlags);
+  EXPECT_EQ(expected.m_Weight, actual.m_Weight);
+  EXPECT_EQ(expected.m_ItalicAngle, actual.m_ItalicAngle);
+  EXPECT_EQ(expected.m_bSubstCJK, actual.m_bSubstCJK);
+  EXPECT_EQ(expected.m_WeightCJK, actual.m_WeightCJK);
+  EXPECT_EQ(expected.m_bItalicCJK, actual.m_bItalicCJK);
+}
+
+class CFX_FontMapperTest : public testing::Test {
+ public:
+  void SetUp() override {
+    m_pFontMgr.reset(new CFX_FontMgr);
+    m_pFontInfo = new TestSystemFontInfo(m_pFontMgr.get());
+    m_pFontMgr->SetSystemFontInfo(
+        std::unique_ptr<IFX_SystemFontInfo>(m_pFontInfo));
+  }
+
+  void TearDown() override {
+    for (FXFT_Face face : m_Faces)
+      m_pFontMgr->ReleaseFace(face);
+    m_pFontMgr.reset();
+  }
+
+  FXFT_Face FindSubstFont(const SubstRequest& request,
+                          CFX_SubstFont* pSubstFont) {
+    FXFT_Face face = m_pFontMgr->FindSubstFont(
+        request.name, request.bTrueType, request.flags, request.weight,
+        request.italic_angle, request.CharsetCP, pSubstFont);
+    m_Faces.push_back(face);
+    return face;
+  }
+
+  CFX_FontMapper* GetMapper() const {
+    return m_pFontMgr->GetBuiltinMapper();
+  }
+
+ protected:
+  std::unique_ptr<CFX_FontMgr> m_pFontMgr;
+  TestSystemFontInfo* m_pFontInfo;
+  std::vector<FXFT_Face> m_Faces;
+};
+
+}  // namespace
+
+TEST_F(CFX_FontMapperTest, SameResults) {
+  std::vector<FXFT_Face> faces;
+  std::vector<CFX_SubstFont> substs(FX_ArraySize(kRequests));
+  for (size_t i = 0; i < FX_ArraySize(kRequests); i++) {
+    faces.push_back(FindSubstFont(kRequests[i], &substs[i]));
+    EXPECT_TRUE(faces.back()) << kRequests[i].name;
+  }
+  EXPECT_EQ(0u, GetMapper()->GetSubstCacheHitCount());
+  EXPECT_EQ(FX_ArraySize(kRequests), GetMapper()->GetSubstCacheMissCount());
+  EXPECT_EQ("Sans", substs[0].m_Family);
+  EXPECT_EQ("Serif", substs[3].m_Family);
+
+  // Hits do not look for system fonts at all.
+  int map_font_calls = m_pFontInfo->GetMapFontCalls();
+  for (size_t pass = 1; pass <= 2; pass++) {
+    for (size_t i = 0; i < FX_ArraySize(kRequests); i++) {
+      CFX_SubstFont subst;
+      EXPECT_EQ(faces[i], FindSubstFont(kRequests[i], &subst))
+          << kRequests[i].name;
+      ExpectSameSubst(substs[i], subst);
+    }
+    EXPECT_EQ(pass * FX_ArraySize(kRequests),
+              GetMapper()->GetSubstCacheHitCount());
+  }
+  EXPECT_EQ(map_font_calls, m_pFontInfo->GetMapFontCalls());
+  EXPECT_EQ(FX_ArraySize(kRequests), GetMapper()->GetSubstCacheMissCount());
+  EXPECT_LE(0, GetMapper()->GetSubstCacheSavedTime());
+}
+
+TEST_F(CFX_FontMapperTest, EquivalentNames) {
+  const SubstRequest kArialBold = {"Arial,Bold", FALSE, 0, 0, 0, 0};
+  const SubstRequest kHelveticaBold = {"Helvetica-Bold", FALSE, 0, 0, 0, 0};
+  const SubstRequest kSpaced = {"Sans Bold", FALSE, 0, 0, 0, 0};
+  const SubstRequest kUnspaced = {"SansBold", FALSE, 0, 0, 0, 0};
+  CFX_SubstFont subst1;
+  CFX_SubstFont subst2;
+  EXPECT_EQ(FindSubstFont(kArialBold, &subst1),
+            FindSubstFont(kHelveticaBold, &subst2));
+  ExpectSameSubst(subst1, subst2);
+  CFX_SubstFont subst3;
+  CFX_SubstFont subst4;
+  EXPECT_EQ(FindSubstFont(kSpaced, &subst3),
+            FindSubstFont(kUnspaced, &subst4));
+  ExpectSameSubst(subst3, subst4);
+  EXPECT_EQ(2u, GetMapper()->GetSubstCacheHitCount());
+  EXPECT_EQ(2u, GetMapper()->GetSubstCacheMissCount());
+}
+
+TEST_F(CFX_FontMapperTest, FaceOutlivesUsers) {
+  const SubstRequest kSans = {"Sans", TRUE, 0, 0, 0, 0};
+  CFX_SubstFont subst;
+  FXFT_Face face = FindSubstFont(kSans, &subst);
+  ASSERT_TRUE(face);
+  // Closing the only document that used the font keeps it around for the
+  // next one.
+  m_Faces.clear();
+  m_pFontMgr->ReleaseFace(face);
+  EXPECT_EQ(face, FindSubstFont(kSans, &subst));
+  EXPECT_EQ(1u, GetMapper()->GetSubstCacheHitCount());
+}
+
+TEST_F(CFX_FontMapperTest, FaceBudget) {
+  const SubstRequest kSerif = {"Serif", TRUE, 0, 0, 0, 0};
+  const SubstRequest kSerifType1 = {"Serif", FALSE, 0, 0, 0, 0};
+  const SubstRequest kSans = {"Sans", TRUE, 0, 0, 0, 0};
+  CFX_SubstFont subst;
+  FXFT_Face serif = FindSubstFont(kSerif, &subst);
+  ASSERT_TRUE(serif);
+  size_t serif_bytes = GetMapper()->GetSubstCacheFaceBytes();
+  EXPECT_LT(0u, serif_bytes);
+  // A second entry for the same face does not count it again.
+  EXPECT_EQ(serif, FindSubstFont(kSerifType1, &subst));
+  EXPECT_EQ(serif_bytes, GetMapper()->GetSubstCacheFaceBytes());
+  EXPECT_EQ(0u, GetMapper()->GetSubstCacheHitCount());
+
+  // A face that does not fit next to the cached ones empties the cache.
+  GetMapper()->SetSubstCacheFaceBudgetForTesting(serif_bytes);
+  FXFT_Face sans = FindSubstFont(kSans, &subst);
+  ASSERT_TRUE(sans);
+  size_t sans_bytes = GetMapper()->GetSubstCacheFaceBytes();
+  EXPECT_LT(0u, sans_bytes);
+  EXPECT_GT(serif_bytes, sans_bytes);
+  EXPECT_EQ(sans, FindSubstFont(kSans, &subst));
+  EXPECT_EQ(1u, GetMapper()->GetSubstCacheHitCount());
+
+  // A face larger than the whole budget is not cached.
+  GetMapper()->SetSubstCacheFaceBudgetForTesting(serif_bytes - 1);
+  EXPECT_EQ(serif, FindSubstFont(kSerif, &subst));
+  EXPECT_EQ(serif, FindSubstFont(kSerif, &subst));
+  EXPECT_EQ(1u, GetMapper()->GetSubstCacheHitCount());
+  EXPECT_EQ(sans_bytes, GetMapper()->GetSubstCacheFaceBytes());
+}
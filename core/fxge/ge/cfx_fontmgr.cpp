@@ -222,6 +222,15 @@ FXFT_Face CFX_FontMgr::GetFileFace(const FX_CHAR* filename, int face_index) {
   return FXFT_Set_Pixel_Sizes(face, 64, 64) ? nullptr : face;
 }
 
+void CFX_FontMgr::RetainFace(FXFT_Face face) {
+  for (const auto& pair : m_FaceMap) {
+    if (pair.second->HasFace(face)) {
+      pair.second->m_RefCount++;
+      return;
+    }
+  }
+}
+
 void CFX_FontMgr::ReleaseFace(FXFT_Face face) {
   if (!face)
     return;
@@ -8,7 +8,9 @@
 
 #include "core/fxge/cfx_fontcache.h"
 #include "core/fxge/cfx_fontmgr.h"
+#include "core/fxge/ge/cfx_embeddedfontregistry.h"
 #include "core/fxge/ge/cfx_folderfontinfo.h"
+#include "core/fxge/ge/cfx_persistentglyphcache.h"
 #include "core/fxge/ge/fx_text_int.h"
 
 namespace {
@@ -23,9 +25,12 @@ CFX_GEModule::CFX_GEModule()
       m_pFontMgr(new CFX_FontMgr),
       m_pCodecModule(nullptr),
       m_pPlatformData(nullptr),
-      m_pUserFontPaths(nullptr) {}
+      m_pUserFontPaths(nullptr),
+      m_pFontIndexPath(nullptr) {}
 
 CFX_GEModule::~CFX_GEModule() {
+  // The registry holds face caches in |m_pFontCache|.
+  m_pEmbeddedFontRegistry.reset();
   delete m_pFontCache;
   DestroyPlatform();
 }
@@ -70,3 +75,21 @@ void CFX_GEModule::SetTextGamma(FX_FLOAT gammaValue) {
 const uint8_t* CFX_GEModule::GetTextGammaTable() const {
   return m_GammaValue;
 }
+
+void CFX_GEModule::InitGlyphCache(const char* path) {
+  // Glyphs rendered with another gamma or by another FreeType are different.
+  uint8_t stamp_data[sizeof(m_GammaValue) + 3];
+  FXSYS_memcpy(stamp_data, m_GammaValue, sizeof(m_GammaValue));
+  stamp_data[sizeof(m_GammaValue)] = FREETYPE_MAJOR;
+  stamp_data[sizeof(m_GammaValue) + 1] = FREETYPE_MINOR;
+  stamp_data[sizeof(m_GammaValue) + 2] = FREETYPE_PATCH;
+  uint32_t stamp = static_cast<uint32_t>(
+      CFX_PersistentGlyphCache::HashData(stamp_data, sizeof(stamp_data)));
+  m_pGlyphCache.reset(new CFX_PersistentGlyphCache(path, stamp));
+}
+
+void CFX_GEModule::InitEmbeddedFontRegistry(size_t unused_budget) {
+  m_pEmbeddedFontRegistry.reset(
+      new CFX_EmbeddedFontRegistry(m_pFontMgr.get(), GetFontCache(),
+                                   unused_budget));
+}
@@ -0,0 +1,360 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#include "core/fxge/ge/cfx_persistentglyphcache.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "core/fxge/fx_font.h"
+
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+#include <process.h>
+#define FXSYS_getpid _getpid
+#else
+#include <unistd.h>
+#define FXSYS_getpid getpid
+#endif
+
+// The file starts with a FileHeader, followed by an IndexEntry per glyph,
+// sorted by key, followed by the glyph records. A record is a GlyphHeader
+// followed by the rows of the bitmap. All values are in native byte order;
+// the file is only meant to be shared between processes on one machine.
+
+namespace {
+
+const char kMagic[8] = {'P', 'D', 'F', 'G', 'L', 'Y', 'P', 'H'};
+const uint32_t kVersion = 2;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t stamp;
+  uint32_t count;
+  uint32_t reserved[3];
+};
+
+struct IndexEntry {
+  CFX_PersistentGlyphCache::Key key;
+  uint32_t offset;
+  uint32_t size;
+};
+
+struct GlyphHeader {
+  int32_t left;
+  int32_t top;
+  int32_t width;
+  int32_t height;
+  uint32_t format;
+};
+
+// A key with its serialized glyph.
+using GlyphRef = std::pair<CFX_PersistentGlyphCache::Key,
+                           std::pair<const uint8_t*, uint32_t>>;
+
+static_assert(sizeof(FileHeader) % 8 == 0, "index must stay aligned");
+static_assert(sizeof(IndexEntry) % 8 == 0, "index must stay aligned");
+
+const IndexEntry* GetIndex(const uint8_t* pData) {
+  return reinterpret_cast<const IndexEntry*>(pData + sizeof(FileHeader));
+}
+
+std::vector<uint8_t> SerializeGlyph(const CFX_GlyphBitmap& glyph) {
+  const CFX_DIBitmap& bitmap = glyph.m_Bitmap;
+  GlyphHeader header;
+  header.left = glyph.m_Left;
+  header.top = glyph.m_Top;
+  header.width = bitmap.GetWidth();
+  header.height = bitmap.GetHeight();
+  header.format = bitmap.GetFormat();
+  size_t data_size = bitmap.GetPitch() * bitmap.GetHeight();
+  std::vector<uint8_t> record(sizeof(header) + data_size);
+  FXSYS_memcpy(record.data(), &header, sizeof(header));
+  if (data_size)
+    FXSYS_memcpy(record.data() + sizeof(header), bitmap.GetBuffer(), data_size);
+  return record;
+}
+
+std::unique_ptr<CFX_GlyphBitmap> DeserializeGlyph(const uint8_t* pRecord,
+                                                  uint32_t size) {
+  GlyphHeader header;
+  if (size < sizeof(header))
+    return nullptr;
+
+  FXSYS_memcpy(&header, pRecord, sizeof(header));
+  if (header.format != FXDIB_1bppMask && header.format != FXDIB_8bppMask)
+    return nullptr;
+  if (header.width < 0 || header.height < 0 || header.width > 2048 ||
+      header.height > 2048) {
+    return nullptr;
+  }
+
+  std::unique_ptr<CFX_GlyphBitmap> pGlyph(new CFX_GlyphBitmap);
+  pGlyph->m_Left = header.left;
+  pGlyph->m_Top = header.top;
+  CFX_DIBitmap& bitmap = pGlyph->m_Bitmap;
+  // Blank glyphs, such as spaces, have no pixels. Create() fails for them but
+  // still sets the format, just like it does in CFX_FaceCache::RenderGlyph().
+  if (!bitmap.Create(header.width, header.height,
+                     static_cast<FXDIB_Format>(header.format)) &&
+      header.width && header.height) {
+    return nullptr;
+  }
+  uint32_t data_size = bitmap.GetPitch() * bitmap.GetHeight();
+  if (size - sizeof(header) != data_size)
+    return nullptr;
+  if (data_size)
+    FXSYS_memcpy(bitmap.GetBuffer(), pRecord + sizeof(header), data_size);
+  return pGlyph;
+}
+
+}  // namespace
+
+CFX_PersistentGlyphCache::Key::Key() {
+  FXSYS_memset(this, 0, sizeof(*this));
+}
+
+bool CFX_PersistentGlyphCache::Key::operator<(const Key& that) const {
+  return FXSYS_memcmp(this, &that, sizeof(*this)) < 0;
+}
+
+CFX_PersistentGlyphCache::FileView::FileView()
+    : m_pData(nullptr), m_nSize(0), m_nCount(0) {}
+
+CFX_PersistentGlyphCache::FileView::~FileView() {}
+
+bool CFX_PersistentGlyphCache::FileView::Load(const CFX_ByteString& path,
+                                              uint32_t stamp) {
+  m_pFile.reset(FX_CreateFileRead(path.c_str()));
+  if (!m_pFile)
+    return false;
+
+  FX_FILESIZE size = m_pFile->GetSize();
+  if (size < static_cast<FX_FILESIZE>(sizeof(FileHeader)) ||
+      size > static_cast<FX_FILESIZE>(kMaxFileSize)) {
+    m_pFile.reset();
+    return false;
+  }
+  m_nSize = static_cast<size_t>(size);
+  m_pData = m_pFile->GetDirectBuffer();
+  if (!m_pData) {
+    m_Buffer.resize(m_nSize);
+    if (!m_pFile->ReadBlock(m_Buffer.data(), 0, m_nSize)) {
+      m_Buffer.clear();
+      m_pFile.reset();
+      return false;
+    }
+    m_pData = m_Buffer.data();
+    // Keep the file closed so that Flush() can replace it on any platform.
+    m_pFile.reset();
+  }
+
+  FileHeader header;
+  FXSYS_memcpy(&header, m_pData, sizeof(header));
+  if (FXSYS_memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion || header.stamp != stamp ||
+      header.count > (m_nSize - sizeof(header)) / sizeof(IndexEntry)) {
+    m_pData = nullptr;
+    m_Buffer.clear();
+    m_pFile.reset();
+    return false;
+  }
+  m_nCount = header.count;
+  return true;
+}
+
+const CFX_PersistentGlyphCache::Key& CFX_PersistentGlyphCache::FileView::GetKey(
+    uint32_t index) const {
+  return GetIndex(m_pData)[index].key;
+}
+
+bool CFX_PersistentGlyphCache::FileView::GetRecord(uint32_t index,
+                                                   const uint8_t** pRecord,
+                                                   uint32_t* size) const {
+  const IndexEntry& entry = GetIndex(m_pData)[index];
+  if (entry.offset > m_nSize || entry.size > m_nSize - entry.offset)
+    return false;
+
+  *pRecord = m_pData + entry.offset;
+  *size = entry.size;
+  return true;
+}
+
+int32_t CFX_PersistentGlyphCache::FileView::Find(const Key& key) const {
+  if (!m_nCount)
+    return -1;
+
+  const IndexEntry* pBegin = GetIndex(m_pData);
+  const IndexEntry* pEnd = pBegin + m_nCount;
+  const IndexEntry* it = std::lower_bound(
+      pBegin, pEnd, key,
+      [](const IndexEntry& entry, const Key& k) { return entry.key < k; });
+  if (it == pEnd || key < it->key)
+    return -1;
+  return static_cast<int32_t>(it - pBegin);
+}
+
+CFX_PersistentGlyphCache::CFX_PersistentGlyphCache(const CFX_ByteString& path,
+                                                   uint32_t stamp)
+    : m_Path(path),
+      m_Stamp(stamp),
+      m_nPendingSize(0),
+      m_nHits(0),
+      m_nMisses(0) {
+  m_File.Load(m_Path, m_Stamp);
+}
+
+CFX_PersistentGlyphCache::~CFX_PersistentGlyphCache() {
+  Flush();
+}
+
+// static
+uint64_t CFX_PersistentGlyphCache::HashData(const uint8_t* pData,
+                                                uint32_t size) {
+  // FNV-1a, consuming eight bytes per step to keep up with large CJK fonts.
+  // The shift folds the high bits of each product back into the low ones,
+  // which a multiplication alone never reaches.
+  const uint64_t kPrime = 0x100000001b3ULL;
+  uint64_t hash = 0xcbf29ce484222325ULL ^ size;
+  uint32_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    FXSYS_memcpy(&word, pData + i, sizeof(word));
+    hash = (hash ^ word) * kPrime;
+    hash ^= hash >> 32;
+  }
+  for (; i < size; ++i)
+    hash = (hash ^ pData[i]) * kPrime;
+  return hash;
+}
+
+std::unique_ptr<CFX_GlyphBitmap> CFX_PersistentGlyphCache::Lookup(
+    const Key& key) {
+  std::unique_ptr<CFX_GlyphBitmap> pGlyph;
+  auto it = m_Pending.find(key);
+  if (it != m_Pending.end()) {
+    pGlyph = DeserializeGlyph(it->second.data(), it->second.size());
+  } else {
+    int32_t index = m_File.Find(key);
+    const uint8_t* pRecord;
+    uint32_t size;
+    if (index >= 0 && m_File.GetRecord(index, &pRecord, &size))
+      pGlyph = DeserializeGlyph(pRecord, size);
+  }
+  if (pGlyph)
+    m_nHits++;
+  else
+    m_nMisses++;
+  return pGlyph;
+}
+
+void CFX_PersistentGlyphCache::Add(const Key& key,
+                                   const CFX_GlyphBitmap& glyph) {
+  if (m_Pending.find(key) != m_Pending.end() || m_File.Find(key) >= 0)
+    return;
+
+  std::vector<uint8_t> record = SerializeGlyph(glyph);
+  uint32_t entry_size = sizeof(IndexEntry) + record.size();
+  if (m_nPendingSize + entry_size > kMaxFileSize)
+    return;
+
+  m_nPendingSize += entry_size;
+  m_Pending[key] = std::move(record);
+}
+
+bool CFX_PersistentGlyphCache::Flush() {
+  if (m_Pending.empty())
+    return true;
+
+  // Start from what is on disk now, which may contain glyphs that other
+  // processes added since this one opened the file.
+  FileView current;
+  current.Load(m_Path, m_Stamp);
+  std::vector<GlyphRef> glyphs;
+  uint64_t total = sizeof(FileHeader);
+  for (uint32_t i = 0; i < current.GetCount(); ++i) {
+    const uint8_t* pRecord;
+    uint32_t size;
+    if (!current.GetRecord(i, &pRecord, &size))
+      continue;
+    glyphs.push_back(
+        std::make_pair(current.GetKey(i), std::make_pair(pRecord, size)));
+    total += sizeof(IndexEntry) + size;
+  }
+  size_t nExisting = glyphs.size();
+  for (const auto& pending : m_Pending) {
+    uint64_t entry_size = sizeof(IndexEntry) + pending.second.size();
+    if (total + entry_size > kMaxFileSize)
+      break;
+    if (current.Find(pending.first) >= 0)
+      continue;
+    glyphs.push_back(std::make_pair(
+        pending.first,
+        std::make_pair(pending.second.data(),
+                       static_cast<uint32_t>(pending.second.size()))));
+    total += entry_size;
+  }
+  if (glyphs.size() == nExisting) {
+    m_Pending.clear();
+    m_nPendingSize = 0;
+    return true;
+  }
+  std::inplace_merge(
+      glyphs.begin(), glyphs.begin() + nExisting, glyphs.end(),
+      [](const GlyphRef& a, const GlyphRef& b) { return a.first < b.first; });
+
+  // Write to a file of our own first, so that readers never see a partially
+  // written cache. The name only has to be unique among the writers at any
+  // one time, which the process id guarantees.
+  CFX_ByteString temp_path = m_Path;
+  temp_path += ".";
+  temp_path += CFX_ByteString::FormatInteger(FXSYS_getpid());
+  temp_path += ".tmp";
+  std::unique_ptr<IFX_FileStream, ReleaseDeleter<IFX_FileStream>> pOut(
+      FX_CreateFileStream(temp_path.c_str(), FX_FILEMODE_Truncate));
+  if (!pOut)
+    return false;
+
+  FileHeader header;
+  FXSYS_memset(&header, 0, sizeof(header));
+  FXSYS_memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.stamp = m_Stamp;
+  header.count = glyphs.size();
+  std::vector<IndexEntry> index(glyphs.size());
+  uint32_t offset = sizeof(header) + sizeof(IndexEntry) * glyphs.size();
+  for (size_t i = 0; i < glyphs.size(); ++i) {
+    FXSYS_memset(&index[i], 0, sizeof(IndexEntry));
+    index[i].key = glyphs[i].first;
+    index[i].offset = offset;
+    index[i].size = glyphs[i].second.second;
+    offset += index[i].size;
+  }
+  bool bWritten =
+      pOut->WriteBlock(&header, 0, sizeof(header)) &&
+      pOut->WriteBlock(index.data(), sizeof(header),
+                       sizeof(IndexEntry) * index.size());
+  for (size_t i = 0; bWritten && i < glyphs.size(); ++i) {
+    bWritten = !!pOut->WriteBlock(glyphs[i].second.first, index[i].offset,
+                                  index[i].size);
+  }
+  bWritten = bWritten && pOut->Flush();
+  pOut.reset();
+  if (bWritten && rename(temp_path.c_str(), m_Path.c_str()) != 0) {
+    // Windows does not replace existing files.
+    remove(m_Path.c_str());
+    bWritten = rename(temp_path.c_str(), m_Path.c_str()) == 0;
+  }
+  if (!bWritten) {
+    remove(temp_path.c_str());
+    return false;
+  }
+  m_Pending.clear();
+  m_nPendingSize = 0;
+  return true;
+}
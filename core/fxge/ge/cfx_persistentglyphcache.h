@@ -0,0 +1,108 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#ifndef CORE_FXGE_GE_CFX_PERSISTENTGLYPHCACHE_H_
+#define CORE_FXGE_GE_CFX_PERSISTENTGLYPHCACHE_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "core/fxcrt/fx_memory.h"
+#include "core/fxcrt/fx_stream.h"
+#include "core/fxcrt/fx_string.h"
+
+class CFX_GlyphBitmap;
+
+// Rendered glyph bitmaps stored in a file, so that they survive the process
+// and can be shared by every process pointing at the same file.
+//
+// The file is mapped read-only when the cache is created and is never
+// modified in place. Glyphs missing from it are collected in memory and
+// written out by Flush(), which merges them with the current contents of the
+// file into a new file and renames it over the old one. Concurrent readers
+// keep seeing the file they opened; of two concurrent writers, the glyphs of
+// the later one win.
+class CFX_PersistentGlyphCache {
+ public:
+  // Identifies a rendered glyph. Every field that changes the output of
+  // CFX_FaceCache::RenderGlyph() has to be part of the key. Keys are compared
+  // bytewise, so they must be zero-initialized before they are filled in.
+  struct Key {
+    Key();
+    bool operator<(const Key& that) const;
+
+    uint64_t font_hash;
+    uint32_t font_size;
+    uint32_t face_index;
+    uint32_t glyph_index;
+    int32_t matrix[4];
+    int32_t dest_width;
+    int32_t anti_alias;
+    int32_t weight;
+    int32_t italic_angle;
+    uint32_t flags;
+  };
+
+  // Glyphs are no longer added once the file would grow beyond this.
+  static const uint32_t kMaxFileSize = 64 * 1024 * 1024;
+
+  // |stamp| identifies everything outside of the key that affects rendering,
+  // such as the text gamma. A file written with a different stamp is ignored.
+  CFX_PersistentGlyphCache(const CFX_ByteString& path, uint32_t stamp);
+  ~CFX_PersistentGlyphCache();
+
+  // Hashes |size| bytes, such as the table directory of a font for
+  // Key::font_hash.
+  static uint64_t HashData(const uint8_t* pData, uint32_t size);
+
+  // Returns a copy of the cached glyph, or nullptr on a miss.
+  std::unique_ptr<CFX_GlyphBitmap> Lookup(const Key& key);
+  void Add(const Key& key, const CFX_GlyphBitmap& glyph);
+
+  // Writes the glyphs added since the cache was created to the file. Returns
+  // false if the file could not be written.
+  bool Flush();
+
+  uint32_t GetHitCount() const { return m_nHits; }
+  uint32_t GetMissCount() const { return m_nMisses; }
+
+ private:
+  // A read-only view of one version of the cache file.
+  class FileView {
+   public:
+    FileView();
+    ~FileView();
+
+    bool Load(const CFX_ByteString& path, uint32_t stamp);
+    uint32_t GetCount() const { return m_nCount; }
+    const Key& GetKey(uint32_t index) const;
+    // Returns the serialized glyph at |index|, or false if it is out of
+    // bounds.
+    bool GetRecord(uint32_t index,
+                   const uint8_t** pRecord,
+                   uint32_t* size) const;
+    // Returns the index of |key|, or -1.
+    int32_t Find(const Key& key) const;
+
+   private:
+    std::unique_ptr<IFX_FileRead, ReleaseDeleter<IFX_FileRead>> m_pFile;
+    std::vector<uint8_t> m_Buffer;
+    const uint8_t* m_pData;
+    size_t m_nSize;
+    uint32_t m_nCount;
+  };
+
+  const CFX_ByteString m_Path;
+  const uint32_t m_Stamp;
+  FileView m_File;
+  std::map<Key, std::vector<uint8_t>> m_Pending;
+  uint32_t m_nPendingSize;
+  uint32_t m_nHits;
+  uint32_t m_nMisses;
+};
+
+#endif  // CORE_FXGE_GE_CFX_PERSISTENTGLYPHCACHE_H_
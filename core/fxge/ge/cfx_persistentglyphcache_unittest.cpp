@@ -0,0 +1,158 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxge/ge/cfx_persistentglyphcache.h"
+
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+
+#include "core/fxge/fx_font.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/utils/path_service.h"
+
+namespace {
+
+const uint32_t kStamp = 1234;
+
+CFX_ByteString GetCachePath() {
+  std::string path;
+  EXPECT_TRUE(PathService::GetExecutableDir(&path));
+  if (!PathService::EndsWithSeparator(path))
+    path.push_back(PATH_SEPARATOR);
+  path.append("cfx_persistentglyphcache_unittest.bin");
+  return CFX_ByteString(path.c_str());
+}
+
+CFX_PersistentGlyphCache::Key MakeKey(uint32_t glyph_index) {
+  CFX_PersistentGlyphCache::Key key;
+  key.font_hash = 0x0123456789abcdefULL;
+  key.glyph_index = glyph_index;
+  key.matrix[0] = 120000;
+  key.matrix[3] = -120000;
+  key.anti_alias = 1;
+  return key;
+}
+
+std::unique_ptr<CFX_GlyphBitmap> MakeGlyph(int width, int height, int seed) {
+  std::unique_ptr<CFX_GlyphBitmap> pGlyph(new CFX_GlyphBitmap);
+  pGlyph->m_Left = seed;
+  pGlyph->m_Top = -seed;
+  EXPECT_TRUE(pGlyph->m_Bitmap.Create(width, height, FXDIB_8bppMask));
+  uint8_t* pBuffer = pGlyph->m_Bitmap.GetBuffer();
+  for (int i = 0; i < pGlyph->m_Bitmap.GetPitch() * height; ++i)
+    pBuffer[i] = static_cast<uint8_t>(i * 7 + seed);
+  return pGlyph;
+}
+
+void ExpectSameGlyph(const CFX_GlyphBitmap& expected,
+                     const CFX_GlyphBitmap* actual) {
+  ASSERT_TRUE(actual);
+  EXPECT_EQ(expected.m_Left, actual->m_Left);
+  EXPECT_EQ(expected.m_Top, actual->m_Top);
+  ASSERT_EQ(expected.m_Bitmap.GetWidth(), actual->m_Bitmap.GetWidth());
+  ASSERT_EQ(expected.m_Bitmap.GetHeight(), actual->m_Bitmap.GetHeight());
+  ASSERT_EQ(expected.m_Bitmap.GetFormat(), actual->m_Bitmap.GetFormat());
+  EXPECT_EQ(0, memcmp(expected.m_Bitmap.GetBuffer(),
+                      actual->m_Bitmap.GetBuffer(),
+                      expected.m_Bitmap.GetPitch() *
+                          expected.m_Bitmap.GetHeight()));
+}
+
+}  // namespace
+
+TEST(CFX_PersistentGlyphCache, RoundTrip) {
+  CFX_ByteString path = GetCachePath();
+  remove(path.c_str());
+  std::unique_ptr<CFX_GlyphBitmap> pGlyph = MakeGlyph(13, 9, 5);
+  {
+    CFX_PersistentGlyphCache cache(path, kStamp);
+    EXPECT_FALSE(cache.Lookup(MakeKey(1)));
+    cache.Add(MakeKey(1), *pGlyph);
+    ExpectSameGlyph(*pGlyph, cache.Lookup(MakeKey(1)).get());
+    EXPECT_EQ(1u, cache.GetHitCount());
+    EXPECT_EQ(1u, cache.GetMissCount());
+    EXPECT_TRUE(cache.Flush());
+  }
+  {
+    CFX_PersistentGlyphCache cache(path, kStamp);
+    ExpectSameGlyph(*pGlyph, cache.Lookup(MakeKey(1)).get());
+    EXPECT_FALSE(cache.Lookup(MakeKey(2)));
+    EXPECT_EQ(1u, cache.GetHitCount());
+    EXPECT_EQ(1u, cache.GetMissCount());
+  }
+  {
+    // Glyphs rendered with other settings are not used.
+    CFX_PersistentGlyphCache cache(path, kStamp + 1);
+    EXPECT_FALSE(cache.Lookup(MakeKey(1)));
+  }
+  remove(path.c_str());
+}
+
+TEST(CFX_PersistentGlyphCache, MergeWriters) {
+  CFX_ByteString path = GetCachePath();
+  remove(path.c_str());
+  std::unique_ptr<CFX_GlyphBitmap> pGlyph1 = MakeGlyph(4, 4, 1);
+  std::unique_ptr<CFX_GlyphBitmap> pGlyph2 = MakeGlyph(30, 2, 2);
+  std::unique_ptr<CFX_GlyphBitmap> pGlyph3 = MakeGlyph(1, 17, 3);
+  {
+    // Two processes that both started from an empty cache.
+    CFX_PersistentGlyphCache cache1(path, kStamp);
+    CFX_PersistentGlyphCache cache2(path, kStamp);
+    cache1.Add(MakeKey(30), *pGlyph1);
+    cache1.Add(MakeKey(10), *pGlyph2);
+    cache2.Add(MakeKey(20), *pGlyph3);
+    EXPECT_TRUE(cache1.Flush());
+    EXPECT_TRUE(cache2.Flush());
+  }
+  CFX_PersistentGlyphCache cache(path, kStamp);
+  ExpectSameGlyph(*pGlyph1, cache.Lookup(MakeKey(30)).get());
+  ExpectSameGlyph(*pGlyph2, cache.Lookup(MakeKey(10)).get());
+  ExpectSameGlyph(*pGlyph3, cache.Lookup(MakeKey(20)).get());
+  EXPECT_FALSE(cache.Lookup(MakeKey(15)));
+  remove(path.c_str());
+}
+
+TEST(CFX_PersistentGlyphCache, BadFile) {
+  CFX_ByteString path = GetCachePath();
+  FILE* file = fopen(path.c_str(), "wb");
+  ASSERT_TRUE(file);
+  const char kGarbage[] = "PDFGLYPH but not really a glyph cache file";
+  fwrite(kGarbage, 1, sizeof(kGarbage), file);
+  fclose(file);
+
+  std::unique_ptr<CFX_GlyphBitmap> pGlyph = MakeGlyph(8, 8, 8);
+  {
+    CFX_PersistentGlyphCache cache(path, kStamp);
+    EXPECT_FALSE(cache.Lookup(MakeKey(1)));
+    cache.Add(MakeKey(1), *pGlyph);
+  }
+  // The broken file was replaced when the cache went away.
+  CFX_PersistentGlyphCache cache(path, kStamp);
+  ExpectSameGlyph(*pGlyph, cache.Lookup(MakeKey(1)).get());
+  remove(path.c_str());
+}
+
+TEST(CFX_PersistentGlyphCache, BlankGlyph) {
+  CFX_ByteString path = GetCachePath();
+  remove(path.c_str());
+  // Glyphs without pixels, such as spaces, are cached as well.
+  CFX_GlyphBitmap blank;
+  blank.m_Left = 3;
+  blank.m_Top = 4;
+  EXPECT_FALSE(blank.m_Bitmap.Create(0, 0, FXDIB_8bppMask));
+  {
+    CFX_PersistentGlyphCache cache(path, kStamp);
+    cache.Add(MakeKey(1), blank);
+  }
+  CFX_PersistentGlyphCache cache(path, kStamp);
+  std::unique_ptr<CFX_GlyphBitmap> pGlyph = cache.Lookup(MakeKey(1));
+  ASSERT_TRUE(pGlyph);
+  EXPECT_EQ(3, pGlyph->m_Left);
+  EXPECT_EQ(4, pGlyph->m_Top);
+  EXPECT_EQ(0, pGlyph->m_Bitmap.GetWidth());
+  EXPECT_EQ(FXDIB_8bppMask, pGlyph->m_Bitmap.GetFormat());
+  remove(path.c_str());
+}
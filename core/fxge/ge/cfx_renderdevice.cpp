@@ -1014,7 +1014,13 @@ FX_BOOL CFX_RenderDevice::DrawNormalText(int nChars,
     }
     bool bBGRStripe = !!(text_flags & FXTEXT_BGR_STRIPE);
     ncols /= 3;
-    int x_subpixel = (int)(glyph.m_fOriginX * 3) % 3;
+    // Measure the subpixel phase from the floored origin so that it stays in
+    // [0, 3) when the glyph starts left of the device origin. The product
+    // can round up to the next whole pixel just below it, hence the clamp.
+    int x_subpixel =
+        std::min(static_cast<int>(FXSYS_floor(glyph.m_fOriginX * 3)) -
+                     glyph.m_OriginX * 3,
+                 2);
     int start_col = std::max(left.ValueOrDie(), 0);
     pdfium::base::CheckedNumeric<int> end_col_safe = left;
     end_col_safe += ncols;
@@ -21,6 +21,18 @@ CTTFontDesc::~CTTFontDesc() {
   FX_Free(m_pFontData);
 }
 
+bool CTTFontDesc::HasFace(FXFT_Face face) const {
+  if (m_Type == 1)
+    return m_SingleFace.m_pFace == face;
+  if (m_Type == 2) {
+    for (int i = 0; i < 16; i++) {
+      if (m_TTCFace.m_pFaces[i] == face)
+        return true;
+    }
+  }
+  return false;
+}
+
 int CTTFontDesc::ReleaseFace(FXFT_Face face) {
   if (m_Type == 1) {
     if (m_SingleFace.m_pFace != face)
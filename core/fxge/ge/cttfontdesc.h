@@ -22,6 +22,7 @@ class CTTFontDesc {
  public:
   CTTFontDesc() : m_Type(0), m_pFontData(nullptr), m_RefCount(0) {}
   ~CTTFontDesc();
+  bool HasFace(FXFT_Face face) const;
   // ret < 0, releaseface not appropriate for this object.
   // ret == 0, object released
   // ret > 0, object still alive, other referrers.
@@ -9,6 +9,7 @@
 #endif
 
 #include <memory>
+#include <utility>
 
 #include "core/fxge/cfx_gemodule.h"
 #include "core/fxge/ge/cfx_folderfontinfo.h"
@@ -161,8 +162,13 @@ FX_BOOL CFX_LinuxFontInfo::ParseFontCfg(const char** pUserPaths) {
 }
 
 void CFX_GEModule::InitPlatform() {
-  m_pFontMgr->SetSystemFontInfo(
-      IFX_SystemFontInfo::CreateDefault(m_pUserFontPaths));
+  std::unique_ptr<IFX_SystemFontInfo> pInfo =
+      IFX_SystemFontInfo::CreateDefault(m_pUserFontPaths);
+  if (m_pFontIndexPath) {
+    static_cast<CFX_LinuxFontInfo*>(pInfo.get())
+        ->SetIndexPath(m_pFontIndexPath);
+  }
+  m_pFontMgr->SetSystemFontInfo(std::move(pInfo));
 }
 
 void CFX_GEModule::DestroyPlatform() {}
@@ -61,6 +61,24 @@ DLLEXPORT int STDCALL FPDF_RenderPageBitmap_Start(FPDF_BITMAP bitmap,
   return FPDF_RENDER_FAILED;
 }
 
+DLLEXPORT int STDCALL FPDF_RenderPageBitmapTile_Start(FPDF_BITMAP bitmap,
+                                                      FPDF_PAGE page,
+                                                      int size_x,
+                                                      int size_y,
+                                                      int rotate,
+                                                      int tile_x,
+                                                      int tile_y,
+                                                      int flags,
+                                                      IFSDK_PAUSE* pause) {
+  if (tile_x < 0 || tile_y < 0 || tile_x >= size_x || tile_y >= size_y)
+    return FPDF_RENDER_FAILED;
+
+  // Shifting the display area by whole pixels keeps the fractional part of
+  // the page matrix unchanged, so the tile matches a full render exactly.
+  return FPDF_RenderPageBitmap_Start(bitmap, page, -tile_x, -tile_y, size_x,
+                                     size_y, rotate, flags, pause);
+}
+
 DLLEXPORT int STDCALL FPDF_RenderPage_Continue(FPDF_PAGE page,
                                                IFSDK_PAUSE* pause) {
   if (!pause || pause->version != 1)
@@ -0,0 +1,92 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "public/fpdf_edit.h"
+#include "public/fpdf_progressive.h"
+#include "public/fpdfview.h"
+#include "testing/embedder_test.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+FPDF_BOOL NeverPause(IFSDK_PAUSE* pThis) {
+  return false;
+}
+
+}  // namespace
+
+class FPDFProgressiveEmbeddertest : public EmbedderTest {};
+
+TEST_F(FPDFProgressiveEmbeddertest, TileBadRect) {
+  EXPECT_TRUE(OpenDocument("hello_world.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  EXPECT_NE(nullptr, page);
+
+  IFSDK_PAUSE pause;
+  pause.version = 1;
+  pause.NeedToPauseNow = NeverPause;
+  pause.user = nullptr;
+
+  FPDF_BITMAP tile = FPDFBitmap_Create(50, 50, 0);
+  EXPECT_EQ(FPDF_RENDER_FAILED, FPDF_RenderPageBitmapTile_Start(
+                                    tile, page, 200, 200, 0, -1, 0, 0, &pause));
+  EXPECT_EQ(FPDF_RENDER_FAILED, FPDF_RenderPageBitmapTile_Start(
+                                    tile, page, 200, 200, 0, 0, 200, 0, &pause));
+  FPDFBitmap_Destroy(tile);
+  UnloadPage(page);
+}
+
+TEST_F(FPDFProgressiveEmbeddertest, TilesMatchFullRender) {
+  EXPECT_TRUE(OpenDocument("hello_world.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  EXPECT_NE(nullptr, page);
+
+  FPDF_BITMAP full = RenderPage(page);
+  const int alpha = FPDFPage_HasTransparency(page) ? 1 : 0;
+  const FPDF_DWORD fill_color = alpha ? 0x00000000 : 0xFFFFFFFF;
+  const int width = FPDFBitmap_GetWidth(full);
+  const int height = FPDFBitmap_GetHeight(full);
+  const int full_stride = FPDFBitmap_GetStride(full);
+  const uint8_t* full_buffer =
+      static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(full));
+
+  IFSDK_PAUSE pause;
+  pause.version = 1;
+  pause.NeedToPauseNow = NeverPause;
+  pause.user = nullptr;
+
+  // Deliberately pick a tile size that does not divide the page evenly.
+  const int kTileSize = 97;
+  for (int tile_y = 0; tile_y < height; tile_y += kTileSize) {
+    for (int tile_x = 0; tile_x < width; tile_x += kTileSize) {
+      const int tile_width = std::min(kTileSize, width - tile_x);
+      const int tile_height = std::min(kTileSize, height - tile_y);
+      FPDF_BITMAP tile = FPDFBitmap_Create(tile_width, tile_height, alpha);
+      FPDFBitmap_FillRect(tile, 0, 0, tile_width, tile_height, fill_color);
+      EXPECT_EQ(FPDF_RENDER_DONE,
+                FPDF_RenderPageBitmapTile_Start(tile, page, width, height, 0,
+                                                tile_x, tile_y, 0, &pause));
+      FPDF_RenderPage_Close(page);
+
+      const int tile_stride = FPDFBitmap_GetStride(tile);
+      const uint8_t* tile_buffer =
+          static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(tile));
+      for (int row = 0; row < tile_height; ++row) {
+        const uint8_t* expected =
+            full_buffer + (tile_y + row) * full_stride + tile_x * 4;
+        EXPECT_EQ(0, memcmp(expected, tile_buffer + row * tile_stride,
+                            tile_width * 4))
+            << "tile (" << tile_x << ", " << tile_y << ") row " << row;
+      }
+      FPDFBitmap_Destroy(tile);
+    }
+  }
+
+  FPDFBitmap_Destroy(full);
+  UnloadPage(page);
+}
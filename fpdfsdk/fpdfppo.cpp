@@ -216,18 +216,19 @@ FX_BOOL CPDF_PageOrganizer::UpdateReference(CPDF_Object* pObj,
     }
     case CPDF_Object::DICTIONARY: {
       CPDF_Dictionary* pDict = pObj->AsDictionary();
-      auto it = pDict->begin();
-      while (it != pDict->end()) {
-        const CFX_ByteString& key = it->first;
-        CPDF_Object* pNextObj = it->second;
-        ++it;
+      std::vector<CFX_ByteString> bad_keys;
+      for (const auto& it : *pDict) {
+        const CFX_ByteString& key = it.first;
+        CPDF_Object* pNextObj = it.second;
         if (key == "Parent" || key == "Prev" || key == "First")
           continue;
         if (!pNextObj)
           return FALSE;
         if (!UpdateReference(pNextObj, pDoc, pObjNumberMap))
-          pDict->RemoveFor(key);
+          bad_keys.push_back(key);
       }
+      for (const auto& key : bad_keys)
+        pDict->RemoveFor(key);
       break;
     }
     case CPDF_Object::ARRAY: {
@@ -6,9 +6,16 @@
 
 #include "public/fpdf_text.h"
 
+#include <vector>
+
+#include "core/fpdfapi/fpdf_font/cpdf_font.h"
 #include "core/fpdfapi/fpdf_page/cpdf_page.h"
+#include "core/fpdfapi/fpdf_page/cpdf_textobject.h"
+#include "core/fpdfapi/fpdf_page/cpdf_textobjectsink.h"
+#include "core/fpdfapi/fpdf_parser/cpdf_document.h"
 #include "core/fpdfdoc/cpdf_viewerpreferences.h"
 #include "core/fpdftext/cpdf_linkextract.h"
+#include "core/fpdftext/cpdf_textdocumentfind.h"
 #include "core/fpdftext/cpdf_textpage.h"
 #include "core/fpdftext/cpdf_textpagefind.h"
 #include "fpdfsdk/fsdk_define.h"
@@ -34,10 +41,84 @@ CPDF_TextPageFind* CPDFTextPageFindFromFPDFSchHandle(FPDF_SCHHANDLE handle) {
   return static_cast<CPDF_TextPageFind*>(handle);
 }
 
+CPDF_TextDocumentFind* CPDFTextDocumentFindFromFPDFDocSchHandle(
+    FPDF_DOCSCHHANDLE handle) {
+  return static_cast<CPDF_TextDocumentFind*>(handle);
+}
+
 CPDF_LinkExtract* CPDFLinkExtractFromFPDFPageLink(FPDF_PAGELINK link) {
   return static_cast<CPDF_LinkExtract*>(link);
 }
 
+// Converts text objects to UTF-16 runs for a FPDF_TEXTRUN_SINK, reusing one
+// buffer for all of them.
+class TextRunSink : public CPDF_TextObjectSink {
+ public:
+  explicit TextRunSink(FPDF_TEXTRUN_SINK* pSink) : m_pSink(pSink) {}
+
+  // CPDF_TextObjectSink
+  void OnTextObject(const CPDF_TextObject* pTextObj) override {
+    CPDF_Font* pFont = pTextObj->GetFont();
+    m_Buffer.clear();
+    int nItems = pTextObj->CountItems();
+    for (int i = 0; i < nItems; ++i) {
+      CPDF_TextObjectItem item;
+      pTextObj->GetItemInfo(i, &item);
+      if (item.m_CharCode == static_cast<uint32_t>(-1))
+        continue;
+
+      // Same fallback as CPDF_TextPage for characters without a mapping.
+      CFX_WideString wstrItem = pFont->UnicodeFromCharCode(item.m_CharCode);
+      if (wstrItem.IsEmpty() && item.m_CharCode)
+        wstrItem += static_cast<FX_WCHAR>(item.m_CharCode);
+      for (int j = 0; j < wstrItem.GetLength(); ++j)
+        AppendUTF16(wstrItem.GetAt(j));
+    }
+    if (m_Buffer.empty())
+      return;
+
+    m_pSink->OnTextRun(m_pSink, m_Buffer.data(),
+                       pdfium::CollectionSize<int>(m_Buffer),
+                       pTextObj->GetFontSize(), pTextObj->m_Left,
+                       pTextObj->m_Top, pTextObj->m_Right,
+                       pTextObj->m_Bottom);
+  }
+
+ private:
+  void AppendUTF16(uint32_t code) {
+    if (code == 0)
+      return;
+
+    if (code < 0x10000 || code > 0x10FFFF) {
+      m_Buffer.push_back(static_cast<unsigned short>(code));
+      return;
+    }
+    code -= 0x10000;
+    m_Buffer.push_back(static_cast<unsigned short>(0xD800 | (code >> 10)));
+    m_Buffer.push_back(static_cast<unsigned short>(0xDC00 | (code & 0x3FF)));
+  }
+
+  FPDF_TEXTRUN_SINK* const m_pSink;
+  std::vector<unsigned short> m_Buffer;
+};
+
+class FindResultsSink : public CPDF_TextDocumentFind::Delegate {
+ public:
+  explicit FindResultsSink(FPDF_FIND_RESULTS_SINK* pSink) : m_pSink(pSink) {}
+
+  // CPDF_TextDocumentFind::Delegate
+  bool OnMatch(int page_index, int start, int count) override {
+    return !!m_pSink->OnMatch(m_pSink, page_index, start, count);
+  }
+  bool OnPageSearched(int page_index) override {
+    return !m_pSink->OnPageSearched ||
+           m_pSink->OnPageSearched(m_pSink, page_index);
+  }
+
+ private:
+  FPDF_FIND_RESULTS_SINK* const m_pSink;
+};
+
 }  // namespace
 
 DLLEXPORT FPDF_TEXTPAGE STDCALL FPDFText_LoadPage(FPDF_PAGE page) {
@@ -345,3 +426,59 @@ DLLEXPORT void STDCALL FPDFLink_GetRect(FPDF_PAGELINK link_page,
 DLLEXPORT void STDCALL FPDFLink_CloseWebLinks(FPDF_PAGELINK link_page) {
   delete CPDFLinkExtractFromFPDFPageLink(link_page);
 }
+
+DLLEXPORT FPDF_BOOL STDCALL FPDFText_StreamPageText(FPDF_DOCUMENT document,
+                                                    int page_index,
+                                                    FPDF_TEXTRUN_SINK* sink) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pDoc || !sink || sink->version != 1 || !sink->OnTextRun)
+    return FALSE;
+
+  if (page_index < 0 || page_index >= pDoc->GetPageCount())
+    return FALSE;
+
+  CPDF_Dictionary* pDict = pDoc->GetPage(page_index);
+  if (!pDict)
+    return FALSE;
+
+  CPDF_Page page(pDoc, pDict, false);
+  TextRunSink text_sink(sink);
+  page.ParseTextContent(&text_sink);
+  return TRUE;
+}
+
+DLLEXPORT FPDF_DOCSCHHANDLE STDCALL
+FPDFText_LoadDocumentSearch(FPDF_DOCUMENT document, FPDF_BOOL keep_text) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pDoc)
+    return nullptr;
+
+  // Same direction as FPDFText_LoadPage, so that the character indices of
+  // the matches are those of its text pages.
+  CPDF_ViewerPreferences viewRef(pDoc);
+  return new CPDF_TextDocumentFind(pDoc,
+                                   viewRef.IsDirectionR2L()
+                                       ? FPDFText_Direction::Right
+                                       : FPDFText_Direction::Left,
+                                   !!keep_text);
+}
+
+DLLEXPORT int STDCALL FPDFText_FindInDocument(FPDF_DOCSCHHANDLE handle,
+                                              FPDF_WIDESTRING findwhat,
+                                              unsigned long flags,
+                                              int start_page,
+                                              int page_count,
+                                              FPDF_FIND_RESULTS_SINK* sink) {
+  if (!handle || !findwhat || !sink || sink->version != 1 || !sink->OnMatch)
+    return -1;
+
+  FX_STRSIZE len = CFX_WideString::WStringLength(findwhat);
+  FindResultsSink results_sink(sink);
+  return CPDFTextDocumentFindFromFPDFDocSchHandle(handle)->Find(
+      CFX_WideString::FromUTF16LE(findwhat, len), flags, start_page,
+      page_count, &results_sink);
+}
+
+DLLEXPORT void STDCALL FPDFText_CloseDocumentSearch(FPDF_DOCSCHHANDLE handle) {
+  delete CPDFTextDocumentFindFromFPDFDocSchHandle(handle);
+}
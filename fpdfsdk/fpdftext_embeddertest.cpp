@@ -2,7 +2,14 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <string>
+#include <vector>
+
+#include "core/fpdfapi/fpdf_parser/cpdf_document.h"
+#include "core/fpdfapi/fpdf_parser/cpdf_stream.h"
 #include "core/fxcrt/fx_basic.h"
+#include "fpdfsdk/fsdk_define.h"
+#include "public/fpdf_edit.h"
 #include "public/fpdf_text.h"
 #include "public/fpdfview.h"
 #include "testing/embedder_test.h"
@@ -25,6 +32,81 @@ bool check_unsigned_shorts(const char* expected,
   return true;
 }
 
+struct TextRun {
+  std::string text;
+  double font_size;
+  double left;
+  double top;
+  double right;
+  double bottom;
+};
+
+struct TextRunCollector : public FPDF_TEXTRUN_SINK {
+  TextRunCollector() {
+    version = 1;
+    OnTextRun = AddRun;
+  }
+
+  static void AddRun(FPDF_TEXTRUN_SINK* pThis,
+                     FPDF_WIDESTRING text,
+                     int count,
+                     double font_size,
+                     double left,
+                     double top,
+                     double right,
+                     double bottom) {
+    TextRun run;
+    // The test documents only contain ASCII text.
+    for (int i = 0; i < count; ++i)
+      run.text.push_back(static_cast<char>(text[i]));
+    run.font_size = font_size;
+    run.left = left;
+    run.top = top;
+    run.right = right;
+    run.bottom = bottom;
+    static_cast<TextRunCollector*>(pThis)->runs.push_back(run);
+  }
+
+  std::vector<TextRun> runs;
+};
+
+struct FindMatch {
+  int page_index;
+  int start_index;
+  int count;
+};
+
+struct FindResultsCollector : public FPDF_FIND_RESULTS_SINK {
+  FindResultsCollector() : max_matches(-1), pages_searched(0) {
+    version = 1;
+    OnMatch = AddMatch;
+    OnPageSearched = PageSearched;
+  }
+
+  static FPDF_BOOL AddMatch(FPDF_FIND_RESULTS_SINK* pThis,
+                            int page_index,
+                            int start_index,
+                            int count) {
+    FindResultsCollector* collector =
+        static_cast<FindResultsCollector*>(pThis);
+    collector->matches.push_back({page_index, start_index, count});
+    return collector->max_matches < 0 ||
+           static_cast<int>(collector->matches.size()) <
+               collector->max_matches;
+  }
+
+  static FPDF_BOOL PageSearched(FPDF_FIND_RESULTS_SINK* pThis,
+                                int page_index) {
+    static_cast<FindResultsCollector*>(pThis)->pages_searched++;
+    return TRUE;
+  }
+
+  // Stop the search after this many matches, unless negative.
+  int max_matches;
+  int pages_searched;
+  std::vector<FindMatch> matches;
+};
+
 }  // namespace
 
 class FPDFTextEmbeddertest : public EmbedderTest {};
@@ -403,3 +485,204 @@ TEST_F(FPDFTextEmbeddertest, ToUnicode) {
   FPDFText_ClosePage(textpage);
   UnloadPage(page);
 }
+
+TEST_F(FPDFTextEmbeddertest, StreamPageText) {
+  EXPECT_TRUE(OpenDocument("hello_world.pdf"));
+
+  TextRunCollector collector;
+  EXPECT_FALSE(FPDFText_StreamPageText(document(), 1, &collector));
+  EXPECT_FALSE(FPDFText_StreamPageText(document(), 0, nullptr));
+  EXPECT_TRUE(collector.runs.empty());
+
+  ASSERT_TRUE(FPDFText_StreamPageText(document(), 0, &collector));
+  ASSERT_EQ(2u, collector.runs.size());
+  EXPECT_EQ("Hello, world!", collector.runs[0].text);
+  EXPECT_EQ(12, collector.runs[0].font_size);
+  EXPECT_EQ("Goodbye, world!", collector.runs[1].text);
+  EXPECT_EQ(16, collector.runs[1].font_size);
+
+  // The runs match the characters of the text page.
+  FPDF_PAGE page = LoadPage(0);
+  EXPECT_TRUE(page);
+  FPDF_TEXTPAGE textpage = FPDFText_LoadPage(page);
+  EXPECT_TRUE(textpage);
+  double left = 0.0;
+  double right = 0.0;
+  double bottom = 0.0;
+  double top = 0.0;
+  FPDFText_GetCharBox(textpage, 0, &left, &right, &bottom, &top);
+  EXPECT_NEAR(left, collector.runs[0].left, 1.0);
+  EXPECT_LE(collector.runs[0].bottom, bottom);
+  EXPECT_GE(collector.runs[0].top, top);
+  FPDFText_GetCharBox(textpage, 29, &left, &right, &bottom, &top);
+  EXPECT_NEAR(right, collector.runs[1].right, 1.0);
+  FPDFText_ClosePage(textpage);
+  UnloadPage(page);
+}
+
+TEST_F(FPDFTextEmbeddertest, StreamPageTextForm) {
+  EXPECT_TRUE(OpenDocument("text_form.pdf"));
+
+  TextRunCollector collector;
+  ASSERT_TRUE(FPDFText_StreamPageText(document(), 0, &collector));
+  ASSERT_EQ(2u, collector.runs.size());
+  EXPECT_EQ("Page", collector.runs[0].text);
+  EXPECT_NEAR(20, collector.runs[0].left, 0.5);
+
+  // Text inside a form XObject is placed through the form matrix and the
+  // current transformation of the page.
+  EXPECT_EQ("Form", collector.runs[1].text);
+  EXPECT_EQ(10, collector.runs[1].font_size);
+  EXPECT_NEAR(60, collector.runs[1].left, 0.5);
+  EXPECT_LT(collector.runs[1].bottom, 30);
+  EXPECT_GT(collector.runs[1].top, 30 + 2 * 5);
+  EXPECT_GT(collector.runs[1].right - collector.runs[1].left, 2 * 15);
+}
+
+TEST_F(FPDFTextEmbeddertest, FindInDocument) {
+  EXPECT_FALSE(FPDFText_LoadDocumentSearch(nullptr, FALSE));
+  EXPECT_TRUE(OpenDocument("text_search_pages.pdf"));
+
+  std::unique_ptr<unsigned short, pdfium::FreeDeleter> world =
+      GetFPDFWideString(L"world");
+  std::unique_ptr<unsigned short, pdfium::FreeDeleter> empty =
+      GetFPDFWideString(L"");
+
+  // The matches are those of searching every page on its own.
+  std::vector<FindMatch> expected;
+  for (int i = 0; i < GetPageCount(); ++i) {
+    FPDF_PAGE page = LoadPage(i);
+    EXPECT_TRUE(page);
+    FPDF_TEXTPAGE textpage = FPDFText_LoadPage(page);
+    EXPECT_TRUE(textpage);
+    FPDF_SCHHANDLE search = FPDFText_FindStart(textpage, world.get(), 0, 0);
+    while (FPDFText_FindNext(search)) {
+      expected.push_back({i, FPDFText_GetSchResultIndex(search),
+                          FPDFText_GetSchCount(search)});
+    }
+    FPDFText_FindClose(search);
+    FPDFText_ClosePage(textpage);
+    UnloadPage(page);
+  }
+  ASSERT_EQ(4u, expected.size());
+  EXPECT_EQ(0, expected[1].page_index);
+  EXPECT_EQ(2, expected[2].page_index);
+
+  for (FPDF_BOOL keep_text : {FALSE, TRUE}) {
+    FPDF_DOCSCHHANDLE handle =
+        FPDFText_LoadDocumentSearch(document(), keep_text);
+    ASSERT_TRUE(handle);
+    // Searching twice gives the same matches, with the text kept or not.
+    for (int pass = 0; pass < 2; ++pass) {
+      FindResultsCollector collector;
+      EXPECT_EQ(4, FPDFText_FindInDocument(handle, world.get(), 0, 0, -1,
+                                           &collector));
+      EXPECT_EQ(3, collector.pages_searched);
+      ASSERT_EQ(expected.size(), collector.matches.size());
+      for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(expected[i].page_index, collector.matches[i].page_index);
+        EXPECT_EQ(expected[i].start_index, collector.matches[i].start_index);
+        EXPECT_EQ(expected[i].count, collector.matches[i].count);
+      }
+    }
+    FPDFText_CloseDocumentSearch(handle);
+  }
+
+  FPDF_DOCSCHHANDLE handle = FPDFText_LoadDocumentSearch(document(), TRUE);
+  ASSERT_TRUE(handle);
+
+  // A range of pages.
+  FindResultsCollector range_collector;
+  EXPECT_EQ(2, FPDFText_FindInDocument(handle, world.get(), 0, 1, 5,
+                                       &range_collector));
+  EXPECT_EQ(2, range_collector.pages_searched);
+  ASSERT_EQ(2u, range_collector.matches.size());
+  EXPECT_EQ(2, range_collector.matches[0].page_index);
+
+  // Matching case.
+  FindResultsCollector case_collector;
+  EXPECT_EQ(3, FPDFText_FindInDocument(handle, world.get(), FPDF_MATCHCASE,
+                                       0, -1, &case_collector));
+
+  // Stopping after the first match.
+  FindResultsCollector stop_collector;
+  stop_collector.max_matches = 1;
+  EXPECT_EQ(1, FPDFText_FindInDocument(handle, world.get(), 0, 0, -1,
+                                       &stop_collector));
+  EXPECT_EQ(0, stop_collector.pages_searched);
+
+  // Invalid arguments.
+  FindResultsCollector bad_collector;
+  EXPECT_EQ(-1, FPDFText_FindInDocument(handle, empty.get(), 0, 0, -1,
+                                        &bad_collector));
+  EXPECT_EQ(-1,
+            FPDFText_FindInDocument(handle, world.get(), 0, 0, -1, nullptr));
+  bad_collector.version = 2;
+  EXPECT_EQ(-1, FPDFText_FindInDocument(handle, world.get(), 0, 0, -1,
+                                        &bad_collector));
+  EXPECT_TRUE(bad_collector.matches.empty());
+  FPDFText_CloseDocumentSearch(handle);
+}
+
+TEST_F(FPDFTextEmbeddertest, FindInEditedDocument) {
+  EXPECT_TRUE(OpenDocument("text_search_pages.pdf"));
+  std::unique_ptr<unsigned short, pdfium::FreeDeleter> world =
+      GetFPDFWideString(L"world");
+  FPDF_DOCSCHHANDLE handle = FPDFText_LoadDocumentSearch(document(), TRUE);
+  ASSERT_TRUE(handle);
+  FindResultsCollector collector;
+  EXPECT_EQ(4, FPDFText_FindInDocument(handle, world.get(), 0, 0, -1,
+                                       &collector));
+
+  // Regenerating the first page keeps only its images, so its text is gone.
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_TRUE(page);
+  EXPECT_TRUE(FPDFPage_GenerateContent(page));
+  UnloadPage(page);
+  FindResultsCollector regenerated_collector;
+  EXPECT_EQ(2, FPDFText_FindInDocument(handle, world.get(), 0, 0, -1,
+                                       &regenerated_collector));
+  ASSERT_EQ(2u, regenerated_collector.matches.size());
+  EXPECT_EQ(2, regenerated_collector.matches[0].page_index);
+
+  // Removing a page moves the text of the pages after it.
+  FPDFPage_Delete(document(), 1);
+  FindResultsCollector deleted_collector;
+  EXPECT_EQ(2, FPDFText_FindInDocument(handle, world.get(), 0, 0, -1,
+                                       &deleted_collector));
+  EXPECT_EQ(2, deleted_collector.pages_searched);
+  ASSERT_EQ(2u, deleted_collector.matches.size());
+  EXPECT_EQ(1, deleted_collector.matches[0].page_index);
+  EXPECT_EQ(regenerated_collector.matches[0].start_index,
+            deleted_collector.matches[0].start_index);
+  FPDFText_CloseDocumentSearch(handle);
+}
+
+TEST_F(FPDFTextEmbeddertest, FindAfterSameSizeContentEdit) {
+  EXPECT_TRUE(OpenDocument("text_search_pages.pdf"));
+  std::unique_ptr<unsigned short, pdfium::FreeDeleter> world =
+      GetFPDFWideString(L"world");
+  FPDF_DOCSCHHANDLE handle = FPDFText_LoadDocumentSearch(document(), TRUE);
+  ASSERT_TRUE(handle);
+  FindResultsCollector collector;
+  EXPECT_EQ(4, FPDFText_FindInDocument(handle, world.get(), 0, 0, -1,
+                                       &collector));
+
+  // Rewrite the content stream of the first page in place, without changing
+  // its size.
+  CPDF_Stream* pStream = ToStream(
+      CPDFDocumentFromFPDFDocument(document())->GetIndirectObject(7));
+  ASSERT_TRUE(pStream);
+  std::string content(reinterpret_cast<const char*>(pStream->GetRawData()),
+                      pStream->GetRawSize());
+  size_t pos = content.find("Goodbye, world!");
+  ASSERT_NE(std::string::npos, pos);
+  content.replace(pos, 15, "Goodbye, there!");
+  pStream->SetData(reinterpret_cast<const uint8_t*>(content.data()),
+                   content.size());
+
+  FindResultsCollector edited_collector;
+  EXPECT_EQ(3, FPDFText_FindInDocument(handle, world.get(), 0, 0, -1,
+                                       &edited_collector));
+  FPDFText_CloseDocumentSearch(handle);
+}
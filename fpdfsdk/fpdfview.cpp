@@ -6,7 +6,9 @@
 
 #include "public/fpdfview.h"
 
+#include <algorithm>
 #include <memory>
+#include <thread>
 #include <utility>
 
 #include "core/fpdfapi/cpdf_modulemgr.h"
@@ -14,9 +16,12 @@
 #include "core/fpdfapi/fpdf_page/cpdf_page.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_array.h"
 #include "core/fpdfapi/fpdf_parser/cpdf_document.h"
+#include "core/fpdfapi/fpdf_parser/cpdf_parser.h"
 #include "core/fpdfapi/fpdf_parser/fpdf_parser_decode.h"
+#include "core/fpdfapi/fpdf_render/cpdf_docimagecache.h"
 #include "core/fpdfapi/fpdf_render/cpdf_progressiverenderer.h"
 #include "core/fpdfapi/fpdf_render/cpdf_renderoptions.h"
+#include "core/fpdfapi/fpdf_render/render_int.h"
 #include "core/fpdfdoc/cpdf_annotlist.h"
 #include "core/fpdfdoc/cpdf_nametree.h"
 #include "core/fpdfdoc/cpdf_occontext.h"
@@ -24,8 +29,12 @@
 #include "core/fxcodec/fx_codec.h"
 #include "core/fxcrt/fx_memory.h"
 #include "core/fxcrt/fx_safe_types.h"
+#include "core/fxge/cfx_fontmapper.h"
+#include "core/fxge/cfx_fontmgr.h"
 #include "core/fxge/cfx_fxgedevice.h"
 #include "core/fxge/cfx_gemodule.h"
+#include "core/fxge/ge/cfx_embeddedfontregistry.h"
+#include "core/fxge/ge/cfx_persistentglyphcache.h"
 #include "fpdfsdk/cpdfsdk_pageview.h"
 #include "fpdfsdk/fsdk_define.h"
 #include "fpdfsdk/fsdk_pauseadapter.h"
@@ -273,7 +282,11 @@ FPDF_InitLibraryWithConfig(const FPDF_LIBRARY_CONFIG* cfg) {
   g_pCodecModule = new CCodec_ModuleMgr();
 
   CFX_GEModule* pModule = CFX_GEModule::Get();
+  if (cfg && cfg->version >= 4)
+    pModule->SetFontIndexPath(cfg->m_pFontIndexPath);
   pModule->Init(cfg ? cfg->m_pUserFontPaths : nullptr, g_pCodecModule);
+  if (cfg && cfg->version >= 5 && cfg->m_EmbeddedFontCacheSize)
+    pModule->InitEmbeddedFontRegistry(cfg->m_EmbeddedFontCacheSize);
   CPDF_ModuleMgr* pModuleMgr = CPDF_ModuleMgr::Get();
   pModuleMgr->SetCodecModule(g_pCodecModule);
   pModuleMgr->InitPageModule();
@@ -290,6 +303,9 @@ FPDF_InitLibraryWithConfig(const FPDF_LIBRARY_CONFIG* cfg) {
 
   if (cfg && cfg->version >= 2)
     IJS_Runtime::Initialize(cfg->m_v8EmbedderSlot, cfg->m_pIsolate);
+
+  if (cfg && cfg->version >= 3 && cfg->m_pGlyphCachePath)
+    pModule->InitGlyphCache(cfg->m_pGlyphCachePath);
 }
 
 DLLEXPORT void STDCALL FPDF_DestroyLibrary() {
@@ -305,6 +321,57 @@ DLLEXPORT void STDCALL FPDF_DestroyLibrary() {
   IJS_Runtime::Destroy();
 }
 
+DLLEXPORT FPDF_BOOL STDCALL FPDF_GetGlyphCacheStats(unsigned long* hits,
+                                                    unsigned long* misses) {
+  CFX_PersistentGlyphCache* pGlyphCache =
+      CFX_GEModule::Get()->GetGlyphCache();
+  if (!pGlyphCache)
+    return FALSE;
+
+  if (hits)
+    *hits = pGlyphCache->GetHitCount();
+  if (misses)
+    *misses = pGlyphCache->GetMissCount();
+  return TRUE;
+}
+
+DLLEXPORT FPDF_BOOL STDCALL FPDF_FlushGlyphCache() {
+  CFX_PersistentGlyphCache* pGlyphCache =
+      CFX_GEModule::Get()->GetGlyphCache();
+  return pGlyphCache && pGlyphCache->Flush();
+}
+
+DLLEXPORT FPDF_BOOL STDCALL FPDF_GetFontSubstStats(unsigned long* hits,
+                                                   unsigned long* misses,
+                                                   double* saved_ms) {
+  CFX_FontMapper* pMapper =
+      CFX_GEModule::Get()->GetFontMgr()->GetBuiltinMapper();
+  if (hits)
+    *hits = pMapper->GetSubstCacheHitCount();
+  if (misses)
+    *misses = pMapper->GetSubstCacheMissCount();
+  if (saved_ms)
+    *saved_ms = pMapper->GetSubstCacheSavedTime();
+  return TRUE;
+}
+
+DLLEXPORT FPDF_BOOL STDCALL FPDF_GetEmbeddedFontStats(unsigned long* hits,
+                                                      unsigned long* misses,
+                                                      unsigned long* size) {
+  CFX_EmbeddedFontRegistry* pRegistry =
+      CFX_GEModule::Get()->GetEmbeddedFontRegistry();
+  if (!pRegistry)
+    return FALSE;
+
+  if (hits)
+    *hits = pRegistry->GetHitCount();
+  if (misses)
+    *misses = pRegistry->GetMissCount();
+  if (size)
+    *size = pRegistry->GetSize();
+  return TRUE;
+}
+
 #ifndef _WIN32
 int g_LastError;
 void SetLastError(int err) {
@@ -355,14 +422,12 @@ DLLEXPORT void STDCALL FPDF_SetPrintTextWithGDI(FPDF_BOOL use_gdi) {
 }
 #endif
 
-DLLEXPORT FPDF_DOCUMENT STDCALL FPDF_LoadDocument(FPDF_STRING file_path,
-                                                  FPDF_BYTESTRING password) {
-  // NOTE: the creation of the file needs to be by the embedder on the
-  // other side of this API.
-  IFX_FileRead* pFileAccess = FX_CreateFileRead((const FX_CHAR*)file_path);
-  if (!pFileAccess) {
+namespace {
+
+FPDF_DOCUMENT LoadDocumentFromFile(IFX_FileRead* pFileAccess,
+                                   FPDF_BYTESTRING password) {
+  if (!pFileAccess)
     return nullptr;
-  }
 
   std::unique_ptr<CPDF_Parser> pParser(new CPDF_Parser);
   pParser->SetPassword(password);
@@ -382,6 +447,22 @@ DLLEXPORT FPDF_DOCUMENT STDCALL FPDF_LoadDocument(FPDF_STRING file_path,
 #endif  // PDF_ENABLE_XFA
 }
 
+}  // namespace
+
+DLLEXPORT FPDF_DOCUMENT STDCALL FPDF_LoadDocument(FPDF_STRING file_path,
+                                                  FPDF_BYTESTRING password) {
+  // NOTE: the creation of the file needs to be by the embedder on the
+  // other side of this API.
+  return LoadDocumentFromFile(FX_CreateFileRead((const FX_CHAR*)file_path),
+                              password);
+}
+
+DLLEXPORT FPDF_DOCUMENT STDCALL
+FPDF_LoadMappedDocument(FPDF_STRING file_path, FPDF_BYTESTRING password) {
+  return LoadDocumentFromFile(
+      FX_CreateMappedFileRead((const FX_CHAR*)file_path), password);
+}
+
 #ifdef PDF_ENABLE_XFA
 DLLEXPORT FPDF_BOOL STDCALL FPDF_HasXFAField(FPDF_DOCUMENT document,
                                              int* docType) {
@@ -434,6 +515,7 @@ class CMemFile final : public IFX_FileRead {
     FXSYS_memcpy(buffer, m_pBuf + offset, size);
     return TRUE;
   }
+  const uint8_t* GetDirectBuffer() override { return m_pBuf; }
 
  private:
   ~CMemFile() override {}
@@ -523,6 +605,51 @@ DLLEXPORT int STDCALL FPDF_GetSecurityHandlerRevision(FPDF_DOCUMENT document) {
   return pDict ? pDict->GetIntegerFor("R") : -1;
 }
 
+DLLEXPORT FPDF_BOOL STDCALL FPDF_LoadAllObjects(FPDF_DOCUMENT document) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pDoc)
+    return FALSE;
+
+  pDoc->LoadAllIndirectObjects();
+  return TRUE;
+}
+
+DLLEXPORT int STDCALL FPDF_LoadObjectStreams(FPDF_DOCUMENT document,
+                                             int threads) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pDoc || !pDoc->GetParser())
+    return 0;
+
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  return pDoc->GetParser()->LoadAllObjectStreams(threads);
+}
+
+DLLEXPORT void STDCALL FPDF_SetImageCacheLimit(FPDF_DOCUMENT document,
+                                               unsigned long limit) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (pDoc)
+    pDoc->GetRenderData()->GetImageCache()->SetLimit(limit);
+}
+
+DLLEXPORT FPDF_BOOL STDCALL FPDF_GetImageCacheStats(FPDF_DOCUMENT document,
+                                                    unsigned long* hits,
+                                                    unsigned long* misses,
+                                                    unsigned long* size) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pDoc)
+    return FALSE;
+
+  CPDF_DocImageCache* pCache = pDoc->GetRenderData()->GetImageCache();
+  if (hits)
+    *hits = pCache->GetHitCount();
+  if (misses)
+    *misses = pCache->GetMissCount();
+  if (size)
+    *size = pCache->GetSize();
+  return TRUE;
+}
+
 DLLEXPORT int STDCALL FPDF_GetPageCount(FPDF_DOCUMENT document) {
   UnderlyingDocumentType* pDoc = UnderlyingFromFPDFDocument(document);
   return pDoc ? pDoc->GetPageCount() : 0;
@@ -142,6 +142,7 @@ int CheckPDFiumCApi() {
 
     // fpdf_progressive.h
     CHK(FPDF_RenderPageBitmap_Start);
+    CHK(FPDF_RenderPageBitmapTile_Start);
     CHK(FPDF_RenderPage_Continue);
     CHK(FPDF_RenderPage_Close);
 
@@ -182,6 +183,10 @@ int CheckPDFiumCApi() {
     CHK(FPDFLink_CountRects);
     CHK(FPDFLink_GetRect);
     CHK(FPDFLink_CloseWebLinks);
+    CHK(FPDFText_StreamPageText);
+    CHK(FPDFText_LoadDocumentSearch);
+    CHK(FPDFText_FindInDocument);
+    CHK(FPDFText_CloseDocumentSearch);
 
     // fpdf_transformpage.h
     CHK(FPDFPage_SetMediaBox);
@@ -198,14 +203,23 @@ int CheckPDFiumCApi() {
     CHK(FPDF_InitLibrary);
     CHK(FPDF_InitLibraryWithConfig);
     CHK(FPDF_DestroyLibrary);
+    CHK(FPDF_GetGlyphCacheStats);
+    CHK(FPDF_FlushGlyphCache);
+    CHK(FPDF_GetFontSubstStats);
+    CHK(FPDF_GetEmbeddedFontStats);
     CHK(FPDF_SetSandBoxPolicy);
     CHK(FPDF_LoadDocument);
+    CHK(FPDF_LoadMappedDocument);
     CHK(FPDF_LoadMemDocument);
     CHK(FPDF_LoadCustomDocument);
     CHK(FPDF_GetFileVersion);
     CHK(FPDF_GetLastError);
     CHK(FPDF_GetDocPermissions);
     CHK(FPDF_GetSecurityHandlerRevision);
+    CHK(FPDF_LoadAllObjects);
+    CHK(FPDF_LoadObjectStreams);
+    CHK(FPDF_SetImageCacheLimit);
+    CHK(FPDF_GetImageCacheStats);
     CHK(FPDF_GetPageCount);
     CHK(FPDF_LoadPage);
     CHK(FPDF_GetPageWidth);
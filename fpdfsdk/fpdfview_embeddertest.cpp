@@ -2,13 +2,23 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
 #include <limits>
 #include <string>
+#include <vector>
 
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "core/fpdfapi/fpdf_parser/cpdf_document.h"
 #include "fpdfsdk/fpdfview_c_api_test.h"
+#include "fpdfsdk/fsdk_define.h"
 #include "public/fpdfview.h"
 #include "testing/embedder_test.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "testing/utils/path_service.h"
 
 TEST(fpdf, CApiTest) {
   EXPECT_TRUE(CheckPDFiumCApi());
@@ -30,6 +40,22 @@ TEST_F(FPDFViewEmbeddertest, Document) {
 }
 
 // See bug 465.
+TEST_F(FPDFViewEmbeddertest, MappedDocument) {
+  std::string path;
+  ASSERT_TRUE(PathService::GetTestFilePath("hello_world.pdf", &path));
+  EXPECT_FALSE(FPDF_LoadMappedDocument("no_such_file.pdf", nullptr));
+  for (bool bMapped : {false, true}) {
+    FPDF_DOCUMENT doc = bMapped ? FPDF_LoadMappedDocument(path.c_str(), nullptr)
+                                : FPDF_LoadDocument(path.c_str(), nullptr);
+    ASSERT_TRUE(doc);
+    EXPECT_EQ(1, FPDF_GetPageCount(doc));
+    FPDF_PAGE page = FPDF_LoadPage(doc, 0);
+    EXPECT_TRUE(page);
+    FPDF_ClosePage(page);
+    FPDF_CloseDocument(doc);
+  }
+}
+
 TEST_F(FPDFViewEmbeddertest, EmptyDocument) {
   EXPECT_TRUE(CreateEmptyDocument());
 
@@ -214,6 +240,214 @@ TEST_F(FPDFViewEmbeddertest, NamedDestsByName) {
   EXPECT_EQ(nullptr, dest);
 }
 
+TEST_F(FPDFViewEmbeddertest, LoadAllObjects) {
+  EXPECT_FALSE(FPDF_LoadAllObjects(nullptr));
+
+  EXPECT_TRUE(OpenDocument("annotiter.pdf"));
+  const int page_count = GetPageCount();
+  EXPECT_EQ(3, page_count);
+
+  // Render every page with lazy object loading.
+  std::vector<std::string> expected;
+  for (int i = 0; i < page_count; ++i) {
+    FPDF_PAGE page = LoadPage(i);
+    EXPECT_NE(nullptr, page);
+    FPDF_BITMAP bitmap = RenderPage(page);
+    const char* buffer =
+        static_cast<const char*>(FPDFBitmap_GetBuffer(bitmap));
+    expected.push_back(std::string(
+        buffer, FPDFBitmap_GetStride(bitmap) * FPDFBitmap_GetHeight(bitmap)));
+    FPDFBitmap_Destroy(bitmap);
+    UnloadPage(page);
+  }
+
+  // Rendering from a fully loaded document, in a different page order, must
+  // produce the same output.
+  EXPECT_TRUE(FPDF_LoadAllObjects(document()));
+  for (int i = page_count - 1; i >= 0; --i) {
+    FPDF_PAGE page = LoadPage(i);
+    EXPECT_NE(nullptr, page);
+    FPDF_BITMAP bitmap = RenderPage(page);
+    const char* buffer =
+        static_cast<const char*>(FPDFBitmap_GetBuffer(bitmap));
+    EXPECT_EQ(expected[i],
+              std::string(buffer, FPDFBitmap_GetStride(bitmap) *
+                                      FPDFBitmap_GetHeight(bitmap)))
+        << "page " << i;
+    FPDFBitmap_Destroy(bitmap);
+    UnloadPage(page);
+  }
+}
+
+#ifndef _WIN32
+TEST_F(FPDFViewEmbeddertest, LoadAllObjectsForkedWorkers) {
+  EXPECT_TRUE(OpenDocument("annotiter.pdf"));
+  const int page_count = GetPageCount();
+  EXPECT_TRUE(FPDF_LoadAllObjects(document()));
+
+  std::vector<std::string> expected;
+  for (int i = 0; i < page_count; ++i) {
+    FPDF_PAGE page = LoadPage(i);
+    EXPECT_NE(nullptr, page);
+    FPDF_BITMAP bitmap = RenderPage(page);
+    const char* buffer =
+        static_cast<const char*>(FPDFBitmap_GetBuffer(bitmap));
+    expected.push_back(std::string(
+        buffer, FPDFBitmap_GetStride(bitmap) * FPDFBitmap_GetHeight(bitmap)));
+    FPDFBitmap_Destroy(bitmap);
+    UnloadPage(page);
+  }
+
+  // Every worker renders all pages of the shared document, each starting at
+  // a different page, and exits with the number of mismatching pages.
+  const int kWorkers = 8;
+  const int kRounds = 4;
+  std::vector<pid_t> workers;
+  for (int worker = 0; worker < kWorkers; ++worker) {
+    pid_t pid = fork();
+    ASSERT_NE(-1, pid);
+    if (pid) {
+      workers.push_back(pid);
+      continue;
+    }
+    int mismatches = 0;
+    for (int round = 0; round < kRounds * page_count; ++round) {
+      int i = (worker + round) % page_count;
+      FPDF_PAGE page = LoadPage(i);
+      if (!page) {
+        ++mismatches;
+        continue;
+      }
+      FPDF_BITMAP bitmap = RenderPage(page);
+      const char* buffer =
+          static_cast<const char*>(FPDFBitmap_GetBuffer(bitmap));
+      if (expected[i] !=
+          std::string(buffer, FPDFBitmap_GetStride(bitmap) *
+                                  FPDFBitmap_GetHeight(bitmap))) {
+        ++mismatches;
+      }
+      FPDFBitmap_Destroy(bitmap);
+      UnloadPage(page);
+    }
+    // Skip the test fixture's teardown, which belongs to the parent.
+    _exit(std::min(mismatches, 255));
+  }
+  for (pid_t pid : workers) {
+    int status = 0;
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(0, WEXITSTATUS(status)) << "worker " << pid;
+  }
+}
+#endif  // _WIN32
+
+TEST_F(FPDFViewEmbeddertest, LoadObjectStreams) {
+  EXPECT_EQ(0, FPDF_LoadObjectStreams(nullptr, 1));
+
+  EXPECT_TRUE(OpenDocument("feature_linearized_loading.pdf"));
+  EXPECT_EQ(7, FPDF_LoadObjectStreams(document(), 4));
+  // Streams that are already loaded are counted again.
+  EXPECT_EQ(7, FPDF_LoadObjectStreams(document(), 1));
+
+  // Pages render the same as in a copy whose streams are loaded lazily.
+  FPDF_DOCUMENT lazy_document =
+      FPDF_LoadMemDocument(file_contents_.get(), file_length_, nullptr);
+  ASSERT_NE(nullptr, lazy_document);
+  const int page_count = GetPageCount();
+  EXPECT_EQ(2, page_count);
+  EXPECT_EQ(page_count, FPDF_GetPageCount(lazy_document));
+  for (int i = 0; i < page_count; ++i) {
+    FPDF_PAGE pages[2] = {FPDF_LoadPage(document(), i),
+                          FPDF_LoadPage(lazy_document, i)};
+    std::string buffers[2];
+    for (int j = 0; j < 2; ++j) {
+      ASSERT_NE(nullptr, pages[j]);
+      FPDF_BITMAP bitmap = FPDFBitmap_Create(200, 200, 0);
+      FPDFBitmap_FillRect(bitmap, 0, 0, 200, 200, 0xFFFFFFFF);
+      FPDF_RenderPageBitmap(bitmap, pages[j], 0, 0, 200, 200, 0, 0);
+      buffers[j].assign(static_cast<const char*>(FPDFBitmap_GetBuffer(bitmap)),
+                        FPDFBitmap_GetStride(bitmap) * 200);
+      FPDFBitmap_Destroy(bitmap);
+      FPDF_ClosePage(pages[j]);
+    }
+    EXPECT_TRUE(buffers[0] == buffers[1]) << "page " << i;
+  }
+  FPDF_CloseDocument(lazy_document);
+}
+
+TEST_F(FPDFViewEmbeddertest, ImageCache) {
+  EXPECT_FALSE(FPDF_GetImageCacheStats(nullptr, nullptr, nullptr, nullptr));
+
+  // Every page draws Im1, the second page also draws Im2.
+  EXPECT_TRUE(OpenDocument("shared_image.pdf"));
+  const int page_count = GetPageCount();
+  EXPECT_EQ(3, page_count);
+
+  unsigned long hits = 0;
+  unsigned long misses = 0;
+  unsigned long size = 0;
+  for (int i = 0; i < page_count; ++i) {
+    FPDF_PAGE page = LoadPage(i);
+    EXPECT_NE(nullptr, page);
+    FPDF_BITMAP bitmap = RenderPage(page);
+    FPDFBitmap_Destroy(bitmap);
+    UnloadPage(page);
+  }
+  EXPECT_TRUE(FPDF_GetImageCacheStats(document(), &hits, &misses, &size));
+  EXPECT_EQ(2u, hits);
+  EXPECT_EQ(2u, misses);
+  EXPECT_LT(0u, size);
+
+  // Images are dropped once they no longer fit, and decoded again on the next
+  // render.
+  FPDF_SetImageCacheLimit(document(), 0);
+  EXPECT_TRUE(FPDF_GetImageCacheStats(document(), nullptr, nullptr, &size));
+  EXPECT_EQ(0u, size);
+
+  FPDF_PAGE page = LoadPage(0);
+  EXPECT_NE(nullptr, page);
+  FPDF_BITMAP bitmap = RenderPage(page);
+  FPDFBitmap_Destroy(bitmap);
+  UnloadPage(page);
+  EXPECT_TRUE(FPDF_GetImageCacheStats(document(), &hits, &misses, &size));
+  EXPECT_EQ(2u, hits);
+  EXPECT_EQ(3u, misses);
+  EXPECT_EQ(0u, size);
+}
+
+TEST_F(FPDFViewEmbeddertest, ImageCacheReleasedObject) {
+  EXPECT_TRUE(OpenDocument("shared_image.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  EXPECT_NE(nullptr, page);
+  FPDF_BITMAP bitmap = RenderPage(page);
+  FPDFBitmap_Destroy(bitmap);
+  UnloadPage(page);
+
+  unsigned long hits = 0;
+  unsigned long misses = 0;
+  unsigned long size = 0;
+  EXPECT_TRUE(FPDF_GetImageCacheStats(document(), &hits, &misses, &size));
+  EXPECT_EQ(0u, hits);
+  EXPECT_EQ(1u, misses);
+  EXPECT_LT(0u, size);
+
+  // Releasing Im1 drops its decoded image, even if the stream parsed again
+  // later happens to land at the same address.
+  CPDFDocumentFromFPDFDocument(document())->ReleaseIndirectObject(8);
+  EXPECT_TRUE(FPDF_GetImageCacheStats(document(), nullptr, nullptr, &size));
+  EXPECT_EQ(0u, size);
+
+  page = LoadPage(0);
+  EXPECT_NE(nullptr, page);
+  bitmap = RenderPage(page);
+  FPDFBitmap_Destroy(bitmap);
+  UnloadPage(page);
+  EXPECT_TRUE(FPDF_GetImageCacheStats(document(), &hits, &misses, &size));
+  EXPECT_EQ(0u, hits);
+  EXPECT_EQ(2u, misses);
+  EXPECT_LT(0u, size);
+}
+
 // The following tests pass if the document opens without crashing.
 TEST_F(FPDFViewEmbeddertest, Crasher_113) {
   EXPECT_TRUE(OpenDocument("bug_113.pdf"));
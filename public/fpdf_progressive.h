@@ -86,6 +86,50 @@ DLLEXPORT int STDCALL FPDF_RenderPageBitmap_Start(FPDF_BITMAP bitmap,
                                                   int flags,
                                                   IFSDK_PAUSE* pause);
 
+// Function: FPDF_RenderPageBitmapTile_Start
+//          Start to render one tile of a page's display area to a device
+//          independent bitmap progressively.
+// Parameters:
+//          bitmap      -   Handle to the device independent bitmap that
+//                          receives the tile. Its width and height are the
+//                          tile size.
+//          page        -   Handle to the page. Returned by FPDF_LoadPage
+//                          function.
+//          size_x      -   Horizontal size (in pixels) of the whole display
+//                          area for the page.
+//          size_y      -   Vertical size (in pixels) of the whole display
+//                          area for the page.
+//          rotate      -   Page orientation. See FPDF_RenderPageBitmap_Start.
+//          tile_x      -   Left pixel position of the tile within the display
+//                          area.
+//          tile_y      -   Top pixel position of the tile within the display
+//                          area.
+//          flags       -   Same as for FPDF_RenderPageBitmap_Start.
+//          pause       -   The IFSDK_PAUSE interface. See
+//                          FPDF_RenderPageBitmap_Start.
+// Return value:
+//          Rendering Status. See flags for progressive process status for the
+//          details.
+// Comments:
+//          The tile is pixel-identical to the same region of a single render
+//          of the whole display area. Page objects that do not intersect the
+//          tile are skipped, so a large page can be rendered tile by tile
+//          without allocating a bitmap for the whole display area.
+//          PDFium is not thread-safe: tiles of one page must be rendered one
+//          at a time within a process, but independent processes may render
+//          disjoint tiles of the same page concurrently.
+//          Use FPDF_RenderPage_Continue and FPDF_RenderPage_Close as for
+//          FPDF_RenderPageBitmap_Start.
+DLLEXPORT int STDCALL FPDF_RenderPageBitmapTile_Start(FPDF_BITMAP bitmap,
+                                                      FPDF_PAGE page,
+                                                      int size_x,
+                                                      int size_y,
+                                                      int rotate,
+                                                      int tile_x,
+                                                      int tile_y,
+                                                      int flags,
+                                                      IFSDK_PAUSE* pause);
+
 // Function: FPDF_RenderPage_Continue
 //          Continue rendering a PDF page.
 // Parameters:
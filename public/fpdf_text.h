@@ -312,6 +312,118 @@ DLLEXPORT int STDCALL FPDFText_GetSchCount(FPDF_SCHHANDLE handle);
 //
 DLLEXPORT void STDCALL FPDFText_FindClose(FPDF_SCHHANDLE handle);
 
+// Structure for receiving matches from FPDFText_FindInDocument.
+typedef struct FPDF_FIND_RESULTS_SINK_ {
+  //
+  // Version number of the interface. Currently must be 1.
+  //
+  int version;
+
+  //
+  // Method: OnMatch
+  //          Receive one match.
+  // Interface Version:
+  //          1
+  // Implementation Required:
+  //          Yes
+  // Comments:
+  //          Called by function FPDFText_FindInDocument, in page order and
+  //          in text order within a page, as soon as the match is found.
+  // Parameters:
+  //          pThis       -   Pointer to the structure itself.
+  //          page_index  -   Index number of the page. 0 for the first page.
+  //          start_index -   Index of the first matched character, as
+  //                          returned by FPDFText_GetSchResultIndex for the
+  //                          text page of FPDFText_LoadPage.
+  //          count       -   Number of matched characters, as returned by
+  //                          FPDFText_GetSchCount.
+  // Return value:
+  //          TRUE to continue the search, FALSE to stop it.
+  //
+  FPDF_BOOL (*OnMatch)(struct FPDF_FIND_RESULTS_SINK_* pThis,
+                       int page_index,
+                       int start_index,
+                       int count);
+
+  //
+  // Method: OnPageSearched
+  //          Called after each page is searched, whether or not it had
+  //          matches, to report progress or cancel a long search.
+  // Interface Version:
+  //          1
+  // Implementation Required:
+  //          No. May be NULL.
+  // Parameters:
+  //          pThis       -   Pointer to the structure itself.
+  //          page_index  -   Index number of the page.
+  // Return value:
+  //          TRUE to continue the search, FALSE to stop it.
+  //
+  FPDF_BOOL (*OnPageSearched)(struct FPDF_FIND_RESULTS_SINK_* pThis,
+                              int page_index);
+} FPDF_FIND_RESULTS_SINK;
+
+// Function: FPDFText_LoadDocumentSearch
+//          Prepare to search the text of many pages of a document.
+// Parameters:
+//          document    -   Handle to document. Returned by FPDF_LoadDocument.
+//          keep_text   -   Whether to keep the text of every page searched,
+//                          so that later searches do not load the page again.
+// Return value:
+//          A handle for the document search context, NULL if |document| is
+//          invalid. FPDFText_CloseDocumentSearch must be called to release
+//          it, before the document is closed.
+// Comments:
+//          The kept text is a small fraction of the memory of a loaded page.
+//          The text of a page is extracted again when another page is at its
+//          index, or when its content streams were replaced or their data
+//          changed since, as by FPDFPage_GenerateContent. Only the page's
+//          own /Contents is checked. After edits to its resources, such as
+//          form XObjects or a font's /ToUnicode map, close the context and
+//          load a new one to search the edited text.
+//
+DLLEXPORT FPDF_DOCSCHHANDLE STDCALL
+FPDFText_LoadDocumentSearch(FPDF_DOCUMENT document, FPDF_BOOL keep_text);
+
+// Function: FPDFText_FindInDocument
+//          Search the text of a range of pages.
+// Parameters:
+//          handle      -   A document search context handle returned by
+//                          FPDFText_LoadDocumentSearch.
+//          findwhat    -   A unicode match pattern. Must not be empty.
+//          flags       -   Option flags, as for FPDFText_FindStart.
+//          start_page  -   Index number of the first page to search.
+//          page_count  -   Number of pages to search, -1 for all pages from
+//                          |start_page| to the end of the document.
+//          sink        -   A pointer to a find results sink structure.
+// Return value:
+//          The number of matches passed to |sink|, or -1 if the arguments
+//          are invalid.
+// Comments:
+//          Every page without kept text is loaded, searched and released
+//          before the next one, so memory use does not grow with the
+//          number of pages. Matches are passed to |sink| as they are found.
+//          The search is serial: pages are searched one after another on the
+//          calling thread, as a document must not be used by several threads
+//          at once.
+//
+DLLEXPORT int STDCALL FPDFText_FindInDocument(FPDF_DOCSCHHANDLE handle,
+                                              FPDF_WIDESTRING findwhat,
+                                              unsigned long flags,
+                                              int start_page,
+                                              int page_count,
+                                              FPDF_FIND_RESULTS_SINK* sink);
+
+// Function: FPDFText_CloseDocumentSearch
+//          Release a document search context and the text it kept.
+// Parameters:
+//          handle      -   A document search context handle returned by
+//                          FPDFText_LoadDocumentSearch.
+// Return value:
+//          None.
+//
+DLLEXPORT void STDCALL FPDFText_CloseDocumentSearch(FPDF_DOCSCHHANDLE handle);
+
 // Function: FPDFLink_LoadWebLinks
 //          Prepare information about weblinks in a page.
 // Parameters:
@@ -417,6 +529,69 @@ DLLEXPORT void STDCALL FPDFLink_GetRect(FPDF_PAGELINK link_page,
 //
 DLLEXPORT void STDCALL FPDFLink_CloseWebLinks(FPDF_PAGELINK link_page);
 
+// Structure for receiving text from FPDFText_StreamPageText.
+typedef struct FPDF_TEXTRUN_SINK_ {
+  //
+  // Version number of the interface. Currently must be 1.
+  //
+  int version;
+
+  //
+  // Method: OnTextRun
+  //          Receive one run of text, i.e. the text shown by a single text
+  //          showing operator in the page content.
+  // Interface Version:
+  //          1
+  // Implementation Required:
+  //          Yes
+  // Comments:
+  //          Called by function FPDFText_StreamPageText, in content order.
+  //          Runs are not reordered, merged or separated by spaces.
+  // Parameters:
+  //          pThis       -   Pointer to the structure itself.
+  //          text        -   The UTF-16LE characters of the run, not NUL
+  //                          terminated. Only valid during the call.
+  //          count       -   The number of UTF-16 code units in |text|.
+  //          font_size   -   The font size of the run, in text space units.
+  //          left        -   The left boundary of the run, in page
+  //                          coordinates.
+  //          top         -   The top boundary of the run.
+  //          right       -   The right boundary of the run.
+  //          bottom      -   The bottom boundary of the run.
+  // Return value:
+  //          None.
+  //
+  void (*OnTextRun)(struct FPDF_TEXTRUN_SINK_* pThis,
+                    FPDF_WIDESTRING text,
+                    int count,
+                    double font_size,
+                    double left,
+                    double top,
+                    double right,
+                    double bottom);
+} FPDF_TEXTRUN_SINK;
+
+// Function: FPDFText_StreamPageText
+//          Extract the text of a page without loading it.
+// Parameters:
+//          document    -   Handle to document. Returned by FPDF_LoadDocument.
+//          page_index  -   Index number of the page. 0 for the first page.
+//          sink        -   A pointer to a text run sink structure.
+// Return value:
+//          TRUE if the page content was processed, FALSE if the arguments
+//          are invalid.
+// Comments:
+//          The page content is parsed once and every text run is passed to
+//          |sink| as soon as it is read; neither the page objects nor the
+//          character list of FPDFText_LoadPage are built, and images, paths
+//          and shadings are skipped. Memory use therefore does not grow with
+//          the size of the page. Use this for indexing; it does not provide
+//          the reading order or layout analysis of FPDFText_GetText.
+//
+DLLEXPORT FPDF_BOOL STDCALL FPDFText_StreamPageText(FPDF_DOCUMENT document,
+                                                    int page_index,
+                                                    FPDF_TEXTRUN_SINK* sink);
+
 #ifdef __cplusplus
 }
 #endif
@@ -151,7 +151,7 @@ DLLEXPORT void STDCALL FPDF_InitLibrary();
 
 // Process-wide options for initializing the library.
 typedef struct FPDF_LIBRARY_CONFIG_ {
-  // Version number of the interface. Currently must be 2.
+  // Version number of the interface. Currently must be 2, 3, 4 or 5.
   int version;
 
   // Array of paths to scan in place of the defaults when using built-in
@@ -170,6 +170,30 @@ typedef struct FPDF_LIBRARY_CONFIG_ {
   // v8::Internals::kNumIsolateDataLots (exclusive). Note that 0 is fine
   // for most embedders.
   unsigned int m_v8EmbedderSlot;
+
+  // Version 3.
+
+  // Path of a file that caches rendered glyphs across processes, or NULL to
+  // only cache them in memory. The file is created if it does not exist, and
+  // may be shared by any number of processes. Glyphs rendered by this process
+  // are added to it by FPDF_FlushGlyphCache() and FPDF_DestroyLibrary().
+  const char* m_pGlyphCachePath;
+
+  // Version 4.
+
+  // Path of a file that lists the fonts found by the built-in FXGE font
+  // loading code, or NULL to scan the font paths in every process. The file
+  // is created if it does not exist, and rewritten when a font or folder in
+  // the font paths changes. Ignored on platforms that do not scan folders.
+  const char* m_pFontIndexPath;
+
+  // Version 5.
+
+  // Number of bytes of embedded font programs to keep loaded after the
+  // documents that embed them are closed, or 0 to free every embedded font
+  // with its document. When not 0, fonts whose programs are identical share
+  // one loaded copy and its rendered glyphs, across pages and documents.
+  unsigned long m_EmbeddedFontCacheSize;
 } FPDF_LIBRARY_CONFIG;
 
 // Function: FPDF_InitLibraryWithConfig
@@ -197,6 +221,70 @@ DLLEXPORT void STDCALL FPDF_InitLibraryWithConfig(
 //          processing functions.
 DLLEXPORT void STDCALL FPDF_DestroyLibrary();
 
+// Function: FPDF_GetGlyphCacheStats
+//          Get usage counters of the glyph cache file.
+// Parameters:
+//          hits        -   Receives the number of glyphs that were found in
+//                          the cache file. May be NULL.
+//          misses      -   Receives the number of glyphs that had to be
+//                          rendered. May be NULL.
+// Return value:
+//          TRUE on success, FALSE if no glyph cache file is configured with
+//          FPDF_LIBRARY_CONFIG.
+// Comments:
+//          Only glyphs missing from the in-memory cache of the process are
+//          counted.
+DLLEXPORT FPDF_BOOL STDCALL FPDF_GetGlyphCacheStats(unsigned long* hits,
+                                                    unsigned long* misses);
+
+// Function: FPDF_FlushGlyphCache
+//          Add the glyphs rendered since the last flush to the glyph cache
+//          file.
+// Parameters:
+//          None.
+// Return value:
+//          TRUE on success, FALSE if no glyph cache file is configured with
+//          FPDF_LIBRARY_CONFIG or the file could not be written.
+// Comments:
+//          FPDF_DestroyLibrary() flushes as well. Processes that may be
+//          killed before they get there, such as pooled workers, should call
+//          this after each job.
+DLLEXPORT FPDF_BOOL STDCALL FPDF_FlushGlyphCache();
+
+// Function: FPDF_GetFontSubstStats
+//          Get usage counters of the cache of font substitutions, which
+//          remembers the system font chosen for each font that is not
+//          embedded, for all documents.
+// Parameters:
+//          hits        -   Receives the number of substitutions that were
+//                          found in the cache. May be NULL.
+//          misses      -   Receives the number of substitutions that had to
+//                          be looked up. May be NULL.
+//          saved_ms    -   Receives an estimate of the time the cache saved,
+//                          in milliseconds: for every hit, how long the
+//                          lookup that filled the entry took. May be NULL.
+// Return value:
+//          TRUE on success.
+DLLEXPORT FPDF_BOOL STDCALL FPDF_GetFontSubstStats(unsigned long* hits,
+                                                   unsigned long* misses,
+                                                   double* saved_ms);
+
+// Function: FPDF_GetEmbeddedFontStats
+//          Get usage counters of the cache of embedded font programs.
+// Parameters:
+//          hits        -   Receives the number of embedded fonts that shared
+//                          a program loaded before. May be NULL.
+//          misses      -   Receives the number of embedded font programs that
+//                          had to be loaded. May be NULL.
+//          size        -   Receives the number of bytes of font programs
+//                          currently loaded, in use or not. May be NULL.
+// Return value:
+//          TRUE on success, FALSE if the cache is disabled with
+//          FPDF_LIBRARY_CONFIG.
+DLLEXPORT FPDF_BOOL STDCALL FPDF_GetEmbeddedFontStats(unsigned long* hits,
+                                                      unsigned long* misses,
+                                                      unsigned long* size);
+
 // Policy for accessing the local machine time.
 #define FPDF_POLICY_MACHINETIME_ACCESS 0
 
@@ -254,6 +342,28 @@ DLLEXPORT void STDCALL FPDF_SetPrintTextWithGDI(FPDF_BOOL use_gdi);
 DLLEXPORT FPDF_DOCUMENT STDCALL FPDF_LoadDocument(FPDF_STRING file_path,
                                                   FPDF_BYTESTRING password);
 
+// Function: FPDF_LoadMappedDocument
+//          Open and load a PDF document like FPDF_LoadDocument(), reading the
+//          file through a memory mapping where possible. Experimental API.
+// Parameters:
+//          file_path -  Path to the PDF file (including extension).
+//          password  -  A string used as the password for the PDF file.
+//                       If no password is needed, empty or NULL can be used.
+// Return value:
+//          A handle to the loaded document, or NULL on failure.
+// Comments:
+//          On Linux, Mac and Android the file is memory-mapped, so that it is
+//          parsed in place instead of being copied out a block at a time.
+//          Elsewhere, or if the file cannot be mapped, this is the same as
+//          FPDF_LoadDocument().
+//
+//          A mapped file must not be truncated or rewritten while the
+//          document is open: reading a part of the mapping that was cut off
+//          raises SIGBUS and ends the process. Only use this function for
+//          files that do not change, and FPDF_LoadDocument() otherwise.
+DLLEXPORT FPDF_DOCUMENT STDCALL
+FPDF_LoadMappedDocument(FPDF_STRING file_path, FPDF_BYTESTRING password);
+
 // Function: FPDF_LoadMemDocument
 //          Open and load a PDF document from memory.
 // Parameters:
@@ -459,6 +569,89 @@ DLLEXPORT unsigned long STDCALL FPDF_GetDocPermissions(FPDF_DOCUMENT document);
 //          protected, -1 will be returned.
 DLLEXPORT int STDCALL FPDF_GetSecurityHandlerRevision(FPDF_DOCUMENT document);
 
+// Function: FPDF_LoadAllObjects
+//          Parse every indirect object in the document up front.
+// Parameters:
+//          document    -   Handle to document. Returned by FPDF_LoadDocument.
+// Return value:
+//          TRUE if the document was fully loaded, FALSE on invalid document.
+// Comments:
+//          Objects are normally parsed lazily, the first time a page or
+//          resource refers to them. After this call, looking up an object no
+//          longer reads from the file or modifies the object table.
+//
+//          This does not make a document safe to use from several threads.
+//          PDFium is not thread-safe, and a document must only be used from
+//          one thread at a time. To render pages of one large document in
+//          parallel, load it once, call this function, and then fork() the
+//          worker processes: the parsed objects are shared copy-on-write
+//          instead of being parsed again by every worker. Stream data is
+//          still read from the file the first time it is decoded. Files
+//          opened by FPDF_LoadDocument() are read through a memory mapping
+//          when possible, which the workers share, and otherwise with
+//          positional reads, which are safe on a file descriptor shared by
+//          forked processes. A FPDF_FILEACCESS passed to
+//          FPDF_LoadCustomDocument() must be safe to call from every worker.
+DLLEXPORT FPDF_BOOL STDCALL FPDF_LoadAllObjects(FPDF_DOCUMENT document);
+
+// Function: FPDF_LoadObjectStreams
+//          Decompress every object stream of a document up front.
+// Parameters:
+//          document    -   Handle to document. Returned by FPDF_LoadDocument.
+//          threads     -   The number of threads to decompress with,
+//                          including the calling one. 0 or less uses one
+//                          per processor.
+// Return value:
+//          The number of object streams loaded. 0 for documents without
+//          object streams, or on invalid document.
+// Comments:
+//          PDF 1.5 and later files may store most of their objects in
+//          compressed object streams, which are otherwise decompressed one
+//          at a time, the first time one of their objects is needed. This
+//          reads all of them in a single forward pass over the file, then
+//          decompresses those using only FlateDecode, which is nearly all of
+//          them, on |threads| threads. The threads have finished when this
+//          returns, and only ever touch the compressed and decompressed
+//          data, so the document itself is still used from one thread only.
+//          The objects are not parsed. FPDF_LoadAllObjects() decodes any
+//          object streams not loaded yet on the calling thread.
+DLLEXPORT int STDCALL FPDF_LoadObjectStreams(FPDF_DOCUMENT document,
+                                             int threads);
+
+// Function: FPDF_SetImageCacheLimit
+//          Set how much memory decoded images of a document may keep.
+// Parameters:
+//          document    -   Handle to document. Returned by FPDF_LoadDocument.
+//          limit       -   Size limit of the cache, in bytes.
+// Return value:
+//          None.
+// Comments:
+//          Images that are indirect objects are decoded once per document and
+//          shared by every page that draws them. The least recently used ones
+//          are dropped once the cache grows beyond |limit|, which defaults to
+//          100MB. Nothing is dropped while a page of the document is being
+//          rendered, so the cache may exceed the limit until then. A limit of
+//          0 disables the cache between renders.
+DLLEXPORT void STDCALL FPDF_SetImageCacheLimit(FPDF_DOCUMENT document,
+                                               unsigned long limit);
+
+// Function: FPDF_GetImageCacheStats
+//          Get usage counters of the image cache of a document.
+// Parameters:
+//          document    -   Handle to document. Returned by FPDF_LoadDocument.
+//          hits        -   Receives the number of image lookups that reused
+//                          a decoded image. May be NULL.
+//          misses      -   Receives the number of image lookups that had to
+//                          decode the image. May be NULL.
+//          size        -   Receives the current size of the cache, in bytes.
+//                          May be NULL.
+// Return value:
+//          TRUE on success, FALSE on invalid document.
+DLLEXPORT FPDF_BOOL STDCALL FPDF_GetImageCacheStats(FPDF_DOCUMENT document,
+                                                    unsigned long* hits,
+                                                    unsigned long* misses,
+                                                    unsigned long* size);
+
 // Function: FPDF_GetPageCount
 //          Get total number of pages in the document.
 // Parameters:
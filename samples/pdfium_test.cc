@@ -7,6 +7,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
+#include <chrono>
 #include <map>
 #include <sstream>
 #include <string>
@@ -18,9 +20,11 @@
 #endif
 
 #include "public/fpdf_dataavail.h"
+#include "public/fpdf_doc.h"
 #include "public/fpdf_edit.h"
 #include "public/fpdf_ext.h"
 #include "public/fpdf_formfill.h"
+#include "public/fpdf_progressive.h"
 #include "public/fpdf_text.h"
 #include "public/fpdfview.h"
 #include "samples/image_diff_png.h"
@@ -56,15 +60,28 @@ enum OutputFormat {
 
 struct Options {
   Options()
-      : show_config(false), send_events(false), output_format(OUTPUT_NONE) {}
+      : show_config(false),
+        send_events(false),
+        resolve_links(false),
+        tiles(0),
+        font_cache_kb(0),
+        objstm_threads(0),
+        output_format(OUTPUT_NONE) {}
 
   bool show_config;
   bool send_events;
+  bool resolve_links;
+  int tiles;
+  int font_cache_kb;
+  int objstm_threads;
   OutputFormat output_format;
   std::string scale_factor_as_string;
   std::string exe_path;
   std::string bin_directory;
   std::string font_directory;
+  std::string glyph_cache_path;
+  std::string font_index_path;
+  std::string find_text;
 };
 
 struct FPDF_FORMFILLINFO_PDFiumTest : public FPDF_FORMFILLINFO {
@@ -405,6 +422,8 @@ bool ParseCommandLine(const std::vector<std::string>& args,
       options->show_config = true;
     } else if (cur_arg == "--send-events") {
       options->send_events = true;
+    } else if (cur_arg == "--links") {
+      options->resolve_links = true;
     } else if (cur_arg == "--ppm") {
       if (options->output_format != OUTPUT_NONE) {
         fprintf(stderr, "Duplicate or conflicting --ppm argument\n");
@@ -438,6 +457,26 @@ bool ParseCommandLine(const std::vector<std::string>& args,
         return false;
       }
       options->font_directory = cur_arg.substr(11);
+    } else if (cur_arg.size() > 14 &&
+               cur_arg.compare(0, 14, "--glyph-cache=") == 0) {
+      if (!options->glyph_cache_path.empty()) {
+        fprintf(stderr, "Duplicate --glyph-cache argument\n");
+        return false;
+      }
+      options->glyph_cache_path = cur_arg.substr(14);
+    } else if (cur_arg.size() > 13 &&
+               cur_arg.compare(0, 13, "--font-index=") == 0) {
+      if (!options->font_index_path.empty()) {
+        fprintf(stderr, "Duplicate --font-index argument\n");
+        return false;
+      }
+      options->font_index_path = cur_arg.substr(13);
+    } else if (cur_arg.size() > 7 && cur_arg.compare(0, 7, "--find=") == 0) {
+      if (!options->find_text.empty()) {
+        fprintf(stderr, "Duplicate --find argument\n");
+        return false;
+      }
+      options->find_text = cur_arg.substr(7);
 #ifdef _WIN32
     } else if (cur_arg == "--emf") {
       if (options->output_format != OUTPUT_NONE) {
@@ -471,6 +510,38 @@ bool ParseCommandLine(const std::vector<std::string>& args,
         return false;
       }
       options->scale_factor_as_string = cur_arg.substr(8);
+    } else if (cur_arg.size() > 8 && cur_arg.compare(0, 8, "--tiles=") == 0) {
+      if (options->tiles) {
+        fprintf(stderr, "Duplicate --tiles argument\n");
+        return false;
+      }
+      options->tiles = atoi(cur_arg.substr(8).c_str());
+      if (options->tiles <= 0) {
+        fprintf(stderr, "Invalid --tiles argument\n");
+        return false;
+      }
+    } else if (cur_arg.size() > 13 &&
+               cur_arg.compare(0, 13, "--font-cache=") == 0) {
+      if (options->font_cache_kb) {
+        fprintf(stderr, "Duplicate --font-cache argument\n");
+        return false;
+      }
+      options->font_cache_kb = atoi(cur_arg.substr(13).c_str());
+      if (options->font_cache_kb <= 0) {
+        fprintf(stderr, "Invalid --font-cache argument\n");
+        return false;
+      }
+    } else if (cur_arg.size() > 15 &&
+               cur_arg.compare(0, 15, "--load-objstms=") == 0) {
+      if (options->objstm_threads) {
+        fprintf(stderr, "Duplicate --load-objstms argument\n");
+        return false;
+      }
+      options->objstm_threads = atoi(cur_arg.substr(15).c_str());
+      if (options->objstm_threads <= 0) {
+        fprintf(stderr, "Invalid --load-objstms argument\n");
+        return false;
+      }
     } else if (cur_arg.size() >= 2 && cur_arg[0] == '-' && cur_arg[1] == '-') {
       fprintf(stderr, "Unrecognized argument %s\n", cur_arg.c_str());
       return false;
@@ -575,6 +646,134 @@ FPDF_PAGE GetPageForIndex(FPDF_FORMFILLINFO* param,
   return page;
 }
 
+FPDF_BOOL NeverPause(IFSDK_PAUSE* pause) {
+  return false;
+}
+
+double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// Looks up the destination page of every link on |page|, the way a viewer
+// does when the user follows them. Returns the number of links resolved.
+int ResolvePageLinks(FPDF_DOCUMENT doc, FPDF_PAGE page) {
+  int resolved_links = 0;
+  int pos = 0;
+  FPDF_LINK link;
+  while (FPDFLink_Enumerate(page, &pos, &link)) {
+    FPDF_DEST dest = FPDFLink_GetDest(doc, link);
+    if (!dest) {
+      FPDF_ACTION action = FPDFLink_GetAction(link);
+      if (action)
+        dest = FPDFAction_GetDest(doc, action);
+    }
+    if (dest) {
+      (void)FPDFDest_GetPageIndex(doc, dest);
+      ++resolved_links;
+    }
+  }
+  return resolved_links;
+}
+
+FPDF_BOOL CountMatch(FPDF_FIND_RESULTS_SINK* sink,
+                     int page_index,
+                     int start_index,
+                     int count) {
+  return true;
+}
+
+// Searches every page of |doc| for |text| twice, the second time in the text
+// kept by the first search, and reports the matches and timings.
+void FindInDocument(FPDF_DOCUMENT doc, const std::string& text) {
+  // Only ASCII search strings can be given on the command line.
+  std::vector<unsigned short> findwhat(text.begin(), text.end());
+  findwhat.push_back(0);
+  FPDF_FIND_RESULTS_SINK sink;
+  memset(&sink, '\0', sizeof(sink));
+  sink.version = 1;
+  sink.OnMatch = CountMatch;
+
+  FPDF_DOCSCHHANDLE search = FPDFText_LoadDocumentSearch(doc, true);
+  auto start = std::chrono::steady_clock::now();
+  int matches =
+      FPDFText_FindInDocument(search, findwhat.data(), 0, 0, -1, &sink);
+  double first_ms = MillisecondsSince(start);
+  start = std::chrono::steady_clock::now();
+  FPDFText_FindInDocument(search, findwhat.data(), 0, 0, -1, &sink);
+  double kept_ms = MillisecondsSince(start);
+  FPDFText_CloseDocumentSearch(search);
+  fprintf(stderr,
+          "Found %d matches of \"%s\" in %.1f ms, then in %.1f ms in the "
+          "kept text.\n",
+          matches, text.c_str(), first_ms, kept_ms);
+}
+
+// Renders |page| again as a |tiles| x |tiles| grid of tiles, checks that the
+// tiles match the single pass render in |bitmap| and reports the timings.
+void RenderPageTiles(FPDF_PAGE page,
+                     FPDF_BITMAP bitmap,
+                     int page_index,
+                     int tiles,
+                     double full_ms) {
+  int width = FPDFBitmap_GetWidth(bitmap);
+  int height = FPDFBitmap_GetHeight(bitmap);
+  int stride = FPDFBitmap_GetStride(bitmap);
+  const char* buffer =
+      reinterpret_cast<const char*>(FPDFBitmap_GetBuffer(bitmap));
+  int alpha = FPDFPage_HasTransparency(page) ? 1 : 0;
+  FPDF_DWORD fill_color = alpha ? 0x00000000 : 0xFFFFFFFF;
+  int tile_width = (width + tiles - 1) / tiles;
+  int tile_height = (height + tiles - 1) / tiles;
+
+  IFSDK_PAUSE pause;
+  memset(&pause, '\0', sizeof(pause));
+  pause.version = 1;
+  pause.NeedToPauseNow = NeverPause;
+
+  bool match = true;
+  double tiles_ms = 0;
+  double slowest_tile_ms = 0;
+  for (int y = 0; y < height; y += tile_height) {
+    for (int x = 0; x < width; x += tile_width) {
+      int w = std::min(tile_width, width - x);
+      int h = std::min(tile_height, height - y);
+      FPDF_BITMAP tile = FPDFBitmap_Create(w, h, alpha);
+      if (!tile) {
+        fprintf(stderr, "Failed to create %dx%d tile.\n", w, h);
+        return;
+      }
+      FPDFBitmap_FillRect(tile, 0, 0, w, h, fill_color);
+      auto start = std::chrono::steady_clock::now();
+      FPDF_RenderPageBitmapTile_Start(tile, page, width, height, 0, x, y,
+                                      FPDF_ANNOT, &pause);
+      FPDF_RenderPage_Close(page);
+      double tile_ms = MillisecondsSince(start);
+      tiles_ms += tile_ms;
+      slowest_tile_ms = std::max(slowest_tile_ms, tile_ms);
+
+      int tile_stride = FPDFBitmap_GetStride(tile);
+      const char* tile_buffer =
+          reinterpret_cast<const char*>(FPDFBitmap_GetBuffer(tile));
+      for (int row = 0; row < h && match; ++row) {
+        match = memcmp(buffer + (y + row) * stride + x * 4,
+                       tile_buffer + row * tile_stride, w * 4) == 0;
+      }
+      FPDFBitmap_Destroy(tile);
+    }
+  }
+
+  // The slowest tile bounds the wall-clock time when each tile is rendered by
+  // its own process.
+  fprintf(stderr,
+          "Page %d: full %.1f ms, %dx%d tiles %.1f ms total, %.1f ms slowest, "
+          "ideal speedup %.2fx, %s\n",
+          page_index, full_ms, tiles, tiles, tiles_ms, slowest_tile_ms,
+          slowest_tile_ms > 0 ? full_ms / slowest_tile_ms : 0.0,
+          match ? "pixels match" : "PIXELS DIFFER");
+}
+
 bool RenderPage(const std::string& name,
                 FPDF_DOCUMENT doc,
                 FPDF_FORMHANDLE& form,
@@ -602,7 +801,12 @@ bool RenderPage(const std::string& name,
   if (bitmap) {
     FPDF_DWORD fill_color = alpha ? 0x00000000 : 0xFFFFFFFF;
     FPDFBitmap_FillRect(bitmap, 0, 0, width, height, fill_color);
+    auto start = std::chrono::steady_clock::now();
     FPDF_RenderPageBitmap(bitmap, page, 0, 0, width, height, 0, FPDF_ANNOT);
+    if (options.tiles) {
+      RenderPageTiles(page, bitmap, page_index, options.tiles,
+                      MillisecondsSince(start));
+    }
 
     FPDF_FFLDraw(form, bitmap, page, 0, 0, width, height, 0, FPDF_ANNOT);
     int stride = FPDFBitmap_GetStride(bitmap);
@@ -763,6 +967,13 @@ void RenderPdf(const std::string& name,
 
   (void)FPDF_GetDocPermissions(doc);
 
+  if (options.objstm_threads) {
+    auto start = std::chrono::steady_clock::now();
+    int loaded = FPDF_LoadObjectStreams(doc, options.objstm_threads);
+    fprintf(stderr, "Loaded %d object streams with %d threads in %.2f ms.\n",
+            loaded, options.objstm_threads, MillisecondsSince(start));
+  }
+
   FPDF_FORMHANDLE form = FPDFDOC_InitFormFillEnvironment(doc, &form_callbacks);
   form_callbacks.formHandle = form;
 
@@ -779,9 +990,14 @@ void RenderPdf(const std::string& name,
   FORM_DoDocumentJSAction(form);
   FORM_DoDocumentOpenAction(form);
 
+  if (!options.find_text.empty())
+    FindInDocument(doc, options.find_text);
+
   int page_count = FPDF_GetPageCount(doc);
   int rendered_pages = 0;
   int bad_pages = 0;
+  int resolved_links = 0;
+  double links_ms = 0;
   for (int i = 0; i < page_count; ++i) {
     if (bIsLinearized) {
       nRet = PDF_DATA_NOTAVAIL;
@@ -795,6 +1011,13 @@ void RenderPdf(const std::string& name,
         return;
       }
     }
+    if (options.resolve_links) {
+      if (FPDF_PAGE page = GetPageForIndex(&form_callbacks, doc, i)) {
+        auto start = std::chrono::steady_clock::now();
+        resolved_links += ResolvePageLinks(doc, page);
+        links_ms += MillisecondsSince(start);
+      }
+    }
     if (RenderPage(name, doc, form, form_callbacks, i, options, events))
       ++rendered_pages;
     else
@@ -808,6 +1031,10 @@ void RenderPdf(const std::string& name,
   fprintf(stderr, "Rendered %d pages.\n", rendered_pages);
   if (bad_pages)
     fprintf(stderr, "Skipped %d bad pages.\n", bad_pages);
+  if (options.resolve_links) {
+    fprintf(stderr, "Resolved %d links in %.1f ms.\n", resolved_links,
+            links_ms);
+  }
 }
 
 static void ShowConfig() {
@@ -835,9 +1062,21 @@ static const char kUsageString[] =
     "Usage: pdfium_test [OPTION] [FILE]...\n"
     "  --show-config     - print build options and exit\n"
     "  --send-events     - send input described by .evt file\n"
+    "  --links           - resolve the destination of every link and report\n"
+    "                      the time taken\n"
     "  --bin-dir=<path>  - override path to v8 external data\n"
     "  --font-dir=<path> - override path to external fonts\n"
+    "  --glyph-cache=<path> - keep rendered glyphs in <path> across runs\n"
+    "  --font-index=<path> - keep the list of external fonts in <path>\n"
     "  --scale=<number>  - scale output size by number (e.g. 0.5)\n"
+    "  --tiles=<number>  - also render pages as number x number tiles and\n"
+    "                      report timings\n"
+    "  --find=<text>     - search every page for text and report the time\n"
+    "                      taken\n"
+    "  --load-objstms=<number> - decompress all object streams after loading,\n"
+    "                      using number threads\n"
+    "  --font-cache=<number> - share identical embedded fonts, and keep up\n"
+    "                      to number KB of them after their file is closed\n"
 #ifdef _WIN32
     "  --bmp - write page images <pdf-name>.<page-number>.bmp\n"
     "  --emf - write page meta files <pdf-name>.<page-number>.emf\n"
@@ -882,10 +1121,17 @@ int main(int argc, const char* argv[]) {
 #endif  // PDF_ENABLE_V8
 
   FPDF_LIBRARY_CONFIG config;
-  config.version = 2;
+  config.version = 5;
   config.m_pUserFontPaths = nullptr;
   config.m_pIsolate = nullptr;
   config.m_v8EmbedderSlot = 0;
+  config.m_pGlyphCachePath = nullptr;
+  if (!options.glyph_cache_path.empty())
+    config.m_pGlyphCachePath = options.glyph_cache_path.c_str();
+  config.m_pFontIndexPath = nullptr;
+  if (!options.font_index_path.empty())
+    config.m_pFontIndexPath = options.font_index_path.c_str();
+  config.m_EmbeddedFontCacheSize = options.font_cache_kb * 1024UL;
 
   const char* path_array[2];
   if (!options.font_directory.empty()) {
@@ -925,6 +1171,36 @@ int main(int argc, const char* argv[]) {
       }
     }
     RenderPdf(filename, file_contents.get(), file_length, options, events);
+    if (!options.glyph_cache_path.empty())
+      FPDF_FlushGlyphCache();
+  }
+
+  unsigned long glyph_hits;
+  unsigned long glyph_misses;
+  if (FPDF_GetGlyphCacheStats(&glyph_hits, &glyph_misses)) {
+    unsigned long glyph_lookups = glyph_hits + glyph_misses;
+    fprintf(stderr, "Glyph cache: %lu hits, %lu misses (%.1f%% hit rate).\n",
+            glyph_hits, glyph_misses,
+            glyph_lookups ? 100.0 * glyph_hits / glyph_lookups : 0.0);
+  }
+
+  unsigned long subst_hits;
+  unsigned long subst_misses;
+  double subst_saved_ms;
+  if (FPDF_GetFontSubstStats(&subst_hits, &subst_misses, &subst_saved_ms) &&
+      subst_hits) {
+    fprintf(stderr,
+            "Font substitutions: %lu hits, %lu misses, %.2f ms saved.\n",
+            subst_hits, subst_misses, subst_saved_ms);
+  }
+
+  unsigned long font_hits;
+  unsigned long font_misses;
+  unsigned long font_size;
+  if (FPDF_GetEmbeddedFontStats(&font_hits, &font_misses, &font_size)) {
+    fprintf(stderr,
+            "Embedded fonts: %lu shared, %lu loaded, %lu KB still loaded.\n",
+            font_hits, font_misses, font_size / 1024);
   }
 
   FPDF_DestroyLibrary();
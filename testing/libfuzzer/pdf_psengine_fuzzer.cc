@@ -5,10 +5,38 @@
 #include "core/fpdfapi/fpdf_page/cpdf_psengine.h"
 
 #include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "third_party/base/logging.h"
+
+namespace {
+
+std::vector<FX_FLOAT> PopAll(CPDF_PSEngine* engine) {
+  std::vector<FX_FLOAT> values;
+  while (engine->GetStackSize())
+    values.push_back(engine->Pop());
+  return values;
+}
+
+}  // namespace
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
   CPDF_PSEngine engine;
-  if (engine.Parse(reinterpret_cast<const char*>(data), size))
-    engine.Execute();
+  if (!engine.Parse(reinterpret_cast<const char*>(data), size))
+    return 0;
+
+  engine.Execute();
+  std::vector<FX_FLOAT> expected = PopAll(&engine);
+
+  // The compiled program must leave the same stack as the interpreter.
+  engine.Compile(0);
+  engine.Reset();
+  engine.ExecuteCompiled();
+  std::vector<FX_FLOAT> actual = PopAll(&engine);
+  CHECK(expected.size() == actual.size());
+  CHECK(expected.empty() ||
+        memcmp(expected.data(), actual.data(),
+               expected.size() * sizeof(FX_FLOAT)) == 0);
   return 0;
 }
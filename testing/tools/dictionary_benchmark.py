@@ -0,0 +1,100 @@
+#!/usr/bin/env python
+# Copyright 2016 The PDFium Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""Measures how pdfium_test copes with a very large number of dictionaries.
+
+Writes a synthetic one-page PDF whose page carries the requested number of
+annotations, each a small direct dictionary, then runs pdfium_test on it and
+reports the wall-clock time to load and render the page together with the
+peak resident set size. Loading the page parses every annotation dictionary
+and building the annotation list looks up a handful of keys in each one."""
+
+import optparse
+import os
+import resource
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def WriteManyDictionariesPdf(path, annot_count):
+  offsets = []
+  with open(path, 'wb') as f:
+    def WriteObject(objnum, body):
+      offsets.append(f.tell())
+      f.write(b'%d 0 obj\n' % objnum)
+      f.write(body)
+      f.write(b'\nendobj\n')
+
+    f.write(b'%PDF-1.7\n')
+    WriteObject(1, b'<< /Type /Catalog /Pages 2 0 R >>')
+    WriteObject(2, b'<< /Type /Pages /Kids [3 0 R] /Count 1 >>')
+    annots = []
+    for i in range(annot_count):
+      x = i % 180
+      y = i // 180 % 180
+      annots.append(
+          b'<< /Type /Annot /Subtype /Square /Rect [%d %d %d %d] /F 4 '
+          b'/NM (a%d) /M (D:20160101000000) /C [1 0 0] /Border [0 0 1] >>' %
+          (x, y, x + 10, y + 10, i))
+    WriteObject(3, b'<< /Type /Page /Parent 2 0 R /MediaBox [0 0 200 200] '
+                   b'/Contents 4 0 R /Annots [\n' + b'\n'.join(annots) +
+                   b'\n] >>')
+    content = b'0 0 1 rg 50 50 100 100 re f'
+    WriteObject(4, b'<< /Length %d >>\nstream\n%s\nendstream' %
+                   (len(content), content))
+
+    xref_pos = f.tell()
+    f.write(b'xref\n0 %d\n' % (len(offsets) + 1))
+    f.write(b'0000000000 65535 f \n')
+    for offset in offsets:
+      f.write(b'%010d 00000 n \n' % offset)
+    f.write(b'trailer\n<< /Size %d /Root 1 0 R >>\n' % (len(offsets) + 1))
+    f.write(b'startxref\n%d\n%%%%EOF\n' % xref_pos)
+
+
+def main():
+  parser = optparse.OptionParser(usage='%prog [options] path/to/pdfium_test')
+  parser.add_option('--annots', type='int', default=100000,
+                    help='number of annotation dictionaries on the page')
+  parser.add_option('--keep', action='store_true', default=False,
+                    help='keep the generated PDF')
+  options, args = parser.parse_args()
+  if len(args) != 1:
+    parser.error('expected the path to pdfium_test')
+
+  fd, pdf_path = tempfile.mkstemp(suffix='.pdf')
+  os.close(fd)
+  try:
+    WriteManyDictionariesPdf(pdf_path, options.annots)
+    size_mb = os.path.getsize(pdf_path) / (1024.0 * 1024.0)
+    print('Generated %s: %d annotations, %.1f MB' %
+          (pdf_path, options.annots, size_mb))
+
+    start = time.time()
+    with open(os.devnull, 'w') as devnull:
+      ret = subprocess.call([args[0], pdf_path], stdout=devnull)
+    elapsed = time.time() - start
+    if ret:
+      print('pdfium_test failed with exit code %d' % ret)
+      return ret
+
+    # ru_maxrss is in kilobytes on Linux and in bytes on Mac.
+    peak = resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss
+    if sys.platform == 'darwin':
+      peak /= 1024
+    print('Time to load and render: %.2f s' % elapsed)
+    print('Peak memory: %.1f MB' % (peak / 1024.0))
+  finally:
+    if options.keep:
+      print('Kept %s' % pdf_path)
+    else:
+      os.remove(pdf_path)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
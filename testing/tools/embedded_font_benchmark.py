@@ -0,0 +1,152 @@
+#!/usr/bin/env python
+# Copyright 2016 The PDFium Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""Measures the effect of sharing identical embedded fonts in pdfium_test.
+
+Writes a number of PDFs that all embed the same TrueType font, once as a
+simple font and once as a CID font, on every page, the way documents from
+one generator embed the same fonts. Then renders them all in one pdfium_test
+run without the embedded font cache, and in one run with it, and reports the
+wall-clock time of each and how many fonts were shared. Both runs write PNGs,
+which are compared to make sure that sharing fonts does not change them."""
+
+import filecmp
+import glob
+import optparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def WriteFontPdf(path, font_data, pages):
+  text = b'The quick brown fox jumps over the lazy dog'
+  glyphs = b''.join(b'%04X' % (ord(c) - 29) for c in 'Glyph ids 1234')
+  content = (b'BT /F1 18 Tf 20 150 Td (%s) Tj ET '
+             b'BT /F2 18 Tf 20 100 Td <%s> Tj ET' % (text, glyphs))
+  objects = [
+      b'<< /Type /Catalog /Pages 2 0 R >>',
+      b'<< /Type /Pages /Kids [%s] /Count %d >>' %
+      (b' '.join(b'%d 0 R' % (9 + i) for i in range(pages)), pages),
+      b'<< /Type /Font /Subtype /TrueType /BaseFont /ABCDEF+Embedded '
+      b'/FirstChar 32 /LastChar 126 /FontDescriptor 5 0 R >>',
+      b'<< /Type /Font /Subtype /Type0 /BaseFont /ABCDEF+Embedded '
+      b'/Encoding /Identity-H /DescendantFonts [7 0 R] >>',
+      b'<< /Type /FontDescriptor /FontName /ABCDEF+Embedded /Flags 32 '
+      b'/FontBBox [0 -200 1000 900] /ItalicAngle 0 /Ascent 900 '
+      b'/Descent -200 /CapHeight 700 /StemV 80 /FontFile2 6 0 R >>',
+      b'<< /Length %d >>\nstream\n%s\nendstream' % (len(font_data),
+                                                    font_data),
+      b'<< /Type /Font /Subtype /CIDFontType2 /BaseFont /ABCDEF+Embedded '
+      b'/CIDSystemInfo << /Registry (Adobe) /Ordering (Identity) '
+      b'/Supplement 0 >> /FontDescriptor 5 0 R >>',
+      b'<< /Length %d >>\nstream\n%s\nendstream' % (len(content), content),
+  ]
+  for _ in range(pages):
+    objects.append(b'<< /Type /Page /Parent 2 0 R /MediaBox [0 0 500 200] '
+                   b'/Resources << /Font << /F1 3 0 R /F2 4 0 R >> >> '
+                   b'/Contents 8 0 R >>')
+  with open(path, 'wb') as f:
+    f.write(b'%PDF-1.7\n')
+    offsets = []
+    for objnum, body in enumerate(objects, 1):
+      offsets.append(f.tell())
+      f.write(b'%d 0 obj\n%s\nendobj\n' % (objnum, body))
+    xref_pos = f.tell()
+    f.write(b'xref\n0 %d\n' % (len(objects) + 1))
+    f.write(b'0000000000 65535 f \n')
+    for offset in offsets:
+      f.write(b'%010d 00000 n \n' % offset)
+    f.write(b'trailer\n<< /Size %d /Root 1 0 R >>\n' % (len(objects) + 1))
+    f.write(b'startxref\n%d\n%%%%EOF\n' % xref_pos)
+
+
+def FindFont(fonts_dir):
+  for root, _, files in os.walk(fonts_dir):
+    for name in sorted(files):
+      if os.path.splitext(name)[1].lower() == '.ttf':
+        return os.path.join(root, name)
+  return None
+
+
+def TimeRun(command, cwd):
+  start = time.time()
+  with open(os.devnull, 'w') as devnull:
+    process = subprocess.Popen(command, cwd=cwd, stdout=devnull,
+                               stderr=subprocess.PIPE)
+    _, stderr = process.communicate()
+  elapsed = time.time() - start
+  if process.returncode:
+    print('pdfium_test failed with exit code %d' % process.returncode)
+    sys.exit(process.returncode)
+  for line in stderr.decode('utf-8', 'replace').splitlines():
+    if line.startswith('Embedded fonts:'):
+      print('  ' + line)
+  return elapsed
+
+
+def main():
+  parser = optparse.OptionParser(usage='%prog [options] path/to/pdfium_test')
+  parser.add_option('--fonts', default='/usr/share/fonts',
+                    help='folder with a TrueType font to embed')
+  parser.add_option('--documents', type='int', default=50,
+                    help='number of documents')
+  parser.add_option('--pages', type='int', default=4,
+                    help='number of pages of every document')
+  parser.add_option('--cache-kb', type='int', default=16384,
+                    help='KB of unused embedded fonts to keep')
+  options, args = parser.parse_args()
+  if len(args) != 1:
+    parser.error('expected the path to pdfium_test')
+  pdfium_test = os.path.abspath(args[0])
+
+  font_path = FindFont(options.fonts)
+  if not font_path:
+    print('No TrueType font found in %s' % options.fonts)
+    return 1
+  with open(font_path, 'rb') as f:
+    font_data = f.read()
+  print('Embedding %s (%d bytes) in %d documents of %d pages' %
+        (font_path, len(font_data), options.documents, options.pages))
+
+  work_dir = tempfile.mkdtemp()
+  try:
+    run_dirs = []
+    for name in ('unshared', 'shared'):
+      run_dir = os.path.join(work_dir, name)
+      os.mkdir(run_dir)
+      for i in range(options.documents):
+        WriteFontPdf(os.path.join(run_dir, 'doc%d.pdf' % i), font_data,
+                     options.pages)
+      run_dirs.append(run_dir)
+
+    pdfs = ['doc%d.pdf' % i for i in range(options.documents)]
+    print('Without font cache:')
+    elapsed = TimeRun([pdfium_test, '--png'] + pdfs, run_dirs[0])
+    print('  %.3f s' % elapsed)
+    print('With font cache:')
+    elapsed = TimeRun([pdfium_test, '--png',
+                       '--font-cache=%d' % options.cache_kb] + pdfs,
+                      run_dirs[1])
+    print('  %.3f s' % elapsed)
+
+    different = 0
+    for png in glob.glob(os.path.join(run_dirs[0], '*.png')):
+      other = os.path.join(run_dirs[1], os.path.basename(png))
+      if not os.path.exists(other) or not filecmp.cmp(png, other, False):
+        different += 1
+    if different:
+      print('%d pages render differently with the font cache' % different)
+      return 1
+    print('All pages render the same')
+  finally:
+    shutil.rmtree(work_dir)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -0,0 +1,119 @@
+#!/usr/bin/env python
+# Copyright 2016 The PDFium Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""Measures how long pdfium_test takes to start with a large font folder.
+
+Builds a font folder holding the requested number of copies of the fonts in
+--fonts, standing in for a large font pack, and a one-page PDF whose text
+uses a font that is not embedded, so that rendering it looks through the font
+folder. Then runs pdfium_test on it a few times without a font index, and a
+few times with one, and reports the average wall-clock time of each. The
+first run with an index builds it and is reported separately."""
+
+import optparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def WriteTextPdf(path):
+  content = b'BT /F1 24 Tf 20 100 Td (Substituted text) Tj ET'
+  objects = [
+      b'<< /Type /Catalog /Pages 2 0 R >>',
+      b'<< /Type /Pages /Kids [3 0 R] /Count 1 >>',
+      b'<< /Type /Page /Parent 2 0 R /MediaBox [0 0 300 200] '
+      b'/Resources << /Font << /F1 4 0 R >> >> /Contents 5 0 R >>',
+      b'<< /Type /Font /Subtype /TrueType /BaseFont /NotEmbeddedSans '
+      b'/FirstChar 32 /LastChar 126 >>',
+      b'<< /Length %d >>\nstream\n%s\nendstream' % (len(content), content),
+  ]
+  with open(path, 'wb') as f:
+    f.write(b'%PDF-1.7\n')
+    offsets = []
+    for objnum, body in enumerate(objects, 1):
+      offsets.append(f.tell())
+      f.write(b'%d 0 obj\n%s\nendobj\n' % (objnum, body))
+    xref_pos = f.tell()
+    f.write(b'xref\n0 %d\n' % (len(objects) + 1))
+    f.write(b'0000000000 65535 f \n')
+    for offset in offsets:
+      f.write(b'%010d 00000 n \n' % offset)
+    f.write(b'trailer\n<< /Size %d /Root 1 0 R >>\n' % (len(objects) + 1))
+    f.write(b'startxref\n%d\n%%%%EOF\n' % xref_pos)
+
+
+def FillFontFolder(folder, fonts_dir, copies):
+  fonts = []
+  for root, _, files in os.walk(fonts_dir):
+    for name in files:
+      if os.path.splitext(name)[1].lower() in ('.ttf', '.otf', '.ttc'):
+        fonts.append(os.path.join(root, name))
+  for copy in range(copies):
+    subfolder = os.path.join(folder, 'pack%d' % copy)
+    os.mkdir(subfolder)
+    for font in fonts:
+      target = os.path.join(subfolder, os.path.basename(font))
+      try:
+        os.link(font, target)
+      except OSError:
+        shutil.copy(font, target)
+  return len(fonts) * copies
+
+
+def TimeRuns(command, runs):
+  total = 0.0
+  for _ in range(runs):
+    start = time.time()
+    with open(os.devnull, 'w') as devnull:
+      ret = subprocess.call(command, stdout=devnull, stderr=devnull)
+    total += time.time() - start
+    if ret:
+      print('pdfium_test failed with exit code %d' % ret)
+      sys.exit(ret)
+  return total / runs
+
+
+def main():
+  parser = optparse.OptionParser(usage='%prog [options] path/to/pdfium_test')
+  parser.add_option('--fonts', default='/usr/share/fonts',
+                    help='folder with the fonts to copy into the font folder')
+  parser.add_option('--copies', type='int', default=200,
+                    help='number of copies of the fonts')
+  parser.add_option('--runs', type='int', default=5,
+                    help='number of runs to average')
+  options, args = parser.parse_args()
+  if len(args) != 1:
+    parser.error('expected the path to pdfium_test')
+
+  work_dir = tempfile.mkdtemp()
+  try:
+    font_dir = os.path.join(work_dir, 'fonts')
+    os.mkdir(font_dir)
+    font_count = FillFontFolder(font_dir, options.fonts, options.copies)
+    if not font_count:
+      print('No fonts found in %s' % options.fonts)
+      return 1
+    pdf_path = os.path.join(work_dir, 'text.pdf')
+    WriteTextPdf(pdf_path)
+    index_path = os.path.join(work_dir, 'fonts.idx')
+    print('Font folder with %d font files' % font_count)
+
+    command = [args[0], '--font-dir=' + font_dir, pdf_path]
+    print('Without index: %.3f s' % TimeRuns(command, options.runs))
+    command.insert(1, '--font-index=' + index_path)
+    # Stamps from the last second are not trusted, so let the folder age.
+    time.sleep(2)
+    print('Building index: %.3f s' % TimeRuns(command, 1))
+    print('With index: %.3f s' % TimeRuns(command, options.runs))
+  finally:
+    shutil.rmtree(work_dir)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
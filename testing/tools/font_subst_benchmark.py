@@ -0,0 +1,113 @@
+#!/usr/bin/env python
+# Copyright 2016 The PDFium Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""Measures how pdfium_test copes with many fonts that are not embedded.
+
+Writes a synthetic PDF in the style of a mail-merge document, where every
+page has its own font resources, none of them embedded, but all of them
+named after a few common fonts. Then renders it with pdfium_test and
+reports the font substitution counters it prints along with the total
+wall-clock time."""
+
+import optparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+FONT_NAMES = [b'Arial', b'Arial,Bold', b'TimesNewRoman', b'CourierNew',
+              b'Verdana', b'Calibri,Italic', b'Garamond', b'Tahoma,Bold']
+
+
+def WriteMergedPdf(path, page_count, fonts_per_page):
+  objects = {}
+  objects[1] = b'<< /Type /Catalog /Pages 2 0 R >>'
+  next_objnum = [3]
+
+  def NewObjNum():
+    objnum = next_objnum[0]
+    next_objnum[0] += 1
+    return objnum
+
+  pages = []
+  for index in range(page_count):
+    fonts = []
+    content = []
+    for font in range(fonts_per_page):
+      name = FONT_NAMES[(index + font) % len(FONT_NAMES)]
+      objnum = NewObjNum()
+      objects[objnum] = (b'<< /Type /Font /Subtype /TrueType /BaseFont /%s '
+                         b'/FirstChar 32 /LastChar 126 >>' %
+                         name.replace(b',', b'#2C'))
+      fonts.append(b'/F%d %d 0 R' % (font, objnum))
+      content.append(b'BT /F%d 12 Tf 20 %d Td (Dear customer %d) Tj ET' %
+                     (font, 180 - font * 14, index))
+    content = b'\n'.join(content)
+    contents = NewObjNum()
+    objects[contents] = (b'<< /Length %d >>\nstream\n%s\nendstream' %
+                         (len(content), content))
+    page = NewObjNum()
+    objects[page] = (b'<< /Type /Page /Parent 2 0 R /MediaBox [0 0 200 200] '
+                     b'/Resources << /Font << %s >> >> /Contents %d 0 R >>' %
+                     (b' '.join(fonts), contents))
+    pages.append(page)
+  objects[2] = (b'<< /Type /Pages /Count %d /Kids [%s] >>' %
+                (page_count, b' '.join(b'%d 0 R' % page for page in pages)))
+
+  with open(path, 'wb') as f:
+    f.write(b'%PDF-1.7\n')
+    offsets = {}
+    for objnum in sorted(objects):
+      offsets[objnum] = f.tell()
+      f.write(b'%d 0 obj\n%s\nendobj\n' % (objnum, objects[objnum]))
+    xref_pos = f.tell()
+    size = max(objects) + 1
+    f.write(b'xref\n0 %d\n' % size)
+    f.write(b'0000000000 65535 f \n')
+    for objnum in range(1, size):
+      f.write(b'%010d 00000 n \n' % offsets[objnum])
+    f.write(b'trailer\n<< /Size %d /Root 1 0 R >>\n' % size)
+    f.write(b'startxref\n%d\n%%%%EOF\n' % xref_pos)
+
+
+def main():
+  parser = optparse.OptionParser(usage='%prog [options] path/to/pdfium_test')
+  parser.add_option('--pages', type='int', default=2000,
+                    help='number of pages in the document')
+  parser.add_option('--fonts', type='int', default=4,
+                    help='number of font resources on each page')
+  options, args = parser.parse_args()
+  if len(args) != 1:
+    parser.error('expected the path to pdfium_test')
+
+  fd, pdf_path = tempfile.mkstemp(suffix='.pdf')
+  os.close(fd)
+  try:
+    WriteMergedPdf(pdf_path, options.pages, options.fonts)
+    print('Generated %s: %d pages, %d font resources' %
+          (pdf_path, options.pages, options.pages * options.fonts))
+
+    start = time.time()
+    proc = subprocess.Popen([args[0], pdf_path], stdout=subprocess.PIPE,
+                            stderr=subprocess.PIPE)
+    _, err = proc.communicate()
+    elapsed = time.time() - start
+    if proc.returncode:
+      print('pdfium_test failed with exit code %d' % proc.returncode)
+      return proc.returncode
+
+    match = re.search(br'Font substitutions: .*', err)
+    if match:
+      print(match.group(0).decode())
+    print('Total time: %.2f s' % elapsed)
+  finally:
+    os.remove(pdf_path)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -0,0 +1,132 @@
+#!/usr/bin/env python
+# Copyright 2016 The PDFium Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""Measures how pdfium_test copes with resolving links in a long document.
+
+Writes a synthetic PDF with the requested number of pages, arranged in a
+balanced page tree, where every page links to pages spread across the whole
+document. Then runs pdfium_test --links on it, which looks up the
+destination page of every link before rendering each page, and reports the
+time spent resolving links along with the total wall-clock time."""
+
+import optparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def WriteLinkedPdf(path, page_count, links_per_page, fanout):
+  objects = {}
+  objects[1] = b'<< /Type /Catalog /Pages 2 0 R >>'
+  content = b'0 0 1 rg 50 50 100 100 re f'
+  objects[3] = (b'<< /Length %d >>\nstream\n%s\nendstream' %
+                (len(content), content))
+  next_objnum = [4]
+
+  def NewObjNum():
+    objnum = next_objnum[0]
+    next_objnum[0] += 1
+    return objnum
+
+  pages = [NewObjNum() for _ in range(page_count)]
+  for index, objnum in enumerate(pages):
+    annots = []
+    for link in range(links_per_page):
+      target = pages[(index * 7919 + link * 104729 + 1) % page_count]
+      annots.append(b'<< /Type /Annot /Subtype /Link /Rect [%d 0 %d 10] '
+                    b'/Border [0 0 0] /Dest [%d 0 R /Fit] >>' %
+                    (link * 20, link * 20 + 10, target))
+    objects[objnum] = (b'<< /Type /Page /Parent %%d 0 R '
+                       b'/MediaBox [0 0 200 200] /Contents 3 0 R '
+                       b'/Annots [%s] >>' % b' '.join(annots))
+
+  # Group the pages into intermediate nodes until one node is left, which
+  # becomes object 2.
+  level = [(objnum, 1) for objnum in pages]
+  while True:
+    groups = [level[i:i + fanout] for i in range(0, len(level), fanout)]
+    parents = []
+    for group in groups:
+      objnum = 2 if len(groups) == 1 else NewObjNum()
+      count = sum(kid_count for _, kid_count in group)
+      kids = b' '.join(b'%d 0 R' % kid for kid, _ in group)
+      objects[objnum] = (b'<< /Type /Pages /Parent %%d 0 R /Count %d '
+                         b'/Kids [%s] >>' % (count, kids))
+      for kid, _ in group:
+        objects[kid] = objects[kid] % objnum
+      parents.append((objnum, count))
+    level = parents
+    if len(groups) == 1:
+      objects[2] = objects[2].replace(b'/Parent %d 0 R ', b'')
+      break
+
+  with open(path, 'wb') as f:
+    f.write(b'%PDF-1.7\n')
+    offsets = {}
+    for objnum in sorted(objects):
+      offsets[objnum] = f.tell()
+      f.write(b'%d 0 obj\n%s\nendobj\n' % (objnum, objects[objnum]))
+    xref_pos = f.tell()
+    size = max(objects) + 1
+    f.write(b'xref\n0 %d\n' % size)
+    f.write(b'0000000000 65535 f \n')
+    for objnum in range(1, size):
+      f.write(b'%010d 00000 n \n' % offsets[objnum])
+    f.write(b'trailer\n<< /Size %d /Root 1 0 R >>\n' % size)
+    f.write(b'startxref\n%d\n%%%%EOF\n' % xref_pos)
+
+
+def main():
+  parser = optparse.OptionParser(usage='%prog [options] path/to/pdfium_test')
+  parser.add_option('--pages', type='int', default=20000,
+                    help='number of pages in the document')
+  parser.add_option('--links', type='int', default=4,
+                    help='number of links on each page')
+  parser.add_option('--fanout', type='int', default=16,
+                    help='number of kids of each page tree node')
+  parser.add_option('--keep', action='store_true', default=False,
+                    help='keep the generated PDF')
+  options, args = parser.parse_args()
+  if len(args) != 1:
+    parser.error('expected the path to pdfium_test')
+
+  fd, pdf_path = tempfile.mkstemp(suffix='.pdf')
+  os.close(fd)
+  try:
+    WriteLinkedPdf(pdf_path, options.pages, options.links,
+                   max(options.fanout, 2))
+    size_mb = os.path.getsize(pdf_path) / (1024.0 * 1024.0)
+    print('Generated %s: %d pages, %d links, %.1f MB' %
+          (pdf_path, options.pages, options.pages * options.links, size_mb))
+
+    start = time.time()
+    proc = subprocess.Popen([args[0], '--links', pdf_path],
+                            stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    _, err = proc.communicate()
+    elapsed = time.time() - start
+    if proc.returncode:
+      print('pdfium_test failed with exit code %d' % proc.returncode)
+      return proc.returncode
+
+    match = re.search(br'Resolved (\d+) links in ([\d.]+) ms', err)
+    if not match:
+      print('pdfium_test did not report resolving links')
+      return 1
+    print('Resolved %d links in %.2f s' %
+          (int(match.group(1)), float(match.group(2)) / 1000.0))
+    print('Total time: %.2f s' % elapsed)
+  finally:
+    if options.keep:
+      print('Kept %s' % pdf_path)
+    else:
+      os.remove(pdf_path)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -0,0 +1,151 @@
+#!/usr/bin/env python
+# Copyright 2016 The PDFium Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""Measures how long pdfium_test takes to open a PDF with many object streams.
+
+Writes a PDF with a cross reference stream, in which every page lives in an
+object stream of its own next to a number of filler objects, so that
+traversing the pages decompresses every object stream once. Then renders it
+with pdfium_test, first loading the object streams lazily and then up front
+with --load-objstms on 1 and on more threads, and reports the wall-clock time
+of each run."""
+
+import multiprocessing
+import optparse
+import os
+import random
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+import zlib
+
+
+def WriteObjectStreamPdf(path, pages, fillers):
+  rng = random.Random(pages * 1000 + fillers)
+  # Objects 1 and 2 are the catalog and the page tree, 3 is the shared empty
+  # content stream. Every page then takes one object stream object, the page
+  # and its fillers.
+  per_page = 2 + fillers
+  first_page = 4
+  size = first_page + pages * per_page + 1
+  page_nums = [first_page + i * per_page + 1 for i in range(pages)]
+
+  offsets = {}
+  in_stream = {}
+  out = [b'%PDF-1.7\n']
+  pos = len(out[0])
+
+  def Add(objnum, body):
+    offsets[objnum] = pos
+    data = b'%d 0 obj\n%s\nendobj\n' % (objnum, body)
+    out.append(data)
+    return len(data)
+
+  kids = b' '.join(b'%d 0 R' % num for num in page_nums)
+  pos += Add(1, b'<< /Type /Catalog /Pages 2 0 R >>')
+  pos += Add(2, b'<< /Type /Pages /Kids [%s] /Count %d >>' % (kids, pages))
+  pos += Add(3, b'<< /Length 0 >>\nstream\n\nendstream')
+  for i in range(pages):
+    stm_num = first_page + i * per_page
+    objects = [(page_nums[i],
+                b'<< /Type /Page /Parent 2 0 R /MediaBox [0 0 200 200] '
+                b'/Contents 3 0 R >>')]
+    for j in range(fillers):
+      values = b' '.join(b'%d' % rng.randint(0, 1 << 30) for _ in range(80))
+      objects.append((page_nums[i] + 1 + j, b'<< /Filler [%s] >>' % values))
+    header = []
+    bodies = []
+    body_pos = 0
+    for index, (objnum, body) in enumerate(objects):
+      header.append(b'%d %d' % (objnum, body_pos))
+      bodies.append(body)
+      body_pos += len(body) + 1
+      in_stream[objnum] = (stm_num, index)
+    header = b' '.join(header) + b'\n'
+    data = zlib.compress(header + b'\n'.join(bodies) + b'\n')
+    pos += Add(stm_num,
+               b'<< /Type /ObjStm /N %d /First %d /Filter /FlateDecode '
+               b'/Length %d >>\nstream\n%s\nendstream' %
+               (len(objects), len(header), len(data), data))
+
+  xref_num = size - 1
+  offsets[xref_num] = pos
+  rows = []
+  for objnum in range(size):
+    if objnum in offsets:
+      rows.append(struct.pack('>BIH', 1, offsets[objnum], 0))
+    elif objnum in in_stream:
+      rows.append(struct.pack('>BIH', 2, in_stream[objnum][0],
+                              in_stream[objnum][1]))
+    else:
+      rows.append(struct.pack('>BIH', 0, 0, 65535))
+  xref = b''.join(rows)
+  out.append(b'%d 0 obj\n<< /Type /XRef /Size %d /W [1 4 2] /Root 1 0 R '
+             b'/Length %d >>\nstream\n%s\nendstream\nendobj\n' %
+             (xref_num, size, len(xref), xref))
+  out.append(b'startxref\n%d\n%%%%EOF\n' % pos)
+  with open(path, 'wb') as f:
+    f.write(b''.join(out))
+
+
+def TimeRun(command, runs):
+  best = None
+  with open(os.devnull, 'w') as devnull:
+    for _ in range(runs):
+      start = time.time()
+      ret = subprocess.call(command, stdout=devnull, stderr=devnull)
+      elapsed = time.time() - start
+      if ret:
+        print('%s failed with exit code %d' % (command[0], ret))
+        sys.exit(ret)
+      best = elapsed if best is None else min(best, elapsed)
+  return best
+
+
+def main():
+  parser = optparse.OptionParser(usage='%prog [options] path/to/pdfium_test')
+  parser.add_option('--pages', type='int', default=1000,
+                    help='pages, and so object streams, in the PDF')
+  parser.add_option('--fillers', type='int', default=100,
+                    help='filler objects of about 800 bytes per object stream')
+  parser.add_option('--threads', type='int',
+                    default=multiprocessing.cpu_count(),
+                    help='threads for the parallel run')
+  parser.add_option('--runs', type='int', default=3,
+                    help='runs per mode, of which the fastest is reported')
+  options, args = parser.parse_args()
+  if len(args) != 1:
+    parser.error('expected the path to pdfium_test')
+  pdfium_test = os.path.abspath(args[0])
+
+  work_dir = tempfile.mkdtemp()
+  try:
+    pdf_path = os.path.join(work_dir, 'objstm.pdf')
+    WriteObjectStreamPdf(pdf_path, options.pages, options.fillers)
+    print('%d object streams, %.1f MB' %
+          (options.pages, os.path.getsize(pdf_path) / 1048576.0))
+    modes = [('lazy', [])]
+    for threads in sorted(set([1, options.threads])):
+      modes.append(('%d threads' % threads,
+                    ['--load-objstms=%d' % threads]))
+    lazy = None
+    for name, flags in modes:
+      elapsed = TimeRun([pdfium_test] + flags + [pdf_path], options.runs)
+      if lazy is None:
+        lazy = elapsed
+        print('%-12s %7.3f s' % (name, elapsed))
+      else:
+        print('%-12s %7.3f s  speedup %.2fx' % (name, elapsed,
+                                                lazy / elapsed))
+  finally:
+    shutil.rmtree(work_dir)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
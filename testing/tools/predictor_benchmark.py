@@ -0,0 +1,150 @@
+#!/usr/bin/env python
+# Copyright 2016 The PDFium Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""Measures how long pdfium_test takes to decode images with predictors.
+
+Writes one PDF per PNG filter type and pixel size, plus one for the TIFF
+predictor, each with a single large FlateDecode image. Any filtered bytes
+decode to some image, so the rows are random bytes behind the chosen filter
+type byte. Then renders every PDF with pdfium_test and reports the
+wall-clock time without writing any output. With --baseline, renders them
+with a second pdfium_test as well, e.g. one built without the vectorized
+predictors, reports the speedup and checks that both render the same
+PNGs."""
+
+import filecmp
+import optparse
+import os
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+import zlib
+
+PNG_FILTERS = [('sub', 1), ('up', 2), ('average', 3), ('paeth', 4)]
+COLOR_SPACES = {1: b'/DeviceGray', 3: b'/DeviceRGB', 4: b'/DeviceCMYK'}
+
+
+def WriteImagePdf(path, width, height, colors, filter_type):
+  rng = random.Random(colors * 10 + (filter_type or 0))
+  row_size = width * colors
+  # A few distinct rows keep generating the data fast.
+  samples = [bytes(bytearray(rng.getrandbits(8) for _ in range(row_size)))
+             for _ in range(16)]
+  rows = []
+  for y in range(height):
+    if filter_type is not None:
+      rows.append(bytes(bytearray([filter_type])))
+    rows.append(samples[y % len(samples)])
+  data = zlib.compress(b''.join(rows))
+  predictor = 2 if filter_type is None else 10 + filter_type
+
+  objects = [
+      b'<< /Type /Catalog /Pages 2 0 R >>',
+      b'<< /Type /Pages /Kids [3 0 R] /Count 1 >>',
+      b'<< /Type /Page /Parent 2 0 R /MediaBox [0 0 600 600] '
+      b'/Resources << /XObject << /Im1 5 0 R >> >> /Contents 4 0 R >>',
+  ]
+  content = b'q 600 0 0 600 0 0 cm /Im1 Do Q'
+  objects.append(b'<< /Length %d >>\nstream\n%s\nendstream' %
+                 (len(content), content))
+  objects.append(
+      b'<< /Type /XObject /Subtype /Image /Width %d /Height %d '
+      b'/ColorSpace %s /BitsPerComponent 8 /Filter /FlateDecode '
+      b'/DecodeParms << /Predictor %d /Colors %d /Columns %d >> '
+      b'/Length %d >>\nstream\n%s\nendstream' %
+      (width, height, COLOR_SPACES[colors], predictor, colors, width,
+       len(data), data))
+  with open(path, 'wb') as f:
+    f.write(b'%PDF-1.7\n')
+    offsets = []
+    for objnum, body in enumerate(objects, 1):
+      offsets.append(f.tell())
+      f.write(b'%d 0 obj\n%s\nendobj\n' % (objnum, body))
+    xref_pos = f.tell()
+    f.write(b'xref\n0 %d\n' % (len(objects) + 1))
+    f.write(b'0000000000 65535 f \n')
+    for offset in offsets:
+      f.write(b'%010d 00000 n \n' % offset)
+    f.write(b'trailer\n<< /Size %d /Root 1 0 R >>\n' % (len(objects) + 1))
+    f.write(b'startxref\n%d\n%%%%EOF\n' % xref_pos)
+
+
+def Run(command):
+  with open(os.devnull, 'w') as devnull:
+    ret = subprocess.call(command, stdout=devnull, stderr=devnull)
+  if ret:
+    print('%s failed with exit code %d' % (command[0], ret))
+    sys.exit(ret)
+
+
+def TimeRun(pdfium_test, pdf_path, runs):
+  best = None
+  for _ in range(runs):
+    start = time.time()
+    Run([pdfium_test, pdf_path])
+    elapsed = time.time() - start
+    best = elapsed if best is None else min(best, elapsed)
+  return best
+
+
+def main():
+  parser = optparse.OptionParser(usage='%prog [options] path/to/pdfium_test')
+  parser.add_option('--size', type='int', default=4000,
+                    help='width and height of every image in pixels')
+  parser.add_option('--runs', type='int', default=3,
+                    help='runs per PDF, of which the fastest is reported')
+  parser.add_option('--baseline',
+                    help='a second pdfium_test to compare against')
+  options, args = parser.parse_args()
+  if len(args) != 1:
+    parser.error('expected the path to pdfium_test')
+  binaries = [os.path.abspath(args[0])]
+  if options.baseline:
+    binaries.append(os.path.abspath(options.baseline))
+
+  cases = []
+  for colors in (1, 3, 4):
+    for name, filter_type in PNG_FILTERS:
+      cases.append(('png-%s-%d' % (name, colors), colors, filter_type))
+  cases.append(('tiff-3', 3, None))
+
+  work_dir = tempfile.mkdtemp()
+  try:
+    different = 0
+    for name, colors, filter_type in cases:
+      times = []
+      pngs = []
+      for index, binary in enumerate(binaries):
+        run_dir = os.path.join(work_dir, str(index))
+        if not os.path.isdir(run_dir):
+          os.mkdir(run_dir)
+        pdf_path = os.path.join(run_dir, name + '.pdf')
+        WriteImagePdf(pdf_path, options.size, options.size, colors,
+                      filter_type)
+        times.append(TimeRun(binary, pdf_path, options.runs))
+        if len(binaries) > 1:
+          Run([binary, '--png', pdf_path])
+          pngs.append(pdf_path + '.0.png')
+      line = '%-16s %7.3f s' % (name, times[0])
+      if len(times) > 1:
+        line += '  baseline %7.3f s  speedup %.2fx' % (times[1],
+                                                       times[1] / times[0])
+        if not filecmp.cmp(pngs[0], pngs[1], False):
+          line += '  DIFFERENT OUTPUT'
+          different += 1
+      print(line)
+    if different:
+      print('%d images render differently from the baseline' % different)
+      return 1
+  finally:
+    shutil.rmtree(work_dir)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -0,0 +1,98 @@
+#!/usr/bin/env python
+# Copyright 2016 The PDFium Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""Measures how long pdfium_test takes to open a large damaged PDF.
+
+Writes a synthetic one-page PDF whose startxref offset is wrong and whose
+streams mostly have the wrong /Length, so that opening it has to rebuild
+the cross reference table by scanning the whole file and searching each
+stream for its end. Then runs pdfium_test on it and reports the wall-clock
+time to load and render the first page."""
+
+import optparse
+import os
+import random
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def WriteDamagedPdf(path, size_mb, bad_length_ratio):
+  rng = random.Random(1)
+  text = b''.join(b'BT /F1 12 Tf %d %d Td (Line %d) Tj ET\n' % (i, i, i)
+                  for i in range(2000))
+  with open(path, 'wb') as f:
+    def WriteObject(objnum, body):
+      f.write(b'%d 0 obj\n%s\nendobj\n' % (objnum, body))
+
+    def WriteStream(objnum, data, length):
+      WriteObject(objnum, b'<< /Length %d >>\nstream\n%s\nendstream' %
+                          (length, data))
+
+    f.write(b'%PDF-1.7\n%\xe2\xe3\xcf\xd3\n')
+    WriteObject(1, b'<< /Type /Catalog /Pages 2 0 R >>')
+    WriteObject(2, b'<< /Type /Pages /Kids [3 0 R] /Count 1 >>')
+    WriteObject(3, b'<< /Type /Page /Parent 2 0 R '
+                   b'/MediaBox [0 0 200 200] /Contents 4 0 R >>')
+    content = b'0 0 1 rg 50 50 100 100 re f'
+    WriteStream(4, content, len(content))
+
+    objnum = 5
+    while f.tell() < size_mb * 1024 * 1024:
+      if objnum % 2:
+        data = bytearray(rng.getrandbits(8) for _ in range(4096)) * 16
+        # Keep the keywords the scan looks for out of the binary data.
+        data = bytes(data).replace(b'end', b'xxx').replace(b'(', b'x')
+      else:
+        data = text[:rng.randint(1000, len(text))]
+      length = len(data)
+      if rng.random() < bad_length_ratio:
+        length = 1
+      WriteStream(objnum, data, length)
+      objnum += 1
+
+    f.write(b'trailer\n<< /Size %d /Root 1 0 R >>\n' % objnum)
+    f.write(b'startxref\n%d\n%%%%EOF\n' % (f.tell() * 2))
+
+
+def main():
+  parser = optparse.OptionParser(usage='%prog [options] path/to/pdfium_test')
+  parser.add_option('--size', type='int', default=200,
+                    help='approximate size of the PDF in MB')
+  parser.add_option('--bad-lengths', type='float', default=0.9,
+                    help='fraction of streams with a wrong /Length')
+  parser.add_option('--keep', action='store_true', default=False,
+                    help='keep the generated PDF')
+  options, args = parser.parse_args()
+  if len(args) != 1:
+    parser.error('expected the path to pdfium_test')
+
+  fd, pdf_path = tempfile.mkstemp(suffix='.pdf')
+  os.close(fd)
+  try:
+    WriteDamagedPdf(pdf_path, options.size, options.bad_lengths)
+    size_mb = os.path.getsize(pdf_path) / (1024.0 * 1024.0)
+    print('Generated %s: %.1f MB' % (pdf_path, size_mb))
+
+    start = time.time()
+    with open(os.devnull, 'w') as devnull:
+      ret = subprocess.call([args[0], pdf_path], stdout=devnull)
+    elapsed = time.time() - start
+    if ret:
+      print('pdfium_test failed with exit code %d' % ret)
+      return ret
+
+    print('Time to first page: %.2f s' % elapsed)
+  finally:
+    if options.keep:
+      print('Kept %s' % pdf_path)
+    else:
+      os.remove(pdf_path)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
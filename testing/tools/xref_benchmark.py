@@ -0,0 +1,89 @@
+#!/usr/bin/env python
+# Copyright 2016 The PDFium Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""Measures how pdfium_test copes with a very large cross reference table.
+
+Writes a synthetic one-page PDF whose xref table lists the requested number
+of objects, then runs pdfium_test on it and reports the wall-clock time to
+load and render the first page together with the peak resident set size."""
+
+import optparse
+import os
+import resource
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def WriteLargeXRefPdf(path, object_count):
+  offsets = []
+  with open(path, 'wb') as f:
+    def WriteObject(objnum, body):
+      offsets.append((objnum, f.tell()))
+      f.write(b'%d 0 obj\n%s\nendobj\n' % (objnum, body))
+
+    f.write(b'%PDF-1.7\n')
+    WriteObject(1, b'<< /Type /Catalog /Pages 2 0 R >>')
+    WriteObject(2, b'<< /Type /Pages /Kids [3 0 R] /Count 1 >>')
+    WriteObject(3, b'<< /Type /Page /Parent 2 0 R '
+                   b'/MediaBox [0 0 200 200] /Contents 4 0 R >>')
+    content = b'0 0 1 rg 50 50 100 100 re f'
+    WriteObject(4, b'<< /Length %d >>\nstream\n%s\nendstream' %
+                   (len(content), content))
+    for objnum in range(5, object_count):
+      WriteObject(objnum, b'%d' % objnum)
+
+    xref_pos = f.tell()
+    f.write(b'xref\n0 %d\n' % object_count)
+    f.write(b'0000000000 65535 f \n')
+    for _, offset in offsets:
+      f.write(b'%010d 00000 n \n' % offset)
+    f.write(b'trailer\n<< /Size %d /Root 1 0 R >>\n' % object_count)
+    f.write(b'startxref\n%d\n%%%%EOF\n' % xref_pos)
+
+
+def main():
+  parser = optparse.OptionParser(usage='%prog [options] path/to/pdfium_test')
+  parser.add_option('--objects', type='int', default=5000000,
+                    help='number of objects in the xref table')
+  parser.add_option('--keep', action='store_true', default=False,
+                    help='keep the generated PDF')
+  options, args = parser.parse_args()
+  if len(args) != 1:
+    parser.error('expected the path to pdfium_test')
+
+  fd, pdf_path = tempfile.mkstemp(suffix='.pdf')
+  os.close(fd)
+  try:
+    WriteLargeXRefPdf(pdf_path, options.objects)
+    size_mb = os.path.getsize(pdf_path) / (1024.0 * 1024.0)
+    print('Generated %s: %d objects, %.1f MB' %
+          (pdf_path, options.objects, size_mb))
+
+    start = time.time()
+    with open(os.devnull, 'w') as devnull:
+      ret = subprocess.call([args[0], pdf_path], stdout=devnull)
+    elapsed = time.time() - start
+    if ret:
+      print('pdfium_test failed with exit code %d' % ret)
+      return ret
+
+    # ru_maxrss is in kilobytes on Linux and in bytes on Mac.
+    peak = resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss
+    if sys.platform == 'darwin':
+      peak /= 1024
+    print('Time to first page: %.2f s' % elapsed)
+    print('Peak memory: %.1f MB' % (peak / 1024.0))
+  finally:
+    if options.keep:
+      print('Kept %s' % pdf_path)
+    else:
+      os.remove(pdf_path)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())